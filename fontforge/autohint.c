@@ -32,7 +32,9 @@
 #include "cvundoes.h"
 #include "dumppfa.h"
 #include "edgelist.h"
+#include "ffglib.h"
 #include "fontforge.h"
+#include "parallel.h"
 #include "psread.h"
 #include "splinefill.h"
 #include "splinefont.h"
@@ -45,6 +47,7 @@
 #include "views.h"
 
 #include <math.h>
+#include <stddef.h>
 #include <stdio.h>
 
 float OpenTypeLoadHintEqualityTolerance = 0.0;
@@ -2618,7 +2621,7 @@ static void MMHFreeList(MMH *mmh) {
 	    n = c->next;
 	    chunkfree(c,sizeof(struct coords));
 	}
-	chunkfree(mmh,sizeof(struct coords));
+	chunkfree(mmh,sizeof(MMH));
     }
 }
 
@@ -2929,47 +2932,74 @@ static real clampToIfNear( real exact, real fluffy, real Tolerance )
 }
 
 
-void _SplineCharAutoHint( SplineChar *sc, int layer, BlueData *bd, struct glyphdata *gd2,
-	int gen_undoes ) {
-    struct glyphdata *gd;
-
-    if ( gen_undoes )
-	SCPreserveHints(sc,layer);
-    StemInfosFree(sc->vstem); sc->vstem=NULL;
-    StemInfosFree(sc->hstem); sc->hstem=NULL;
-    DStemInfosFree(sc->dstem); sc->dstem=NULL;
-    MinimumDistancesFree(sc->md); sc->md=NULL;
-
-    free(sc->countermasks);
-    sc->countermasks = NULL; sc->countermask_cnt = 0;
-    /* We'll free the hintmasks when we call SCFigureHintMasks */
+/* The stems of a glyph's outlines. Finding them touches nothing outside */
+/*  the glyph, so several glyphs may be searched at once */
+struct ahstems {
+    uint64_t fingerprint;		/* Of what they were found from, 0 if unknown */
+    StemInfo *hstem, *vstem;
+    DStemInfo *dstem;
+};
 
-    sc->changedsincelasthinted = false;
-    sc->manualhints = false;
+static void SCFindStems( SplineChar *sc, int layer, BlueData *bd, struct glyphdata *gd2,
+	struct ahstems *found ) {
+    struct glyphdata *gd;
 
+    found->hstem = found->vstem = NULL;
+    found->dstem = NULL;
     if ( (gd=gd2)==NULL )
 	gd = GlyphDataBuild( sc,layer,bd,false );
     if ( gd!=NULL ) {
 	
-	sc->vstem = GDFindStems(gd,1);
-	sc->hstem = GDFindStems(gd,0);
+	found->vstem = GDFindStems(gd,1);
+	found->hstem = GDFindStems(gd,0);
 
 	if ( !gd->only_hv )
-	    sc->dstem = GDFindDStems(gd);
+	    found->dstem = GDFindDStems(gd);
 	if ( gd2==NULL ) GlyphDataFree(gd);
     }
 
     real AutohintRoundingTolerance = 0.005;
-    StemInfo* s = sc->hstem;
+    StemInfo* s = found->hstem;
     for( ; s; s = s->next )
     {
 	s->width = clampToIfNear( 20.0, s->width, AutohintRoundingTolerance );
 	s->width = clampToIfNear( 21.0, s->width, AutohintRoundingTolerance );
     }
+}
+
+/* Gives the glyph the stems found for it, and hints its references */
+static void SCSetAutoHints( SplineChar *sc, int layer, BlueData *bd, struct ahstems *found,
+	int gen_undoes ) {
+
+    if ( gen_undoes )
+	SCPreserveHints(sc,layer);
+    StemInfosFree(sc->vstem); sc->vstem=NULL;
+    StemInfosFree(sc->hstem); sc->hstem=NULL;
+    DStemInfosFree(sc->dstem); sc->dstem=NULL;
+    MinimumDistancesFree(sc->md); sc->md=NULL;
+
+    free(sc->countermasks);
+    sc->countermasks = NULL; sc->countermask_cnt = 0;
+    /* We'll free the hintmasks when we call SCFigureHintMasks */
+
+    sc->changedsincelasthinted = false;
+    sc->manualhints = false;
+
+    sc->vstem = found->vstem;
+    sc->hstem = found->hstem;
+    sc->dstem = found->dstem;
 
     AutoHintRefs(sc,layer,bd,false,gen_undoes);
 }
 
+void _SplineCharAutoHint( SplineChar *sc, int layer, BlueData *bd, struct glyphdata *gd2,
+	int gen_undoes ) {
+    struct ahstems found;
+
+    SCFindStems(sc,layer,bd,gd2,&found);
+    SCSetAutoHints(sc,layer,bd,&found,gen_undoes);
+}
+
 static void __SplineCharAutoHint( SplineChar *sc, int layer, BlueData *bd, int gen_undoes ) {
     MMSet *mm = sc->parent->mm;
     int i;
@@ -3021,11 +3051,230 @@ return( true );
 return( false );
 }
     
+/* Almost all the time autohinting takes goes into finding stems, and the */
+/*  stems found depend only on the outlines, on a few things about the */
+/*  font (its blues, em size, italic angle, BlueFuzz and whether it is */
+/*  quadratic) and on the hinting preferences. So the font remembers the */
+/*  stems found for a fingerprint of all of those, and a glyph whose */
+/*  outlines come back to ones hinted before (after an undo, say, or when */
+/*  changedsincelasthinted was set by something which didn't really */
+/*  change them) gets a copy rather than being searched again */
+struct autohintcache {
+    GHashTable *stems;			/* fingerprint => struct ahstems */
+    int limit;				/* Start afresh once it holds this many */
+};
+
+static void AHStemsFree(gpointer data) {
+    struct ahstems *stems = data;
+
+    StemInfosFree(stems->hstem);
+    StemInfosFree(stems->vstem);
+    DStemInfosFree(stems->dstem);
+    free(stems);
+}
+
+void AutoHintCacheFree(struct autohintcache *ahc) {
+
+    if ( ahc==NULL )
+return;
+    g_hash_table_destroy(ahc->stems);
+    free(ahc);
+}
+
+/* Of everything but the outlines that the stems found in sf depend on */
+static uint64_t AHFontFingerprint(SplineFont *sf,int layer,BlueData *bd) {
+    uint64_t hash = FINGERPRINT_START;
+    int ints[7];
+    float slopes[2];
+    char *fuzz;
+
+    ints[0] = sf->ascent+sf->descent;
+    ints[1] = sf->layers[layer].order2;
+    ints[2] = hint_diagonal_ends;
+    ints[3] = hint_diagonal_intersections;
+    ints[4] = hint_bounding_boxes;
+    ints[5] = detect_diagonal_stems;
+    ints[6] = bd->bluecnt;
+    hash = FingerprintAdd(hash,ints,sizeof(ints));
+    slopes[0] = stem_slope_error; slopes[1] = stub_slope_error;
+    hash = FingerprintAdd(hash,slopes,sizeof(slopes));
+    hash = FingerprintAdd(hash,&sf->italicangle,sizeof(sf->italicangle));
+    if ( sf->private!=NULL && (fuzz=PSDictHasEntry(sf->private,"BlueFuzz"))!=NULL )
+	hash = FingerprintAdd(hash,fuzz,strlen(fuzz));
+    /* The heights before bluecnt are all reals, and so not padded */
+    hash = FingerprintAdd(hash,bd,offsetof(BlueData,bluecnt));
+    hash = FingerprintAdd(hash,bd->blues,bd->bluecnt*sizeof(bd->blues[0]));
+return( hash );
+}
+
+/* Of the outlines of sc and the point numbers GlyphDataBuild will find on */
+/*  them. Cubic points are numbered afresh from the outlines alone (which */
+/*  is what GlyphDataBuild would do anyway), so a glyph merely renumbered */
+/*  since it was last hinted still matches. Quadratic numbering depends on */
+/*  the numbers already there, so those are hashed as they are. Stem */
+/*  finding also looks at the bounds of the whole glyph (references and */
+/*  all layers included), so those go in too */
+static uint64_t AHGlyphFingerprint(SplineChar *sc,int layer,uint64_t font) {
+    uint64_t hash = font;
+    SplineSet *ss;
+    SplinePoint *sp;
+    DBounds bb;
+    int flags;
+
+    if ( layer<0 || layer>=sc->layer_cnt || sc->layers[layer].splines==NULL )
+return( 0 );
+    if ( !sc->layers[layer].order2 )
+	SCNumberPoints(sc,layer);
+    SplineCharFindBounds(sc,&bb);
+    hash = FingerprintAdd(hash,&bb,sizeof(bb));
+    for ( ss=sc->layers[layer].splines; ss!=NULL; ss=ss->next ) {
+	for ( sp=ss->first; ; ) {
+	    hash = FingerprintAdd(hash,&sp->me,sizeof(BasePoint));
+	    hash = FingerprintAdd(hash,&sp->nextcp,sizeof(BasePoint));
+	    hash = FingerprintAdd(hash,&sp->prevcp,sizeof(BasePoint));
+	    flags = sp->nonextcp | (sp->noprevcp<<1) | (sp->pointtype<<2) |
+		    ((sp->next!=NULL)<<4) | ((sp->prev!=NULL)<<5) |
+		    (sp->ttfindex<<6);
+	    hash = FingerprintAdd(hash,&flags,sizeof(flags));
+	    hash = FingerprintAdd(hash,&sp->nextcpindex,sizeof(sp->nextcpindex));
+	    if ( sp->next==NULL )
+	break;
+	    sp = sp->next->to;
+	    if ( sp==ss->first )
+	break;
+	}
+	flags = -1;			/* End of contour */
+	hash = FingerprintAdd(hash,&flags,sizeof(flags));
+    }
+return( hash==0 ? 1 : hash );
+}
+
+struct ahwork {
+    SplineChar **glyphs;
+    struct ahstems *found;
+    uint8 *cached, *done;
+    GHashTable *cache;
+    uint64_t *font;			/* Fingerprint of each glyph's (sub)font */
+    int layer;
+    BlueData *bd;
+};
+
+static void AHFindStemsWork(int i,void *data) {
+    struct ahwork *work = data;
+    SplineChar *sc = work->glyphs[i];
+    struct ahstems *found = &work->found[i], *old;
+
+    found->fingerprint = AHGlyphFingerprint(sc,work->layer,work->font[i]);
+    if ( found->fingerprint!=0 &&
+	    (old = g_hash_table_lookup(work->cache,&found->fingerprint))!=NULL ) {
+	found->hstem = StemInfoCopy(old->hstem);
+	found->vstem = StemInfoCopy(old->vstem);
+	found->dstem = DStemInfoCopy(old->dstem);
+	work->cached[i] = true;
+    } else
+	SCFindStems(sc,work->layer,work->bd,NULL,found);
+    work->done[i] = true;
+}
+
+/* The glyphs SFSCAutoHint would hint for sc, in the order it would */
+static void SCAutoHintOrder(SplineChar *sc,SplineChar **glyphs,int *cnt) {
+    RefChar *ref;
+
+    if ( sc->ticked )
+return;
+    for ( ref=sc->layers[ly_fore].refs; ref!=NULL; ref=ref->next ) {
+	if ( !ref->sc->ticked )
+	    SCAutoHintOrder(ref->sc,glyphs,cnt);
+    }
+    sc->ticked = true;
+    glyphs[(*cnt)++] = sc;
+}
+
+/* Does what calling SFSCAutoHint on each of the glyphs would (so they */
+/*  must start unticked, as must any references that are to be hinted */
+/*  first), but looks for the stems of all of them at once first, on as */
+/*  many threads as ff_parallel_jobs allows. The progress indicator */
+/*  advances once per glyph hinted, and if it is cancelled no more get */
+/*  hinted */
+void SFAutoHintGlyphs(SplineFont *_sf,int layer,BlueData *bd,SplineChar **glyphs,int cnt) {
+    struct ahwork work;
+    struct ahstems *stems;
+    SplineChar *sc;
+    int i, k, total, order_cnt;
+    uint64_t font = 0;
+    SplineFont *last = NULL;
+
+    if ( _sf->mm!=NULL || bd==NULL ) {
+	/* Each instance of a multiple master is hinted with its own blues */
+	for ( i=0; i<cnt; ++i ) {
+	    SFSCAutoHint(glyphs[i],layer,bd);
+	    if ( !ff_progress_next())
+	break;
+	}
+return;
+    }
+
+    k=total=0;
+    do {
+	total += _sf->subfontcnt==0 ? _sf->glyphcnt : _sf->subfonts[k]->glyphcnt;
+	++k;
+    } while ( k<_sf->subfontcnt );
+
+    memset(&work,0,sizeof(work));
+    work.glyphs = malloc((total+1)*sizeof(SplineChar *));
+    order_cnt = 0;
+    for ( i=0; i<cnt; ++i )
+	SCAutoHintOrder(glyphs[i],work.glyphs,&order_cnt);
+    work.found = calloc(order_cnt+1,sizeof(struct ahstems));
+    work.cached = calloc(order_cnt+1,1);
+    work.done = calloc(order_cnt+1,1);
+    work.font = malloc((order_cnt+1)*sizeof(uint64_t));
+    for ( i=0; i<order_cnt; ++i ) {
+	if ( work.glyphs[i]->parent!=last ) {
+	    last = work.glyphs[i]->parent;
+	    font = AHFontFingerprint(last,layer,bd);
+	}
+	work.font[i] = font;
+    }
+    work.layer = layer;
+    work.bd = bd;
+    if ( _sf->ahcache==NULL ) {
+	_sf->ahcache = calloc(1,sizeof(struct autohintcache));
+	_sf->ahcache->stems = g_hash_table_new_full(g_int64_hash,g_int64_equal,NULL,AHStemsFree);
+    }
+    /* Entries for outlines long since edited away are never looked for */
+    /*  again, don't let them pile up */
+    _sf->ahcache->limit = 2*total+256;
+    if ( (int) g_hash_table_size(_sf->ahcache->stems)+order_cnt>_sf->ahcache->limit )
+	g_hash_table_remove_all(_sf->ahcache->stems);
+    work.cache = _sf->ahcache->stems;
+
+    ParallelFor(order_cnt,AHFindStemsWork,&work,true);
+
+    for ( i=0; i<order_cnt; ++i ) if ( work.done[i] ) {
+	sc = work.glyphs[i];
+	if ( !work.cached[i] && work.found[i].fingerprint!=0 &&
+		g_hash_table_lookup(work.cache,&work.found[i].fingerprint)==NULL ) {
+	    stems = malloc(sizeof(struct ahstems));
+	    stems->fingerprint = work.found[i].fingerprint;
+	    stems->hstem = StemInfoCopy(work.found[i].hstem);
+	    stems->vstem = StemInfoCopy(work.found[i].vstem);
+	    stems->dstem = DStemInfoCopy(work.found[i].dstem);
+	    g_hash_table_insert(work.cache,&stems->fingerprint,stems);
+	}
+	SCSetAutoHints(sc,layer,bd,&work.found[i],true);
+	SCFigureHintMasks(sc,layer);
+	SCUpdateAll(sc);
+    }
+    free(work.glyphs); free(work.found); free(work.font);
+    free(work.cached); free(work.done);
+}
+
 void SplineFontAutoHint( SplineFont *_sf,int layer) {
-    int i,k;
+    int i,k,cnt,total,glyphcnt;
     SplineFont *sf;
     BlueData *bd = NULL, _bd;
-    SplineChar *sc;
+    SplineChar *sc, **glyphs;
 
     if ( _sf->mm==NULL ) {
 	QuickBlues(_sf,layer,&_bd);
@@ -3033,28 +3282,33 @@ void SplineFontAutoHint( SplineFont *_sf,int layer) {
     }
 
     /* Tick the ones we don't want to AH, untick the ones that need AH */
-    k=0;
+    k=total=0;
     do {
 	sf = _sf->subfontcnt==0 ? _sf : _sf->subfonts[k];
 	for ( i=0; i<sf->glyphcnt; ++i ) if ( (sc = sf->glyphs[i])!=NULL )
 	    sc->ticked = ( !sc->changedsincelasthinted || sc->manualhints );
+	total += sf->glyphcnt;
 	++k;
     } while ( k<_sf->subfontcnt );
 
-    k=0;
+    glyphs = malloc((total+1)*sizeof(SplineChar *));
+    k=cnt=glyphcnt=0;
     do {
 	sf = _sf->subfontcnt==0 ? _sf : _sf->subfonts[k];
-	for ( i=0; i<sf->glyphcnt; ++i ) if ( sf->glyphs[i]!=NULL ) {
-	    if ( sf->glyphs[i]->changedsincelasthinted &&
-		    !sf->glyphs[i]->manualhints )
-		SFSCAutoHint(sf->glyphs[i],layer,bd);
-	    if ( !ff_progress_next()) {
-		k = _sf->subfontcnt+1;
-	break;
-	    }
+	for ( i=0; i<sf->glyphcnt; ++i ) if ( (sc = sf->glyphs[i])!=NULL ) {
+	    if ( !sc->ticked )
+		glyphs[cnt++] = sc;
+	    ++glyphcnt;
 	}
 	++k;
     } while ( k<_sf->subfontcnt );
+    SFAutoHintGlyphs(_sf,layer,bd,glyphs,cnt);
+    free(glyphs);
+
+    /* The progress indicator counts every glyph, hinted or not */
+    for ( i=cnt; i<glyphcnt; ++i )
+	if ( !ff_progress_next())
+    break;
 }
 
 void SplineFontAutoHintRefs( SplineFont *_sf,int layer) {
@@ -43,5 +43,7 @@ extern void SFSCAutoHint(SplineChar *sc, int layer, BlueData *bd);
 extern void SplineCharAutoHint(SplineChar *sc, int layer, BlueData *bd);
 extern void _SplineCharAutoHint(SplineChar *sc, int layer, BlueData *bd, struct glyphdata *gd2, int gen_undoes);
 extern void SplineFontAutoHintRefs(SplineFont *_sf, int layer);
+extern void AutoHintCacheFree(struct autohintcache *ahc);
+extern void SFAutoHintGlyphs(SplineFont *_sf, int layer, BlueData *bd, SplineChar **glyphs, int cnt);
 
 #endif /* FONTFORGE_AUTOHINT_H */
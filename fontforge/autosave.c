@@ -108,6 +108,9 @@ return( false );
     }
     while ( (entry=readdir(dir))!=NULL ) {
 	if ( strcmp(entry->d_name,".")==0 || strcmp(entry->d_name,"..")==0 )
+    continue;
+	/* A snapshot which was still being written when we went down */
+	if ( entry->d_name[0]!='\0' && entry->d_name[strlen(entry->d_name)-1]=='~' )
     continue;
 	buffer = smprintf("%s/%s",recoverdir,entry->d_name);
 	fprintf( stderr, "Recovering from %s... ", buffer);
@@ -160,13 +163,17 @@ return;
 static void _DoAutoSaves(FontViewBase *fvs) {
     FontViewBase *fv;
     SplineFont *sf;
+    int changed, k;
 
     if ( AutoSaveFrequency<=0 )
 return;
 
     for ( fv=fvs; fv!=NULL; fv=fv->next ) {
 	sf = fv->cidmaster?fv->cidmaster:fv->sf;
-	if ( sf->changed_since_autosave ) {
+	changed = sf->changed_since_autosave;
+	for ( k=0; k<sf->subfontcnt && !changed; ++k )
+	    changed = sf->subfonts[k]->changed_since_autosave;
+	if ( changed ) {
 	    if ( sf->autosavename==NULL )
 		MakeAutoSaveName(sf);
 	    if ( sf->autosavename!=NULL )
@@ -823,7 +823,7 @@ return( NULL );
 			    _SCAutoTrace(sc, ly_fore, args);
 			    if ( mf_clearbackgrounds ) {
 				GImageDestroy(sc->layers[ly_back].images->image);
-			        free(sc->layers[ly_back].images);
+			        chunkfree(sc->layers[ly_back].images,sizeof(ImageList));
 			        sc->layers[ly_back].images = NULL;
 			    }
 			}
@@ -228,6 +228,7 @@ void AW_AutoKern(WidthInfo *wi) {
     SplineChar *lsc, *rsc;
     int i, diff;
     KernPair *kp;
+    struct kernpairindex *kern_index = KernPairIndexNew(wi->sf,false);
 
     for ( i=0; i<wi->pcnt; ++i ) {
 	cp = wi->pairs[i];
@@ -240,7 +241,7 @@ void AW_AutoKern(WidthInfo *wi) {
 	    diff = 0;
 	lsc = cp->left->sc;
 	rsc = cp->right->sc;
-	for ( kp = lsc->kerns; kp!=NULL && kp->sc!=rsc; kp = kp->next );
+	kp = KernPairIndexFind(kern_index,lsc,rsc);
 	if ( kp!=NULL ) {
 	    if ( kp->off!=diff ) {
 		kp->off = diff;
@@ -253,9 +254,11 @@ void AW_AutoKern(WidthInfo *wi) {
 	    kp->subtable = wi->subtable;
 	    kp->next = lsc->kerns;
 	    lsc->kerns = kp;
+	    KernPairIndexAdd(kern_index,lsc,kp);
 	    wi->sf->changed = true;
 	}
     }
+    KernPairIndexFree(kern_index);
     MVReKernAll(wi->fv->sf);
 }
 
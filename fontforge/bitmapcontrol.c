@@ -58,7 +58,7 @@ static void RemoveBDFWindows(BDFFont *bdf) {
 }
 
 static BDFFont *BDFNew(SplineFont *sf,int pixel_size, int depth) {
-    BDFFont *new = chunkalloc(sizeof(BDFFont));
+    BDFFont *new = calloc(1,sizeof(BDFFont));
     int linear_scale = 1<<(depth/2);
 
     new->sf = sf;
@@ -934,7 +934,7 @@ return( new );
 }
 
 BDFFont *BitmapFontScaleTo(BDFFont *old, int to) {
-    BDFFont *new = chunkalloc(sizeof(BDFFont));
+    BDFFont *new = calloc(1,sizeof(BDFFont));
     int i;
     int to_depth = (to>>16), old_depth = 1;
     int linear_scale = 1<<(to_depth/2);
@@ -353,7 +353,7 @@ static void FixupImages(SplineChar *sc,ImageList *uimgs,int layer) {
 		uimgs->yscale==cimgs->yscale  ) {
 	    unext = uimgs->next;
 	    cimgs->selected = uimgs->selected;
-	    free(uimgs);
+	    chunkfree(uimgs,sizeof(ImageList));
 	    uimgs = unext;
 	    cprev = cimgs;
 	    cimgs = cimgs->next;
@@ -367,7 +367,7 @@ static void FixupImages(SplineChar *sc,ImageList *uimgs,int layer) {
 		cprev->next = cend;
 	    while ( cimgs!=cend ) {
 		cnext = cimgs->next;
-		free(cimgs);
+		chunkfree(cimgs,sizeof(ImageList));
 		cimgs = cnext;
 	    }
 	} else { /* uimgs isn't on the list. Add it here */
@@ -1001,6 +1001,8 @@ static void SCUndoAct(SplineChar *sc,int layer, Undoes *undo) {
 	    undo->u.state.possub = possub;
 	    sc->comment = undo->u.state.comment;
 	    undo->u.state.comment = comment;
+	    SFHashRename(sc->parent,sc,temp);
+	    SFHashUnicodes(sc->parent,sc);
 	}
       } break;
       default:
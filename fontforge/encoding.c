@@ -413,7 +413,7 @@ return( NULL );
     if ( !make_it )
 return( NULL );
 
-    enc = chunkalloc(sizeof(Encoding));
+    enc = calloc(1,sizeof(Encoding));
     *enc = temp;
     enc->enc_name = copy(name);
     if ( iconv_name!=name )
@@ -477,7 +477,7 @@ return( 0 );			/* Failure */
     if ( strmatch(name,"unicode4")==0 || strmatch(name,"ucs4")==0 )
 return( 0 );			/* Failure */
 
-    enc = chunkalloc(sizeof(Encoding));
+    enc = calloc(1,sizeof(Encoding));
     enc->enc_name = copy(name);
     enc->next = enclist;
     enclist = enc;
@@ -1985,6 +1985,8 @@ return( true );
 	free(sf->glyphs[j]->name);
 	sf->glyphs[j]->name = copy(dummy.name);
     }
+    /* Most glyphs have new names and code points, start their index again */
+    GlyphHashFree(sf);
     /* We just changed the unicode values for most glyphs */
     /* but any references to them will have the old values, and that's bad, so fix 'em up */
     for ( i=0; i<sf->glyphcnt; ++i ) if ( sf->glyphs[i]!=NULL ) {
@@ -2231,6 +2233,11 @@ void SFRemoveGlyph( SplineFont *sf,SplineChar *sc ) {
     if ( sc==NULL )
 return;
 
+    /* The autosave journal can't drop a glyph, only a fresh snapshot leaves */
+    /*  it out */
+    (sf->cidmaster!=NULL ? sf->cidmaster : sf)->autosave_base = 0;
+    sf->changed_since_autosave = true;
+
     /* Close any open windows */
     SCCloseAllViews(sc);
 
@@ -2316,8 +2323,8 @@ return;
 	}
     }
 
+    SFHashRemoveGlyph(sf,sc);
     SplineCharFree(sc);
-    GlyphHashFree(sf);
 }
 
 static int MapAddEncodingSlot(EncMap *map,int gid) {
@@ -2260,6 +2260,15 @@ struct gpos_mark {
 
 #define MAXT	80
 #define MAXI	5
+
+/* Feature files are read a character at a time, and only the thread */
+/*  parsing one reads it, so there is no need to lock the stream for each */
+#if defined(__MINGW32__)
+# define fea_getc(in)	getc(in)
+#else
+# define fea_getc(in)	getc_unlocked(in)
+#endif
+
 struct parseState {
     char tokbuf[MAXT+1];
     long value;
@@ -2289,6 +2298,8 @@ struct parseState {
     int gm_cnt[2], gm_max[2], gm_pos[2];
     struct gdef_mark *gdef_mark[2];
     struct gpos_mark *gpos_mark;
+    GHashTable *keywords;	/* Keyword names, to their token types */
+    GHashTable *glyphnames;	/* Glyph names found so far, to their glyphs */
 };
 
 static struct keywords {
@@ -2403,17 +2414,17 @@ return;
     }
 
     in = tok->inlist[tok->inc_depth];
-    ch = getc(in);
+    ch = fea_getc(in);
     while ( isspace(ch))
-	ch = getc(in);
+	ch = fea_getc(in);
     pt = namebuf;
     while ( ch!=EOF && ch!=')' && pt<namebuf+sizeof(namebuf)-1 ) {
 	*pt++ = ch;
-	ch = getc(in);
+	ch = fea_getc(in);
     }
     if ( ch!=EOF && ch!=')' ) {
 	while ( ch!=EOF && ch!=')' )
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	LogError(_("Include filename too long on line %d of %s"), tok->line[tok->inc_depth], tok->filename[tok->inc_depth] );
 	++tok->err_count;
     }
@@ -2504,19 +2515,19 @@ return;
     }
 
   skip_whitespace:
-    ch = getc(in);
+    ch = fea_getc(in);
     while ( isspace(ch) || ch=='#' ) {
 	if ( ch=='#' )
-	    while ( (ch=getc(in))!=EOF && ch!='\n' && ch!='\r' );
+	    while ( (ch=fea_getc(in))!=EOF && ch!='\n' && ch!='\r' );
 	if ( ch=='\n' || ch=='\r' ) {
 	    if ( ch=='\r' ) {
-		ch = getc(in);
+		ch = fea_getc(in);
 		if ( ch!='\n' )
 		    ungetc(ch,in);
 	    }
 	    ++tok->line[tok->inc_depth];
 	}
-	ch = getc(in);
+	ch = fea_getc(in);
     }
 
     tok->could_be_tag = 0;
@@ -2534,7 +2545,7 @@ return;
 
     start = pt = tok->tokbuf;
     if ( ch=='\\' || ch=='-' ) {
-	peekch=getc(in);
+	peekch=fea_getc(in);
 	ungetc(peekch,in);
     }
 
@@ -2545,16 +2556,16 @@ return;
 		*pt++ = ch;
 		start = pt;
 	    }
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	} else if ( ch=='\\' ) {
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	    tok->type = tk_cid;
 	}
 	while ( (isdigit( ch ) ||
 		(tok->base==0 && (ch=='x' || ch=='X' || (ch>='a' && ch<='f') || (ch>='A' && ch<='F'))))
 		&& pt<tok->tokbuf+15 ) {
 	    *pt++ = ch;
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	}
 	if ( isdigit(ch)) {
 	    LogError(_("Number too long on line %d of %s"), tok->line[tok->inc_depth], tok->filename[tok->inc_depth] );
@@ -2574,16 +2585,16 @@ return;
 	    tok->type = tk_class;
 	    *pt++ = ch;
 	    start = pt;
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	    check_keywords = false;
 	} else if ( ch=='\\' ) {
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	    check_keywords = false;
 	}
 	while ( isalnum(ch) || ch=='_' || ch=='.' || (ch=='-' && tok->type==tk_class) ) {
 	    if ( pt<tok->tokbuf+MAXT )
 		*pt++ = ch;
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	}
 	*pt = '\0';
 	ungetc(ch,in);
@@ -2607,13 +2618,9 @@ return;
 		}
 
 		if ( check_keywords && do_keywords) {
-		    int i;
-		    for ( i=tk_firstkey; fea_keywords[i].name!=NULL; ++i ) {
-			if ( strcmp(fea_keywords[i].name,tok->tokbuf)==0 ) {
-			    tok->type = fea_keywords[i].tok;
-		    break;
-			}
-		    }
+		    gpointer keyword = g_hash_table_lookup(tok->keywords,tok->tokbuf);
+		    if ( keyword!=NULL )
+			tok->type = GPOINTER_TO_INT(keyword);
 		    if ( tok->type==tk_include )
 			fea_handle_include(tok);
 		}
@@ -2667,9 +2674,9 @@ static void fea_ParseTag(struct parseState *tok) {
 	    tok->tag==CHR('O','S',' ',' ') ) {
 	FILE *in = tok->inlist[tok->inc_depth];
 	int ch;
-	ch = getc(in);
+	ch = fea_getc(in);
 	if ( ch=='/' ) {
-	    ch = getc(in);
+	    ch = fea_getc(in);
 	    if ( ch=='2' ) {
 		tok->tag = CHR('O','S','/','2');
 	    } else {
@@ -2701,10 +2708,10 @@ static int fea_ParseDeciPoints(struct parseState *tok) {
 	FILE *in = tok->inlist[tok->inc_depth];
 	char *pt = tok->tokbuf + strlen(tok->tokbuf);
 	int ch;
-	ch = getc(in);
+	ch = fea_getc(in);
 	if ( ch=='.' ) {
 	    *pt++ = ch;
-	    while ( (ch = getc(in))!=EOF && isdigit(ch)) {
+	    while ( (ch = fea_getc(in))!=EOF && isdigit(ch)) {
 		if ( pt<tok->tokbuf+sizeof(tok->tokbuf)-1 )
 		    *pt++ = ch;
 	    }
@@ -2926,7 +2933,7 @@ return( NULL );
 return( copy( sc->name ));
 }
 
-static SplineChar *fea_glyphname_get(struct parseState *tok,char *name) {
+static SplineChar *_fea_glyphname_get(struct parseState *tok,char *name) {
     SplineFont *sf = tok->sf;
     EncMap *map = sf->fv==NULL ? sf->map : sf->fv->map;
     SplineChar *sc = SFGetChar(sf,-1,name);
@@ -2980,6 +2987,18 @@ return( sc );
 #endif // 0
 }
 
+/* Big feature files name the same glyphs over and over */
+static SplineChar *fea_glyphname_get(struct parseState *tok,char *name) {
+    SplineChar *sc = g_hash_table_lookup(tok->glyphnames,name);
+
+    if ( sc==NULL ) {
+	sc = _fea_glyphname_get(tok,name);
+	if ( sc!=NULL && tok->sf->subfontcnt==0 )
+	    g_hash_table_insert(tok->glyphnames,copy(name),sc);
+    }
+return( sc );
+}
+
 static char *fea_glyphname_validate(struct parseState *tok,char *name) {
     SplineChar *sc = fea_glyphname_get(tok,name);
 
@@ -3783,7 +3802,7 @@ return( NULL );
     if ( tok->type!=tk_char || tok->tokbuf[0]!='<' ) {
 	LogError(_("Expected two anchors (after cursive) on line %d of %s"), tok->line[tok->inc_depth], tok->filename[tok->inc_depth] );
 	++tok->err_count;
-	free(cur->name_or_class); chunkfree(cur, sizeof(markedglyphs));
+	free(cur->name_or_class); chunkfree(cur, sizeof(struct markedglyphs));
 return( NULL );
     }
     fea_TokenMustBe(tok,tk_anchor,' ');
@@ -3897,7 +3916,7 @@ return( NULL );
     if ( tok->type!=tk_char || tok->tokbuf[0]!='<' ) {
 	LogError(_("Expected an anchor (after ligature) on line %d of %s"), tok->line[tok->inc_depth], tok->filename[tok->inc_depth] );
 	++tok->err_count;
-	free(cur->name_or_class); chunkfree(cur, sizeof(markedglyphs));
+	free(cur->name_or_class); chunkfree(cur, sizeof(struct markedglyphs));
 return( NULL );
     }
     lc_max = 8;
@@ -5245,7 +5264,7 @@ static struct nameid *fea_ParseNameId(struct parseState *tok,int strid) {
 	    nm = NULL;
 	max = 0;
 	pt = 0; start = NULL;
-	while ( (ch=getc(in))!=EOF && ch!='"' ) {
+	while ( (ch=fea_getc(in))!=EOF && ch!='"' ) {
 	    if ( ch=='\n' || ch=='\r' )
 	continue;		/* Newline characters are ignored here */
 				/*  may be specified with backslashes */
@@ -5253,7 +5272,7 @@ static struct nameid *fea_ParseNameId(struct parseState *tok,int strid) {
 		int i, dmax = platform==3 ? 4 : 2;
 		value = 0;
 		for ( i=0; i<dmax; ++i ) {
-		    ch = getc(in);
+		    ch = fea_getc(in);
 		    if ( !ishexdigit(ch)) {
 			ungetc(ch,in);
 		break;
@@ -5601,7 +5620,7 @@ static void fea_ParseTableKeywords(struct parseState *tok, struct tablekeywords
 		FILE *in = tok->inlist[tok->inc_depth];
 		memset(foo,' ',sizeof(foo));
 		for ( i=0; i<4; ++i ) {
-		    ch = getc(in);
+		    ch = fea_getc(in);
 		    if ( ch==EOF )
 		break;
 		    else if ( ch=='"' ) {
@@ -5610,7 +5629,7 @@ static void fea_ParseTableKeywords(struct parseState *tok, struct tablekeywords
 		    }
 		    foo[i] = ch;
 		}
-		while ( (ch=getc(in))!=EOF && ch!='"' );
+		while ( (ch=fea_getc(in))!=EOF && ch!='"' );
 		tok->value=(foo[0]<<24) | (foo[1]<<16) | (foo[2]<<8) | foo[3];
 	    } else {
 		LogError(_("Expected string on line %d of %s"),
@@ -5635,9 +5654,9 @@ static void fea_ParseTableKeywords(struct parseState *tok, struct tablekeywords
 		if ( strcmp(keys[index].name,"FontRevision")==0 ) {
 		    /* Can take a float */
 		    FILE *in = tok->inlist[tok->inc_depth];
-		    int ch = getc(in);
+		    int ch = fea_getc(in);
 		    if ( ch=='.' )
-			for ( ch=getc(in); isdigit(ch); ch=getc(in));
+			for ( ch=fea_getc(in); isdigit(ch); ch=fea_getc(in));
 		    ungetc(ch,in);
 		}
 		if ( index!=-1 && keys[index].cnt!=1 ) {
@@ -6595,6 +6614,25 @@ static void SFKernClassRemoveFree(SplineFont *sf,KernClass *kc) {
     KernClassListFree(kc);
 }
 
+/* Pairs go on the ends of their glyphs' lists, and a big kerning lookup */
+/*  puts many on each glyph, so remember where each list ends */
+static void *fea_ListEnd(GHashTable *ends,SplineChar *sc,void *head,int is_pst) {
+    void *end = g_hash_table_lookup(ends,sc);
+
+    if ( end==NULL && head!=NULL ) {
+	if ( is_pst ) {
+	    PST *pst;
+	    for ( pst=head; pst->next!=NULL; pst=pst->next );
+	    end = pst;
+	} else {
+	    KernPair *kp;
+	    for ( kp=head; kp->next!=NULL; kp=kp->next );
+	    end = kp;
+	}
+    }
+return( end );
+}
+
 static void fea_ApplyLookupListPair(struct parseState *tok,
 	struct feat_item *lookup_data,int kmax,OTLookup *otl) {
     /* kcnt is the number of left/right glyph-name-lists we must sort into classes */
@@ -6602,10 +6640,14 @@ static void fea_ApplyLookupListPair(struct parseState *tok,
     struct class_set lefts, rights;
     struct lookup_subtable *sub = NULL, *lastsub=NULL;
     SplineChar *sc, *other;
-    PST *pst;
-    KernPair *kp;
+    PST *pst, *lastpst;
+    KernPair *kp, *lastkp;
     KernClass *kc;
     int vkern, kcnt, i;
+    /* The pairs already in this subtable, and where each glyph's kerns, */
+    /*  vkerns and possubs end */
+    struct kernpairindex *kpi[2];
+    GHashTable *ends[3];
 
     memset(&lefts,0,sizeof(lefts));
     memset(&rights,0,sizeof(rights));
@@ -6615,9 +6657,13 @@ static void fea_ApplyLookupListPair(struct parseState *tok,
 	lefts.max = rights.max = kmax;
     }
     vkern = false;
+    for ( i=0; i<3; ++i )
+	ends[i] = g_hash_table_new(g_direct_hash,g_direct_equal);
     for ( l = lookup_data; l!=NULL; ) {
 	first = l;
 	kcnt = 0;
+	kpi[0] = KernPairIndexNew(NULL,false);
+	kpi[1] = KernPairIndexNew(NULL,true);
 	while ( l!=NULL && l->type!=ft_subtable ) {
 	    if ( l->type == ft_pst ) {
 		if ( sub==NULL ) {
@@ -6634,7 +6680,9 @@ static void fea_ApplyLookupListPair(struct parseState *tok,
 		sc = l->u1.sc;
 		l->u2.pst = NULL;
 		kp = NULL;
-		other = SFGetChar(sc->parent,-1,pst->u.pair.paired);
+		other = g_hash_table_lookup(tok->glyphnames,pst->u.pair.paired);
+		if ( other==NULL )
+		    other = SFGetChar(sc->parent,-1,pst->u.pair.paired);
 		if ( pst->u.pair.vr[0].xoff==0 && pst->u.pair.vr[0].yoff==0 &&
 			pst->u.pair.vr[1].xoff==0 && pst->u.pair.vr[1].yoff==0 &&
 			pst->u.pair.vr[1].v_adv_off==0 &&
@@ -6654,40 +6702,32 @@ static void fea_ApplyLookupListPair(struct parseState *tok,
 		}
 		if ( kp!=NULL ) {
 		    // We want to add to the ends of the lists.
-		    KernPair *lastkp = NULL;
-		    KernPair *tmpkp = NULL;
-		    for ( tmpkp=(vkern?sc->vkerns:sc->kerns); tmpkp!=NULL && (tmpkp->sc != other || tmpkp->subtable != sub); lastkp = tmpkp, tmpkp=tmpkp->next );
-		    if (tmpkp == NULL) {
+		    if ( KernPairIndexFind(kpi[vkern],sc,other)==NULL ) {
 		      // Populate the kerning pair.
 		      kp->sc = other;
 		      kp->subtable = sub;
 		      // Add to the list.
-		      if ( vkern ) {
-			if (lastkp) lastkp->next = kp;
-			else sc->vkerns = kp;
-			lastkp = kp;
-		      } else {
-			if (lastkp) lastkp->next = kp;
-			else sc->kerns = kp;
-			lastkp = kp;
-		      }
+		      lastkp = fea_ListEnd(ends[vkern],sc,vkern?sc->vkerns:sc->kerns,false);
+		      if (lastkp) lastkp->next = kp;
+		      else if ( vkern ) sc->vkerns = kp;
+		      else sc->kerns = kp;
+		      g_hash_table_insert(ends[vkern],sc,kp);
+		      KernPairIndexAdd(kpi[vkern],sc,kp);
 		      PSTFree(pst);
 		    } else {
 		      LogError(_("Discarding a duplicate kerning pair."));
-		      SplineCharFree(sc); sc = NULL;
-		      free(kp); kp = NULL;
+		      PSTFree(pst);
+		      KernPairsFree(kp); kp = NULL;
 		    }
 		} else {
 		    // We want to add to the end of the list.
-		    PST *lastpst = NULL;
-		    PST *tmppst = NULL;
-		    for ( tmppst=sc->possub; tmppst!=NULL; lastpst = tmppst, tmppst=tmppst->next );
+		    lastpst = fea_ListEnd(ends[2],sc,sc->possub,true);
 		    // Populate.
 		    pst->subtable = sub;
 		    // Add to the list.
 		    if (lastpst) lastpst->next = pst;
 		    else sc->possub = pst;
-		    lastpst = pst;
+		    g_hash_table_insert(ends[2],sc,pst);
 		}
 	    } else if ( l->type == ft_pstclass ) {
 		lefts.classes[kcnt] = copy(fea_canonicalClassOrder(l->u1.class));
@@ -6737,9 +6777,13 @@ static void fea_ApplyLookupListPair(struct parseState *tok,
 	    }
 	}
 	sub = NULL;
+	KernPairIndexFree(kpi[0]);
+	KernPairIndexFree(kpi[1]);
 	while ( l!=NULL && l->type==ft_subtable )
 	    l = l->lookup_next;
     }
+    for ( i=0; i<3; ++i )
+	g_hash_table_destroy(ends[i]);
     if ( kmax!=0 ) {
 	free(lefts.classes);
 	free(rights.classes);
@@ -7347,8 +7391,13 @@ void SFApplyFeatureFile(SplineFont *sf,FILE *file,char *filename) {
     struct glyphclasses *gc, *gcnext;
     struct namedanchor *nap, *napnext;
     struct namedvalue *nvr, *nvrnext;
+    int i;
 
     memset(&tok,0,sizeof(tok));
+    tok.keywords = g_hash_table_new(g_str_hash,g_str_equal);
+    tok.glyphnames = g_hash_table_new_full(g_str_hash,g_str_equal,free,NULL);
+    for ( i=tk_firstkey; fea_keywords[i].name!=NULL; ++i )
+	g_hash_table_insert(tok.keywords,fea_keywords[i].name,GINT_TO_POINTER(fea_keywords[i].tok));
 
     tok.line[0] = 1;
     tok.filename[0] = filename;
@@ -7393,6 +7442,8 @@ void SFApplyFeatureFile(SplineFont *sf,FILE *file,char *filename) {
 	}
 	free(tok.gdef_mark[j]);
     }
+    g_hash_table_destroy(tok.keywords);
+    g_hash_table_destroy(tok.glyphnames);
 }
 
 void SFApplyFeatureFilename(SplineFont *sf,char *filename) {
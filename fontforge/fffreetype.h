@@ -73,6 +73,8 @@ typedef struct freetypecontext {
 			        /*  times */
     int isttf;
     int em;			/* Em size in the spline font, not ppem */
+    int users;			/* This context and those sharing its data, until freed */
+    int inmemory;		/* mappedfile was malloced rather than mapped */
 } FTC;
 
 extern void *__FreeTypeFontContext(FT_Library context,
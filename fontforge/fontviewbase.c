@@ -43,6 +43,7 @@
 #include "gresource.h"
 #include "groups.h"
 #include "namelist.h"
+#include "parallel.h"
 #include "psfont.h"
 #include "pua.h"
 #include "scripting.h"
@@ -853,27 +854,93 @@ void FVReencode(FontViewBase *fv,Encoding *enc) {
     FontViewReformatOne(fv);
 }
 
-void FVOverlap(FontViewBase *fv,enum overlap_type ot) {
-    int i, cnt=0, layer, first, last, gid;
-    SplineChar *sc;
+/* The outline operations below change each selected glyph on its own, so */
+/*  the glyphs can be done on several threads. Anything which touches the */
+/*  ui or the undo lists is done here on the calling thread: undoes are */
+/*  preserved before the work starts, and SCCharChangedUpdate is called */
+/*  once it is over, for each glyph which was done */
+typedef void (*FVGlyphFunc)(SplineChar *sc,int layer,void *data);
 
-    /* We know it's more likely that we'll find a problem in the overlap code */
-    /*  than anywhere else, so let's save the current state against a crash */
-    DoAutoSaves();
+struct fvglyphwork {
+    SplineChar **glyphs;
+    uint8 *done;
+    int active_layer;
+    FVGlyphFunc func;
+    void *data;
+};
 
-    for ( i=0; i<fv->map->enccount; ++i )
-	if ( fv->selected[i] && (gid = fv->map->map[i])!=-1 &&
-		SCWorthOutputting(fv->sf->glyphs[gid]) )
-	    ++cnt;
+static void FVLayerRange(SplineChar *sc,int active_layer,int *first,int *last) {
+    if ( sc->parent->multilayer ) {
+	*first = ly_fore;
+	*last = sc->layer_cnt-1;
+    } else
+	*first = *last = active_layer;
+}
 
-    ff_progress_start_indicator(10,_("Removing overlaps..."),_("Removing overlaps..."),0,cnt,1);
+/* Each selected glyph worth outputting, once (however many times it is */
+/*  encoded) */
+static SplineChar **FVSelectedGlyphs(FontViewBase *fv,int *_cnt) {
+    SplineChar **glyphs, *sc;
+    int i, cnt=0, gid;
 
+    glyphs = malloc((fv->sf->glyphcnt+1)*sizeof(SplineChar *));
     SFUntickAll(fv->sf);
     for ( i=0; i<fv->map->enccount; ++i ) if ( fv->selected[i] &&
 	    (gid = fv->map->map[i])!=-1 &&
 	    SCWorthOutputting((sc=fv->sf->glyphs[gid])) &&
 	    !sc->ticked ) {
 	sc->ticked = true;
+	glyphs[cnt++] = sc;
+    }
+    *_cnt = cnt;
+return( glyphs );
+}
+
+static void FVGlyphDo(int i,void *_work) {
+    struct fvglyphwork *work = _work;
+    SplineChar *sc = work->glyphs[i];
+    int layer, first, last;
+
+    FVLayerRange(sc,work->active_layer,&first,&last);
+    for ( layer = first; layer<=last; ++layer )
+	(work->func)(sc,layer,work->data);
+    work->done[i] = true;
+}
+
+static void FVGlyphsDo(FontViewBase *fv,SplineChar **glyphs,int cnt,
+	FVGlyphFunc func,void *data) {
+    struct fvglyphwork work;
+    int i;
+
+    work.glyphs = glyphs;
+    work.done = calloc(cnt+1,sizeof(uint8));
+    work.active_layer = fv->active_layer;
+    work.func = func;
+    work.data = data;
+    ParallelFor(cnt,FVGlyphDo,&work,true);
+    for ( i=0; i<cnt; ++i ) if ( work.done[i] )
+	SCCharChangedUpdate(glyphs[i],fv->active_layer);
+    free(work.done);
+}
+
+static void FVOverlapGlyph(SplineChar *sc,int layer,void *data) {
+    sc->layers[layer].splines = SplineSetRemoveOverlap(sc,sc->layers[layer].splines,
+	    *(enum overlap_type *) data);
+}
+
+void FVOverlap(FontViewBase *fv,enum overlap_type ot) {
+    int i, cnt;
+    SplineChar **glyphs, *sc;
+
+    /* We know it's more likely that we'll find a problem in the overlap code */
+    /*  than anywhere else, so let's save the current state against a crash */
+    DoAutoSaves();
+
+    glyphs = FVSelectedGlyphs(fv,&cnt);
+    ff_progress_start_indicator(10,_("Removing overlaps..."),_("Removing overlaps..."),0,cnt,1);
+
+    for ( i=0; i<cnt; ++i ) {
+	sc = glyphs[i];
 #if 0
 	// We await testing on the necessity of this operation.
 	if ( !SCRoundToCluster(sc,ly_all,false,.03,.12))
@@ -882,52 +949,42 @@ void FVOverlap(FontViewBase *fv,enum overlap_type ot) {
 	    SCPreserveLayer(sc,fv->active_layer,false);
 #endif // 0
 	MinimumDistancesFree(sc->md);
-	if ( sc->parent->multilayer ) {
-	    first = ly_fore;
-	    last = sc->layer_cnt-1;
-	} else
-	    first = last = fv->active_layer;
-	for ( layer = first; layer<=last; ++layer )
-	    sc->layers[layer].splines = SplineSetRemoveOverlap(sc,sc->layers[layer].splines,ot);
-	SCCharChangedUpdate(sc,fv->active_layer);
-	if ( !ff_progress_next())
-    break;
+	sc->md = NULL;
     }
+    FVGlyphsDo(fv,glyphs,cnt,FVOverlapGlyph,&ot);
+    free(glyphs);
     ff_progress_end_indicator();
 }
 
+struct addextrema_data {
+    enum ae_type type;
+    int emsize;
+};
+
+static void FVAddExtremaGlyph(SplineChar *sc,int layer,void *data) {
+    struct addextrema_data *ad = data;
+    SplineCharAddExtrema(sc, sc->layers[layer].splines, ad->type, ad->emsize);
+}
+
 void FVAddExtrema(FontViewBase *fv, int force_adding ) {
-    int i, cnt=0, layer, first, last, gid;
-    SplineChar *sc;
+    int i, cnt, layer, first, last;
+    SplineChar **glyphs;
     SplineFont *sf = fv->sf;
-    int emsize = sf->ascent+sf->descent;
+    struct addextrema_data ad;
 
-    for ( i=0; i<fv->map->enccount; ++i )
-	if ( fv->selected[i] && (gid = fv->map->map[i])!=-1 &&
-		SCWorthOutputting(fv->sf->glyphs[gid]) )
-	    ++cnt;
+    ad.type = force_adding ? ae_all : ae_only_good;
+    ad.emsize = sf->ascent+sf->descent;
+
+    glyphs = FVSelectedGlyphs(fv,&cnt);
     ff_progress_start_indicator(10,_("Adding points at Extrema..."),_("Adding points at Extrema..."),0,cnt,1);
 
-    SFUntickAll(fv->sf);
-    for ( i=0; i<fv->map->enccount; ++i ) if ( fv->selected[i] &&
-	    (gid = fv->map->map[i])!=-1 &&
-	    SCWorthOutputting((sc = fv->sf->glyphs[gid])) &&
-	    !sc->ticked) {
-	sc->ticked = true;
-	if ( sc->parent->multilayer ) {
-	    first = ly_fore;
-	    last = sc->layer_cnt-1;
-	} else
-	    first = last = fv->active_layer;
-	for ( layer = first; layer<=last; ++layer ) {
-	    SCPreserveLayer(sc,layer,false);
-	    SplineCharAddExtrema(sc, sc->layers[layer].splines, 
-		force_adding? ae_all : ae_only_good, emsize);
-	}
-	SCCharChangedUpdate(sc,fv->active_layer);
-	if ( !ff_progress_next())
-    break;
+    for ( i=0; i<cnt; ++i ) {
+	FVLayerRange(glyphs[i],fv->active_layer,&first,&last);
+	for ( layer = first; layer<=last; ++layer )
+	    SCPreserveLayer(glyphs[i],layer,false);
     }
+    FVGlyphsDo(fv,glyphs,cnt,FVAddExtremaGlyph,&ad);
+    free(glyphs);
     ff_progress_end_indicator();
 }
 
@@ -1053,40 +1110,29 @@ return;
     ff_progress_end_indicator();
 }
 
+static void FVSimplifyGlyph(SplineChar *sc,int layer,void *data) {
+    sc->layers[layer].splines = SplineCharSimplify(sc,sc->layers[layer].splines,
+	    (struct simplifyinfo *) data);
+}
+
 void _FVSimplify(FontViewBase *fv,struct simplifyinfo *smpl) {
-    int i, cnt=0, layer, first, last, gid;
-    SplineChar *sc;
+    int i, cnt;
+    SplineChar **glyphs;
 
-    for ( i=0; i<fv->map->enccount; ++i )
-	if ( fv->selected[i] && (gid = fv->map->map[i])!=-1 &&
-		SCWorthOutputting(fv->sf->glyphs[gid]) )
-	    ++cnt;
+    glyphs = FVSelectedGlyphs(fv,&cnt);
     ff_progress_start_indicator(10,_("Simplifying..."),_("Simplifying..."),0,cnt,1);
 
-    SFUntickAll(fv->sf);
-    for ( i=0; i<fv->map->enccount; ++i )
-	if ( (gid=fv->map->map[i])!=-1 && SCWorthOutputting((sc=fv->sf->glyphs[gid])) &&
-		fv->selected[i] && !sc->ticked ) {
-	    sc->ticked = true;
-	    SCPreserveLayer(sc,fv->active_layer,false);
-	    if ( sc->parent->multilayer ) {
-		first = ly_fore;
-		last = sc->layer_cnt-1;
-	    } else
-		first = last = fv->active_layer;
-	    for ( layer = first; layer<=last; ++layer )
-		sc->layers[layer].splines = SplineCharSimplify(sc,sc->layers[layer].splines,smpl);
-	    SCCharChangedUpdate(sc,fv->active_layer);
-	    if ( !ff_progress_next())
-    break;
-	}
+    for ( i=0; i<cnt; ++i )
+	SCPreserveLayer(glyphs[i],fv->active_layer,false);
+    FVGlyphsDo(fv,glyphs,cnt,FVSimplifyGlyph,smpl);
+    free(glyphs);
     ff_progress_end_indicator();
 }
 
 void FVAutoHint(FontViewBase *fv) {
     int i, cnt=0, gid;
     BlueData *bd = NULL, _bd;
-    SplineChar *sc;
+    SplineChar *sc, **glyphs;
 
     if ( fv->sf->mm==NULL ) {
 	QuickBlues(fv->sf,fv->active_layer,&_bd);
@@ -1105,15 +1151,18 @@ void FVAutoHint(FontViewBase *fv) {
 	}
     ff_progress_start_indicator(10,_("Auto Hinting Font..."),_("Auto Hinting Font..."),0,cnt,1);
 
+    glyphs = malloc((cnt+1)*sizeof(SplineChar *));
+    cnt = 0;
     for ( i=0; i<fv->map->enccount; ++i ) if ( fv->selected[i] &&
 	    (gid = fv->map->map[i])!=-1 && SCWorthOutputting(fv->sf->glyphs[gid]) ) {
 	sc = fv->sf->glyphs[gid];
 	sc->manualhints = false;
-	/* Hint undoes are done in _SplineCharAutoHint */
-	SFSCAutoHint(sc,fv->active_layer,bd);
-	if ( !ff_progress_next())
-    break;
+	if ( !sc->ticked )
+	    glyphs[cnt++] = sc;
     }
+    /* Hint undoes are done in SFAutoHintGlyphs */
+    SFAutoHintGlyphs(fv->sf,fv->active_layer,bd,glyphs,cnt);
+    free(glyphs);
     ff_progress_end_indicator();
     FVRefreshAll(fv->sf);
 }
@@ -1275,6 +1324,7 @@ void FVAutoInstr(FontViewBase *fv) {
     BlueData bd;
     int i, cnt=0, gid;
     GlobalInstrCt gic;
+    SplineChar **glyphs;
 
     /* If all glyphs are selected, then no legacy hint will remain after */
     /*  instructing, so we might as well clear all the legacy tables too */
@@ -1290,19 +1340,21 @@ void FVAutoInstr(FontViewBase *fv) {
 
     InitGlobalInstrCt(&gic,fv->sf,fv->active_layer,&bd);
 
+    /* A glyph encoded more than once is still only instructed once */
+    for ( gid = 0; gid<fv->sf->glyphcnt; ++gid ) if ( fv->sf->glyphs[gid]!=NULL )
+	fv->sf->glyphs[gid]->ticked = false;
+    glyphs = malloc((fv->map->enccount+1)*sizeof(SplineChar *));
     for ( i=0; i<fv->map->enccount; ++i )
 	if ( fv->selected[i] && (gid = fv->map->map[i])!=-1 &&
-		SCWorthOutputting(fv->sf->glyphs[gid]) )
-	    ++cnt;
+		SCWorthOutputting(fv->sf->glyphs[gid]) &&
+		!fv->sf->glyphs[gid]->ticked ) {
+	    fv->sf->glyphs[gid]->ticked = true;
+	    glyphs[cnt++] = fv->sf->glyphs[gid];
+	}
     ff_progress_start_indicator(10,_("Auto Instructing Font..."),_("Auto Instructing Font..."),0,cnt,1);
 
-    for ( i=0; i<fv->map->enccount; ++i ) if ( fv->selected[i] &&
-	    (gid = fv->map->map[i])!=-1 && SCWorthOutputting(fv->sf->glyphs[gid]) ) {
-	SplineChar *sc = fv->sf->glyphs[gid];
-	NowakowskiSCAutoInstr(&gic,sc);
-	if ( !ff_progress_next())
-    break;
-    }
+    NowakowskiSFAutoInstr(&gic,glyphs,cnt);
+    free(glyphs);
     
     FreeGlobalInstrCt(&gic);
 
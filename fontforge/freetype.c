@@ -30,6 +30,7 @@
 #include "autohint.h"
 #include "dumppfa.h"
 #include "fffreetype.h"
+#include "ffglib.h"
 #include "fontforgevw.h"
 #include "fvfonts.h"
 #include "gfile.h"
@@ -138,17 +139,14 @@ static void AddIf(SplineFont *sf,SplineChar **new,SplineChar **old,int unienc,in
 	TransitiveClosureAdd(new,old,sc,layer);
 }
 
-void FreeTypeFreeContext(void *freetypecontext) {
-    FTC *ftc = freetypecontext;
+/* The data of a context goes when it and every context sharing it are freed */
+static void FTCRelease(FTC *ftc) {
 
-    if ( ftc==NULL )
-return;
-
-    if ( ftc->face!=NULL )
-	FT_Done_Face(ftc->face);
-    if ( ftc->shared_ftc )
+    if ( --ftc->users>0 )
 return;
-    if ( ftc->mappedfile )
+    if ( ftc->mappedfile && ftc->inmemory )
+	free(ftc->mappedfile);
+    else if ( ftc->mappedfile )
 #if defined(__MINGW32__)
 		UnmapViewOfFile(ftc->mappedfile);
 #else
@@ -159,7 +157,23 @@ return;
     free(ftc->glyph_indeces);
     free(ftc);
 }
-    
+
+void FreeTypeFreeContext(void *freetypecontext) {
+    FTC *ftc = freetypecontext;
+
+    if ( ftc==NULL )
+return;
+
+    if ( ftc->face!=NULL )
+	FT_Done_Face(ftc->face);
+    ftc->face = NULL;
+    if ( ftc->shared_ftc ) {
+	FTCRelease(ftc->shared_ftc);
+	free(ftc);
+    } else
+	FTCRelease(ftc);
+}
+
 void *__FreeTypeFontContext(FT_Library context,
 	SplineFont *sf,SplineChar *sc,FontViewBase *fv,
 	int layer,
@@ -187,7 +201,9 @@ return( NULL );
 	ftc->shared_ftc = shared_ftc;
 	ftc->em = ((FTC *) shared_ftc)->em;
 	ftc->layer = layer;
+	++((FTC *) shared_ftc)->users;
     } else {
+	ftc->users = 1;
 	ftc->sf = sf;
 	ftc->em = sf->ascent+sf->descent;
 	ftc->file = NULL;
@@ -340,13 +356,15 @@ return( NULL );
 
     if ( FT_New_Memory_Face(context,ftc->mappedfile,ftc->len,0,&ftc->face))
  goto fail;
-    GlyphHashFree(sf);		/* If we created a tiny font, our hash table may reflect that */
-    
+    if ( shared_ftc==NULL )
+	GlyphHashFree(sf);	/* If we created a tiny font, our hash table may reflect that */
+
 return( ftc );
 
  fail:
     sf->internal_temp = false;
-    GlyphHashFree(sf);
+    if ( shared_ftc==NULL )
+	GlyphHashFree(sf);
     FreeTypeFreeContext(ftc);
     if ( sf->glyphs!=old ) {
 	free(sf->glyphs);
@@ -355,12 +373,325 @@ return( ftc );
 return( NULL );
 }
 
+/* Contexts kept for a font (in sf->ftcache) so that rasterizing a glyph */
+/*  needn't write out a font each time. There is a cache for each layer, */
+/*  format and set of flags asked for. Until a few glyphs have been asked */
+/*  for each gets a small font of its own (as __FreeTypeFontContext would */
+/*  make it), after that one font of all the glyphs is made, and only */
+/*  glyphs which have changed since it was made get fonts of their own */
+#define FT_CACHE_GLYPHS		64
+
+struct ftcachedglyph {
+    FTC *ftc;
+    uint64_t fingerprint;
+};
+
+struct ftcache {
+    int layer;
+    enum fontformat ff;
+    int flags;
+    uint64_t font;			/* Fingerprint of what all glyphs depend on */
+    FTC *whole;				/* All the glyphs, or NULL */
+    int wholefailed;
+    int glyphcnt;
+    uint64_t *fingerprints;		/* Of each glyph as it is in whole, 0 if it isn't */
+    GHashTable *glyphs;			/* SplineChar -> struct ftcachedglyph */
+    struct ftcache *next;
+};
+
+/* Of what the rasterized glyph depends on in sc and what it refers to */
+static uint64_t FTGlyphFingerprint(SplineChar *sc,int layer,int depth) {
+    uint64_t hash = FINGERPRINT_START;
+    SplineSet *ss;
+    SplinePoint *sp;
+    StemInfo *h;
+    RefChar *ref;
+    uint64_t refhash;
+    int ints[4];
+
+    ints[0] = sc->orig_pos;
+    ints[1] = sc->width;
+    ints[2] = sc->vwidth;
+    ints[3] = sc->hconflicts | (sc->vconflicts<<1);
+    hash = FingerprintAdd(hash,ints,sizeof(ints));
+    hash = FingerprintAdd(hash,sc->ttf_instrs,sc->ttf_instrs_len);
+    hash = FingerprintAdd(hash,sc->countermasks,sc->countermask_cnt*sizeof(HintMask));
+    for ( h=sc->hstem; h!=NULL; h=h->next ) {
+	hash = FingerprintAdd(hash,&h->start,sizeof(h->start));
+	hash = FingerprintAdd(hash,&h->width,sizeof(h->width));
+    }
+    ints[0] = -1;			/* Between the hstems and vstems */
+    hash = FingerprintAdd(hash,ints,sizeof(int));
+    for ( h=sc->vstem; h!=NULL; h=h->next ) {
+	hash = FingerprintAdd(hash,&h->start,sizeof(h->start));
+	hash = FingerprintAdd(hash,&h->width,sizeof(h->width));
+    }
+    for ( ss=sc->layers[layer].splines; ss!=NULL; ss=ss->next ) {
+	for ( sp=ss->first; ; ) {
+	    hash = FingerprintAdd(hash,&sp->me,sizeof(BasePoint));
+	    hash = FingerprintAdd(hash,&sp->nextcp,sizeof(BasePoint));
+	    hash = FingerprintAdd(hash,&sp->prevcp,sizeof(BasePoint));
+	    ints[0] = sp->nonextcp | (sp->noprevcp<<1) | (sp->dontinterpolate<<2) |
+		    ((sp->next!=NULL)<<3) | ((sp->prev!=NULL)<<4) |
+		    ((sp->hintmask!=NULL)<<5);
+	    ints[1] = sp->ttfindex;
+	    ints[2] = sp->nextcpindex;
+	    hash = FingerprintAdd(hash,ints,3*sizeof(int));
+	    if ( sp->hintmask!=NULL )
+		hash = FingerprintAdd(hash,sp->hintmask,sizeof(HintMask));
+	    if ( sp->next==NULL )
+	break;
+	    sp = sp->next->to;
+	    if ( sp==ss->first )
+	break;
+	}
+	ints[0] = -1;			/* End of contour */
+	hash = FingerprintAdd(hash,ints,sizeof(int));
+    }
+    for ( ref=sc->layers[layer].refs; ref!=NULL; ref=ref->next ) {
+	hash = FingerprintAdd(hash,ref->transform,sizeof(ref->transform));
+	ints[0] = ref->point_match | (ref->use_my_metrics<<1) |
+		(ref->round_translation_to_grid<<2);
+	ints[1] = ref->match_pt_base;
+	ints[2] = ref->match_pt_ref;
+	hash = FingerprintAdd(hash,ints,3*sizeof(int));
+	/* References can't loop, but a font might be broken */
+	refhash = depth<20 ? FTGlyphFingerprint(ref->sc,layer,depth+1) : 0;
+	hash = FingerprintAdd(hash,&refhash,sizeof(refhash));
+    }
+return( hash==0 ? 1 : hash );
+}
+
+/* Of what every glyph's rasterization depends on. Without BlueValues the */
+/*  blues are worked out from the glyphs, from those __FreeTypeFontContext */
+/*  adds for the purpose in a font of one glyph, so those glyphs count */
+static uint64_t FTFontFingerprint(SplineFont *sf,int layer) {
+    uint64_t hash = FINGERPRINT_START, glyph;
+    struct ttf_table *tab;
+    SplineChar *sc;
+    static int blueglyphs[] = { 'I', 'O', 'x', 'o', -1 };
+    int ints[4], i;
+
+    ints[0] = sf->ascent;
+    ints[1] = sf->descent;
+    ints[2] = sf->layers[layer].order2;
+    ints[3] = sf->hasvmetrics;
+    hash = FingerprintAdd(hash,ints,sizeof(ints));
+    if ( sf->private!=NULL ) {
+	for ( i=0; i<sf->private->next; ++i ) {
+	    hash = FingerprintAdd(hash,sf->private->keys[i],strlen(sf->private->keys[i])+1);
+	    hash = FingerprintAdd(hash,sf->private->values[i],strlen(sf->private->values[i])+1);
+	}
+    }
+    for ( tab=sf->ttf_tables; tab!=NULL; tab=tab->next ) {
+	hash = FingerprintAdd(hash,&tab->tag,sizeof(tab->tag));
+	hash = FingerprintAdd(hash,&tab->len,sizeof(tab->len));
+	hash = FingerprintAdd(hash,tab->data,tab->len);
+    }
+    if ( PSDictHasEntry(sf->private,"BlueValues")==NULL ) {
+	for ( i=0; blueglyphs[i]!=-1; ++i ) {
+	    sc = SFGetChar(sf,blueglyphs[i],NULL);
+	    glyph = SCWorthOutputting(sc) ? FTGlyphFingerprint(sc,layer,0) : 0;
+	    hash = FingerprintAdd(hash,&glyph,sizeof(glyph));
+	}
+    }
+    sc = SFGetChar(sf,-1,".notdef");
+    glyph = SCWorthOutputting(sc) ? FTGlyphFingerprint(sc,layer,0) : 0;
+    hash = FingerprintAdd(hash,&glyph,sizeof(glyph));
+return( hash );
+}
+
+/* Whether a font made with sc in it would autohint it (or what it refers */
+/*  to) first, so that sc would no longer be as it was when cached */
+static int FTNeedsAutoHint(SplineChar *sc,int layer,enum fontformat ff,int depth) {
+    RefChar *ref;
+
+    if ( !autohint_before_generate ||
+	    !(ff==ff_pfb || ff==ff_pfa || ff==ff_otf || ff==ff_otfcid || ff==ff_cff) )
+return( false );
+    if ( sc->changedsincelasthinted && !sc->manualhints )
+return( true );
+    for ( ref=sc->layers[layer].refs; ref!=NULL; ref=ref->next )
+	if ( depth<20 && FTNeedsAutoHint(ref->sc,layer,ff,depth+1) )
+return( true );
+return( false );
+}
+
+/* Cached contexts keep their font in memory rather than in a temporary */
+/*  file, so as not to hold a file open for each */
+static int FTCHoldInMemory(FTC *ftc) {
+    uint8 *copy = malloc(ftc->len);
+
+    if ( copy==NULL )
+return( false );
+    memcpy(copy,ftc->mappedfile,ftc->len);
+    if ( ftc->face!=NULL )
+	FT_Done_Face(ftc->face);
+    ftc->face = NULL;
+#if defined(__MINGW32__)
+    UnmapViewOfFile(ftc->mappedfile);
+#else
+    munmap(ftc->mappedfile,ftc->len);
+#endif
+    fclose(ftc->file);
+    ftc->file = NULL;
+    ftc->mappedfile = copy;
+    ftc->inmemory = true;
+return( true );
+}
+
+static void FTCachedGlyphFree(void *_cg) {
+    struct ftcachedglyph *cg = _cg;
+
+    FreeTypeFreeContext(cg->ftc);
+    free(cg);
+}
+
+/* Contexts handed out keep working after this, until they are freed */
+static void FTCacheClear(struct ftcache *cache) {
+
+    FreeTypeFreeContext(cache->whole);
+    cache->whole = NULL;
+    cache->wholefailed = false;
+    free(cache->fingerprints);
+    cache->fingerprints = NULL;
+    cache->glyphcnt = 0;
+    g_hash_table_remove_all(cache->glyphs);
+}
+
+void FreeTypeCacheFree(struct ftcache *cache) {
+    struct ftcache *next;
+
+    for ( ; cache!=NULL; cache=next ) {
+	next = cache->next;
+	FTCacheClear(cache);
+	g_hash_table_destroy(cache->glyphs);
+	free(cache);
+    }
+}
+
+static void FTCacheMakeWhole(struct ftcache *cache,SplineFont *sf) {
+    FTC *whole;
+    SplineChar *sc;
+    int i;
+
+    FTCacheClear(cache);
+    whole = __FreeTypeFontContext(ff_ft_context,sf,NULL,NULL,cache->layer,
+	    cache->ff,cache->flags,NULL);
+    if ( whole==NULL || !FTCHoldInMemory(whole) ) {
+	FreeTypeFreeContext(whole);
+	cache->wholefailed = true;
+return;
+    }
+    cache->whole = whole;
+    cache->glyphcnt = sf->glyphcnt;
+    cache->fingerprints = calloc(sf->glyphcnt,sizeof(uint64_t));
+    for ( i=0; i<sf->glyphcnt; ++i )
+	if ( whole->glyph_indeces[i]!=-1 && SCWorthOutputting(sc=sf->glyphs[i]) )
+	    cache->fingerprints[i] = FTGlyphFingerprint(sc,cache->layer,0);
+}
+
+static int FTCacheWholeHas(struct ftcache *cache,SplineChar *sc,uint64_t fingerprint) {
+return( cache->whole!=NULL && sc->orig_pos<cache->glyphcnt &&
+	cache->fingerprints[sc->orig_pos]==fingerprint );
+}
+
+static int FTCacheWholeCurrent(struct ftcache *cache,SplineFont *sf) {
+    SplineChar *sc;
+    int i;
+
+    if ( cache->whole==NULL || cache->glyphcnt!=sf->glyphcnt )
+return( false );
+    for ( i=0; i<sf->glyphcnt; ++i ) {
+	sc = sf->glyphs[i];
+	if ( cache->fingerprints[i]!=
+		(SCWorthOutputting(sc) ? FTGlyphFingerprint(sc,cache->layer,0) : 0) )
+return( false );
+    }
+return( true );
+}
+
+/* A new context sharing the font of ftc */
+static void *FTCacheShare(struct ftcache *cache,SplineFont *sf,FTC *ftc) {
+return( __FreeTypeFontContext(ff_ft_context,sf,NULL,NULL,cache->layer,
+	cache->ff,cache->flags,ftc) );
+}
+
+static void *FTCacheContext(SplineFont *sf,SplineChar *sc,int layer,
+	enum fontformat ff,int flags) {
+    struct ftcache *cache;
+    struct ftcachedglyph *cg;
+    uint64_t font, fingerprint;
+    FTC *ftc;
+
+    for ( cache=sf->ftcache; cache!=NULL; cache=cache->next )
+	if ( cache->layer==layer && cache->ff==ff && cache->flags==flags )
+    break;
+    if ( cache==NULL ) {
+	cache = calloc(1,sizeof(struct ftcache));
+	cache->layer = layer;
+	cache->ff = ff;
+	cache->flags = flags;
+	cache->glyphs = g_hash_table_new_full(g_direct_hash,g_direct_equal,NULL,FTCachedGlyphFree);
+	cache->next = sf->ftcache;
+	sf->ftcache = cache;
+    }
+    font = FTFontFingerprint(sf,layer);
+    if ( font!=cache->font ) {
+	FTCacheClear(cache);
+	cache->font = font;
+    }
+
+    if ( sc==NULL ) {
+	if ( !cache->wholefailed && !FTCacheWholeCurrent(cache,sf) )
+	    FTCacheMakeWhole(cache,sf);
+	if ( cache->whole==NULL )
+return( __FreeTypeFontContext(ff_ft_context,sf,NULL,NULL,layer,ff,flags,NULL) );
+return( FTCacheShare(cache,sf,cache->whole) );
+    }
+
+    cg = g_hash_table_lookup(cache->glyphs,sc);
+    if ( !FTNeedsAutoHint(sc,layer,ff,0) ) {
+	fingerprint = FTGlyphFingerprint(sc,layer,0);
+	if ( FTCacheWholeHas(cache,sc,fingerprint) )
+return( FTCacheShare(cache,sf,cache->whole) );
+	if ( cg!=NULL && cg->fingerprint==fingerprint )
+return( FTCacheShare(cache,sf,cg->ftc) );
+	if ( cg==NULL && g_hash_table_size(cache->glyphs)>=FT_CACHE_GLYPHS &&
+		!cache->wholefailed ) {
+	    FTCacheMakeWhole(cache,sf);
+	    if ( FTCacheWholeHas(cache,sc,fingerprint) )
+return( FTCacheShare(cache,sf,cache->whole) );
+	}
+    }
+
+    ftc = __FreeTypeFontContext(ff_ft_context,sf,sc,NULL,layer,ff,flags,NULL);
+    /* If there is no font of the whole, the cache stays small */
+    if ( ftc==NULL ||
+	    (cg==NULL && g_hash_table_size(cache->glyphs)>=FT_CACHE_GLYPHS) ||
+	    !FTCHoldInMemory(ftc) )
+return( ftc );
+    cg = malloc(sizeof(struct ftcachedglyph));
+    cg->ftc = ftc;
+    /* After the font was made, as sc may have been autohinted for it */
+    cg->fingerprint = FTGlyphFingerprint(sc,layer,0);
+    g_hash_table_replace(cache->glyphs,sc,cg);
+return( FTCacheShare(cache,sf,ftc) );
+}
+
 void *_FreeTypeFontContext(SplineFont *sf,SplineChar *sc,FontViewBase *fv,
 	int layer, enum fontformat ff,int flags,void *shared_ftc) {
 
     if ( !hasFreeType())
 return( NULL );
 
+    /* A single glyph or the whole font (with the encoding it would have */
+    /*  been given anyway) may come from the cache */
+    if ( shared_ftc==NULL && sf->subfontcnt==0 && sf->cidmaster==NULL &&
+	    !sf->multilayer && !sf->strokedfont &&
+	    (fv==NULL || (sc!=NULL && fv==sf->fv)) )
+return( FTCacheContext(sf,sc,layer,ff,flags) );
+
 return( __FreeTypeFontContext(ff_ft_context,sf,sc,fv,
 	layer, ff,flags,shared_ftc));
 }
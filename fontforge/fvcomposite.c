@@ -2453,7 +2453,7 @@ static void BCMakeRule(BDFFont *bdf, int gid, int layer) {
 	bc->bytes_per_line = tempbc->bytes_per_line;
 	bc->width = tempbc->width;
 	bc->bitmap = tempbc->bitmap;
-	free(tempbc);
+	chunkfree(tempbc,sizeof(BDFChar));
     }
 }
 
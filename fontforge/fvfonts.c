@@ -493,6 +493,7 @@ SplineChar *SplineCharCopy(SplineChar *sc,SplineFont *into,struct sfmergecontext
     Layer *layers = nsc->layers;
     int layer, lycopy;
 
+	SCLoadLazy(sc);
 	*nsc = *sc;
 
 	/* Copy the instrs from the given sc to the new splinechar */
@@ -541,6 +542,9 @@ SplineChar *SplineCharCopy(SplineChar *sc,SplineFont *into,struct sfmergecontext
     }
     nsc->anchor = AnchorPointsDuplicate(nsc->anchor,nsc);
     nsc->changed = true;
+    nsc->autosave_fingerprint = 0;
+    if ( into!=NULL )
+	into->changed_since_autosave = true;
     /* Fix up dependents later when we know more */
     nsc->dependents = NULL;
     
@@ -616,22 +620,119 @@ void BitmapsCopy(SplineFont *to, SplineFont *from, int to_index, int from_index
     }
 }
 
-void __GlyphHashFree(struct glyphnamehash *hash) {
-    struct glyphnamebucket *test, *next;
-    int i;
+#define GNH_MINSIZE	64
 
-    if ( hash==NULL )
+static const char *GlyphNameKey(struct glyphnameentry *e) {
+return( e->name!=NULL ? e->name : e->sc->name );
+}
+
+static void GlyphNameHashResize(struct glyphnamehash *hash,int size) {
+    struct glyphnameentry *old = hash->table;
+    int oldsize = hash->size, i;
+    unsigned int mask = size-1, pos;
+
+    hash->table = calloc(size,sizeof(struct glyphnameentry));
+    hash->size = size;
+    for ( i=0; i<oldsize; ++i ) if ( old[i].sc!=NULL ) {
+	for ( pos=old[i].hash&mask; hash->table[pos].sc!=NULL; pos=(pos+1)&mask );
+	hash->table[pos] = old[i];
+    }
+    free(old);
+}
+
+/* Returns the slot holding name, or the empty slot where it would go */
+static struct glyphnameentry *GlyphNameHashSlot(struct glyphnamehash *hash,
+	const char *name,unsigned int hv) {
+    unsigned int mask = hash->size-1, pos;
+    struct glyphnameentry *e;
+
+    for ( pos=hv&mask; ; pos=(pos+1)&mask ) {
+	e = &hash->table[pos];
+	if ( e->sc==NULL || (e->hash==hv && strcmp(GlyphNameKey(e),name)==0) )
+return( e );
+    }
+}
+
+/* Add sc under name (or under its own name if name is NULL). If the name */
+/*  is already present the existing glyph is kept, unless replace is set */
+void GlyphNameHashAdd(struct glyphnamehash *hash,SplineChar *sc,const char *name,
+	int replace) {
+    const char *key = name!=NULL ? name : sc->name;
+    struct glyphnameentry *e;
+    unsigned int hv;
+
+    if ( key==NULL )
 return;
-    for ( i=0; i<GN_HSIZE; ++i ) {
-	for ( test = hash->table[i]; test!=NULL; test = next ) {
-	    next = test->next;
-	    chunkfree(test,sizeof(struct glyphnamebucket));
+    if ( 2*(hash->cnt+1)>hash->size )
+	GlyphNameHashResize(hash,hash->size==0 ? GNH_MINSIZE : 2*hash->size);
+    hv = glyphnamehashval(key);
+    e = GlyphNameHashSlot(hash,key,hv);
+    if ( e->sc!=NULL ) {
+	hash->dups = true;
+	if ( !replace )
+return;
+    } else
+	++hash->cnt;
+    e->sc = sc;
+    e->name = name;
+    e->hash = hv;
+}
+
+SplineChar *GlyphNameHashFind(struct glyphnamehash *hash,const char *name) {
+    if ( hash->size==0 )
+return( NULL );
+return( GlyphNameHashSlot(hash,name,glyphnamehashval(name))->sc );
+}
+
+/* Remove the entry for sc which was added under name. The glyph itself */
+/*  may already have been renamed, so the match is on sc, not on the key */
+/*  string. Returns false if there was no such entry */
+int GlyphNameHashRemove(struct glyphnamehash *hash,SplineChar *sc,const char *name) {
+    unsigned int hv, mask, i, j, home;
+
+    if ( hash->size==0 || name==NULL )
+return( false );
+    hv = glyphnamehashval(name);
+    mask = hash->size-1;
+    for ( i=hv&mask; hash->table[i].sc!=NULL; i=(i+1)&mask )
+	if ( hash->table[i].sc==sc && hash->table[i].hash==hv )
+    break;
+    if ( hash->table[i].sc==NULL )
+return( false );
+    /* Close up the gap, moving back any later entry of the same run whose */
+    /*  home slot does not lie (cyclically) between the gap and itself */
+    for ( j=(i+1)&mask; hash->table[j].sc!=NULL; j=(j+1)&mask ) {
+	home = hash->table[j].hash&mask;
+	if ( ((j-home)&mask) >= ((j-i)&mask) ) {
+	    hash->table[i] = hash->table[j];
+	    i = j;
 	}
     }
+    hash->table[i].sc = NULL;
+    --hash->cnt;
+return( true );
+}
+
+void __GlyphHashFree(struct glyphnamehash *hash) {
+
+    if ( hash==NULL )
+return;
+    free(hash->table);
+    memset(hash,0,sizeof(*hash));
+}
+
+static void UniHashFree(SplineFont *sf) {
+
+    if ( sf->glyphunis==NULL )
+return;
+    free(sf->glyphunis->table);
+    free(sf->glyphunis);
+    sf->glyphunis = NULL;
 }
 
 static void _GlyphHashFree(SplineFont *sf) {
 
+    UniHashFree(sf);
     if ( sf->glyphnames==NULL )
 return;
     __GlyphHashFree(sf->glyphnames);
@@ -646,60 +747,108 @@ void GlyphHashFree(SplineFont *sf) {
 }
 
 static void GlyphHashCreate(SplineFont *sf) {
-    int i, k;
-    unsigned int hash;
+    int i, k, cnt, size;
     SplineFont *_sf;
     struct glyphnamehash *gnh;
-    struct glyphnamebucket *new;
 
     if ( sf->glyphnames!=NULL )
 return;
     sf->glyphnames = gnh = calloc(1,sizeof(*gnh));
+    cnt = 0;
     k = 0;
     do {
 	_sf = k<sf->subfontcnt ? sf->subfonts[k] : sf;
-	/* I walk backwards because there are some ttf files where multiple */
-	/*  glyphs get the same name. In the cases I've seen only one of these */
-	/*  has an encoding. That's the one we want. It will be earlier in the */
-	/*  font than the others. If we build the list backwards then it will */
-	/*  be the top name in the bucket, and will be the one we return */
-	for ( i=_sf->glyphcnt-1; i>=0; --i ) if ( _sf->glyphs[i]!=NULL ) {
-	    new = chunkalloc(sizeof(struct glyphnamebucket));
-	    new->sc = _sf->glyphs[i];
-	    hash = hashname(new->sc->name);
-	    new->next = gnh->table[hash];
-	    gnh->table[hash] = new;
-	}
+	cnt += _sf->glyphcnt;
+	++k;
+    } while ( k<sf->subfontcnt );
+    for ( size=GNH_MINSIZE; size<2*cnt; size *= 2 );
+    GlyphNameHashResize(gnh,size);
+    k = 0;
+    do {
+	_sf = k<sf->subfontcnt ? sf->subfonts[k] : sf;
+	/* There are some ttf files where multiple glyphs get the same name. */
+	/*  In the cases I've seen only one of these has an encoding. That's */
+	/*  the one we want. It will be earlier in the font than the others, */
+	/*  so the first glyph to claim a name keeps it */
+	for ( i=0; i<_sf->glyphcnt; ++i ) if ( _sf->glyphs[i]!=NULL )
+	    GlyphNameHashAdd(gnh,_sf->glyphs[i],NULL,false);
 	++k;
     } while ( k<sf->subfontcnt );
 }
 
+static void UniHashAddGlyph(SplineFont *sf,SplineChar *sc);
+
 void SFHashGlyph(SplineFont *sf,SplineChar *sc) {
     /* sc just got added to the font. Put it in the lookup */
-    unsigned int hash;
-    struct glyphnamebucket *new;
+    struct glyphunihash *guh = sf->glyphunis;
 
-    if ( sf->glyphnames==NULL )
+    if ( sf->glyphnames!=NULL )
+	GlyphNameHashAdd(sf->glyphnames,sc,NULL,true);
+    if ( sf->cidmaster!=NULL && sf->cidmaster->glyphnames!=NULL )
+	GlyphNameHashAdd(sf->cidmaster->glyphnames,sc,NULL,true);
+    if ( guh!=NULL ) {
+	/* If the glyph array has grown by more than this glyph, something */
+	/*  else was added that we were not told about */
+	if ( guh->glyphcnt<sc->orig_pos ) {
+	    UniHashFree(sf);
+return;
+	}
+	guh->glyphs = sf->glyphs;
+	if ( guh->glyphcnt<=sc->orig_pos )
+	    guh->glyphcnt = sc->orig_pos+1;
+	UniHashAddGlyph(sf,sc);
+    }
+}
+
+static void _SFHashRename(SplineFont *sf,SplineChar *sc,const char *oldname) {
+    struct glyphnamehash *gnh = sf->glyphnames;
+
+    if ( gnh==NULL )
 return;		/* No hash table, nothing to update */
+    /* If names are shared then which glyph a name should find depends on */
+    /*  the glyph order, so start again from scratch */
+    if ( gnh->dups ||
+	    (oldname!=NULL && !GlyphNameHashRemove(gnh,sc,oldname)) ||
+	    (sc->name!=NULL && GlyphNameHashFind(gnh,sc->name)!=NULL) ) {
+	_GlyphHashFree(sf);
+return;
+    }
+    GlyphNameHashAdd(gnh,sc,NULL,false);
+}
+
+void SFHashRename(SplineFont *sf,SplineChar *sc,const char *oldname) {
+    /* sc used to be called oldname, and now has a new name */
+    _SFHashRename(sf,sc,oldname);
+    if ( sf->cidmaster!=NULL )
+	_SFHashRename(sf->cidmaster,sc,oldname);
+}
+
+static void UniHashRemoveGlyph(SplineFont *sf,SplineChar *sc);
+
+static void _SFHashRemoveGlyph(SplineFont *sf,SplineChar *sc) {
+    struct glyphnamehash *gnh = sf->glyphnames;
+
+    if ( sf->glyphunis!=NULL && sc->parent==sf )
+	UniHashRemoveGlyph(sf,sc);
+    if ( gnh==NULL )
+return;
+    if ( gnh->dups || !GlyphNameHashRemove(gnh,sc,sc->name) )
+	_GlyphHashFree(sf);
+}
 
-    new = chunkalloc(sizeof(struct glyphnamebucket));
-    new->sc = sc;
-    hash = hashname(sc->name);
-    new->next = sf->glyphnames->table[hash];
-    sf->glyphnames->table[hash] = new;
+void SFHashRemoveGlyph(SplineFont *sf,SplineChar *sc) {
+    /* sc is about to be removed from the font */
+    _SFHashRemoveGlyph(sf,sc);
+    if ( sf->cidmaster!=NULL )
+	_SFHashRemoveGlyph(sf->cidmaster,sc);
 }
 
 SplineChar *SFHashName(SplineFont *sf,const char *name) {
-    struct glyphnamebucket *test;
 
     if ( sf->glyphnames==NULL )
 	GlyphHashCreate(sf);
 
-    for ( test=sf->glyphnames->table[hashname(name)]; test!=NULL; test = test->next )
-	if ( strcmp(test->sc->name,name)==0 )
-return( test->sc );
-
-return( NULL );
+return( GlyphNameHashFind(sf->glyphnames,name) );
 }
 
 static int SCUniMatch(SplineChar *sc,int unienc) {
@@ -714,6 +863,158 @@ return( true );
 return( false );
 }
 
+static unsigned int UniHashValue(int uni) {
+    unsigned int val = uni;
+
+    val ^= val>>16;
+    val *= 0x45d9f3bU;
+    val ^= val>>16;
+return( val );
+}
+
+static struct glyphunientry *UniHashSlot(struct glyphunihash *guh,int uni) {
+    unsigned int mask = guh->size-1, pos;
+
+    for ( pos=UniHashValue(uni)&mask;
+	    guh->table[pos].uni!=-1 && guh->table[pos].uni!=uni;
+	    pos=(pos+1)&mask );
+return( &guh->table[pos] );
+}
+
+static void UniHashResize(struct glyphunihash *guh,int size) {
+    struct glyphunientry *old = guh->table;
+    int oldsize = guh->size, i;
+
+    guh->table = malloc(size*sizeof(struct glyphunientry));
+    for ( i=0; i<size; ++i )
+	guh->table[i].uni = -1;
+    guh->size = size;
+    for ( i=0; i<oldsize; ++i ) if ( old[i].uni!=-1 )
+	*UniHashSlot(guh,old[i].uni) = old[i];
+    free(old);
+}
+
+static void UniHashAdd(struct glyphunihash *guh,int uni,int gid) {
+    struct glyphunientry *e;
+
+    if ( uni<0 )
+return;
+    if ( 2*(guh->cnt+1)>guh->size )
+	UniHashResize(guh,2*guh->size);
+    e = UniHashSlot(guh,uni);
+    if ( e->uni==-1 ) {
+	e->uni = uni;
+	e->gid = gid;
+	++guh->cnt;
+    } else if ( e->gid!=gid ) {
+	/* The first glyph with a code point is the one we find */
+	guh->dups = true;
+	if ( gid<e->gid )
+	    e->gid = gid;
+    }
+}
+
+/* Remove uni if it maps to gid, closing up the run as for glyph names */
+static void UniHashRemove(struct glyphunihash *guh,int uni,int gid) {
+    struct glyphunientry *e;
+    unsigned int mask = guh->size-1, i, j, home;
+
+    if ( uni<0 )
+return;
+    e = UniHashSlot(guh,uni);
+    if ( e->uni==-1 || e->gid!=gid )
+return;
+    i = e-guh->table;
+    for ( j=(i+1)&mask; guh->table[j].uni!=-1; j=(j+1)&mask ) {
+	home = UniHashValue(guh->table[j].uni)&mask;
+	if ( ((j-home)&mask) >= ((j-i)&mask) ) {
+	    guh->table[i] = guh->table[j];
+	    i = j;
+	}
+    }
+    guh->table[i].uni = -1;
+    --guh->cnt;
+}
+
+static void UniHashAddGlyph(SplineFont *sf,SplineChar *sc) {
+    struct altuni *alt;
+
+    UniHashAdd(sf->glyphunis,sc->unicodeenc,sc->orig_pos);
+    for ( alt=sc->altuni; alt!=NULL; alt=alt->next )
+	UniHashAdd(sf->glyphunis,alt->unienc,sc->orig_pos);
+}
+
+static void UniHashRemoveGlyph(SplineFont *sf,SplineChar *sc) {
+    struct altuni *alt;
+
+    /* Another glyph may share one of its code points, and should now be */
+    /*  found instead */
+    if ( sf->glyphunis->dups ) {
+	UniHashFree(sf);
+return;
+    }
+    UniHashRemove(sf->glyphunis,sc->unicodeenc,sc->orig_pos);
+    for ( alt=sc->altuni; alt!=NULL; alt=alt->next )
+	UniHashRemove(sf->glyphunis,alt->unienc,sc->orig_pos);
+}
+
+static void UniHashCreate(SplineFont *sf) {
+    struct glyphunihash *guh;
+    int gid, size;
+
+    sf->glyphunis = guh = calloc(1,sizeof(struct glyphunihash));
+    guh->glyphs = sf->glyphs;
+    guh->glyphcnt = sf->glyphcnt;
+    for ( size=GNH_MINSIZE; size<2*sf->glyphcnt; size *= 2 );
+    UniHashResize(guh,size);
+    for ( gid=0; gid<sf->glyphcnt; ++gid ) if ( sf->glyphs[gid]!=NULL )
+	UniHashAddGlyph(sf,sf->glyphs[gid]);
+}
+
+void SFHashUnicodes(SplineFont *sf,SplineChar *sc) {
+    /* sc has been given new code points. Any it has lost are noticed when */
+    /*  looked up */
+    if ( sf==NULL )
+return;
+    if ( sf->glyphunis!=NULL && sc->orig_pos>=0 &&
+	    sc->orig_pos<sf->glyphunis->glyphcnt && sf->glyphs[sc->orig_pos]==sc )
+	UniHashAddGlyph(sf,sc);
+    else
+	UniHashFree(sf);
+}
+
+/* The first glyph in sf (not its subfonts) with unienc as its code point */
+/*  or one of its alternates, or -1 */
+static int SFHashUni(SplineFont *sf,int unienc) {
+    struct glyphunihash *guh = sf->glyphunis;
+    struct glyphunientry *e;
+    SplineChar *sc;
+    int tries;
+
+    if ( unienc<0 )
+return( -1 );
+    for ( tries=0; tries<2; ++tries ) {
+	if ( guh!=NULL && (guh->glyphs!=sf->glyphs || guh->glyphcnt!=sf->glyphcnt) ) {
+	    UniHashFree(sf);
+	    guh = NULL;
+	}
+	if ( guh==NULL ) {
+	    UniHashCreate(sf);
+	    guh = sf->glyphunis;
+	}
+	e = UniHashSlot(guh,unienc);
+	if ( e->uni==-1 )
+return( -1 );
+	if ( e->gid<sf->glyphcnt && (sc=sf->glyphs[e->gid])!=NULL &&
+		sc->orig_pos==e->gid && SCUniMatch(sc,unienc) )
+return( e->gid );
+	/* The glyph has lost the code point since it was indexed */
+	UniHashFree(sf);
+	guh = NULL;
+    }
+return( -1 );
+}
+
 /* Find the position in the glyph list where this code point/name is found. */
 /*  Returns -1 else on error */
 int SFFindGID(SplineFont *sf, int unienc, const char *name ) {
@@ -721,10 +1022,9 @@ int SFFindGID(SplineFont *sf, int unienc, const char *name ) {
     SplineChar *sc;
 
     if ( unienc!=-1 ) {
-	for ( gid=0; gid<sf->glyphcnt; ++gid ) if ( sf->glyphs[gid]!=NULL ) {
-	    if ( SCUniMatch(sf->glyphs[gid],unienc) )
+	gid = SFHashUni(sf,unienc);
+	if ( gid!=-1 )
 return( gid );
-	}
     }
     if ( name!=NULL ) {
 	sc = SFHashName(sf,name);
@@ -738,7 +1038,7 @@ return ( -1 );
 /* Find the position in the current encoding where this code point/name should*/
 /*  be found. (or for unencoded glyphs where it is found). Returns -1 else */
 int SFFindSlot(SplineFont *sf, EncMap *map, int unienc, const char *name ) {
-    int index=-1, pos;
+    int index=-1, pos, gid;
     struct cidmap *cidmap;
 
     if ( sf->cidmaster!=NULL && !map->enc->is_compact &&
@@ -756,10 +1056,15 @@ int SFFindSlot(SplineFont *sf, EncMap *map, int unienc, const char *name ) {
 		sf->glyphs[map->map[unienc]]!=NULL &&
 		sf->glyphs[map->map[unienc]]->unicodeenc==unienc )
 	    index = unienc;
-	else for ( index = map->enccount-1; index>=0; --index ) {
-	    if ( (pos = map->map[index])!=-1 && sf->glyphs[pos]!=NULL &&
-			SCUniMatch(sf->glyphs[pos],unienc) )
-	break;
+	else if ( (gid = SFHashUni(sf,unienc))==-1 )
+	    index = -1;
+	else if ( (index = map->backmap[gid])==-1 ) {
+	    /* Not encoded, but there may be another glyph with it which is */
+	    for ( index = map->enccount-1; index>=0; --index ) {
+		if ( (pos = map->map[index])!=-1 && sf->glyphs[pos]!=NULL &&
+			    SCUniMatch(sf->glyphs[pos],unienc) )
+	    break;
+	    }
 	}
     } else if ( unienc!=-1 &&
 	    ((unienc<0x10000 && map->enc->is_unicodebmp) ||
@@ -768,12 +1073,20 @@ int SFFindSlot(SplineFont *sf, EncMap *map, int unienc, const char *name ) {
     } else if ( unienc!=-1 ) {
 	index = EncFromUni(unienc,map->enc);
 	if ( index<0 || index>=map->enccount ) {
-	    for ( index=map->enc->char_cnt; index<map->enccount; ++index )
-		if ( (pos = map->map[index])!=-1 && sf->glyphs[pos]!=NULL &&
-			SCUniMatch(sf->glyphs[pos],unienc) )
-	    break;
-	    if ( index>=map->enccount )
+	    /* Look among the glyphs past the end of the encoding */
+	    gid = SFHashUni(sf,unienc);
+	    if ( gid==-1 )
 		index = -1;
+	    else if ( map->backmap[gid]>=map->enc->char_cnt )
+		index = map->backmap[gid];
+	    else {
+		for ( index=map->enc->char_cnt; index<map->enccount; ++index )
+		    if ( (pos = map->map[index])!=-1 && sf->glyphs[pos]!=NULL &&
+			    SCUniMatch(sf->glyphs[pos],unienc) )
+		break;
+		if ( index>=map->enccount )
+		    index = -1;
+	    }
 	}
     }
     if ( index==-1 && name!=NULL ) {
@@ -30,5 +30,8 @@ extern void __GlyphHashFree(struct glyphnamehash *hash);
 extern void MergeFont(FontViewBase *fv, SplineFont *other, int preserveCrossFontKerning);
 extern void SFFinishMergeContext(struct sfmergecontext *mc);
 extern void SFHashGlyph(SplineFont *sf, SplineChar *sc);
+extern void SFHashRemoveGlyph(SplineFont *sf, SplineChar *sc);
+extern void SFHashUnicodes(SplineFont *sf, SplineChar *sc);
+extern void SFHashRename(SplineFont *sf, SplineChar *sc, const char *oldname);
 
 #endif /* FONTFORGE_FVFONTS_H */
@@ -192,6 +192,7 @@ static SplineChar *MakeEncChar(SplineFont *sf,EncMap *map, int enc,const char *n
     uni = UniFromName(name,sf->uni_interp,map->enc);
     if ( uni!=-1 )
 	sc->unicodeenc = uni;
+    SFHashGlyph(sf,sc);
 return( sc );
 }
 
@@ -2370,6 +2371,7 @@ static void SFAddToBackground(SplineFont *sf,BDFFont *bdf) {
 		sc->name = copy(bdf->glyphs[i]->sc->name);
 		sc->orig_pos = i;
 		sc->unicodeenc = bdf->glyphs[i]->sc->unicodeenc;
+		SFHashGlyph(sf,sc);
 	    }
 	    bdfc = bdf->glyphs[i];
 
@@ -2494,7 +2496,7 @@ return;			/* No images */
       and all images have the same scale
     */
 
-    bdf = chunkalloc(sizeof(BDFFont));
+    bdf = calloc(1,sizeof(BDFFont));
     bdf->sf = sf;
     sf->bitmaps = bdf;
     bdf->pixelsize = (sf->ascent+sf->descent)/scale;
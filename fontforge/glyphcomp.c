@@ -1193,6 +1193,7 @@ static void FDAddMissingGlyph(struct font_diff *fd,SplineChar *sc2) {
     free(sc->name);
     sc->name = copy(sc2->name);
     sc->unicodeenc = sc2->unicodeenc;
+    SFHashGlyph(fd->sf1,sc);
     SCAddBackgrounds(sc,sc2);
 }
 
@@ -4037,6 +4037,7 @@ void SFGlyphRenameFixup(SplineFont *sf, const char *old, const char *new, int re
 		free(sc->name);
 		sc->name = newer;
 		sc->namechanged = sc->changed = true;
+		sf->changed_since_autosave = true;
 	    }
 	    for ( pst=sc->possub; pst!=NULL; pst=pst->next ) {
 		if ( pst->type==pst_substitution || pst->type==pst_alternate ||
@@ -2179,7 +2179,8 @@ return( (SplineFont *) names );
 	}
 	rewind(ttf);
 	sf = _SFReadTTF(ttf,flags,openflags,NULL,NULL,NULL);
-	fclose(ttf);
+	if ( sf==NULL || sf->lazy==NULL )	/* A lazy font keeps reading from it */
+	    fclose(ttf);
 	if ( sf!=NULL ) {
 	    free(buffer);
 	    fseek(f,start,SEEK_SET);
@@ -2816,7 +2817,8 @@ return( (SplineFont *) ret );
     }
     rewind(temp);
     sf = _SFReadTTF(temp,flags,openflags,NULL,NULL,NULL);
-    fclose(temp);
+    if ( sf==NULL || sf->lazy==NULL )	/* A lazy font keeps reading from it */
+	fclose(temp);
     free(buffer);
 return( sf );
 }
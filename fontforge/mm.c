@@ -31,6 +31,7 @@
 
 #include "dumppfa.h"
 #include "fontforgevw.h"
+#include "fvfonts.h"
 #include "lookups.h"
 #include "macenc.h"
 #include "splinesaveafm.h"
@@ -298,6 +299,7 @@ static SplineChar *SFMakeGlyphLike(SplineFont *sf, int gid, SplineFont *base) {
     sc->width = bsc->width; sc->widthset = true; sc->vwidth = bsc->vwidth;
     free(sc->name); sc->name = copy(bsc->name);
     sc->unicodeenc = bsc->unicodeenc;
+    SFHashGlyph(sf,sc);
 return( sc );
 }
 
@@ -28,16 +28,40 @@
 #ifndef FONTFORGE_NAMEHASH_H
 #define FONTFORGE_NAMEHASH_H
 
+/* Size of the fixed table of standard postscript names in namelist.c */
 #define GN_HSIZE	257
 
-struct glyphnamebucket {
-    SplineChar *sc;
-    struct glyphnamebucket *next;
-    const char *name;
+/* Glyph names are looked up in an open addressing table with linear */
+/*  probing. It is kept at most half full, so lookups rarely look at more */
+/*  than a couple of consecutive slots */
+struct glyphnameentry {
+    SplineChar *sc;		/* NULL for an empty slot */
+    const char *name;		/* The key, or NULL if it is sc->name */
+    unsigned int hash;		/* Full hash value of the key */
 };
 
 struct glyphnamehash {
-    struct glyphnamebucket *table[GN_HSIZE];
+    struct glyphnameentry *table;
+    int size;			/* A power of two (or 0 before anything is added) */
+    int cnt;
+    int dups;			/* Some name was added more than once */
+};
+
+/* Code points (including alternate unicodes) to the first glyph which has */
+/*  them. Like the name table this is built when first needed, and is */
+/*  thrown away if the glyph array changes behind its back */
+struct glyphunientry {
+    int uni;			/* -1 for an empty slot */
+    int gid;
+};
+
+struct glyphunihash {
+    struct glyphunientry *table;
+    int size;			/* A power of two */
+    int cnt;
+    int dups;			/* Some code point is in more than one glyph */
+    SplineChar **glyphs;	/* What sf->glyphs and sf->glyphcnt were */
+    int glyphcnt;
 };
 
 #ifndef __GNUC__
@@ -58,4 +82,20 @@ static __inline__ unsigned int hashname(const char *pt) {
 return( val );
 }
 
+/* FNV-1a, all 32 bits of which are used to pick a slot and to reject */
+/*  most mismatches without a strcmp */
+static __inline__ unsigned int glyphnamehashval(const char *pt) {
+    unsigned int val = 2166136261U;
+
+    while ( *pt ) {
+	val ^= (unsigned char) *pt++;
+	val *= 16777619U;
+    }
+return( val );
+}
+
+extern void GlyphNameHashAdd(struct glyphnamehash *hash, SplineChar *sc, const char *name, int replace);
+extern SplineChar *GlyphNameHashFind(struct glyphnamehash *hash, const char *name);
+extern int GlyphNameHashRemove(struct glyphnamehash *hash, SplineChar *sc, const char *name);
+
 #endif /* FONTFORGE_NAMEHASH_H */
@@ -812,33 +812,14 @@ return( buffer );
 
 static void BuildHash(struct glyphnamehash *hash,SplineFont *sf, char **oldnames) {
     int gid;
-    unsigned int hv;
-    SplineChar *sc;
-    struct glyphnamebucket *new;
 
     memset(hash,0,sizeof(*hash));
     for ( gid = 0; gid<sf->glyphcnt; ++gid ) {
-	if ( (sc=sf->glyphs[gid])!=NULL && oldnames[gid]!=NULL ) {
-	    new = chunkalloc(sizeof(struct glyphnamebucket));
-	    new->sc = sf->glyphs[gid];
-	    hv = hashname(oldnames[gid]);
-	    new->next = hash->table[hv];
-	    new->name = oldnames[gid];
-	    hash->table[hv] = new;
-	}
+	if ( sf->glyphs[gid]!=NULL && oldnames[gid]!=NULL )
+	    GlyphNameHashAdd(hash,sf->glyphs[gid],oldnames[gid],true);
     }
 }
 
-static SplineChar *HashFind(struct glyphnamehash *hash,const char *name) {
-    struct glyphnamebucket *test;
-
-    for ( test=hash->table[hashname(name)]; test!=NULL; test = test->next )
-	if ( strcmp(test->name,name)==0 )
-return( test->sc );
-
-return( NULL );
-}
-
 struct bits {
     char *start, *end;
     SplineChar *rpl;
@@ -913,7 +894,7 @@ return;
 	ch = *end; *end='\0';
 	bits[bc].start = start;
 	bits[bc].end   = end;
-	bits[bc].rpl   = HashFind(hash,start);
+	bits[bc].rpl   = GlyphNameHashFind(hash,start);
 	if ( bits[bc].rpl!=NULL )
 	    ++bc;
 	*end = ch;
@@ -936,7 +917,7 @@ static void SFRenameLookupsByHash(SplineFont *sf,struct glyphnamehash *hash) {
 	for ( pst=sc->possub; pst!=NULL; pst=pst->next ) {
 	    switch ( pst->type ) {
 	      case pst_pair: case pst_substitution:
-		rpl = HashFind(hash,pst->u.subs.variant);	/* variant is at same location as paired */
+		rpl = GlyphNameHashFind(hash,pst->u.subs.variant);	/* variant is at same location as paired */
 		if ( rpl!=NULL ) {
 		    free( pst->u.subs.variant );
 		    pst->u.subs.variant = copy(rpl->name);
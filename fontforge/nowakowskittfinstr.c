@@ -33,6 +33,7 @@
 #include "dumppfa.h"
 #include "fontforgevw.h"
 #include "mem.h"
+#include "parallel.h"
 #include "splinefont.h"
 #include "splineutil.h"
 #include "splineutil2.h"
@@ -287,6 +288,21 @@ struct ttf_table *SFFindTable(SplineFont *sf,uint32 tag) {
 return( tab );
 }
 
+/* Index of the first cvt entry within one unit of val, -1 if none */
+static int TTF__findcvtval(SplineFont *sf,int val) {
+    int i;
+    struct ttf_table *cvt_tab = SFFindTable(sf,CHR('c','v','t',' '));
+
+    if ( cvt_tab==NULL )
+return( -1 );
+    for ( i=0; (int)sizeof(uint16)*i<cvt_tab->len; ++i ) {
+        int tval = (int16) memushort(cvt_tab->data,cvt_tab->len, sizeof(uint16)*i);
+        if ( val>=tval-1 && val<=tval+1 )
+return( i );
+    }
+return( -1 );
+}
+
 int TTF__getcvtval(SplineFont *sf,int val) {
     int i;
     struct ttf_table *cvt_tab = SFFindTable(sf,CHR('c','v','t',' '));
@@ -299,11 +315,9 @@ int TTF__getcvtval(SplineFont *sf,int val) {
         cvt_tab->next = sf->ttf_tables;
         sf->ttf_tables = cvt_tab;
     }
-    for ( i=0; (int)sizeof(uint16)*i<cvt_tab->len; ++i ) {
-        int tval = (int16) memushort(cvt_tab->data,cvt_tab->len, sizeof(uint16)*i);
-        if ( val>=tval-1 && val<=tval+1 )
+    if ( (i = TTF__findcvtval(sf,val))!=-1 )
 return( i );
-    }
+    i = (cvt_tab->len+sizeof(uint16)-1)/sizeof(uint16);
     if ( (int)sizeof(uint16)*i>=cvt_tab->maxlen ) {
         if ( cvt_tab->maxlen==0 ) cvt_tab->maxlen = cvt_tab->len;
         cvt_tab->maxlen += 200;
@@ -2062,10 +2076,19 @@ typedef struct diagpointinfo {
     int count;
 } DiagPointInfo;
 
+/* The cvt values asked for while instructing a glyph on a worker thread, */
+/*  where the cvt may be looked in but mustn't grow */
+typedef struct cvtwants {
+    int cnt, max;
+    int *vals;
+    int missed;           /* some weren't in the cvt yet */
+} CvtWants;
+
 typedef struct instrct {
     /* Things that are global for font and should be
        initialized before instructing particular glyph. */
     GlobalInstrCt *gic;
+    CvtWants *cvtwants;   /* NULL if the cvt may grow */
 
     /* Here things for this particular glyph start. */
     SplineChar *sc;
@@ -4388,6 +4411,27 @@ return( true );
 return( false );
 }
 
+/* Like TTF_getcvtval, but when the cvt mustn't grow a value not in it */
+/*  yet is only noted (and 0 given instead), for the glyph to be done again */
+/*  once the cvt has been made to hold it */
+static int InstrCtGetCvtVal( InstrCt *ct,int val ) {
+    CvtWants *wants = ct->cvtwants;
+    int cvt;
+
+    if ( wants==NULL )
+return( TTF_getcvtval( ct->gic->sf,val ));
+    if ( wants->cnt>=wants->max ) {
+        wants->max += 10;
+        wants->vals = realloc( wants->vals,wants->max*sizeof(int) );
+    }
+    wants->vals[wants->cnt++] = val;
+    if ( (cvt = TTF__findcvtval( ct->gic->sf,val<0 ? -val : val ))==-1 ) {
+        wants->missed = true;
+        cvt = 0;
+    }
+return( cvt );
+}
+
 static uint8 *FixDStemPoint ( InstrCt *ct,StemData *stem,
     int pt,int refpt,int firstedge,int cvt,BasePoint *fv ) {
     uint8 *instrs, *touched;
@@ -4552,7 +4596,7 @@ return( ct->pt );
          * stems, but for diagonales it is just unlikely that we can find an
          * acceptable predefined value in StemSnapH or StemSnapV
          */
-        cvt = TTF_getcvtval( ct->gic->sf,ds->width );
+        cvt = InstrCtGetCvtVal( ct,ds->width );
 
         pushpts[0] = EF2Dot14(ds->l_to_r.x);
         pushpts[1] = EF2Dot14(ds->l_to_r.y);
@@ -5164,26 +5208,22 @@ static uint8 *dogeninstructions(InstrCt *ct) {
 return ct->sc->ttf_instrs = realloc(ct->instrs,(ct->pt)-(ct->instrs));
 }
 
-void NowakowskiSCAutoInstr(GlobalInstrCt *gic, SplineChar *sc) {
-    int cnt, contourcnt;
-    BasePoint *bp;
-    int *contourends;
-    uint8 *clockwise;
-    uint8 *touched;
-    uint8 *affected;
-    SplineSet *ss;
+/* Does what instructing sc needs done first, which may post errors, hint */
+/*  the glyph and renumber its points. Returns whether there are */
+/*  instructions to generate. The glyph's old instructions are freed, or */
+/*  if old isn't NULL, handed back there */
+static int SCAutoInstrPrepare(GlobalInstrCt *gic, SplineChar *sc,
+	uint8 **old, int16 *oldlen) {
     RefChar *ref;
-    InstrCt ct;
-    int i;
 
     if ( !sc->layers[gic->layer].order2 )
-return;
+return( false );
 
     if ( sc->layers[gic->layer].refs!=NULL && sc->layers[gic->layer].splines!=NULL ) {
 	ff_post_error(_("Can't instruct this glyph"),
 		_("TrueType does not support mixed references and contours.\nIf you want instructions for %.30s you should either:\n * Unlink the reference(s)\n * Copy the inline contours into their own (unencoded\n    glyph) and make a reference to that."),
 		sc->name );
-return;
+return( false );
     }
     for ( ref = sc->layers[gic->layer].refs; ref!=NULL; ref=ref->next ) {
 	if ( ref->transform[0]>=2 || ref->transform[0]<-2 ||
@@ -5196,10 +5236,15 @@ return;
 	ff_post_error(_("Can't instruct this glyph"),
 		_("TrueType does not support references which\nare scaled by more than 200%%.  But %1$.30s\nhas been in %2$.30s. Any instructions\nadded would be meaningless."),
 		ref->sc->name, sc->name );
-return;
+return( false );
     }
 
-    if ( sc->ttf_instrs ) {
+    if ( old!=NULL ) {
+	*old = sc->ttf_instrs;
+	*oldlen = sc->ttf_instrs_len;
+	sc->ttf_instrs = NULL;
+	sc->ttf_instrs_len = 0;
+    } else if ( sc->ttf_instrs ) {
 	free(sc->ttf_instrs);
 	sc->ttf_instrs = NULL;
 	sc->ttf_instrs_len = 0;
@@ -5210,7 +5255,7 @@ return;
 	SplineCharAutoHint(sc,gic->layer,NULL);
 
     if ( sc->vstem==NULL && sc->hstem==NULL && sc->dstem==NULL && sc->md==NULL)
-return;
+return( false );
 
     /* TODO!
      *
@@ -5222,8 +5267,22 @@ return;
      * Perhaps we should advise turning 'use my metrics' off.
      */
 
-    if ( sc->layers[gic->layer].splines==NULL )
-return;
+return( sc->layers[gic->layer].splines!=NULL );
+}
+
+/* Generates the instructions of a glyph SCAutoInstrPrepare has approved. */
+/*  This touches nothing outside the glyph but the cvt, and that only if */
+/*  cvtwants is NULL, so several glyphs may be done at once if it isn't */
+static void SCAutoInstrGenerate(GlobalInstrCt *gic, SplineChar *sc, CvtWants *cvtwants) {
+    int cnt, contourcnt;
+    BasePoint *bp;
+    int *contourends;
+    uint8 *clockwise;
+    uint8 *touched;
+    uint8 *affected;
+    SplineSet *ss;
+    InstrCt ct;
+    int i;
 
     /* Start dealing with the glyph */
     contourcnt = 0;
@@ -5250,6 +5309,7 @@ return;
         gic->blues[i].highest = gic->blues[i].lowest = -1;
 
     ct.gic = gic;
+    ct.cvtwants = cvtwants;
 
     ct.sc = sc;
     ct.ss = sc->layers[gic->layer].splines;
@@ -5273,7 +5333,104 @@ return;
     free(bp);
     free(contourends);
     free(clockwise);
+}
+
+void NowakowskiSCAutoInstr(GlobalInstrCt *gic, SplineChar *sc) {
+
+    if ( !SCAutoInstrPrepare(gic,sc,NULL,NULL) )
+return;
+    SCAutoInstrGenerate(gic,sc,NULL);
 
     SCMarkInstrDlgAsChanged(sc);
     SCHintsChanged(sc);
 }
+
+struct instrwork {
+    GlobalInstrCt *gic;
+    SplineChar **glyphs;
+    CvtWants *wants;
+    uint8 *done;
+};
+
+static void SCAutoInstrWork(int i, void *data) {
+    struct instrwork *work = data;
+    /* Each glyph notes its blue zones' extreme points in the context, and */
+    /*  some steps widen its fudge for a while, so give each its own */
+    GlobalInstrCt gic = *work->gic;
+
+    work->wants[i].cnt = 0;
+    work->wants[i].missed = false;
+    SCAutoInstrGenerate(&gic,work->glyphs[i],&work->wants[i]);
+    work->done[i] = true;
+}
+
+/* Instructs the glyphs as calling NowakowskiSCAutoInstr on each in turn */
+/*  would, but generates the instructions on as many threads as */
+/*  ff_parallel_jobs allows. A diagonal stem width not yet in the cvt can't */
+/*  be added to it then, and makes a glyph's instructions wrong, so */
+/*  afterwards the widths those glyphs asked for are added to the cvt in */
+/*  glyph order, just as they would have been one glyph at a time, and */
+/*  those glyphs are done again. The progress indicator advances once per */
+/*  glyph, and if it is cancelled glyphs not yet done keep the */
+/*  instructions they had. No glyph may be given twice */
+void NowakowskiSFAutoInstr(GlobalInstrCt *gic, SplineChar **glyphs, int cnt) {
+    struct instrwork work, redo;
+    uint8 **old;
+    int16 *oldlen;
+    int i, j, k, todocnt, ok = true;
+
+    /* Readying a glyph may post errors and autohint it (which looks at */
+    /*  other glyphs), so that is done here, one glyph at a time, in order */
+    work.gic = redo.gic = gic;
+    work.glyphs = malloc((cnt+1)*sizeof(SplineChar *));
+    old = malloc((cnt+1)*sizeof(uint8 *));
+    oldlen = malloc((cnt+1)*sizeof(int16));
+    for ( i=todocnt=0; i<cnt && ok; ++i ) {
+	old[todocnt] = NULL;
+	if ( SCAutoInstrPrepare(gic,glyphs[i],&old[todocnt],&oldlen[todocnt]) )
+	    work.glyphs[todocnt++] = glyphs[i];
+	else {
+	    free(old[todocnt]);
+	    ok = ff_progress_next();
+	}
+    }
+    work.wants = calloc(todocnt+1,sizeof(CvtWants));
+    work.done = calloc(todocnt+1,1);
+    if ( ok )
+	ParallelFor(todocnt,SCAutoInstrWork,&work,true);
+
+    redo.glyphs = malloc((todocnt+1)*sizeof(SplineChar *));
+    redo.wants = calloc(todocnt+1,sizeof(CvtWants));
+    redo.done = calloc(todocnt+1,1);
+    for ( i=j=0; i<todocnt; ++i ) if ( work.done[i] && work.wants[i].missed ) {
+	for ( k=0; k<work.wants[i].cnt; ++k )
+	    TTF_getcvtval(gic->sf,work.wants[i].vals[k]);
+	free(work.glyphs[i]->ttf_instrs);
+	work.glyphs[i]->ttf_instrs = NULL;
+	work.glyphs[i]->ttf_instrs_len = 0;
+	redo.glyphs[j++] = work.glyphs[i];
+    }
+    ParallelFor(j,SCAutoInstrWork,&redo,false);
+    for ( i=0; i<j; ++i ) if ( redo.wants[i].missed )
+	IError("The cvt lacks a width %s asked for", redo.glyphs[i]->name );
+
+    for ( i=0; i<todocnt; ++i ) {
+	SplineChar *sc = work.glyphs[i];
+	if ( work.done[i] ) {
+	    free(old[i]);
+	    SCMarkInstrDlgAsChanged(sc);
+	    SCHintsChanged(sc);
+	} else {
+	    sc->ttf_instrs = old[i];
+	    sc->ttf_instrs_len = oldlen[i];
+	}
+    }
+
+    for ( i=0; i<todocnt; ++i ) {
+	free(work.wants[i].vals);
+	free(redo.wants[i].vals);
+    }
+    free(work.glyphs); free(work.wants); free(work.done);
+    free(redo.glyphs); free(redo.wants); free(redo.done);
+    free(old); free(oldlen);
+}
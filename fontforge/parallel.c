@@ -0,0 +1,237 @@
+/* Copyright (C) 2020 by FontForge authors */
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+
+ * The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fontforge-config.h>
+
+#include "parallel.h"
+
+#include "ffglib.h"
+#include "uiinterface.h"
+#include "ustring.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+int ff_parallel_jobs = 1;
+
+struct parallel_data {
+    int cnt;
+    ParallelFunc func;
+    void *data;
+    gint next;		/* Next index to be claimed */
+    gint done;		/* Number of items finished */
+    gint stop;		/* Set when the user cancels */
+};
+
+/* While the workers run, errors and warnings they report are queued up and */
+/*  handed on to the real ui_interface, in the order they arrived, once */
+/*  the work is done. Only the calling thread may talk to the ui */
+enum parallel_msgtype { pm_ierror, pm_logwarning, pm_post_error, pm_post_warning };
+
+struct parallel_msg {
+    enum parallel_msgtype type;
+    char *title, *msg;
+    struct parallel_msg *next;
+};
+
+static struct ui_interface *parallel_ui;	/* The real one */
+static GThread *parallel_caller;
+static GMutex parallel_lock;
+static struct parallel_msg *parallel_msgs, *parallel_last;
+static gint parallel_running;
+
+static void ParallelDeliver(enum parallel_msgtype type,const char *title,const char *msg) {
+    switch ( type ) {
+      case pm_ierror:
+	(parallel_ui->ierror)("%s",msg);
+      break;
+      case pm_logwarning:
+	(parallel_ui->logwarning)("%s",msg);
+      break;
+      case pm_post_error:
+	(parallel_ui->post_error)(title,"%s",msg);
+      break;
+      case pm_post_warning:
+	(parallel_ui->post_warning)(title,"%s",msg);
+      break;
+    }
+}
+
+static void ParallelMessage(enum parallel_msgtype type,const char *title,const char *fmt,va_list ap) {
+    struct parallel_msg *pm;
+    char *msg = vsmprintf(fmt,ap);
+
+    if ( g_thread_self()==parallel_caller ) {
+	ParallelDeliver(type,title,msg);
+	free(msg);
+return;
+    }
+    pm = calloc(1,sizeof(struct parallel_msg));
+    pm->type = type;
+    pm->title = copy(title);
+    pm->msg = msg;
+    g_mutex_lock(&parallel_lock);
+    if ( parallel_last==NULL )
+	parallel_msgs = pm;
+    else
+	parallel_last->next = pm;
+    parallel_last = pm;
+    g_mutex_unlock(&parallel_lock);
+}
+
+static void ParallelIError(const char *fmt,...) {
+    va_list ap;
+    va_start(ap,fmt);
+    ParallelMessage(pm_ierror,NULL,fmt,ap);
+    va_end(ap);
+}
+
+static void ParallelLogWarning(const char *fmt,...) {
+    va_list ap;
+    va_start(ap,fmt);
+    ParallelMessage(pm_logwarning,NULL,fmt,ap);
+    va_end(ap);
+}
+
+static void ParallelPostError(const char *title,const char *fmt,...) {
+    va_list ap;
+    va_start(ap,fmt);
+    ParallelMessage(pm_post_error,title,fmt,ap);
+    va_end(ap);
+}
+
+static void ParallelPostWarning(const char *title,const char *fmt,...) {
+    va_list ap;
+    va_start(ap,fmt);
+    ParallelMessage(pm_post_warning,title,fmt,ap);
+    va_end(ap);
+}
+
+static void ParallelFlushMessages(void) {
+    struct parallel_msg *pm, *next;
+
+    for ( pm=parallel_msgs; pm!=NULL; pm=next ) {
+	next = pm->next;
+	ParallelDeliver(pm->type,pm->title,pm->msg);
+	free(pm->title);
+	free(pm->msg);
+	free(pm);
+    }
+    parallel_msgs = parallel_last = NULL;
+}
+
+int ParallelRunning(void) {
+return( g_atomic_int_get(&parallel_running)>0 );
+}
+
+int ParallelJobCount(int cnt) {
+    int jobs = ff_parallel_jobs;
+
+    if ( jobs<=0 )
+	jobs = g_get_num_processors();
+    if ( jobs>cnt )
+	jobs = cnt;
+return( jobs<1 ? 1 : jobs );
+}
+
+static void ParallelWork(struct parallel_data *pd) {
+    int i;
+
+    while ( !g_atomic_int_get(&pd->stop) ) {
+	i = g_atomic_int_add(&pd->next,1);
+	if ( i>=pd->cnt )
+    break;
+	(pd->func)(i,pd->data);
+	g_atomic_int_inc(&pd->done);
+    }
+}
+
+static gpointer ParallelThread(gpointer data) {
+    ParallelWork((struct parallel_data *) data);
+return( NULL );
+}
+
+int ParallelFor(int cnt, ParallelFunc func, void *data, int progress) {
+    struct parallel_data pd;
+    struct ui_interface queued_ui;
+    GThread **threads;
+    int jobs = ParallelJobCount(cnt), i, reported, done;
+
+    if ( cnt<=0 )
+return( true );
+    if ( jobs==1 ) {
+	for ( i=0; i<cnt; ++i ) {
+	    (func)(i,data);
+	    if ( progress && !ff_progress_next())
+return( false );
+	}
+return( true );
+    }
+
+    pd.cnt = cnt; pd.func = func; pd.data = data;
+    pd.next = pd.done = pd.stop = 0;
+    parallel_ui = ui_interface;
+    parallel_caller = g_thread_self();
+    queued_ui = *ui_interface;
+    queued_ui.ierror = ParallelIError;
+    queued_ui.logwarning = ParallelLogWarning;
+    queued_ui.post_error = ParallelPostError;
+    queued_ui.post_warning = ParallelPostWarning;
+    ui_interface = &queued_ui;
+    g_atomic_int_inc(&parallel_running);
+    threads = malloc((jobs-1)*sizeof(GThread *));
+    for ( i=0; i<jobs-1; ++i )
+	threads[i] = g_thread_new("ff-parallel",ParallelThread,&pd);
+
+    /* The calling thread does its share of the work too, but it is also the */
+    /*  only one allowed to talk to the progress indicator, so it reports what */
+    /*  everyone has finished each time it completes an item of its own */
+    reported = 0;
+    while ( !pd.stop ) {
+	i = g_atomic_int_add(&pd.next,1);
+	if ( i>=cnt )
+    break;
+	(func)(i,data);
+	g_atomic_int_inc(&pd.done);
+	if ( progress ) {
+	    done = g_atomic_int_get(&pd.done);
+	    if ( done>reported && !ff_progress_increment(done-reported))
+		g_atomic_int_set(&pd.stop,true);
+	    reported = done;
+	}
+    }
+    for ( i=0; i<jobs-1; ++i )
+	g_thread_join(threads[i]);
+    free(threads);
+    g_atomic_int_add(&parallel_running,-1);
+    ui_interface = parallel_ui;
+    ParallelFlushMessages();
+    if ( progress && !pd.stop && pd.done>reported &&
+	    !ff_progress_increment(pd.done-reported))
+return( false );
+return( !pd.stop );
+}
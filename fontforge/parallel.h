@@ -0,0 +1,30 @@
+#ifndef FONTFORGE_PARALLEL_H
+#define FONTFORGE_PARALLEL_H
+
+/* Number of threads used by operations which can process glyphs */
+/*  independently of one another. 1 (the default) keeps everything on the */
+/*  calling thread, 0 means one thread per processor */
+extern int ff_parallel_jobs;
+
+typedef void (*ParallelFunc)(int index, void *data);
+
+/* How many threads would be used to process cnt items */
+extern int ParallelJobCount(int cnt);
+
+/* True while ParallelFor has worker threads running, when data which */
+/*  several glyphs share may be read by all of them at once */
+extern int ParallelRunning(void);
+
+/* Calls func(i,data) for every i in [0,cnt), in no particular order. func */
+/*  must not touch the ui, nor any state shared with other indices, except */
+/*  that it may report problems through the ui_interface's ierror, */
+/*  logwarning, post_error and post_warning (IError, LogError, */
+/*  ff_post_error and ff_post_notice, which is post_warning). Only those */
+/*  are queued, to be passed on from the calling thread once all the work */
+/*  is done; ff_ask and the like must not be used. If progress is set the progress indicator is */
+/*  advanced once per item (from the calling thread) and the return value */
+/*  is false if the user cancelled (in which case some items will not have */
+/*  been processed) */
+extern int ParallelFor(int cnt, ParallelFunc func, void *data, int progress);
+
+#endif /* FONTFORGE_PARALLEL_H */
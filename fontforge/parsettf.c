@@ -2241,7 +2241,15 @@ return( sc );
 	    info->bbcomplain = true;
 	}
     }
-    if ( path_cnt>=0 )
+    if ( path_cnt>=0 && info->lazy!=NULL ) {
+	/* Composites are still read, we need to know who depends on whom */
+	struct lazyoutline *lo = chunkalloc(sizeof(struct lazyoutline));
+	lo->offset = info->glyph_start+start;
+	lo->end = info->glyph_start+end;
+	lo->layer = ly_fore;
+	sc->lazy = lo;
+return( sc );
+    } else if ( path_cnt>=0 )
 	readttfsimpleglyph(ttf,info,sc,path_cnt,gbb);
     else
 	readttfcompositglyph(ttf,info,sc,info->glyph_start+end);
@@ -2258,6 +2266,41 @@ return( sc );
 return( sc );
 }
 
+static void ttfLoadLazy(SplineChar *sc,struct lazyglyphs *lazy) {
+    struct ttfinfo info;
+    int path_cnt, gbb[4], i;
+
+    memset(&info,'\0',sizeof(info));
+    info.to_order2 = lazy->order2;
+    info.gbbcomplain = true;		/* Don't complain again for every glyph */
+    fseek(lazy->file,sc->lazy->offset,SEEK_SET);
+    path_cnt = (short) getushort(lazy->file);
+    for ( i=0; i<4; ++i )
+	gbb[i] = (short) getushort(lazy->file);
+    readttfsimpleglyph(lazy->file,&info,sc,path_cnt,gbb);
+    if ( ftell(lazy->file)>sc->lazy->end )
+	LogError(_("Bad glyph (%d), its definition extends beyond the space allowed for it\n"), sc->orig_pos );
+}
+
+/* Glyphs used as components must be read now so that references to them */
+/*  can be instanciated (their parent font doesn't exist yet) */
+static void ttfLoadLazyComponents(struct ttfinfo *info) {
+    int i;
+    RefChar *ref;
+    SplineChar *rsc;
+
+    for ( i=0; i<info->glyph_cnt; ++i ) if ( info->chars[i]!=NULL ) {
+	for ( ref=info->chars[i]->layers[ly_fore].refs; ref!=NULL; ref=ref->next ) {
+	    if ( ref->orig_pos<info->glyph_cnt && (rsc=info->chars[ref->orig_pos])!=NULL &&
+		    rsc->lazy!=NULL ) {
+		ttfLoadLazy(rsc,info->lazy);
+		LazyOutlinesFree(rsc->lazy);
+		rsc->lazy = NULL;
+	    }
+	}
+    }
+}
+
 static void readttfencodings(FILE *ttf,struct ttfinfo *info, int justinuse);
 
 static void readttfglyphs(FILE *ttf,struct ttfinfo *info) {
@@ -5572,6 +5615,15 @@ return( 0 );
 	/*  This messes up the point count */
 	if ( info->gvar_start!=0 && info->fvar_start!=0 )
 	    info->to_order2 = true;
+	/* Variations and sidebearing corrections need the points, and */
+	/*  fontlint wants to see everything */
+	else if ( (info->openflags&of_lazy) && !(info->openflags&of_fontlint) &&
+		!info->apply_lsb ) {
+	    info->lazy = chunkalloc(sizeof(struct lazyglyphs));
+	    info->lazy->file = ttf;
+	    info->lazy->load = ttfLoadLazy;
+	    info->lazy->order2 = info->to_order2;
+	}
 	readttfglyphs(ttf,info);
     } else if ( info->cff_start!=0 ) {
 	info->to_order2 = (loaded_fonts_same_as_new && new_fonts_are_order2);
@@ -5666,6 +5718,8 @@ return( 0 );
     if ( info->math_start!=0 )
 	otf_read_math(ttf,info);
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
+    if ( info->lazy!=NULL )
+	ttfLoadLazyComponents(info);
     if ( !info->onlystrikes && info->glyphlocations_start!=0 && info->glyph_start!=0 )
 	ttfFixupReferences(info);
     /* Can't fix up any postscript references until we create a SplineFont */
@@ -6056,6 +6110,7 @@ static SplineFont *SFFillFromTTF(struct ttfinfo *info) {
     sf->comments = info->fontcomments;
     sf->fontlog = info->fontlog;
     sf->cvt_names = info->cvt_names;
+    sf->lazy = info->lazy;
 
     sf->creationtime = info->creationtime;
     sf->modificationtime = info->modificationtime;
@@ -6319,8 +6374,13 @@ SplineFont *_SFReadTTF(FILE *ttf, int flags,enum openflags openflags, char *file
     if ( chosenname!=NULL) 
 	info.chosenname = copy(chosenname);
     ret = readttf(ttf,&info,filename);
-    if ( !ret )
+    if ( !ret ) {
+	if ( info.lazy!=NULL ) {
+	    info.lazy->file = NULL;		/* Belongs to our caller */
+	    LazyGlyphsFree(info.lazy);
+	}
 return( NULL );
+    }
 return( SFFillFromTTF(&info));
 }
 
@@ -6341,7 +6401,8 @@ SplineFont *SFReadTTF(char *filename, int flags, enum openflags openflags) {
     ttf = fopen(strippedname,"rb");
     if ( ttf!=NULL ) {
         sf = _SFReadTTF(ttf,flags,openflags,strippedname,chosenname,NULL);
-        fclose(ttf);
+        if ( sf==NULL || sf->lazy==NULL )	/* A lazy font keeps reading from it */
+            fclose(ttf);
     }
     if ( strippedname!=filename ) free(strippedname);
     if ( chosenname!=NULL ) free(chosenname);
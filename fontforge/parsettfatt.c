@@ -497,17 +497,34 @@ static void addPairPos(struct ttfinfo *info, int glyph1, int glyph2,
     }
 }
 
+static void KernIndexesFree(struct ttfinfo *info) {
+    KernPairIndexFree(info->kern_index[0]);
+    KernPairIndexFree(info->kern_index[1]);
+    info->kern_index[0] = info->kern_index[1] = NULL;
+}
+
+/* Of the pairs the glyphs have so far, whichever table they came from */
+static struct kernpairindex *KernIndexNew(struct ttfinfo *info, int isv) {
+    struct kernpairindex *kpi = KernPairIndexNew(NULL,isv);
+    KernPair *kp;
+    int i;
+
+    for ( i=0; i<info->glyph_cnt; ++i ) if ( info->chars[i]!=NULL ) {
+	for ( kp = isv ? info->chars[i]->vkerns : info->chars[i]->kerns; kp!=NULL; kp=kp->next )
+	    KernPairIndexAdd(kpi,info->chars[i],kp);
+    }
+return( kpi );
+}
+
 static int addKernPair(struct ttfinfo *info, int glyph1, int glyph2,
 	int16 offset, uint32 devtab, struct lookup_subtable *subtable,int isv,
 	FILE *ttf) {
     KernPair *kp;
     if ( glyph1<info->glyph_cnt && glyph2<info->glyph_cnt &&
 	    info->chars[glyph1]!=NULL && info->chars[glyph2]!=NULL ) {
-	for ( kp=isv ? info->chars[glyph1]->vkerns : info->chars[glyph1]->kerns;
-		kp!=NULL; kp=kp->next ) {
-	    if ( kp->sc == info->chars[glyph2] )
-	break;
-	}
+	if ( info->kern_index[isv]==NULL )
+	    info->kern_index[isv] = KernIndexNew(info,isv);
+	kp = KernPairIndexFind(info->kern_index[isv],info->chars[glyph1],info->chars[glyph2]);
 	if ( kp==NULL ) {
 	    kp = chunkalloc(sizeof(KernPair));
 	    kp->sc = info->chars[glyph2];
@@ -524,6 +541,7 @@ static int addKernPair(struct ttfinfo *info, int glyph1, int glyph2,
 		kp->next = info->chars[glyph1]->kerns;
 		info->chars[glyph1]->kerns = kp;
 	    }
+	    KernPairIndexAdd(info->kern_index[isv],info->chars[glyph1],kp);
 	} else if ( kp->subtable!=subtable )
 return( true );
     } else if ( glyph1>=info->glyph_cnt || glyph2>=info->glyph_cnt ) {
@@ -3019,6 +3037,7 @@ void GuessNamesFromGSUB(FILE *ttf,struct ttfinfo *info) {
 void readttfgpossub(FILE *ttf,struct ttfinfo *info,int gpos) {
     ProcessGPOSGSUB(ttf,info,gpos,git_normal);
     info->g_bounds = 0;
+    KernIndexesFree(info);
 }
 
 void readttfgdef(FILE *ttf,struct ttfinfo *info) {
@@ -6060,7 +6079,7 @@ return( NULL );
 return( ret );
 }
 
-void readttfjstf(FILE *ttf,struct ttfinfo *info) {
+static void _readttfjstf(FILE *ttf,struct ttfinfo *info) {
     int version;
     int scnt, lcnt, lmax;
     int i,j;
@@ -6156,3 +6175,9 @@ return;
     free(loff);
     free(soff);
 }
+
+void readttfjstf(FILE *ttf,struct ttfinfo *info) {
+    /* Justification lookups may kern too */
+    _readttfjstf(ttf,info);
+    KernIndexesFree(info);
+}
@@ -48,6 +48,7 @@
 #include "fvcomposite.h"
 #include "fvfonts.h"
 #include "fvimportbdf.h"
+#include "gfile.h"
 #include "glyphcomp.h"
 #include "langfreq.h"
 #include "lookups.h"
@@ -56,6 +57,7 @@
 #include "namelist.h"
 #include "nonlineartrans.h"
 #include "othersubrs.h"
+#include "parallel.h"
 #include "plugin.h"
 #include "print.h"
 #include "psread.h"
@@ -396,6 +398,8 @@ return( NULL );
 }
 
 PyObject *PySC_From_SC(SplineChar *sc) {
+    /* Glyph objects may look at anything, so read in lazy outlines now */
+    SCLoadLazy(sc);
     if ( sc->python_sc_object==NULL ) {
 	sc->python_sc_object = PyFF_GlyphType.tp_alloc(&PyFF_GlyphType,0);
 	((PyFF_Glyph *) (sc->python_sc_object))->sc = sc;
@@ -870,14 +874,21 @@ struct flaglist openflaglist[] = {
     FLAGLIST_EMPTY
 };
 
-static PyObject *PyFF_OpenFont(PyObject *UNUSED(self), PyObject *args) { 
+static const char *open_keywords[] = { "filename", "flags", "lazy", "threads", NULL };
+
+static PyObject *PyFF_OpenFont(PyObject *UNUSED(self), PyObject *args, PyObject *keywds) { 
     char *filename, *locfilename;
-    int openflags = 0;
+    int openflags = 0, lazy = false, threads = -1, oldjobs;
     SplineFont *sf;
     PyObject *flagsobj = NULL;
 
-    if ( !PyArg_ParseTuple(args,"s|O", &filename, &flagsobj ))
+    if ( !PyArg_ParseTupleAndKeywords(args,keywds,"s|O$pi",(char **) open_keywords,
+	    &filename, &flagsobj, &lazy, &threads ))
+	return NULL;
+    if ( threads<-1 ) {
+	PyErr_Format(PyExc_ValueError, "Thread count may not be negative" );
 	return NULL;
+    }
     locfilename = utf82def_copy(filename);
 
     if ( flagsobj!=NULL && PyLong_Check(flagsobj) ) {
@@ -889,11 +900,19 @@ static PyObject *PyFF_OpenFont(PyObject *UNUSED(self), PyObject *args) {
 	PyErr_Format(PyExc_IndexError, "Flags must be specified as String Tuple or Int");
 	return NULL;
     }
+    /* The font view draws every glyph, so only scripts get lazy fonts */
+    openflags &= ~of_lazy;
+    if ( lazy && no_windowing_ui )
+	openflags |= of_lazy;
     /* The actual filename opened may be different from the one passed
      * to LoadSplineFont, so we can't report the filename on an
      * error.
      */
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
     sf = LoadSplineFont(locfilename,openflags);
+    ff_parallel_jobs = oldjobs;
 
     if ( sf==NULL ) {
 	PyErr_Format(PyExc_EnvironmentError, "Open failed");
@@ -904,6 +923,34 @@ return( NULL );
 return( PyFF_FontForFV_I( SFAdd( sf, openflags&of_hidewindow )));
 }
 
+static PyObject *PyFF_OpenFontFromBytes(PyObject *UNUSED(self), PyObject *args) {
+    Py_buffer data;
+    int openflags = 0;
+    SplineFont *sf;
+    PyObject *flagsobj = NULL;
+
+    if ( !PyArg_ParseTuple(args,"y*|O", &data, &flagsobj ))
+	return NULL;
+
+    if ( flagsobj!=NULL && PyLong_Check(flagsobj) ) {
+	openflags = PyLong_AsLong(flagsobj);
+    } else if ( flagsobj!=NULL && PyTuple_Check(flagsobj) ) {
+	openflags = FlagsFromTuple(flagsobj, openflaglist, "open flag");
+    } else if ( flagsobj!=NULL ) {
+	PyBuffer_Release(&data);
+	PyErr_Format(PyExc_IndexError, "Flags must be specified as String Tuple or Int");
+	return NULL;
+    }
+    sf = ReadSplineFontFromMemory(data.buf,data.len,openflags&~of_lazy);
+    PyBuffer_Release(&data);
+
+    if ( sf==NULL ) {
+	PyErr_Format(PyExc_EnvironmentError, "Open failed");
+return( NULL );
+    }
+return( PyFF_FontForFV_I( SFAdd( sf, openflags&of_hidewindow )));
+}
+
 static PyObject *PyFF_FontsInFile(PyObject *UNUSED(self), PyObject *args) {
     char *filename;
     char *locfilename = NULL;
@@ -4993,7 +5040,7 @@ return( NULL );
 		    ++nexti;
 		if ( c->points[nexti]->on_curve ) {
 		    SplinePointListsFree(ss);
-                    free(sp);
+                    SplinePointFree(sp);
 		    PyErr_Format(PyExc_TypeError, "In cubic splines there must be exactly 2 control points between on curve points");
 return( NULL );
 		}
@@ -5003,7 +5050,7 @@ return( NULL );
 		    ++nexti;
 		if ( !c->points[nexti]->on_curve ) {
 		    SplinePointListsFree(ss);
-                    free(sp);
+                    SplinePointFree(sp);
 		    PyErr_Format(PyExc_TypeError, "In cubic splines there must be exactly 2 control points between on curve points");
 return( NULL );
 		}
@@ -6400,6 +6447,7 @@ return( Py_BuildValue("s", self->sc->name ));
 
 static int PyFF_Glyph_set_glyphname(PyFF_Glyph *self,PyObject *value, void *UNUSED(closure)) {
     FontViewBase *fvs;
+    char *oldname;
     const char *str = PyUnicode_AsUTF8(value);
     if (str == NULL) {
         return -1;
@@ -6407,9 +6455,11 @@ static int PyFF_Glyph_set_glyphname(PyFF_Glyph *self,PyObject *value, void *UNUS
 
     SFGlyphRenameFixup(self->sc->parent,self->sc->name,str,false);
     self->sc->namechanged = self->sc->changed = true;
-    free( self->sc->name );
+    self->sc->parent->changed_since_autosave = true;
+    oldname = self->sc->name;
     self->sc->name = copy(str);
-    GlyphHashFree(self->sc->parent);
+    SFHashRename(self->sc->parent,self->sc,oldname);
+    free( oldname );
     SCRefreshTitles(self->sc);
     for ( fvs=self->sc->parent->fv; fvs!=NULL; fvs=fvs->nextsame ) {
 	/* Postscript encodings are by name, others are by codepoint */
@@ -6447,6 +6497,7 @@ static int PyFF_Glyph_set_unicode(PyFF_Glyph *self,PyObject *value, void *UNUSED
     if ( PyErr_Occurred()!=NULL )
 return( -1 );
     self->sc->unicodeenc = uenc;
+    SFHashUnicodes(self->sc->parent,self->sc);
     SCRefreshTitles(self->sc);
     for ( fvs=self->sc->parent->fv; fvs!=NULL; fvs=fvs->nextsame ) {
 	/* Postscript encodings are by name, others are by codepoint */
@@ -6509,6 +6560,7 @@ return( -1 );
 
     AltUniFree(self->sc->altuni);
     self->sc->altuni = head;
+    SFHashUnicodes(self->sc->parent,self->sc);
 
     for ( fvs=self->sc->parent->fv; fvs!=NULL; fvs=fvs->nextsame ) {
 	fvs->map->enc = &custom;
@@ -14243,6 +14295,7 @@ return( NULL );
 
     free( locfilename );
 
+    SFLoadLazyGlyphs(other->fv->sf);
     ret = Py_BuildValue("i", CompareFonts(self->fv->sf, self->fv->map, other->fv->sf, diffs, flags ));
     if ( diffs!=stdout )
 	fclose( diffs );
@@ -15292,7 +15345,7 @@ return( BAD_FEATURE_LIST );
 	fl = chunkalloc(sizeof(FeatureScriptLangList));
 	fl->featuretag = StrObjToTag(PySequence_GetItem(subs,0),&wasmac);
 	if ( fl->featuretag == BAD_TAG ) {
-	    free(fl);
+	    chunkfree(fl,sizeof(FeatureScriptLangList));
 	    FeatureScriptLangListFree(flhead);
 return( BAD_FEATURE_LIST );
 	}
@@ -15332,7 +15385,7 @@ return( BAD_FEATURE_LIST );
 	    sl = chunkalloc(sizeof(struct scriptlanglist));
 	    sl->script = StrObjToTag(PySequence_GetItem(scriptsubs,0),NULL);
 	    if ( sl->script==BAD_TAG ) {
-		free(sl);
+		chunkfree(sl,sizeof(struct scriptlanglist));
 		FeatureScriptLangListFree(flhead);
 return( BAD_FEATURE_LIST );
 	    }
@@ -16206,9 +16259,9 @@ return (NULL);
 Py_RETURN( self );
 }
 
-/* filename, bitmaptype,flags,resolution,mult-sfd-file,namelist */
+/* filename, bitmaptype,flags,resolution,mult-sfd-file,namelist,layer,threads */
 static const char *gen_keywords[] = { "filename", "bitmap_type", "flags", "bitmap_resolution",
-	"subfont_directory", "namelist", "layer", NULL };
+	"subfont_directory", "namelist", "layer", "threads", NULL };
 static const char *genttc_keywords[] = { "filename", "others", "bitmap_type", "flags",
 	"ttcflags", "namelist", "layer", NULL };
 struct flaglist gen_flags[] = {
@@ -16236,6 +16289,7 @@ struct flaglist gen_flags[] = {
     { "no-flex", fm_flag_noflex },
     { "no-hints", fm_flag_nopshints },
     { "round", fm_flag_round },
+    { "subroutinize", fm_flag_subroutinize },
     { "composites-in-afm", fm_flag_afmwithmarks },
     { "no-mac-names", fm_flag_nomacnames },
     FLAGLIST_EMPTY /* Sentinel */
@@ -16247,6 +16301,25 @@ struct flaglist genttc_flags[] = {
     FLAGLIST_EMPTY /* Sentinel */
 };
 
+static int GenerateFlagsFromTuple(PyObject *flags) {
+    int iflags = FlagsFromTuple(flags,gen_flags,"generate flag");
+
+    if ( iflags==FLAG_UNKNOWN )
+return( iflags );
+    /* Legacy screw ups mean that opentype & apple bits don't mean what */
+    /*  I want them to. Python users should not see that, but fix it up */
+    /*  here */
+    if ( (iflags&0x80) && (iflags&0x10) )	/* Both */
+	iflags &= ~0x10;
+    else if ( (iflags&0x80) && !(iflags&0x10)) /* Just opentype */
+	iflags &= ~0x80;
+    else if ( !(iflags&0x80) && (iflags&0x10)) /* Just apple */
+	/* This one's set already */;
+    else
+	iflags |= 0x90;
+return( iflags );
+}
+
 static PyObject *PyFFFont_Generate(PyFF_Font *self, PyObject *args, PyObject *keywds) {
     char *filename;
     char *locfilename = NULL;
@@ -16259,21 +16332,26 @@ static PyObject *PyFFFont_Generate(PyFF_Font *self, PyObject *args, PyObject *ke
     NameList *rename_to = NULL;
     int layer;
     char *layer_str=NULL;
+    int threads = -1, oldjobs, ok;
 
     if ( CheckIfFontClosed(self) )
 return (NULL);
     fv = self->fv;
     layer = fv->active_layer;
-    if ( !PyArg_ParseTupleAndKeywords(args, keywds, "s|sOissi", (char **)gen_keywords,
+    if ( !PyArg_ParseTupleAndKeywords(args, keywds, "s|sOissii", (char **)gen_keywords,
 	    &filename, &bitmaptype, &flags, &resolution, &subfontdirectory,
-	    &namelist, &layer) ) {
+	    &namelist, &layer, &threads) ) {
 	PyErr_Clear();
-	if ( !PyArg_ParseTupleAndKeywords(args, keywds, "s|sOisss", (char **)gen_keywords,
+	if ( !PyArg_ParseTupleAndKeywords(args, keywds, "s|sOisssi", (char **)gen_keywords,
 		&filename, &bitmaptype, &flags, &resolution, &subfontdirectory,
-		&namelist, &layer_str) )
+		&namelist, &layer_str, &threads) )
 return( NULL );
 	layer = SFFindLayerIndexByName(fv->sf,layer_str);
 	if ( layer<0 )
+return( NULL );
+    }
+    if ( threads<-1 ) {
+	PyErr_Format(PyExc_ValueError, "Thread count may not be negative" );
 return( NULL );
     }
     if ( layer<0 || layer>=fv->sf->layer_cnt ) {
@@ -16281,21 +16359,10 @@ return( NULL );
 return( NULL );
     }
     if ( flags!=NULL ) {
-	iflags = FlagsFromTuple(flags,gen_flags,"generate flag");
+	iflags = GenerateFlagsFromTuple(flags);
 	if ( iflags==FLAG_UNKNOWN ) {
 return( NULL );
 	}
-	/* Legacy screw ups mean that opentype & apple bits don't mean what */
-	/*  I want them to. Python users should not see that, but fix it up */
-	/*  here */
-	if ( (iflags&0x80) && (iflags&0x10) )	/* Both */
-	    iflags &= ~0x10;
-	else if ( (iflags&0x80) && !(iflags&0x10)) /* Just opentype */
-	    iflags &= ~0x80;
-	else if ( !(iflags&0x80) && (iflags&0x10)) /* Just apple */
-	    /* This one's set already */;
-	else
-	    iflags |= 0x90;
     }
     if ( namelist!=NULL ) {
 	rename_to = NameListByName(namelist);
@@ -16305,16 +16372,104 @@ return( NULL );
 	}
     }
     locfilename = utf82def_copy(filename);
-    if ( !GenerateScript(fv->sf,locfilename,bitmaptype,iflags,resolution,subfontdirectory,
-	    NULL,fv->normal==NULL?fv->map:fv->normal,rename_to,layer) ) {
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
+    ok = GenerateScript(fv->sf,locfilename,bitmaptype,iflags,resolution,subfontdirectory,
+	    NULL,fv->normal==NULL?fv->map:fv->normal,rename_to,layer);
+    ff_parallel_jobs = oldjobs;
+    free(locfilename);
+    if ( !ok ) {
 	PyErr_Format(PyExc_EnvironmentError, "Font generation failed");
 return( NULL );
     }
-    free(locfilename);
 Py_RETURN( self );
 }
 
 
+/* type,bitmaptype,flags,namelist,layer,threads */
+static const char *genbytes_keywords[] = { "type", "bitmap_type", "flags",
+	"namelist", "layer", "threads", NULL };
+
+static PyObject *PyFFFont_GenerateToBytes(PyFF_Font *self, PyObject *args, PyObject *keywds) {
+    char *type;
+    FontViewBase *fv;
+    PyObject *flags=NULL, *ret;
+    int iflags = -1;
+    const char *bitmaptype="";
+    char *namelist=NULL;
+    NameList *rename_to = NULL;
+    int layer;
+    char *layer_str=NULL;
+    int threads = -1, oldjobs, ok;
+    FILE *out;
+    char *data;
+    long len;
+
+    if ( CheckIfFontClosed(self) )
+return (NULL);
+    fv = self->fv;
+    layer = fv->active_layer;
+    if ( !PyArg_ParseTupleAndKeywords(args, keywds, "s|sOsii", (char **)genbytes_keywords,
+	    &type, &bitmaptype, &flags, &namelist, &layer, &threads) ) {
+	PyErr_Clear();
+	if ( !PyArg_ParseTupleAndKeywords(args, keywds, "s|sOssi", (char **)genbytes_keywords,
+		&type, &bitmaptype, &flags, &namelist, &layer_str, &threads) )
+return( NULL );
+	layer = SFFindLayerIndexByName(fv->sf,layer_str);
+	if ( layer<0 )
+return( NULL );
+    }
+    if ( threads<-1 ) {
+	PyErr_Format(PyExc_ValueError, "Thread count may not be negative" );
+return( NULL );
+    }
+    if ( layer<0 || layer>=fv->sf->layer_cnt ) {
+	PyErr_Format(PyExc_ValueError, "Layer is out of range" );
+return( NULL );
+    }
+    if ( flags!=NULL ) {
+	iflags = GenerateFlagsFromTuple(flags);
+	if ( iflags==FLAG_UNKNOWN ) {
+return( NULL );
+	}
+    }
+    if ( namelist!=NULL ) {
+	rename_to = NameListByName(namelist);
+	if ( rename_to==NULL ) {
+	    PyErr_Format(PyExc_EnvironmentError, "Unknown namelist");
+return( NULL );
+	}
+    }
+    if ( (out = GFileMemTmpfile())==NULL ) {
+	PyErr_NoMemory();
+return( NULL );
+    }
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
+    ok = GenerateScriptToFile(fv->sf,out,type,bitmaptype,iflags,
+	    fv->normal==NULL?fv->map:fv->normal,rename_to,layer);
+    ff_parallel_jobs = oldjobs;
+    if ( !ok || ferror(out) || fseek(out,0,SEEK_END)!=0 || (len = ftell(out))<0 ) {
+	fclose(out);
+	PyErr_Format(PyExc_EnvironmentError, "Font generation failed");
+return( NULL );
+    }
+    rewind(out);
+    ret = PyBytes_FromStringAndSize(NULL,len);
+    if ( ret!=NULL ) {
+	data = PyBytes_AS_STRING(ret);
+	if ( fread(data,1,len,out)!=(size_t) len ) {
+	    Py_DECREF(ret);
+	    ret = NULL;
+	    PyErr_Format(PyExc_EnvironmentError, "Font generation failed");
+	}
+    }
+    fclose(out);
+return( ret );
+}
+
 static void freesflist(struct sflist* list) {
     struct sflist *next;
     for( ; list != NULL; list=next ) {
@@ -16335,6 +16490,7 @@ return(NULL);
     ret = chunkalloc(sizeof( struct sflist ));
     ret->sf  = font->fv->sf;
     ret->map = font->fv->map;
+    SFLoadLazyGlyphs(ret->sf);
 
     if ( bf==bf_ttf ) {
 	int cnt;
@@ -16554,9 +16710,10 @@ return (NULL);
 		&preserveCrossFontKerning) || CheckIfFontClosed(other) )
 return( NULL );
 	sf = other->fv->sf;
+	SFLoadLazyGlyphs(sf);
     } else {
 	locfilename = utf82def_copy(filename);
-	sf = LoadSplineFont(locfilename,openflags);
+	sf = LoadSplineFont(locfilename,openflags&~of_lazy);
 	if ( sf==NULL ) {
 	    PyErr_Format(PyExc_EnvironmentError, "No font found in file \"%s\"", locfilename);
 	    free(locfilename);
@@ -16584,7 +16741,7 @@ return (NULL);
     if ( !PyArg_ParseTuple(args,"ds|i",&fraction,&filename, &openflags) )
 return( NULL );
     locfilename = utf82def_copy(filename);
-    sf = LoadSplineFont(locfilename,openflags);
+    sf = LoadSplineFont(locfilename,openflags&~of_lazy);
     if ( sf==NULL ) {
 	PyErr_Format(PyExc_EnvironmentError, "No font found in file \"%s\"", locfilename);
 	free(locfilename);
@@ -16648,9 +16805,10 @@ return( NULL );
     if ( enc!=-1 ) {
 	sc = SFMakeChar(fv->sf,fv->map,enc);
 	if ( name!=NULL ) {
-	    free(sc->name);
+	    char *oldname = sc->name;
 	    sc->name = copy(name);
-	    GlyphHashFree(fv->sf);
+	    SFHashRename(fv->sf,sc,oldname);
+	    free(oldname);
 	}
     } else {
 	sc = SFGetOrMakeChar(fv->sf,uni,name);
@@ -17450,23 +17608,52 @@ static PyObject *PyFFFont_genericGlyphChange(PyFF_Font *self, PyObject *args,
     Py_RETURN( self );
 }
 
-static PyObject *PyFFFont_autoHint(PyFF_Font *self, PyObject *UNUSED(args)) {
+static char *threads_keywords[] = { "threads", NULL };
+
+/* The outline operations on the whole font may be given the number of */
+/*  threads to use. Returns -1 (use the default) if there is none */
+static int ThreadsFromKeywords(PyObject *args, PyObject *keywds, int *threads) {
+    *threads = -1;
+    if ( !PyArg_ParseTupleAndKeywords(args, keywds, "|$i", threads_keywords, threads) )
+return( false );
+    if ( *threads<-1 ) {
+	PyErr_Format(PyExc_ValueError, "Thread count may not be negative" );
+return( false );
+    }
+return( true );
+}
+
+static PyObject *PyFFFont_autoHint(PyFF_Font *self, PyObject *args, PyObject *keywds) {
     FontViewBase *fv;
+    int threads, oldjobs;
 
     if ( CheckIfFontClosed(self) )
 return (NULL);
+    if ( !ThreadsFromKeywords(args,keywds,&threads) )
+return( NULL );
     fv = self->fv;
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
     FVAutoHint(fv);
+    ff_parallel_jobs = oldjobs;
 Py_RETURN( self );
 }
 
-static PyObject *PyFFFont_autoInstr(PyFF_Font *self, PyObject *UNUSED(args)) {
+static PyObject *PyFFFont_autoInstr(PyFF_Font *self, PyObject *args, PyObject *keywds) {
     FontViewBase *fv;
+    int threads, oldjobs;
 
     if ( CheckIfFontClosed(self) )
 return (NULL);
+    if ( !ThreadsFromKeywords(args,keywds,&threads) )
+return( NULL );
     fv = self->fv;
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
     FVAutoInstr(fv);
+    ff_parallel_jobs = oldjobs;
 Py_RETURN( self );
 }
 
@@ -17532,12 +17719,19 @@ return( NULL );
 Py_RETURN( self );
 }
 
-static PyObject *PyFFFont_Simplify(PyFF_Font *self, PyObject *args) {
+static PyObject *PyFFFont_Simplify(PyFF_Font *self, PyObject *args, PyObject *keywds) {
     static struct simplifyinfo smpl = { sf_normal, 0.75, 0.2, 10, 0, 0, 0 };
     FontViewBase *fv;
+    PyObject *noargs;
+    int threads, oldjobs, ok;
 
     if ( CheckIfFontClosed(self) )
 return (NULL);
+    noargs = PyTuple_New(0);
+    ok = ThreadsFromKeywords(noargs,keywds,&threads);
+    Py_DECREF(noargs);
+    if ( !ok )
+return( NULL );
     fv = self->fv;
     smpl.err = (fv->sf->ascent+fv->sf->descent)/1000.;
     smpl.linefixup = (fv->sf->ascent+fv->sf->descent)/500.;
@@ -17555,7 +17749,11 @@ return (NULL);
 	smpl.linelenmax = PyFloat_AsDouble( PySequence_GetItem(args,4));
     if ( PyErr_Occurred() )
 return( NULL );
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
     _FVSimplify(self->fv,&smpl);
+    ff_parallel_jobs = oldjobs;
 Py_RETURN( self );
 }
 
@@ -17602,13 +17800,20 @@ return( NULL );
 Py_RETURN( self );
 }
 
-static PyObject *PyFFFont_AddExtrema(PyFF_Font *self, PyObject *UNUSED(args)) {
+static PyObject *PyFFFont_AddExtrema(PyFF_Font *self, PyObject *args, PyObject *keywds) {
     FontViewBase *fv;
+    int threads, oldjobs;
 
     if ( CheckIfFontClosed(self) )
 return (NULL);
+    if ( !ThreadsFromKeywords(args,keywds,&threads) )
+return( NULL );
     fv = self->fv;
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
     FVAddExtrema(fv, false);
+    ff_parallel_jobs = oldjobs;
 Py_RETURN( self );
 }
 
@@ -17668,17 +17873,33 @@ return (NULL);
 Py_RETURN( self );
 }
 
-static PyObject *PyFFFont_RemoveOverlap(PyFF_Font *self, PyObject *UNUSED(args)) {
+static PyObject *PyFFFont_RemoveOverlap(PyFF_Font *self, PyObject *args, PyObject *keywds) {
+    int threads, oldjobs;
+
     if ( CheckIfFontClosed(self) )
 return (NULL);
+    if ( !ThreadsFromKeywords(args,keywds,&threads) )
+return( NULL );
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
     FVOverlap(self->fv,over_remove);
+    ff_parallel_jobs = oldjobs;
 Py_RETURN( self );
 }
 
-static PyObject *PyFFFont_Intersect(PyFF_Font *self, PyObject *UNUSED(args)) {
+static PyObject *PyFFFont_Intersect(PyFF_Font *self, PyObject *args, PyObject *keywds) {
+    int threads, oldjobs;
+
     if ( CheckIfFontClosed(self) )
 return (NULL);
+    if ( !ThreadsFromKeywords(args,keywds,&threads) )
+return( NULL );
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
     FVOverlap(self->fv,over_intersect);
+    ff_parallel_jobs = oldjobs;
 Py_RETURN( self );
 }
 
@@ -17700,18 +17921,31 @@ static PyObject *PyFFFont_correctReferences(PyFF_Font *self, PyObject *UNUSED(ar
 Py_RETURN( self );
 }
 
-static PyObject *PyFFFont_validate(PyFF_Font *self, PyObject *args) {
+static char *validate_keywords[] = { "force", "cache", "threads", NULL };
+
+static PyObject *PyFFFont_validate(PyFF_Font *self, PyObject *args, PyObject *keywds) {
     FontViewBase *fv;
     SplineFont *sf;
-    int force=false;
+    int force=false, threads=-1, oldjobs, ret;
+    char *cachefile=NULL;
 
     if ( CheckIfFontClosed(self) )
 return (NULL);
     fv = self->fv;
     sf = fv->sf;
-    if ( !PyArg_ParseTuple(args,"|i",&force) )
+    if ( !PyArg_ParseTupleAndKeywords(args,keywds,"|i$si",validate_keywords,
+	    &force,&cachefile,&threads) )
 return( NULL );
-return( Py_BuildValue("i", SFValidate(sf,fv->active_layer,force)));
+    if ( threads<-1 ) {
+	PyErr_Format(PyExc_ValueError, "Thread count may not be negative" );
+return( NULL );
+    }
+    oldjobs = ff_parallel_jobs;
+    if ( threads!=-1 )
+	ff_parallel_jobs = threads;
+    ret = _SFValidate(sf,fv->active_layer,force,cachefile);
+    ff_parallel_jobs = oldjobs;
+return( Py_BuildValue("i", ret));
 }
 
 static PyObject *PyFFFont_reencode(PyFF_Font *self, PyObject *args) {
@@ -17746,6 +17980,7 @@ PyMethodDef PyFF_Font_methods[] = {
     { "compareFonts", (PyCFunction) PyFFFont_compareFonts, METH_VARARGS, "Compares two fonts and stores the result into a file"},
     { "save", (PyCFunction) PyFFFont_Save, METH_VARARGS, "Save the current font to a sfd file" },
     { "generate", (PyCFunction) PyFFFont_Generate, METH_VARARGS | METH_KEYWORDS, "Save the current font to a standard font file" },
+    { "generateToBytes", (PyCFunction) PyFFFont_GenerateToBytes, METH_VARARGS | METH_KEYWORDS, "Generate the current font as an sfnt or WOFF file and return it as a bytes object" },
     { "generateTtc", (PyCFunction) PyFFFont_GenerateTTC, METH_VARARGS | METH_KEYWORDS, "Save the current font and some others into a truetype collection file" },
     { "generateFeatureFile", (PyCFunction) PyFFFont_GenerateFeature, METH_VARARGS, "Creates an adobe feature file containing all features and lookups" },
     { "mergeKern", (PyCFunction) PyFFFont_MergeKern, METH_VARARGS, "Merge feature data into the current font from an external file" },
@@ -17811,10 +18046,10 @@ PyMethodDef PyFF_Font_methods[] = {
     { "replaceWithReference", (PyCFunction) PyFFFont_replaceWithReference, METH_VARARGS, "Replaces any inline copies of any of the selected glyphs with a reference" },
     { "correctReferences", (PyCFunction) PyFFFont_correctReferences, METH_NOARGS, "Replaces any inline copies of any of the selected glyphs with a reference" },
 
-    { "addExtrema", (PyCFunction) PyFFFont_AddExtrema, METH_NOARGS, "Add extrema to the contours of the glyph"},
+    { "addExtrema", (PyCFunction) PyFFFont_AddExtrema, METH_VARARGS | METH_KEYWORDS, "Add extrema to the contours of the glyph"},
     { "addSmallCaps", (PyCFunction) PyFFFont_addSmallCaps, METH_VARARGS | METH_KEYWORDS, "For selected upper/lower case (latin, greek, cyrillic) characters, add a small caps variant of that glyph"},
-    { "autoHint", (PyCFunction) PyFFFont_autoHint, METH_NOARGS, "Guess at postscript hints"},
-    { "autoInstr", (PyCFunction) PyFFFont_autoInstr, METH_NOARGS, "Guess at truetype instructions"},
+    { "autoHint", (PyCFunction) PyFFFont_autoHint, METH_VARARGS | METH_KEYWORDS, "Guess at postscript hints"},
+    { "autoInstr", (PyCFunction) PyFFFont_autoInstr, METH_VARARGS | METH_KEYWORDS, "Guess at truetype instructions"},
     { "autoWidth", (PyCFunction) PyFFFont_autoWidth, METH_VARARGS | METH_KEYWORDS, "Guess horizontal advance widths for selected glyphs" },
     { "autoTrace", (PyCFunction) PyFFFont_autoTrace, METH_NOARGS, "Autotrace any background images"},
     { "build", (PyCFunction) PyFFFont_Build, METH_NOARGS, "If the current glyph is an accented character\nand all components are in the font\nthen build it out of references" },
@@ -17828,14 +18063,14 @@ PyMethodDef PyFF_Font_methods[] = {
     { "correctDirection", (PyCFunction) PyFFFont_correctDirection, METH_NOARGS, "Orient a layer so that external contours are clockwise and internal counter clockwise." },
     { "genericGlyphChange", (PyCFunction) PyFFFont_genericGlyphChange, METH_VARARGS | METH_KEYWORDS, "Rather like changeWeight or condenseExtend, called 'Change Glyph' in UI"},
     { "italicize", (PyCFunction) PyFFFont_italicize, METH_VARARGS | METH_KEYWORDS, "Italicize the selected glyphs"},
-    { "intersect", (PyCFunction) PyFFFont_Intersect, METH_NOARGS, "Leaves the areas where the contours of a glyph overlap."},
-    { "removeOverlap", (PyCFunction) PyFFFont_RemoveOverlap, METH_NOARGS, "Remove overlapping areas from a glyph"},
+    { "intersect", (PyCFunction) PyFFFont_Intersect, METH_VARARGS | METH_KEYWORDS, "Leaves the areas where the contours of a glyph overlap."},
+    { "removeOverlap", (PyCFunction) PyFFFont_RemoveOverlap, METH_VARARGS | METH_KEYWORDS, "Remove overlapping areas from a glyph"},
     { "round", (PyCFunction)PyFFFont_Round, METH_VARARGS, "Rounds point coordinates (and reference translations) to integers"},
-    { "simplify", (PyCFunction)PyFFFont_Simplify, METH_VARARGS, "Simplifies a glyph" },
+    { "simplify", (PyCFunction)PyFFFont_Simplify, METH_VARARGS | METH_KEYWORDS, "Simplifies a glyph" },
     { "stroke", (PyCFunction)PyFFFont_Stroke, METH_VARARGS | METH_KEYWORDS, "Strokes the contours in a glyph"},
     { "transform", (PyCFunction)PyFFFont_Transform, METH_VARARGS, "Transform a font by a 6 element matrix." },
     { "nltransform", (PyCFunction)PyFFFont_NLTransform, METH_VARARGS, "Transform a font by non-linear expressions for x and y." },
-    { "validate", (PyCFunction)PyFFFont_validate, METH_VARARGS, "Check whether a font is valid and return True if it is." },
+    { "validate", (PyCFunction)PyFFFont_validate, METH_VARARGS | METH_KEYWORDS, "Check whether a font is valid and return True if it is." },
     { "reencode", (PyCFunction)PyFFFont_reencode, METH_VARARGS, "Reencodes the current font into the given encoding." },
     { "clearSpecialData", (PyCFunction)PyFFFont_clearSpecialData, METH_NOARGS, "Clear special data not accessible in FontForge." },
 
@@ -17958,6 +18193,49 @@ static PyMappingMethods PyFF_FontMapping = {
     NULL			/* subscript assign */
 };
 
+/* Attributes of a lazily opened font which don't look at glyph outlines. */
+/*  Anything else reads in all the outlines first */
+static const char *lazyfont_attrs[] = { "userdata", "temporary", "persistant",
+    "persistent", "selection", "activeLayer", "sfnt_names", "gpos_lookups",
+    "gsub_lookups", "path", "sfd_path", "default_base_filename", "fontname",
+    "fullname", "familyname", "weight", "copyright", "version", "comment",
+    "fontlog", "xuid", "fondname", "italicangle", "creationtime", "upos",
+    "uwidth", "ascent", "descent", "sfntRevision", "woffMajor", "woffMinor",
+    "woffMetadata", "uniqueid", "layer_cnt", "loadState", "macstyle",
+    "design_size", "close", "glyphs", "findEncodingSlot", "createChar",
+    "createMappedChar", "getLookupInfo", "getLookupSubtables",
+    "getLookupOfSubtable", "getKerningClass", "isKerningClass", NULL };
+
+static void PyFF_Font_LoadLazy(PyFF_Font *self, PyObject *attr_name) {
+    const char *name;
+    int i;
+
+    if ( self->fv==NULL || self->fv->sf->lazy==NULL )
+return;
+    if ( (name = PyUnicode_AsUTF8(attr_name))==NULL ) {
+	PyErr_Clear();
+	SFLoadLazyGlyphs(self->fv->sf);
+return;
+    }
+    if ( strncmp(name,"__",2)==0 || strncmp(name,"os2_",4)==0 ||
+	    strncmp(name,"hhea_",5)==0 || strncmp(name,"vhea_",5)==0 )
+return;
+    for ( i=0; lazyfont_attrs[i]!=NULL; ++i )
+	if ( strcmp(name,lazyfont_attrs[i])==0 )
+return;
+    SFLoadLazyGlyphs(self->fv->sf);
+}
+
+static PyObject *PyFF_Font_GetAttro(PyObject *self, PyObject *attr_name) {
+    PyFF_Font_LoadLazy((PyFF_Font *) self,attr_name);
+return( PyObject_GenericGetAttr(self,attr_name));
+}
+
+static int PyFF_Font_SetAttro(PyObject *self, PyObject *attr_name, PyObject *value) {
+    PyFF_Font_LoadLazy((PyFF_Font *) self,attr_name);
+return( PyObject_GenericSetAttr(self,attr_name,value));
+}
+
 static PyTypeObject PyFF_FontType = {
     PyVarObject_HEAD_INIT(NULL, 0)
     "fontforge.font",          /* tp_name */
@@ -17975,8 +18253,8 @@ static PyTypeObject PyFF_FontType = {
     NULL,                      /* tp_hash */
     NULL,                      /* tp_call */
     (reprfunc) PyFFFont_Str,   /* tp_str */
-    NULL,                      /* tp_getattro */
-    NULL,                      /* tp_setattro */
+    PyFF_Font_GetAttro,        /* tp_getattro */
+    PyFF_Font_SetAttro,        /* tp_setattro */
     NULL,                      /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT,        /* tp_flags */
     "FontForge Font object",   /* tp_doc */
@@ -18501,7 +18779,8 @@ PyMethodDef module_fontforge_methods[] = {
     { "userConfigPath", PyFF_GetUserConfigPath, METH_NOARGS, "Returns the path to the user's FontForge configuration directory, which should be writable."},
     { "fonts", PyFF_FontTuple, METH_NOARGS, "Returns a tuple of all loaded fonts" },
     { "fontsInFile", PyFF_FontsInFile, METH_VARARGS, "Returns a tuple containing the names of any fonts in an external file"},
-    { "open", PyFF_OpenFont, METH_VARARGS, "Opens a font and returns it" },
+    { "open", (PyCFunction) PyFF_OpenFont, METH_VARARGS | METH_KEYWORDS, "Opens a font and returns it" },
+    { "openFromBytes", PyFF_OpenFontFromBytes, METH_VARARGS, "Opens an sfnt or WOFF font held in a bytes object and returns it" },
     { "printSetup", PyFF_printSetup, METH_VARARGS, "Prepare to print a font sample (select default printer or file, page size, etc.)" },
     { "parseTTInstrs", PyFF_ParseTTFInstrs, METH_VARARGS, "Takes a string and parses it into a tuple of truetype instruction bytes"},
     { "unParseTTInstrs", PyFF_UnParseTTFInstrs, METH_VARARGS, "Takes a tuple of truetype instruction bytes and converts to a human readable string"},
@@ -18853,12 +19132,49 @@ return( NULL );
 return( (PyObject *) self );
 }
 
+/* The autosave only runs from the ui, so these let the tests drive it */
+static PyObject *PyFFi_autoSave(PyObject *UNUSED(noself), PyObject *args) {
+    PyFF_Font *font;
+    char *filename;
+    SplineFont *sf;
+
+    if ( !PyArg_ParseTuple(args,"O!s",&PyFF_FontType,&font,&filename) ||
+	    CheckIfFontClosed(font) )
+return( NULL );
+    sf = font->fv->cidmaster!=NULL ? font->fv->cidmaster : font->fv->sf;
+    if ( sf->autosavename==NULL || strcmp(sf->autosavename,filename)!=0 ) {
+	free(sf->autosavename);
+	sf->autosavename = copy(filename);
+	sf->autosave_base = 0;
+    }
+    _SFAutoSave(sf,font->fv->map);
+    SFAutoSaveWait();
+Py_RETURN_NONE;
+}
+
+static PyObject *PyFFi_recoverFile(PyObject *UNUSED(noself), PyObject *args) {
+    char *filename;
+    SplineFont *sf;
+    int state;
+
+    if ( !PyArg_ParseTuple(args,"s",&filename) )
+return( NULL );
+    sf = SFRecoverFile(filename,false,&state);
+    if ( sf==NULL ) {
+	PyErr_Format(PyExc_EnvironmentError, "Could not recover from \"%s\"", filename);
+return( NULL );
+    }
+return( PyFF_FontForFV_I( SFAdd( sf, true )));
+}
+
 static PyMethodDef module_ff_internals_methods[] = {
     { "initPickles", PyFFi_initPickles, METH_VARARGS, "Set the pickle/unpickle globals so I can call them from C" },
     { "initPickleTypes", PyFFi_initPickleTypes, METH_VARARGS, "Set the some globals so I can call C functions from python" },
     { "newPoint", PyFFi_newPoint, METH_VARARGS, "Top level function to create a new point, needed (I think) for the pickler" },
     { "newContour", PyFFi_newContour, METH_VARARGS, "Top level function to create a new contour, needed (I think) for the pickler" },
     { "newLayer", PyFFi_newLayer, METH_VARARGS, "Top level function to create a new layer, needed (I think) for the pickler" },
+    { "autoSave", PyFFi_autoSave, METH_VARARGS, "Autosave a font to the given file now, as the ui would" },
+    { "recoverFile", PyFFi_recoverFile, METH_VARARGS, "Open the font recovered from an autosave file" },
     PYMETHODDEF_EMPTY /* Sentinel */
 };
 
@@ -63,6 +63,11 @@ int old_psotb_flags = ps_flag_afm;
 
 int oldformatstate = ff_pfb;
 int oldbitmapstate = 0;
+
+/* When set, _DoSave writes the font itself to this stream rather than to */
+/*  newname, and writes no auxiliary files */
+static FILE *save_to_file = NULL;
+
 #if __Mac
 const char *savefont_extensions[] = { ".pfa", ".pfb", ".res", "%s.pfb", ".pfa", ".pfb", ".pt3", ".ps",
 	".cid", ".cff", ".cid.cff",
@@ -579,6 +584,7 @@ static int SaveSubFont(SplineFont *sf,char *newname,
     temp.uniqueid = 0;
     memset(chars,0,sizeof(chars));
     temp.glyphnames = NULL;
+    temp.glyphunis = NULL;
     used = 0;
     for ( i=0; mapping[i]!=-2; ++i ) if ( (mapping[i]>>8)==subfont ) {
 	k = 0;
@@ -810,6 +816,19 @@ return( WriteMultiplePSFont(sf,newname,sizes,subfontdefinition,map,layer));
 	flags = old_sfnt_flags&~(ttf_flag_ofm);
     if ( oldformatstate<=ff_cffcid && oldbitmapstate==bf_otb )
 	flags = old_psotb_flags;
+    if ( save_to_file!=NULL ) {
+	if ( oldformatstate!=ff_ttf && oldformatstate!=ff_ttfsym &&
+		oldformatstate!=ff_otf && oldformatstate!=ff_otfcid &&
+		oldformatstate!=ff_cff && oldformatstate!=ff_cffcid &&
+#ifdef FONTFORGE_CAN_USE_WOFF2
+		oldformatstate!=ff_woff2 &&
+#endif
+		oldformatstate!=ff_woff ) {
+	    ff_post_error(_("Save Failed"),_("Only sfnt and WOFF fonts can be generated to memory"));
+return( true );
+	}
+	flags &= ~(ps_flag_afm|ps_flag_pfm|ps_flag_tfm|ttf_flag_ofm|ps_flag_outputfontlog);
+    }
 
     path = def2utf8_copy(newname);
     ff_progress_start_indicator(10,_("Saving font"),
@@ -842,17 +861,29 @@ return( true );
 	  break;
 	  case ff_ttf: case ff_ttfsym: case ff_otf: case ff_otfcid:
 	  case ff_cff: case ff_cffcid:
-	    oerr = !WriteTTFFont(newname,sf,oldformatstate,sizes,bmap,
-		flags,map,layer);
+	    if ( save_to_file!=NULL )
+		oerr = !_WriteTTFFont(save_to_file,sf,oldformatstate,sizes,bmap,
+		    flags,map,layer);
+	    else
+		oerr = !WriteTTFFont(newname,sf,oldformatstate,sizes,bmap,
+		    flags,map,layer);
 	  break;
 	  case ff_woff:
-	    oerr = !WriteWOFFFont(newname,sf,oldformatstate,sizes,bmap,
-		flags,map,layer);
+	    if ( save_to_file!=NULL )
+		oerr = !_WriteWOFFFont(save_to_file,sf,oldformatstate,sizes,bmap,
+		    flags,map,layer);
+	    else
+		oerr = !WriteWOFFFont(newname,sf,oldformatstate,sizes,bmap,
+		    flags,map,layer);
 	  break;
 #ifdef FONTFORGE_CAN_USE_WOFF2
 	  case ff_woff2:
-	    oerr = !WriteWOFF2Font(newname,sf,oldformatstate,sizes,bmap,
-		flags,map,layer);
+	    if ( save_to_file!=NULL )
+		oerr = !_WriteWOFF2Font(save_to_file,sf,oldformatstate,sizes,bmap,
+		    flags,map,layer);
+	    else
+		oerr = !WriteWOFF2Font(newname,sf,oldformatstate,sizes,bmap,
+		    flags,map,layer);
 	  break;
 #endif
 	  case ff_pfbmacbin:
@@ -920,7 +951,9 @@ return( true );
 	    err = true;
 	}
     }
-    if ( oldbitmapstate==bf_otb || oldbitmapstate==bf_sfnt_ms ) {
+    if ( save_to_file!=NULL ) {
+	/* Any strikes went into the font itself */;
+    } else if ( oldbitmapstate==bf_otb || oldbitmapstate==bf_sfnt_ms ) {
 	char *temp = newname;
 	if ( newname[strlen(newname)-1]=='.' ) {
 	    temp = malloc(strlen(newname)+8);
@@ -1158,6 +1191,7 @@ int GenerateScript(SplineFont *sf,char *filename,const char *bitmaptype, int fmf
 	    if ( fmflags&fm_flag_restrict256 ) old_ps_flags |= ps_flag_restrict256;
 	    if ( fmflags&fm_flag_round ) old_ps_flags |= ps_flag_round;
 	    if ( fmflags&fm_flag_afmwithmarks ) old_ps_flags |= ps_flag_afmwithmarks;
+	    if ( fmflags&fm_flag_subroutinize ) old_ps_flags |= ps_flag_subroutinize;
 	    if ( i==bf_otb ) {
 		old_sfnt_flags = 0;
 		switch ( fmflags&(fm_flag_apple|fm_flag_opentype) ) {
@@ -1202,6 +1236,7 @@ int GenerateScript(SplineFont *sf,char *filename,const char *bitmaptype, int fmf
 	    if ( fmflags&fm_flag_nopshints ) old_sfnt_flags |= ps_flag_nohints;
 	    if ( fmflags&fm_flag_round ) old_sfnt_flags |= ps_flag_round;
 	    if ( fmflags&fm_flag_afmwithmarks ) old_sfnt_flags |= ps_flag_afmwithmarks;
+	    if ( fmflags&fm_flag_subroutinize ) old_sfnt_flags |= ps_flag_subroutinize;
 		/* Applicable truetype flags */
 	    switch ( fmflags&(fm_flag_apple|fm_flag_opentype) ) {
 	      case fm_flag_opentype:
@@ -1292,3 +1327,24 @@ int GenerateScript(SplineFont *sf,char *filename,const char *bitmaptype, int fmf
     }
 return( ret );
 }
+
+/* Generates an sfnt or WOFF font into out rather than into a file. ext */
+/*  selects the format just as the extension of a filename would */
+int GenerateScriptToFile(SplineFont *sf, FILE *out, const char *ext,
+	const char *bitmaptype, int fmflags, EncMap *map, NameList *rename_to,
+	int layer) {
+    char *filename;
+    int ret;
+
+    if ( *ext=='.' )
+	++ext;
+    filename = malloc(strlen(ext)+6);
+    strcpy(filename,"font.");
+    strcat(filename,ext);
+    save_to_file = out;
+    ret = GenerateScript(sf,filename,bitmaptype,fmflags,-1,NULL,NULL,map,
+	    rename_to,layer);
+    save_to_file = NULL;
+    free(filename);
+return( ret );
+}
@@ -60,6 +60,7 @@ enum fm_flags { fm_flag_afm = 0x1,
                 fm_flag_pfed_layers = 0x2000000,
                 fm_flag_winkern = 0x4000000,
                 fm_flag_nomacnames = 0x8000000,
+                fm_flag_subroutinize = 0x10000000,
               };
 
 extern const char (*savefont_extensions[]), (*bitmapextensions[]);
@@ -72,6 +73,7 @@ int _DoSave(SplineFont *sf,char *newname,int32 *sizes,int res,
 int CheckIfTransparent(SplineFont *sf);
 
 extern int GenerateScript(SplineFont *sf, char *filename, const char *bitmaptype, int fmflags, int res, char *subfontdirectory, struct sflist *sfs, EncMap *map, NameList *rename_to, int layer);
+extern int GenerateScriptToFile(SplineFont *sf, FILE *out, const char *ext, const char *bitmaptype, int fmflags, EncMap *map, NameList *rename_to, int layer);
 
 #ifdef FONTFORGE_CONFIG_WRITE_PFM
 extern int WritePfmFile(char *filename, SplineFont *sf, EncMap *map, int layer);
@@ -59,6 +59,7 @@
 #include "mm.h"
 #include "namelist.h"
 #include "othersubrs.h"
+#include "parallel.h"
 #include "parsepdf.h"
 #include "parsepfa.h"
 #include "parsettf.h"
@@ -257,6 +258,30 @@ static void DicaNewEntry(struct dictionary *dica,char *name,Val *val) {
     ++dica->cnt;
 }
 
+/* Loops run by seeking back to the start of their bodies. Rather than lex */
+/*  the body again each time round, every token is remembered the first */
+/*  time it is read, along with where it started in the script. Tokens are */
+/*  first read in file order, so the list is sorted, and the one wanted is */
+/*  nearly always the one after the last */
+struct scripttoken {
+    long pos, end;		/* Start (including white space before it) and end */
+    int startch, endch;		/* Character pushed back at the start and end */
+    int lines;			/* Number of line ends counted in between */
+    enum token_type tok;
+    Val val;			/* For numbers */
+    char *text;			/* For names, keywords and strings */
+};
+
+struct scripttokens {
+    struct scripttoken *toks;
+    int cnt, max;
+    int next;			/* The token after the last one returned */
+    long pos;			/* Where we are, if not where the file is */
+    int ungotch;		/* And the character pushed back there */
+    unsigned int replaying: 1;
+};
+
+static void ScriptTokensFree(Context *c);
 
 static void calldatafree(Context *c) {
     int i;
@@ -277,6 +302,7 @@ static void calldatafree(Context *c) {
 	c->a.vals[i].flags = vf_none;
     }
     DictionaryFree(&c->locals);
+    ScriptTokensFree(c);
 
     if ( c->script!=NULL ) {
 		fclose(c->script);
@@ -1795,7 +1821,7 @@ static void bOpen(Context *c) {
     else if ( c->a.argc==3 ) {
 	if ( c->a.vals[2].type!=v_int )
 	    ScriptError( c, "Open expects an integer for second argument" );
-	openflags = c->a.vals[2].u.ival;
+	openflags = c->a.vals[2].u.ival & ~of_lazy;	/* Only for python */
     }
     t = script2utf8_copy(c->a.vals[1].u.sval);
     locfilename = utf82def_copy(t);
@@ -5603,7 +5629,7 @@ static void bMergeFonts(Context *c) {
     else if ( c->a.argc==3 ) {
 	if ( c->a.vals[2].type!=v_int )
 	    ScriptError( c, "MergeFonts expects an integer for second argument" );
-	openflags = c->a.vals[2].u.ival;
+	openflags = c->a.vals[2].u.ival & ~of_lazy;
     }
     t = script2utf8_copy(c->a.vals[1].u.sval);
     locfilename = utf82def_copy(t);
@@ -5632,7 +5658,7 @@ static void bInterpolateFonts(Context *c) {
     else if ( c->a.argc==4 ) {
 	if ( c->a.vals[3].type!=v_int )
 	    ScriptError( c, "InterpolateFonts expects an integer for third argument" );
-	openflags = c->a.vals[3].u.ival;
+	openflags = c->a.vals[3].u.ival & ~of_lazy;
     }
     if ( c->a.vals[1].type==v_int )
 	percent = c->a.vals[1].u.ival;
@@ -8254,19 +8280,28 @@ static void bCompareFonts(Context *c) {
 
 static void bValidate(Context *c) {
     int force = false;
+    char *t, *cachefile = NULL;
 
-    if ( c->a.argc>2 ) {
+    if ( c->a.argc>3 ) {
 	c->error = ce_wrongnumarg;
 	return;
     }
-    if ( c->a.argc==2 ) {
+    if ( c->a.argc>=2 ) {
 	if ( c->a.vals[1].type!=v_int )
 	    ScriptError( c, "Bad type for argument");
 	force = c->a.vals[1].u.ival;
     }
+    if ( c->a.argc==3 ) {
+	if ( c->a.vals[2].type!=v_str )
+	    ScriptError( c, "Bad type for argument");
+	t = script2utf8_copy(c->a.vals[2].u.sval);
+	cachefile = utf82def_copy(t);
+	free(t);
+    }
 
     c->return_val.type = v_int;
-    c->return_val.u.ival = SFValidate(c->curfv->sf, ly_fore, force );
+    c->return_val.u.ival = _SFValidate(c->curfv->sf, ly_fore, force, cachefile );
+    free(cachefile);
 }
 
 /* #define _DEBUGCRASHFONTFORGE 1 */
@@ -8830,26 +8865,122 @@ static void cungetc(int ch,Context *c) {
 }
 
 static long ctell(Context *c) {
-    long pos = ftell(c->script);
+    long pos;
+
+    if ( c->tokens!=NULL && c->tokens->replaying )
+return( c->tokens->pos );
+    pos = ftell(c->script);
     if ( c->ungotch )
 	--pos;
 return( pos );
 }
 
 static void cseek(Context *c,long pos) {
-    fseek(c->script,pos,SEEK_SET);
+    if ( c->tokens!=NULL ) {
+	/* Don't touch the file unless we find something we haven't lexed */
+	c->tokens->replaying = true;
+	c->tokens->pos = pos;
+	c->tokens->ungotch = 0;
+    } else
+	fseek(c->script,pos,SEEK_SET);
     c->ungotch = 0;
     c->backedup = false;
 }
 
+/* The line count depends on whether the first character was pushed back */
+/*  (and so already counted), so that must match too */
+static struct scripttoken *ScriptTokenAt(struct scripttokens *st,long pos,int ungotch) {
+    int low, high, mid;
+
+    if ( st->next<st->cnt && st->toks[st->next].pos==pos )
+return( st->toks[st->next].startch==ungotch ? &st->toks[st->next] : NULL );
+    low = 0; high = st->cnt-1;
+    while ( low<=high ) {
+	mid = (low+high)/2;
+	if ( st->toks[mid].pos==pos )
+return( st->toks[mid].startch==ungotch ? &st->toks[mid] : NULL );
+	else if ( st->toks[mid].pos<pos )
+	    low = mid+1;
+	else
+	    high = mid-1;
+    }
+return( NULL );
+}
+
+static void ScriptTokenAdd(Context *c,long pos,int startch,int lineno,int textset) {
+    struct scripttokens *st = c->tokens;
+    struct scripttoken *t;
+
+    /* Keep the list sorted. After a seek back the first token may be lexed */
+    /*  again with nothing pushed back. Those aren't worth remembering */
+    if ( st->cnt>0 && pos<st->toks[st->cnt-1].end )
+return;
+    if ( st->cnt>=st->max )
+	st->toks = realloc(st->toks,(st->max += 256)*sizeof(struct scripttoken));
+    t = &st->toks[st->cnt];
+    t->pos = pos;
+    t->end = ctell(c);
+    t->startch = startch;
+    t->endch = c->ungotch;
+    t->lines = c->lineno-lineno;
+    t->tok = c->tok;
+    t->val = c->tok_val;
+    t->text = textset ? copy(c->tok_text) : NULL;
+    st->next = ++st->cnt;
+}
+
+static void ScriptTokensFree(Context *c) {
+    int i;
+
+    if ( c->tokens==NULL )
+return;
+    for ( i=0; i<c->tokens->cnt; ++i )
+	free(c->tokens->toks[i].text);
+    free(c->tokens->toks);
+    free(c->tokens);
+    c->tokens = NULL;
+}
+
 enum token_type ff_NextToken(Context *c) {
     int ch, nch;
     enum token_type tok = tt_error;
+    struct scripttokens *st;
+    struct scripttoken *t;
+    long pos = 0;
+    int lineno = 0, startch = 0, textset = false;
 
     if ( c->backedup ) {
 	c->backedup = false;
 return( c->tok );
     }
+    /* An interactive script grows as it is typed, and in verbose mode we */
+    /*  echo the script as we read it, so only remember tokens otherwise */
+    if ( c->tokens==NULL && c->script!=NULL && !c->interactive && verbose<=0 )
+	c->tokens = calloc(1,sizeof(struct scripttokens));
+    if ( (st = c->tokens)!=NULL ) {
+	pos = ctell(c);
+	startch = st->replaying ? st->ungotch : c->ungotch;
+	if ( (t = ScriptTokenAt(st,pos,startch))!=NULL ) {
+	    st->replaying = true;
+	    st->pos = t->end;
+	    st->ungotch = t->endch;
+	    st->next = t-st->toks+1;
+	    c->lineno += t->lines;
+	    if ( t->text!=NULL )
+		strcpy(c->tok_text,t->text);
+	    if ( t->tok==tt_number || t->tok==tt_real || t->tok==tt_unicode )
+		c->tok_val = t->val;
+	    c->tok = t->tok;
+return( c->tok );
+	}
+	if ( st->replaying ) {
+	    /* Put the file back as it would have been had we lexed all that */
+	    fseek(c->script,st->pos+(st->ungotch!=0),SEEK_SET);
+	    c->ungotch = st->ungotch;
+	    st->replaying = false;
+	}
+	lineno = c->lineno;
+    }
     do {
 	ch = cgetc(c);
 	nch = cgetc(c); cungetc(nch,c);
@@ -8861,6 +8992,7 @@ return( c->tok );
 		ch = cgetc(c);
 	    }
 	    *pt = '\0';
+	    textset = true;
 	    while ( isalnum(ch) || ch=='$' || ch=='_' || ch=='.' ) {
 		ch = cgetc(c);
 		toolong = true;
@@ -8976,6 +9108,7 @@ return( c->tok );
 		ch = cgetc(c);
 	    }
 	    *pt = '\0';
+	    textset = true;
 	    if ( ch=='\n' || ch=='\r' )
 		cungetc(ch,c);
 	    tok = tt_string;
@@ -9137,6 +9270,8 @@ return( c->tok );
     } while ( tok==tt_error );
 
     c->tok = tok;
+    if ( st!=NULL )
+	ScriptTokenAdd(c,pos,startch,lineno,textset);
 return( tok );
 }
 
@@ -10351,6 +10486,8 @@ _Noreturn void ProcessNativeScript(int argc, char *argv[], FILE *script) {
 		if ( argc>i+1 && (strcmp(argv[i],"-nosplash")==0 || strcmp(argv[i],"--nosplash")==0
 		                    || strcmp(argv[i],"-quiet")==0 || strcmp(argv[i],"--quiet")==0 ))
 			++i;
+		if ( argc>i+2 && (strcmp(argv[i],"-jobs")==0 || strcmp(argv[i],"--jobs")==0 ))
+			i+=2;		/* _CheckIsScript has set ff_parallel_jobs */
 		if ( argc>i+1 && (strncmp(argv[i],"-lang=",6)==0 || strncmp(argv[i],"--lang=",7)==0 ))
 			++i;
 		if ( argc>i+2 && (strncmp(argv[i],"-lang",5)==0 || strncmp(argv[i],"--lang",6)==0 ) &&
@@ -10494,6 +10631,8 @@ return;
 	if ( *pt=='-' && pt[1]=='-' && pt[2]!='\0' ) ++pt;
 	if ( strcmp(pt,"-nosplash")==0 || strcmp(pt,"-quiet")==0 )
 	    /* Skip it */;
+	else if ( strcmp(pt,"-jobs")==0 && i+1<argc )
+	    ff_parallel_jobs = strtol(argv[++i],NULL,10);
 	else if ( strcmp(pt,"-SkipPythonInitFiles")==0 || strcmp(pt,"-skippyfile")==0 )
 	    run_python_init_files = false;
 	else if ( strcmp(pt,"-skippyplug")==0 )
@@ -10598,6 +10737,7 @@ return;				/* Error return */
 	    ff_backuptok(&c);
 	    ff_statement(&c);
 	}
+	ScriptTokensFree(&c);
 	fclose(c.script);
     }
 }
@@ -109,6 +109,7 @@ typedef struct context {
     int ungotch;			/* Irrelevant for user defined funcs */
     FontViewBase *curfv;		/* Current fontview */
     jmp_buf *err_env;			/* place to longjump to on an error */
+    struct scripttokens *tokens;	/* Irrelevant for user defined funcs */
 } Context;
 
 Array* arraynew(int sz);
@@ -1852,6 +1852,108 @@ static void appendnames(char *dest,char *dir,const char *dir_char,char *name,con
     strcpy(dest,ext);
 }
 
+/* Each file in an sfdir is dumped to memory first, and only replaces what */
+/*  is on disk if it is different. So saving into an existing sfdir just */
+/*  touches the glyphs (and property files) which changed, which is what */
+/*  version control wants to see. We can't go by sc->changed: renaming, */
+/*  reordering or reencoding glyphs changes the files of others too */
+static GHashTable *sfdir_written;	/* Everything in the sfdir being saved */
+
+/* To tell whether a file is different without reading it back, the font */
+/*  remembers a fingerprint of each file of the sfdir it was last read from */
+/*  or saved to. A file which has been modified since then is compared */
+struct sfdirprints {
+    char *dir;			/* Absolute name of the sfdir */
+    long long time;		/* When that read or save began */
+    GHashTable *prints;		/* File name within dir to uint64_t fingerprint */
+};
+
+static struct sfdirprints *sfdir_old, *sfdir_new;	/* Of the sfdir being saved or read */
+static size_t sfdir_rootlen;	/* Of the name it was given as */
+
+void SFDirPrintsFree(struct sfdirprints *prints) {
+    if ( prints==NULL )
+return;
+    free(prints->dir);
+    g_hash_table_destroy(prints->prints);
+    free(prints);
+}
+
+static struct sfdirprints *SFDirPrintsNew(const char *dir, long long started) {
+    struct sfdirprints *prints = calloc(1,sizeof(struct sfdirprints));
+
+    prints->dir = GFileMakeAbsoluteName((char *) dir);
+    prints->time = started;
+    prints->prints = g_hash_table_new_full(g_str_hash,g_str_equal,free,free);
+    sfdir_rootlen = strlen(dir);
+return( prints );
+}
+
+static void SFDirNotePrint(const char *filename, uint64_t fingerprint) {
+    uint64_t *val;
+
+    if ( sfdir_new==NULL || strlen(filename)<sfdir_rootlen )
+return;
+    val = malloc(sizeof(uint64_t));
+    *val = fingerprint;
+    g_hash_table_insert(sfdir_new->prints,copy(filename+sfdir_rootlen),val);
+}
+
+/* Whether filename holds len bytes with this fingerprint, as far as we know */
+static int SFDirSame(const char *filename, uint64_t fingerprint, long len) {
+    uint64_t *val;
+    struct stat st;
+
+    if ( sfdir_old==NULL || strlen(filename)<sfdir_rootlen ||
+	    (val = g_hash_table_lookup(sfdir_old->prints,filename+sfdir_rootlen))==NULL ||
+	    *val!=fingerprint )
+return( false );
+return( stat(filename,&st)==0 && S_ISREG(st.st_mode) && st.st_size==len &&
+	    st.st_mtime<sfdir_old->time );
+}
+
+/* Called once the file has been parsed */
+static void SFDirNoteRead(FILE *sfd, const char *filename) {
+    long len;
+    char *buf;
+
+    if ( sfdir_new==NULL || fseek(sfd,0,SEEK_END)!=0 || (len = ftell(sfd))<0 )
+return;
+    buf = malloc(len+1);
+    rewind(sfd);
+    if ( fread(buf,1,len,sfd)==(size_t) len )
+	SFDirNotePrint(filename,FingerprintAdd(FINGERPRINT_START,buf,len));
+    free(buf);
+}
+
+static FILE *SFDirOpen(void) {
+return( GFileMemTmpfile());
+}
+
+static int SFDirCommit(FILE *mem, const char *filename) {
+    long len = ftell(mem);
+    char *buf;
+    int err = ferror(mem) || len<0;
+    uint64_t fingerprint;
+
+    if ( !err ) {
+	buf = malloc(len+1);
+	rewind(mem);
+	err = fread(buf,1,len,mem)!=(size_t) len;
+	if ( !err ) {
+	    fingerprint = FingerprintAdd(FINGERPRINT_START,buf,len);
+	    if ( !SFDirSame(filename,fingerprint,len) )
+		err = GFileWriteIfChanged(filename,buf,len)==-1;
+	    if ( !err )
+		SFDirNotePrint(filename,fingerprint);
+	}
+	free(buf);
+    }
+    fclose(mem);
+    g_hash_table_add(sfdir_written,copy(filename));
+return( err );
+}
+
 static int SFDDumpBitmapFont(FILE *sfd,BDFFont *bdf,EncMap *encm,int *newgids,
 	int todir, char *dirname) {
     int i;
@@ -1891,11 +1993,10 @@ static int SFDDumpBitmapFont(FILE *sfd,BDFFont *bdf,EncMap *encm,int *newgids,
 		char *glyphfile = malloc(strlen(dirname)+2*strlen(bdf->glyphs[i]->sc->name)+20);
 		FILE *gsfd;
 		appendnames(glyphfile,dirname,"/",bdf->glyphs[i]->sc->name,BITMAP_EXT );
-		gsfd = fopen(glyphfile,"w");
+		gsfd = SFDirOpen();
 		if ( gsfd!=NULL ) {
 		    SFDDumpBitmapChar(gsfd,bdf->glyphs[i],encm->backmap[i],newgids);
-		    if ( ferror(gsfd)) err = true;
-		    if ( fclose(gsfd)) err = true;
+		    err |= SFDirCommit(gsfd,glyphfile);
 		} else
 		    err = true;
 		free(glyphfile);
@@ -2874,11 +2975,10 @@ static int SFD_Dump( FILE *sfd, SplineFont *sf, EncMap *map, EncMap *normal,
 		GFileMkDir(subfont, 0755);
 		fontprops = malloc(strlen(subfont)+strlen("/" FONT_PROPS)+1);
 		strcpy(fontprops,subfont); strcat(fontprops,"/" FONT_PROPS);
-		ssfd = fopen( fontprops,"w");
+		ssfd = SFDirOpen();
 		if ( ssfd!=NULL ) {
 		    err |= SFD_Dump(ssfd,sf->subfonts[i],map,NULL,todir,subfont);
-		    if ( ferror(ssfd) ) err = true;
-		    if ( fclose(ssfd)) err = true;
+		    err |= SFDirCommit(ssfd,fontprops);
 		} else
 		    err = true;
 		free(fontprops);
@@ -2925,11 +3025,10 @@ static int SFD_Dump( FILE *sfd, SplineFont *sf, EncMap *map, EncMap *normal,
 		    char *glyphfile = malloc(strlen(dirname)+2*strlen(sf->glyphs[i]->name)+20);
 		    FILE *gsfd;
 		    appendnames(glyphfile,dirname,"/",sf->glyphs[i]->name,GLYPH_EXT );
-		    gsfd = fopen(glyphfile,"w");
+		    gsfd = SFDirOpen();
 		    if ( gsfd!=NULL ) {
 			SFDDumpChar(gsfd,sf->glyphs[i],map,newgids,todir,1);
-			if ( ferror(gsfd)) err = true;
-			if ( fclose(gsfd)) err = true;
+			err |= SFDirCommit(gsfd,glyphfile);
 		    } else
 			err = true;
 		    free(glyphfile);
@@ -2948,15 +3047,19 @@ static int SFD_Dump( FILE *sfd, SplineFont *sf, EncMap *map, EncMap *normal,
 	    char *strike = malloc(strlen(dirname)+1+20+20);
 	    char *strikeprops;
 	    FILE *ssfd;
-	    sprintf( strike,"%s/%d" STRIKE_EXT, dirname, bdf->pixelsize );
+	    /* Greymaps get a name of their own, or they would overwrite the */
+	    /*  bitmap strike of the same size (the name is never read back) */
+	    if ( BDFDepth(bdf)==1 )
+		sprintf( strike,"%s/%d" STRIKE_EXT, dirname, bdf->pixelsize );
+	    else
+		sprintf( strike,"%s/%d@%d" STRIKE_EXT, dirname, bdf->pixelsize, BDFDepth(bdf) );
 	    GFileMkDir(strike, 0755);
 	    strikeprops = malloc(strlen(strike)+strlen("/" STRIKE_PROPS)+1);
 	    strcpy(strikeprops,strike); strcat(strikeprops,"/" STRIKE_PROPS);
-	    ssfd = fopen( strikeprops,"w");
+	    ssfd = SFDirOpen();
 	    if ( ssfd!=NULL ) {
 		err |= SFDDumpBitmapFont(ssfd,bdf,map,newgids,todir,strike);
-		if ( ferror(ssfd) ) err = true;
-		if ( fclose(ssfd)) err = true;
+		err |= SFDirCommit(ssfd,strikeprops);
 	    } else
 		err = true;
 	    free(strikeprops);
@@ -2981,11 +3084,10 @@ static int SFD_MIDump(SplineFont *sf,EncMap *map,char *dirname,	int mm_pos) {
     GFileMkDir(instance, 0755);
     fontprops = malloc(strlen(instance)+strlen("/" FONT_PROPS)+1);
     strcpy(fontprops,instance); strcat(fontprops,"/" FONT_PROPS);
-    ssfd = fopen( fontprops,"w");
+    ssfd = SFDirOpen();
     if ( ssfd!=NULL ) {
 	err |= SFD_Dump(ssfd,sf,map,NULL,true,instance);
-	if ( ferror(ssfd) ) err = true;
-	if ( fclose(ssfd)) err = true;
+	err |= SFDirCommit(ssfd,fontprops);
     } else
 	err = true;
     free(fontprops);
@@ -3090,46 +3192,15 @@ return( err );
 }
 
 static void SFDirClean(char *filename) {
-    DIR *dir;
-    struct dirent *ent;
-    char *buffer, *pt;
-
-    unlink(filename);		/* Just in case it's a normal file, it shouldn't be, but just in case... */
-    dir = opendir(filename);
-    if ( dir==NULL )
-return;
-    buffer = malloc(strlen(filename)+1+NAME_MAX+1);
-    while ( (ent = readdir(dir))!=NULL ) {
-	if ( strcmp(ent->d_name,".")==0 || strcmp(ent->d_name,"..")==0 )
-    continue;
-	pt = strrchr(ent->d_name,EXT_CHAR);
-	if ( pt==NULL )
-    continue;
-	sprintf( buffer,"%s/%s", filename, ent->d_name );
-	if ( strcmp(pt,".props")==0 ||
-		strcmp(pt,GLYPH_EXT)==0 ||
-		strcmp(pt,BITMAP_EXT)==0 )
-	    unlink( buffer );
-	else if ( strcmp(pt,STRIKE_EXT)==0 ||
-		strcmp(pt,SUBFONT_EXT)==0 ||
-		strcmp(pt,INSTANCE_EXT)==0 )
-	    SFDirClean(buffer);
-	/* If there are filenames we don't recognize, leave them. They might contain version control info */
-    }
-    free(buffer);
-    closedir(dir);
-}
-
-static void SFFinalDirClean(char *filename) {
     DIR *dir;
     struct dirent *ent;
     char *buffer, *markerfile, *pt;
 
-    /* we did not unlink sub-directories in case they contained version control */
-    /*  files. We did remove all our files from them, however.  If the user */
-    /*  removed a bitmap strike or a cid-subfont those sub-dirs will now be */
-    /*  empty. If the user didn't remove them then they will contain our marker */
-    /*  files. So if we find a subdir with no marker files in it, remove it */
+    /* Removes the files of ours which weren't written this time (those of */
+    /*  glyphs which have gone, for instance). If there are filenames we */
+    /*  don't recognize, leave them. They might contain version control */
+    /*  info. For the same reason we only remove a sub-directory for a */
+    /*  bitmap strike or a cid-subfont which has gone once it is empty */
     dir = opendir(filename);
     if ( dir==NULL )
 return;
@@ -3142,10 +3213,16 @@ return;
 	if ( pt==NULL )
     continue;
 	sprintf( buffer,"%s/%s", filename, ent->d_name );
-	if ( strcmp(pt,".strike")==0 ||
+	if ( strcmp(pt,".props")==0 ||
+		strcmp(pt,GLYPH_EXT)==0 ||
+		strcmp(pt,BITMAP_EXT)==0 ) {
+	    if ( !g_hash_table_contains(sfdir_written,buffer))
+		unlink( buffer );
+	} else if ( strcmp(pt,STRIKE_EXT)==0 ||
 		strcmp(pt,SUBFONT_EXT)==0 ||
 		strcmp(pt,INSTANCE_EXT)==0 ) {
-	    if ( strcmp(pt,".strike")==0 )
+	    SFDirClean(buffer);
+	    if ( strcmp(pt,STRIKE_EXT)==0 )
 		sprintf( markerfile,"%s/" STRIKE_PROPS, buffer );
 	    else
 		sprintf( markerfile,"%s/" FONT_PROPS, buffer );
@@ -3164,18 +3241,25 @@ int SFDWrite(char *filename,SplineFont *sf,EncMap *map,EncMap *normal,int todir)
     int i, gc;
     char *tempfilename = filename;
     int err = false;
+    SplineFont *prints_sf = sf->cidmaster!=NULL ? sf->cidmaster : sf;
 
     if ( todir ) {
-	SFDirClean(filename);
+	unlink(filename);		/* Just in case it's a normal file, it shouldn't be, but just in case... */
 	GFileMkDir(filename, 0755);		/* this will fail if directory already exists. That's ok */
 	tempfilename = malloc(strlen(filename)+strlen("/" FONT_PROPS)+1);
 	strcpy(tempfilename,filename); strcat(tempfilename,"/" FONT_PROPS);
-    }
-
-    sfd = fopen(tempfilename,"w");
-    if ( tempfilename!=filename ) free(tempfilename);
-    if ( sfd==NULL )
+	sfd = SFDirOpen();
+	sfdir_written = g_hash_table_new_full(g_str_hash,g_str_equal,free,NULL);
+	sfdir_new = SFDirPrintsNew(filename,time(NULL));
+	sfdir_old = prints_sf->sfdir_prints;
+	if ( sfdir_old!=NULL && strcmp(sfdir_old->dir,sfdir_new->dir)!=0 )
+	    sfdir_old = NULL;
+    } else
+	sfd = fopen(tempfilename,"w");
+    if ( sfd==NULL ) {
+	if ( tempfilename!=filename ) free(tempfilename);
 return( 0 );
+    }
 
     locale_t tmplocale; locale_t oldlocale; // Declare temporary locale storage.
     switch_to_c_locale(&tmplocale, &oldlocale); // Switch to the C locale temporarily and cache the old locale.
@@ -3191,10 +3275,21 @@ return( 0 );
     } else
 	err = SFDDump(sfd,sf,map,normal,todir,filename);
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
-    if ( ferror(sfd) ) err = true;
-    if ( fclose(sfd) ) err = true;
-    if ( todir )
-	SFFinalDirClean(filename);
+    if ( todir ) {
+	err |= SFDirCommit(sfd,tempfilename);
+	free(tempfilename);
+	/* Don't throw anything away if we couldn't write its replacement */
+	if ( !err )
+	    SFDirClean(filename);
+	g_hash_table_destroy(sfdir_written);
+	sfdir_written = NULL;
+	SFDirPrintsFree(prints_sf->sfdir_prints);
+	prints_sf->sfdir_prints = sfdir_new;
+	sfdir_old = sfdir_new = NULL;
+    } else {
+	if ( ferror(sfd) ) err = true;
+	if ( fclose(sfd) ) err = true;
+    }
 return( !err );
 }
 
@@ -5285,6 +5380,47 @@ char* SFDMoveToNextStartChar( FILE* sfd ) {
     return 0;
 }
 
+/* A lazily opened font leaves its outlines (and instructions) in the file. */
+/*  Skip over one, remembering where it was so that SFDLoadLazy can come */
+/*  back for it */
+static void SFDSkipLazy(FILE *sfd,SplineChar *sc,int layer,const char *terminator) {
+    struct lazyoutline *lo = chunkalloc(sizeof(struct lazyoutline));
+    char buffer[200], *pt;
+    int atstart = true, tlen = strlen(terminator);
+    size_t len;
+
+    lo->offset = ftell(sfd);
+    lo->layer = layer;
+    lo->next = sc->lazy;
+    sc->lazy = lo;
+    while ( fgets(buffer,sizeof(buffer),sfd)!=NULL ) {
+	if ( atstart ) {
+	    for ( pt=buffer; *pt==' ' || *pt=='\t'; ++pt );
+	    if ( strncmp(pt,terminator,tlen)==0 )
+    break;
+	}
+	len = strlen(buffer);
+	atstart = len>0 && buffer[len-1]=='\n';
+    }
+}
+
+static void SFDLoadLazy(SplineChar *sc,struct lazyglyphs *lazy) {
+    struct lazyoutline *lo;
+    locale_t tmplocale; locale_t oldlocale; // Declare temporary locale storage.
+
+    switch_to_c_locale(&tmplocale, &oldlocale); // Switch to the C locale temporarily and cache the old locale.
+    for ( lo=sc->lazy; lo!=NULL; lo=lo->next ) {
+	fseek(lazy->file,lo->offset,SEEK_SET);
+	if ( lo->layer==-1 )
+	    SFDGetTtInstrs(lazy->file,sc);
+	else if ( lo->layer<sc->layer_cnt )
+	    sc->layers[lo->layer].splines = SFDGetSplineSet(lazy->file,sc->layers[lo->layer].order2);
+    }
+    switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
+    if ( sc->layers[ly_fore].order2 )
+	SCDefaultInterpolation(sc);
+}
+
 static SplineChar *SFDGetChar(FILE *sfd,SplineFont *sf, int had_sf_layer_cnt) {
     SplineChar *sc;
     char tok[2000], ch;
@@ -5691,7 +5827,10 @@ return( NULL );
 		}
 	    }
 	} else if ( strmatch(tok,"SplineSet")==0 ) {
-	    sc->layers[current_layer].splines = SFDGetSplineSet(sfd,sc->layers[current_layer].order2);
+	    if ( sf->lazy!=NULL )
+		SFDSkipLazy(sfd,sc,current_layer,"EndSplineSet");
+	    else
+		sc->layers[current_layer].splines = SFDGetSplineSet(sfd,sc->layers[current_layer].order2);
 	} else if ( strmatch(tok,"Guideline:")==0 ) {
 	    lastgl = SFDReadGuideline(sfd, &sc->layers[current_layer].guidelines, lastgl);
 	} else if ( strmatch(tok,"Ref:")==0 || strmatch(tok,"Refer:")==0 ) {
@@ -5755,7 +5894,10 @@ return( NULL );
 	} else if ( strmatch(tok,"TtfInstrs:")==0 ) {	/* Binary format */
 	    SFDGetTtfInstrs(sfd,sc);
 	} else if ( strmatch(tok,"TtInstrs:")==0 ) {	/* ASCII format */
-	    SFDGetTtInstrs(sfd,sc);
+	    if ( sf->lazy!=NULL )
+		SFDSkipLazy(sfd,sc,-1,end_tt_instrs);
+	    else
+		SFDGetTtInstrs(sfd,sc);
 	} else if ( strmatch(tok,"Kerns2:")==0 ||
 		strmatch(tok,"VKerns2:")==0 ) {
 	    KernPair *kp, *last=NULL;
@@ -5994,6 +6136,8 @@ exit(1);
 	} else if ( strmatch(tok,"EndChar")==0 ) {
 	    if ( sc->orig_pos<sf->glyphcnt )
 		sf->glyphs[sc->orig_pos] = sc;
+	    if ( had_old_dstems )
+		SCLoadLazy(sc);
             /* Recalculating hint active zones may be needed for old .sfd files. */
             /* Do this when we have finished with other glyph components, */
             /* so that splines are already available */
@@ -6266,6 +6410,7 @@ return( 0 );
 		if ( gsfd!=NULL ) {
 		    if ( getname(gsfd,tok) && strcmp(tok,"BDFChar:")==0)
 			SFDGetBitmapChar(gsfd,bdf);
+		    SFDirNoteRead(gsfd,name);
 		    fclose(gsfd);
 		    ff_progress_next();
 		}
@@ -7090,7 +7235,7 @@ static void SFDSizeMap(EncMap *map,int glyphcnt,int enccnt) {
 }
 
 static SplineFont *SFD_GetFont(FILE *sfd,SplineFont *cidmaster,char *tok,
-	int fromdir, char *dirname, float sfdversion);
+	int fromdir, char *dirname, float sfdversion, int lazy);
 
 static SplineFont *SFD_FigureDirType(SplineFont *sf,char *tok, char *dirname,
 	Encoding *enc, struct remap *remap,int had_layer_cnt) {
@@ -7147,6 +7292,7 @@ return( sf );
 		gsfd = fopen(name,"r");
 		if ( gsfd!=NULL ) {
 		    SFDGetChar(gsfd,sf,had_layer_cnt);
+		    SFDirNoteRead(gsfd,name);
 		    ff_progress_next();
 		    fclose(gsfd);
 		}
@@ -7172,7 +7318,7 @@ return( sf );
 		if ( ssfd!=NULL ) {
 		    if ( i!=0 )
 			ff_progress_next_stage();
-		    sf->subfonts[i++] = SFD_GetFont(ssfd,sf,tok,true,name,sf->sfd_version);
+		    sf->subfonts[i++] = SFD_GetFont(ssfd,sf,tok,true,name,sf->sfd_version,false);
 		    fclose(ssfd);
 		}
 	    }
@@ -7196,7 +7342,7 @@ return( sf );
 		ssfd = fopen(props,"r");
 		if ( ssfd!=NULL ) {
 		    SplineFont *mmsf;
-		    mmsf = SFD_GetFont(ssfd,NULL,tok,true,name,sf->sfd_version);
+		    mmsf = SFD_GetFont(ssfd,NULL,tok,true,name,sf->sfd_version,false);
 		    if ( ipos!=0 ) {
 			EncMapFree(mmsf->map);
 			mmsf->map=NULL;
@@ -8462,7 +8608,7 @@ void SFD_GetFontMetaDataVoid( FILE *sfd,
 }
 
 static SplineFont *SFD_GetFont( FILE *sfd,SplineFont *cidmaster,char *tok,
-				int fromdir, char *dirname, float sfdversion )
+				int fromdir, char *dirname, float sfdversion, int lazy )
 {
     SplineFont *sf;
     int realcnt, i, eof, mappos=-1, ch;
@@ -8961,7 +9107,7 @@ exit( 1 );
 	for ( i=0; i<sf->subfontcnt; ++i ) {
 	    if ( i!=0 )
 		ff_progress_next_stage();
-	    sf->subfonts[i] = SFD_GetFont(sfd,sf,tok,fromdir,dirname,sfdversion);
+	    sf->subfonts[i] = SFD_GetFont(sfd,sf,tok,fromdir,dirname,sfdversion,false);
 	}
     } else if ( sf->mm!=NULL ) {
 	MMSet *mm = sf->mm;
@@ -8969,12 +9115,12 @@ exit( 1 );
 	for ( i=0; i<mm->instance_count; ++i ) {
 	    if ( i!=0 )
 		ff_progress_next_stage();
-	    mm->instances[i] = SFD_GetFont(sfd,NULL,tok,fromdir,dirname,sfdversion);
+	    mm->instances[i] = SFD_GetFont(sfd,NULL,tok,fromdir,dirname,sfdversion,false);
 	    EncMapFree(mm->instances[i]->map); mm->instances[i]->map=NULL;
 	    mm->instances[i]->mm = mm;
 	}
 	ff_progress_next_stage();
-	mm->normal = SFD_GetFont(sfd,NULL,tok,fromdir,dirname,sfdversion);
+	mm->normal = SFD_GetFont(sfd,NULL,tok,fromdir,dirname,sfdversion,false);
 	mm->normal->mm = mm;
 	sf->mm = NULL;
 	SplineFontFree(sf);
@@ -8987,6 +9133,11 @@ exit( 1 );
 	    sf->map = map;
 	}
     } else {
+	if ( lazy && sf->sfd_version>=2 ) {
+	    sf->lazy = chunkalloc(sizeof(struct lazyglyphs));
+	    sf->lazy->file = sfd;
+	    sf->lazy->load = SFDLoadLazy;
+	}
 	while ( SFDGetChar(sfd,sf,had_layer_cnt)!=NULL ) {
 	    ff_progress_next();
 	}
@@ -9064,7 +9215,7 @@ return( -1 );
 return( dval );
 }
 
-static SplineFont *SFD_Read(char *filename,FILE *sfd, int fromdir) {
+static SplineFont *SFD_Read(char *filename,FILE *sfd, int fromdir, int lazy) {
     SplineFont *sf=NULL;
     char tok[2000];
     double version;
@@ -9081,9 +9232,17 @@ return( NULL );
     locale_t tmplocale; locale_t oldlocale; // Declare temporary locale storage.
     switch_to_c_locale(&tmplocale, &oldlocale); // Switch to the C locale temporarily and cache the old locale.
     ff_progress_change_stages(2);
+    if ( fromdir )
+	sfdir_new = SFDirPrintsNew(filename,time(NULL));
     if ( (version = SFDStartsCorrectly(sfd,tok))!=-1 )
-	sf = SFD_GetFont(sfd,NULL,tok,fromdir,filename,version);
+	sf = SFD_GetFont(sfd,NULL,tok,fromdir,filename,version,lazy);
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
+    if ( sf!=NULL && sfdir_new!=NULL ) {
+	sf->sfdir_prints = sfdir_new;
+	sfdir_new = NULL;
+    }
+    SFDirPrintsFree(sfdir_new);
+    sfdir_new = NULL;
     if ( sf!=NULL ) {
 	sf->filename = copy(filename);
 	if ( sf->mm!=NULL ) {
@@ -9098,7 +9257,7 @@ return( NULL );
 	    SplineChar *sc;
 	    for ( i=sf->glyphcnt-1; i>=0; --i )
 		if ( (sc = sf->glyphs[i])!=NULL &&
-			(sc->layer_cnt!=2 ||
+			(sc->layer_cnt!=2 || sc->lazy!=NULL ||
 			 sc->layers[ly_fore].splines!=NULL ||
 			 sc->layers[ly_fore].refs!=NULL ))
 	     break;
@@ -9106,20 +9265,21 @@ return( NULL );
 		 sf->onlybitmaps = true;
 	}
     }
-    fclose(sfd);
+    if ( sf==NULL || sf->lazy==NULL )	/* A lazy font keeps reading from it */
+	fclose(sfd);
 return( sf );
 }
 
 SplineFont *SFDRead(char *filename) {
-return( SFD_Read(filename,NULL,false));
+return( SFD_Read(filename,NULL,false,false));
 }
 
-SplineFont *_SFDRead(char *filename,FILE *sfd) {
-return( SFD_Read(filename,sfd,false));
+SplineFont *_SFDRead(char *filename,FILE *sfd,enum openflags openflags) {
+return( SFD_Read(filename,sfd,false,(openflags&of_lazy)!=0));
 }
 
 SplineFont *SFDirRead(char *filename) {
-return( SFD_Read(filename,NULL,true));
+return( SFD_Read(filename,NULL,true,false));
 }
 
 SplineChar *SFDReadOneChar(SplineFont *cur_sf,const char *name) {
@@ -9316,11 +9476,14 @@ return(false);
 	    }
 	}
 	if ( sc->orig_pos<ssf->glyphcnt ) {
-	    if ( ssf->glyphs[sc->orig_pos]!=NULL )
+	    if ( ssf->glyphs[sc->orig_pos]!=NULL ) {
+		SFHashRemoveGlyph(ssf,ssf->glyphs[sc->orig_pos]);
 		SplineCharFree(ssf->glyphs[sc->orig_pos]);
+	    }
 	    ssf->glyphs[sc->orig_pos] = sc;
 	    sc->parent = ssf;
 	    sc->changed = true;
+	    SFHashGlyph(ssf,sc);
 	}
     }
     sf->changed = true;
@@ -9357,6 +9520,21 @@ return( NULL );
 	SplineFontFree(sf);
 return( NULL );
     }
+    /* Then any changes journalled since. A block we crashed while writing */
+    /*  will be shorter than it claims, and is ignored */
+    while ( getname(asfd,tok)==1 ) {
+	if ( strcmp(tok,"Journal:")==0 ) {
+	    long len, pos;
+	    struct stat sb;
+	    int ilen;
+	    if ( getint(asfd,&ilen)!=1 || fstat(fileno(asfd),&sb)!=0 )
+    break;
+	    len = ilen; pos = ftell(asfd);
+	    if ( len<=0 || pos+1+len>sb.st_size || !ModSF(asfd,sf))
+    break;
+	} else if ( strcmp(tok,"EndSplineFont")!=0 )
+    break;
+    }
 return( sf );
 }
 
@@ -9453,26 +9631,119 @@ return( NULL );
 return( ret );
 }
 
-void SFAutoSave(SplineFont *sf,EncMap *map) {
-    int i, k, max;
-    FILE *asfd;
-    SplineFont *ssf;
+/* Autosaves are kept as a journal. The first one (and every so often after */
+/*  that, so the file does not grow for ever) is a snapshot of all changed */
+/*  glyphs, as it has always been. After that each autosave just appends the */
+/*  glyphs changed since the last one as a "Journal: <length>" block, which */
+/*  SlurpRecovery applies on top of what came before. Blocks are built up */
+/*  in memory here and written out on a separate thread, so a big font does */
+/*  not make the ui stutter each time its autosave comes round */
+#define AUTOSAVE_MAX_APPENDS	100
 
-    if ( no_windowing_ui )		/* No autosaves when just scripting */
-return;
+struct autosavewrite {
+    char *filename;
+    FILE *data;
+    int append;
+};
+
+static GThread *autosave_writer = NULL;
+
+static gpointer AutoSaveWrite(gpointer data) {
+    struct autosavewrite *asw = data;
+    char buffer[8192], *tempname = NULL;
+    FILE *out;
+    size_t len;
+
+    if ( asw->append )
+	out = fopen(asw->filename,"ab");
+    else {
+	/* Snapshots replace the file in one go, so there is always a */
+	/*  complete one to recover from */
+	tempname = smprintf("%s~",asw->filename);
+	out = fopen(tempname,"wb");
+    }
+    if ( out!=NULL ) {
+	if ( asw->append ) {
+	    fseek(asw->data,0,SEEK_END);
+	    fprintf( out, "Journal: %ld\n", ftell(asw->data));
+	}
+	rewind(asw->data);
+	while ( (len=fread(buffer,1,sizeof(buffer),asw->data))>0 )
+	    fwrite(buffer,1,len,out);
+	if ( fclose(out)==0 && tempname!=NULL ) {
+#if defined(__MINGW32__)
+	    unlink(asw->filename);
+#endif
+	    rename(tempname,asw->filename);
+	}
+    }
+    fclose(asw->data);
+    free(tempname);
+    free(asw->filename);
+    free(asw);
+return( NULL );
+}
+
+void SFAutoSaveWait(void) {
+    if ( autosave_writer!=NULL ) {
+	g_thread_join(autosave_writer);
+	autosave_writer = NULL;
+    }
+}
+
+static SplineChar *AutoSaveGlyph(SplineFont *sf,int i) {
+    SplineFont *ssf = sf;
+    int k;
+
+    for ( k=0; k<sf->subfontcnt; ++k ) {
+	if ( i<sf->subfonts[k]->glyphcnt ) {
+	    ssf = sf->subfonts[k];
+	    if ( SCWorthOutputting(ssf->glyphs[i]))
+	break;
+	}
+    }
+return( i<ssf->glyphcnt ? ssf->glyphs[i] : NULL );
+}
+
+void _SFAutoSave(SplineFont *sf,EncMap *map) {
+    int i, k, max, full, written = 0;
+    FILE *asfd, *scratch;
+    SplineFont *ssf;
+    SplineChar *sc;
+    struct autosavewrite *asw;
+    char *buf = NULL;
+    long len, bufmax = 0;
+    uint64_t fingerprint;
 
     if ( sf->cidmaster!=NULL ) sf=sf->cidmaster;
-    asfd = fopen(sf->autosavename,"w");
+    asfd = GFileMemTmpfile();
     if ( asfd==NULL )
 return;
+    scratch = GFileMemTmpfile();
+    if ( scratch==NULL ) {
+	fclose(asfd);
+return;
+    }
 
     max = sf->glyphcnt;
     for ( i=0; i<sf->subfontcnt; ++i )
 	if ( sf->subfonts[i]->glyphcnt>max ) max = sf->subfonts[i]->glyphcnt;
 
+    /* Start again from a snapshot once the changes outweigh it, or if a */
+    /*  glyph the autosave holds has reverted to its saved state (the */
+    /*  journal can only replace glyphs, not drop them). SFRemoveGlyph */
+    /*  zeroes autosave_base for the same reason */
+    full = sf->autosave_base==0 || sf->autosave_appends>=AUTOSAVE_MAX_APPENDS ||
+	    sf->autosave_journal>sf->autosave_base;
+    for ( i=0; i<max && !full; ++i ) {
+	sc = AutoSaveGlyph(sf,i);
+	if ( sc!=NULL && !sc->changed && sc->autosave_fingerprint!=0 )
+	    full = true;
+    }
+
     locale_t tmplocale; locale_t oldlocale; // Declare temporary locale storage.
     switch_to_c_locale(&tmplocale, &oldlocale); // Switch to the C locale temporarily and cache the old locale.
-    if ( !sf->new && sf->origname!=NULL )	/* might be a new file */
+    if ( full && !sf->new && sf->origname!=NULL )	/* might be a new file */
 	fprintf( asfd, "Base: %s%s\n", sf->origname,
 		sf->compression==0?"":compressors[sf->compression-1].ext );
     fprintf( asfd, "Encoding: %s\n", map->enc->enc_name );
@@ -9486,31 +9757,91 @@ return;
     if ( sf->multilayer )
 	fprintf( asfd, "MultiLayer: %d\n", sf->multilayer );
     fprintf( asfd, "BeginChars: %d\n", max );
+    /* Not everything which changes a glyph marks it changed_since_autosave, */
+    /*  so each changed glyph is dumped and goes in the block only if that */
+    /*  differs from what the autosave already holds for it */
     for ( i=0; i<max; ++i ) {
-	ssf = sf;
-	for ( k=0; k<sf->subfontcnt; ++k ) {
-	    if ( i<sf->subfonts[k]->glyphcnt ) {
-		ssf = sf->subfonts[k];
-		if ( SCWorthOutputting(ssf->glyphs[i]))
-	break;
-	    }
+	sc = AutoSaveGlyph(sf,i);
+	if ( sc==NULL )
+    continue;
+	if ( !sc->changed ) {
+	    sc->autosave_fingerprint = 0;
+    continue;
 	}
-	if ( ssf->glyphs[i]!=NULL && ssf->glyphs[i]->changed )
-	    SFDDumpChar( asfd,ssf->glyphs[i],map,NULL,false,1);
+	rewind(scratch);
+	SFDDumpChar( scratch,sc,map,NULL,false,1);
+	len = ftell(scratch);
+	if ( len>bufmax )
+	    buf = realloc(buf,bufmax = len);
+	rewind(scratch);
+	if ( fread(buf,1,len,scratch)!=(size_t) len ) {
+	    /* Can't tell whether it differs, so write it anyway */
+	    SFDDumpChar( asfd,sc,map,NULL,false,1);
+	    sc->autosave_fingerprint = 1;
+	    ++written;
+    continue;
+	}
+	fingerprint = FingerprintAdd(FINGERPRINT_START,buf,len);
+	if ( fingerprint==0 ) fingerprint = 1;
+	if ( full || fingerprint!=sc->autosave_fingerprint ) {
+	    fwrite(buf,1,len,asfd);
+	    ++written;
+	}
+	sc->autosave_fingerprint = fingerprint;
     }
+    fclose(scratch);
+    free(buf);
     fprintf( asfd, "EndChars\n" );
-    fprintf( asfd, "EndSplineFont\n" );
-    fclose(asfd);
+    if ( full )
+	fprintf( asfd, "EndSplineFont\n" );
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
+
+    for ( k=0; k<sf->subfontcnt || k==0; ++k ) {
+	ssf = sf->subfontcnt==0 ? sf : sf->subfonts[k];
+	ssf->changed_since_autosave = false;
+	for ( i=0; i<ssf->glyphcnt; ++i )
+	    if ( ssf->glyphs[i]!=NULL )
+		ssf->glyphs[i]->changed_since_autosave = false;
+    }
     sf->changed_since_autosave = false;
+    if ( !full && written==0 ) {	/* Nothing the autosave doesn't have */
+	fclose(asfd);
+return;
+    }
+
+    if ( full ) {
+	sf->autosave_base = ftell(asfd);
+	sf->autosave_journal = 0;
+	sf->autosave_appends = 0;
+    } else {
+	sf->autosave_journal += ftell(asfd);
+	++sf->autosave_appends;
+    }
+
+    /* Only one write in flight at a time, so blocks land in order */
+    SFAutoSaveWait();
+    asw = calloc(1,sizeof(struct autosavewrite));
+    asw->filename = copy(sf->autosavename);
+    asw->data = asfd;
+    asw->append = !full;
+    autosave_writer = g_thread_new("ff-autosave",AutoSaveWrite,asw);
+}
+
+void SFAutoSave(SplineFont *sf,EncMap *map) {
+    if ( no_windowing_ui )		/* No autosaves when just scripting */
+return;
+    _SFAutoSave(sf,map);
 }
 
 void SFClearAutoSave(SplineFont *sf) {
     int i;
     SplineFont *ssf;
 
+    SFAutoSaveWait();
     if ( sf->cidmaster!=NULL ) sf = sf->cidmaster;
     sf->changed_since_autosave = false;
+    sf->autosave_base = sf->autosave_journal = 0;
+    sf->autosave_appends = 0;
     for ( i=0; i<sf->subfontcnt; ++i ) {
 	ssf = sf->subfonts[i];
 	ssf->changed_since_autosave = false;
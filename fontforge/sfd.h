@@ -115,10 +115,13 @@ extern int SFDWriteBakExtended(char* locfilename, SplineFont *sf, EncMap *map, E
 extern MacFeat *SFDParseMacFeatures(FILE *sfd, char *tok);
 extern SplineChar *SFDReadOneChar(SplineFont *cur_sf, const char *name);
 extern SplineFont *SFDirRead(char *filename);
-extern SplineFont *_SFDRead(char *filename, FILE *sfd);
+extern void SFDirPrintsFree(struct sfdirprints *prints);
+extern SplineFont *_SFDRead(char *filename, FILE *sfd, enum openflags openflags);
 extern SplineFont *SFRecoverFile(char *autosavename, int inquire, int *state);
 extern Undoes *SFDGetUndo(FILE *sfd, SplineChar *sc, const char* startTag, int current_layer);
+extern void _SFAutoSave(SplineFont *sf, EncMap *map);
 extern void SFAutoSave(SplineFont *sf, EncMap *map);
+extern void SFAutoSaveWait(void);
 extern void SFClearAutoSave(SplineFont *sf);
 extern void SFDDumpCharStartingMarker(FILE *sfd, SplineChar *sc);
 extern void SFD_DumpKerns(FILE *sfd, SplineChar *sc, int *newgids);
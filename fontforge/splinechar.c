@@ -36,6 +36,7 @@
 #include "gresource.h"
 #include "lookups.h"
 #include "mem.h"
+#include "parallel.h"
 #include "parsettf.h"
 #include "spiro.h"
 #include "splineorder2.h"
@@ -49,6 +50,7 @@
 
 #include <locale.h>
 #include <math.h>
+#include <unistd.h>
 
 #ifdef HAVE_IEEEFP_H
 # include <ieeefp.h>		/* Solaris defines isnan in ieeefp rather than math.h */
@@ -168,6 +170,7 @@ return;
 		dlist->sc->changed = true;
 		FVToggleCharChanged(dlist->sc);
 	    }
+	    dlist->sc->parent->changed_since_autosave = true;
 	    SCUpdateAll(dlist->sc);
 	}
     }
@@ -939,6 +942,7 @@ void AltUniAdd(SplineChar *sc,int uni) {
 	    altuni->unienc = uni;
 	    altuni->vs = -1;
 	    altuni->fid = 0;
+	    SFHashUnicodes(sc->parent,sc);
 	}
     }
 }
@@ -953,6 +957,7 @@ void AltUniAdd_DontCheckDups(SplineChar *sc,int uni) {
 	altuni->unienc = uni;
 	altuni->vs = -1;
 	altuni->fid = 0;
+	SFHashUnicodes(sc->parent,sc);
     }
 }
 
@@ -1092,6 +1097,7 @@ return( false );
     if ( alt!=NULL )
 	alt->unienc = sc->unicodeenc;
     sc->unicodeenc = unienc;
+    SFHashUnicodes(sf,sc);
     if ( sc->name==NULL || strcmp(name,sc->name)!=0 ) {
 	if ( sc->name!=NULL )
 	    SFGlyphRenameFixup(sf,sc->name,name,false);
@@ -1503,37 +1509,208 @@ return( h1 );
 return( NULL );
 }
 
-int SCValidate(SplineChar *sc, int layer, int force) {
+/* The checks SCValidate makes which look at nothing but the outlines of */
+/*  the glyph, those of its references and the extrema bound. They touch */
+/*  nothing else, so several glyphs may be checked at once, and what they */
+/*  find may be remembered by a fingerprint of what they look at */
+#define vs_outlines	(vs_opencontour|vs_selfintersects|vs_wrongdirection|\
+			 vs_missingextrema|vs_nonintegral|vs_pointstoofarapart|\
+			 vs_toomanypoints)
+
+/* Square of the length below which splines needn't have points at extrema */
+static bigreal SFExtremaBound2(SplineFont *sf) {
+    bigreal bound2 = sf->extrema_bound;
+
+    if ( bound2<=0 )
+	bound2 = (sf->ascent + sf->descent)/32.0;
+return( bound2*bound2 );
+}
+
+static int SCValidateOutlines(SplineChar *sc, int layer, bigreal bound2) {
     SplineSet *ss;
     Spline *s1, *s2, *s, *first;
     SplinePoint *sp;
-    RefChar *ref;
     int lastscan= -1;
-    int cnt, path_cnt, pt_cnt;
-    StemInfo *h;
+    int pt_cnt, state = 0;
     SplineSet *base;
-    bigreal len2, bound2, x, y;
+    bigreal len2, x, y;
     extended extrema[4];
+    BasePoint lastpt;
+
+    base = LayerAllSplines(&sc->layers[layer]);
+
+    for ( ss=sc->layers[layer].splines; ss!=NULL; ss=ss->next ) {
+	/* TrueType uses single points to move things around so ignore them */
+	if ( ss->first->next==NULL )
+	    /* Do Nothing */;
+	else if ( ss->first->prev==NULL ) {
+	    state |= vs_opencontour|vs_known;
+    break;
+	}
+    }
+
+    /* If there's an open contour we can't really tell whether it self-intersects */
+    if ( state & vs_opencontour )
+	/* state |= vs_selfintersects*/;
+    else {
+	if ( SplineSetIntersect(base,&s1,&s2) )
+	    state |= vs_selfintersects|vs_known;
+    }
+
+    /* If there's a self-intersection we are guaranteed that both the self- */
+    /*  intersecting contours will be in the wrong direction at some point */
+    if ( state & vs_selfintersects )
+	/*state |= vs_wrongdirection*/;
+    else {
+	if ( SplineSetsDetectDir(&base,&lastscan)!=NULL )
+	    state |= vs_wrongdirection|vs_known;
+    }
+
+    memset(&lastpt,0,sizeof(lastpt));
+    for ( ss=sc->layers[layer].splines, pt_cnt=0; ss!=NULL; ss=ss->next ) {
+	for ( sp=ss->first; ; ) {
+	    /* If we're interpolating the point, it won't show up in the truetype */
+	    /*  points list and it need not be integral (often it will end in .5) */
+	    if ( (!SPInterpolate(sp) && (sp->me.x != rint(sp->me.x) || sp->me.y != rint(sp->me.y))) ||
+		    sp->nextcp.x != rint(sp->nextcp.x) || sp->nextcp.y != rint(sp->nextcp.y) ||
+		    sp->prevcp.x != rint(sp->prevcp.x) || sp->prevcp.y != rint(sp->prevcp.y))
+		state |= vs_nonintegral|vs_known;
+	    if ( BPTooFar(&lastpt,&sp->prevcp) ||
+		    BPTooFar(&sp->prevcp,&sp->me) ||
+		    BPTooFar(&sp->me,&sp->nextcp))
+		state |= vs_pointstoofarapart|vs_known;
+	    memcpy(&lastpt,&sp->nextcp,sizeof(lastpt));
+	    ++pt_cnt;
+	    if ( sp->next==NULL )
+	break;
+	    if ( !sp->next->knownlinear ) {
+		if ( sp->next->order2 )
+		    ++pt_cnt;
+		else
+		    pt_cnt += 2;
+	    }
+	    sp = sp->next->to;
+	    if ( sp==ss->first ) {
+		memcpy(&lastpt,&sp->me,sizeof(lastpt));
+	break;
+	    }
+	}
+    }
+    if ( pt_cnt>1500 )
+	state |= vs_toomanypoints|vs_known;
+
+    LayerUnAllSplines(&sc->layers[layer]);
+
+    /* Only check the splines in the glyph, not those in refs */
+    for ( ss=sc->layers[layer].splines; ss!=NULL; ss=ss->next ) {
+	first = NULL;
+	for ( s=ss->first->next ; s!=NULL && s!=first; s=s->to->next ) {
+	    if ( first==NULL )
+		first = s;
+	    if ( s->acceptableextrema )
+	continue;		/* If marked as good, don't check it */
+	    /* rough appoximation to spline's length */
+	    x = (s->to->me.x-s->from->me.x);
+	    y = (s->to->me.y-s->from->me.y);
+	    len2 = x*x + y*y;
+	    /* short splines (serifs) are not required to have points at their extrema */
+	    if ( len2>bound2 && Spline2DFindExtrema(s,extrema)>0 ) {
+		state |= vs_missingextrema|vs_known;
+return( state );
+	    }
+	}
+    }
+return( state );
+}
+
+/* Glyph names and code points of a font (all the subfonts of a CID font) */
+/*  with how many glyphs have each, so that looking for duplicates of what */
+/*  one glyph has needn't compare it with every other */
+struct dupindex {
+    GHashTable *names;			/* name -> glyph count */
+    GHashTable *unis;			/* (vs<<32)|code point -> glyph count */
+};
+
+static gint64 DupUniKey(int vs, int uni) {
+return( (((gint64) vs)<<32) | (uint32) uni );
+}
+
+/* Keys of the code point table are freed by it, so are copied in here */
+static void DupIndexCount(GHashTable *table, gpointer key) {
+    g_hash_table_insert(table,key,
+	    GINT_TO_POINTER(GPOINTER_TO_INT(g_hash_table_lookup(table,key))+1));
+}
+
+static void DupIndexCountUni(GHashTable *table, int vs, int uni) {
+    gint64 *key = malloc(sizeof(gint64));
+
+    *key = DupUniKey(vs,uni);
+    DupIndexCount(table,key);
+}
+
+static void DupIndexBuild(struct dupindex *dups, SplineFont *cid) {
+    SplineFont *sf;
+    SplineChar *sc;
+    struct altuni *alt, *prev;
+    int k, gid;
+
+    dups->names = g_hash_table_new(g_str_hash,g_str_equal);
+    dups->unis = g_hash_table_new_full(g_int64_hash,g_int64_equal,free,NULL);
+    k = 0;
+    do {
+	sf = cid->subfontcnt==0 ? cid : cid->subfonts[k];
+	for ( gid=0; gid<sf->glyphcnt; ++gid ) if ( (sc=sf->glyphs[gid])!=NULL ) {
+	    DupIndexCount(dups->names,sc->name);
+	    if ( sc->unicodeenc!=-1 )
+		DupIndexCountUni(dups->unis,-1,sc->unicodeenc);
+	    for ( alt=sc->altuni; alt!=NULL; alt=alt->next ) {
+		/* A glyph which lists a code point twice is still only one glyph */
+		if ( alt->vs==-1 && alt->unienc==sc->unicodeenc )
+	    continue;
+		for ( prev=sc->altuni; prev!=alt; prev=prev->next )
+		    if ( prev->vs==alt->vs && prev->unienc==alt->unienc )
+		break;
+		if ( prev!=alt )
+	    continue;
+		DupIndexCountUni(dups->unis,alt->vs,alt->unienc);
+	    }
+	}
+	++k;
+    } while ( k<cid->subfontcnt );
+}
+
+static void DupIndexFree(struct dupindex *dups) {
+    g_hash_table_destroy(dups->names);
+    g_hash_table_destroy(dups->unis);
+}
+
+static int DupIndexHasOthers(GHashTable *table, gconstpointer key) {
+return( GPOINTER_TO_INT(g_hash_table_lookup(table,key))>1 );
+}
+
+/* The checks SCValidate makes which look at the font around the glyph: */
+/*  its name and what it names, its references, hints and maxp limits, and */
+/*  whether another glyph has its name or a code point of it. dups may be */
+/*  NULL, in which case every other glyph is looked at */
+static int SCValidateInFont(SplineChar *sc, int layer, struct dupindex *dups) {
+    SplineSet *ss;
+    SplinePoint *sp;
+    RefChar *ref;
+    int cnt, path_cnt, pt_cnt, state = 0;
+    StemInfo *h;
     PST *pst;
     struct ttf_table *tab;
     extern int allow_utf8_glyphnames;
     RefChar *r;
-    BasePoint lastpt;
     int gid, k;
     SplineFont *cid, *sf;
     SplineChar *othersc;
     struct altuni *alt;
-
-    if ( (sc->layers[layer].validation_state&vs_known) && !force )
-  goto end;
-
-    sc->layers[layer].validation_state = 0;
-
-    base = LayerAllSplines(&sc->layers[layer]);
+    gint64 key;
 
     if ( !allow_utf8_glyphnames ) {
 	if ( strlen(sc->name)>31 )
-	    sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+	    state |= vs_badglyphname|vs_known;
 	else {
 	    char *pt;
 	    for ( pt = sc->name; *pt; ++pt ) {
@@ -1543,7 +1720,7 @@ int SCValidate(SplineChar *sc, int layer, int force) {
 			*pt == '.' || *pt == '_' )
 		    /* That's ok */;
 		else {
-		    sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+		    state |= vs_badglyphname|vs_known;
 	    break;
 		}
 	    }
@@ -1553,74 +1730,47 @@ int SCValidate(SplineChar *sc, int layer, int force) {
     for ( pst=sc->possub; pst!=NULL; pst=pst->next ) {
 	if ( pst->type==pst_substitution &&
 		!SCWorthOutputting(SFGetChar(sc->parent,-1,pst->u.subs.variant))) {
-	    sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+	    state |= vs_badglyphname|vs_known;
     break;
 	} else if ( pst->type==pst_pair &&
 		!SCWorthOutputting(SFGetChar(sc->parent,-1,pst->u.pair.paired))) {
-	    sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+	    state |= vs_badglyphname|vs_known;
     break;
 	} else if ( (pst->type==pst_alternate || pst->type==pst_multiple || pst->type==pst_ligature) &&
 		!SFValidNameList(sc->parent,pst->u.mult.components)) {
-	    sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+	    state |= vs_badglyphname|vs_known;
     break;
 	}
     }
     if ( sc->vert_variants!=NULL && sc->vert_variants->variants != NULL &&
 	    !SFValidNameList(sc->parent,sc->vert_variants->variants) )
-	sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+	state |= vs_badglyphname|vs_known;
     else if ( sc->horiz_variants!=NULL && sc->horiz_variants->variants != NULL &&
 	    !SFValidNameList(sc->parent,sc->horiz_variants->variants) )
-	sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+	state |= vs_badglyphname|vs_known;
     else {
 	int i;
 	if ( sc->vert_variants!=NULL ) {
 	    for ( i=0; i<sc->vert_variants->part_cnt; ++i ) {
 		if ( !SCWorthOutputting(SFGetChar(sc->parent,-1,sc->vert_variants->parts[i].component)))
-		    sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+		    state |= vs_badglyphname|vs_known;
 	    break;
 	    }
 	}
 	if ( sc->horiz_variants!=NULL ) {
 	    for ( i=0; i<sc->horiz_variants->part_cnt; ++i ) {
 		if ( !SCWorthOutputting(SFGetChar(sc->parent,-1,sc->horiz_variants->parts[i].component)))
-		    sc->layers[layer].validation_state |= vs_badglyphname|vs_known;
+		    state |= vs_badglyphname|vs_known;
 	    break;
 	    }
 	}
     }
 
-    for ( ss=sc->layers[layer].splines; ss!=NULL; ss=ss->next ) {
-	/* TrueType uses single points to move things around so ignore them */
-	if ( ss->first->next==NULL )
-	    /* Do Nothing */;
-	else if ( ss->first->prev==NULL ) {
-	    sc->layers[layer].validation_state |= vs_opencontour|vs_known;
-    break;
-	}
-    }
-
-    /* If there's an open contour we can't really tell whether it self-intersects */
-    if ( sc->layers[layer].validation_state & vs_opencontour )
-	/* sc->layers[layer].validation_state |= vs_selfintersects*/;
-    else {
-	if ( SplineSetIntersect(base,&s1,&s2) )
-	    sc->layers[layer].validation_state |= vs_selfintersects|vs_known;
-    }
-
-    /* If there's a self-intersection we are guaranteed that both the self- */
-    /*  intersecting contours will be in the wrong direction at some point */
-    if ( sc->layers[layer].validation_state & vs_selfintersects )
-	/*sc->layers[layer].validation_state |= vs_wrongdirection*/;
-    else {
-	if ( SplineSetsDetectDir(&base,&lastscan)!=NULL )
-	    sc->layers[layer].validation_state |= vs_wrongdirection|vs_known;
-    }
-
     /* Different kind of "wrong direction" */
     for ( ref=sc->layers[layer].refs; ref!=NULL; ref=ref->next ) {
 	if ( ref->transform[0]*ref->transform[3]<0 ||
 		(ref->transform[0]==0 && ref->transform[1]*ref->transform[2]>0)) {
-	    sc->layers[layer].validation_state |= vs_flippedreferences|vs_known;
+	    state |= vs_flippedreferences|vs_known;
     break;
 	}
     }
@@ -1628,11 +1778,13 @@ int SCValidate(SplineChar *sc, int layer, int force) {
     for ( h=sc->hstem, cnt=0; h!=NULL; h=h->next, ++cnt );
     for ( h=sc->vstem       ; h!=NULL; h=h->next, ++cnt );
     if ( cnt>=96 )
-	sc->layers[layer].validation_state |= vs_toomanyhints|vs_known;
+	state |= vs_toomanyhints|vs_known;
 
     if ( sc->layers[layer].splines!=NULL ) {
 	int anyhm=0;
 	h=NULL;
+	/* The hint masks of the references count as well */
+	LayerAllSplines(&sc->layers[layer]);
 	for ( ss=sc->layers[layer].splines; ss!=NULL && h==NULL; ss=ss->next ) {
 	    sp = ss->first;
 	    do {
@@ -1647,71 +1799,12 @@ int SCValidate(SplineChar *sc, int layer, int force) {
 		sp = sp->next->to;
 	    } while ( sp!=ss->first );
 	}
+	LayerUnAllSplines(&sc->layers[layer]);
 	if ( !anyhm )
 	    h = SCHintOverlapInMask(sc,NULL);
 	if ( h!=NULL )
-	    sc->layers[layer].validation_state |= vs_overlappedhints|vs_known;
-    }
-
-    memset(&lastpt,0,sizeof(lastpt));
-    for ( ss=sc->layers[layer].splines, pt_cnt=path_cnt=0; ss!=NULL; ss=ss->next, ++path_cnt ) {
-	for ( sp=ss->first; ; ) {
-	    /* If we're interpolating the point, it won't show up in the truetype */
-	    /*  points list and it need not be integral (often it will end in .5) */
-	    if ( (!SPInterpolate(sp) && (sp->me.x != rint(sp->me.x) || sp->me.y != rint(sp->me.y))) ||
-		    sp->nextcp.x != rint(sp->nextcp.x) || sp->nextcp.y != rint(sp->nextcp.y) ||
-		    sp->prevcp.x != rint(sp->prevcp.x) || sp->prevcp.y != rint(sp->prevcp.y))
-		sc->layers[layer].validation_state |= vs_nonintegral|vs_known;
-	    if ( BPTooFar(&lastpt,&sp->prevcp) ||
-		    BPTooFar(&sp->prevcp,&sp->me) ||
-		    BPTooFar(&sp->me,&sp->nextcp))
-		sc->layers[layer].validation_state |= vs_pointstoofarapart|vs_known;
-	    memcpy(&lastpt,&sp->nextcp,sizeof(lastpt));
-	    ++pt_cnt;
-	    if ( sp->next==NULL )
-	break;
-	    if ( !sp->next->knownlinear ) {
-		if ( sp->next->order2 )
-		    ++pt_cnt;
-		else
-		    pt_cnt += 2;
-	    }
-	    sp = sp->next->to;
-	    if ( sp==ss->first ) {
-		memcpy(&lastpt,&sp->me,sizeof(lastpt));
-	break;
-	    }
-	}
-    }
-    if ( pt_cnt>1500 )
-	sc->layers[layer].validation_state |= vs_toomanypoints|vs_known;
-
-    LayerUnAllSplines(&sc->layers[layer]);
-
-    /* Only check the splines in the glyph, not those in refs */
-    bound2 = sc->parent->extrema_bound;
-    if ( bound2<=0 )
-	bound2 = (sc->parent->ascent + sc->parent->descent)/32.0;
-    bound2 *= bound2;
-    for ( ss=sc->layers[layer].splines, cnt=0; ss!=NULL; ss=ss->next ) {
-	first = NULL;
-	for ( s=ss->first->next ; s!=NULL && s!=first; s=s->to->next ) {
-	    if ( first==NULL )
-		first = s;
-	    if ( s->acceptableextrema )
-	continue;		/* If marked as good, don't check it */
-	    /* rough appoximation to spline's length */
-	    x = (s->to->me.x-s->from->me.x);
-	    y = (s->to->me.y-s->from->me.y);
-	    len2 = x*x + y*y;
-	    /* short splines (serifs) are not required to have points at their extrema */
-	    if ( len2>bound2 && Spline2DFindExtrema(s,extrema)>0 ) {
-		sc->layers[layer].validation_state |= vs_missingextrema|vs_known;
-    goto break_2_loops;
-	    }
-	}
+	    state |= vs_overlappedhints|vs_known;
     }
-    break_2_loops:;
 
     if ( (tab = SFFindTable(sc->parent,CHR('m','a','x','p')))!=NULL && tab->len>=32 ) {
 	/* If we have a maxp table then do some truetype checks */
@@ -1726,14 +1819,6 @@ int SCValidate(SplineChar *sc, int layer, int force) {
 	int comp_depth_max  = memushort(tab->data,tab->len,15*sizeof(uint16));
 	int rd, rdtest;
 
-	/* Already figured out two of these */
-	if ( sc->layers[layer].splines==NULL ) {
-	    if ( pt_cnt>composit_pt_max )
-		sc->layers[layer].validation_state |= vs_maxp_toomanycomppoints|vs_known;
-	    if ( path_cnt>composit_path_max )
-		sc->layers[layer].validation_state |= vs_maxp_toomanycomppaths|vs_known;
-	}
-
 	for ( ss=sc->layers[layer].splines, pt_cnt=path_cnt=0; ss!=NULL; ss=ss->next, ++path_cnt ) {
 	    for ( sp=ss->first; ; ) {
 		++pt_cnt;
@@ -1744,13 +1829,19 @@ int SCValidate(SplineChar *sc, int layer, int force) {
 	    break;
 	    }
 	}
+	if ( sc->layers[layer].splines==NULL ) {
+	    if ( pt_cnt>composit_pt_max )
+		state |= vs_maxp_toomanycomppoints|vs_known;
+	    if ( path_cnt>composit_path_max )
+		state |= vs_maxp_toomanycomppaths|vs_known;
+	}
 	if ( pt_cnt>pt_max )
-	    sc->layers[layer].validation_state |= vs_maxp_toomanypoints|vs_known;
+	    state |= vs_maxp_toomanypoints|vs_known;
 	if ( path_cnt>path_max )
-	    sc->layers[layer].validation_state |= vs_maxp_toomanypaths|vs_known;
+	    state |= vs_maxp_toomanypaths|vs_known;
 
 	if ( sc->ttf_instrs_len>instr_len_max )
-	    sc->layers[layer].validation_state |= vs_maxp_instrtoolong|vs_known;
+	    state |= vs_maxp_instrtoolong|vs_known;
 
 	rd = 0;
 	for ( r=sc->layers[layer].refs, cnt=0; r!=NULL; r=r->next, ++cnt ) {
@@ -1759,9 +1850,25 @@ int SCValidate(SplineChar *sc, int layer, int force) {
 		rd = rdtest;
 	}
 	if ( cnt>num_comp_max )
-	    sc->layers[layer].validation_state |= vs_maxp_toomanyrefs|vs_known;
+	    state |= vs_maxp_toomanyrefs|vs_known;
 	if ( rd>comp_depth_max )
-	    sc->layers[layer].validation_state |= vs_maxp_refstoodeep|vs_known;
+	    state |= vs_maxp_refstoodeep|vs_known;
+    }
+
+    if ( dups!=NULL ) {
+	if ( DupIndexHasOthers(dups->names,sc->name) )
+	    state |= vs_dupname|vs_known;
+	if ( sc->unicodeenc!=-1 ) {
+	    key = DupUniKey(-1,sc->unicodeenc);
+	    if ( DupIndexHasOthers(dups->unis,&key) )
+		state |= vs_dupunicode|vs_known;
+	}
+	for ( alt=sc->altuni; alt!=NULL; alt=alt->next ) {
+	    key = DupUniKey(alt->vs,alt->unienc);
+	    if ( DupIndexHasOthers(dups->unis,&key) )
+		state |= vs_dupunicode|vs_known;
+	}
+return( state );
     }
 
     k=0;
@@ -1774,17 +1881,20 @@ int SCValidate(SplineChar *sc, int layer, int force) {
 	    if ( othersc==sc )
 	continue;
 	    if ( strcmp(sc->name,othersc->name)==0 )
-		sc->layers[layer].validation_state |= vs_dupname|vs_known;
+		state |= vs_dupname|vs_known;
 	    if ( sc->unicodeenc!=-1 && UniMatch(-1,sc->unicodeenc,othersc) )
-		sc->layers[layer].validation_state |= vs_dupunicode|vs_known;
+		state |= vs_dupunicode|vs_known;
 	    for ( alt=sc->altuni; alt!=NULL; alt=alt->next )
 		if ( UniMatch(alt->vs,alt->unienc,othersc) )
-		    sc->layers[layer].validation_state |= vs_dupunicode|vs_known;
+		    state |= vs_dupunicode|vs_known;
 	}
 	++k;
     } while ( k<cid->subfontcnt );
+return( state );
+}
 
-  end:;
+/* What is checked even when the glyph hasn't changed, and the result */
+static int SCValidateFinish(SplineChar *sc, int layer) {
     /* This test is intentionally here and should be done even if the glyph */
     /*  hasn't changed. If the lookup changed it could make the glyph invalid */
     if ( SCValidateAnchors(sc)!=NULL )
@@ -1797,42 +1907,238 @@ return( sc->layers[layer].validation_state&~(vs_known|vs_selfintersects) );
 return( sc->layers[layer].validation_state&~vs_known );
 }
 
-int SFValidate(SplineFont *sf, int layer, int force) {
-    int k, gid;
+int SCValidate(SplineChar *sc, int layer, int force) {
+
+    if ( !(sc->layers[layer].validation_state&vs_known) || force )
+	sc->layers[layer].validation_state =
+		SCValidateOutlines(sc,layer,SFExtremaBound2(sc->parent)) |
+		SCValidateInFont(sc,layer,NULL);
+return( SCValidateFinish(sc,layer) );
+}
+
+/* The file a validation cache is kept in starts with this line. Each line */
+/*  after it holds the fingerprint of what SCValidateOutlines looked at and */
+/*  what it found, both in hex. Change the version when either changes */
+#define VCACHE_HEADER	"FontForge validation cache 1"
+
+static uint64_t VCHashContours(uint64_t hash,SplineSet *ss) {
+    SplinePoint *sp;
+    int flags;
+
+    for ( ; ss!=NULL; ss=ss->next ) {
+	for ( sp=ss->first; ; ) {
+	    hash = FingerprintAdd(hash,&sp->me,sizeof(BasePoint));
+	    hash = FingerprintAdd(hash,&sp->nextcp,sizeof(BasePoint));
+	    hash = FingerprintAdd(hash,&sp->prevcp,sizeof(BasePoint));
+	    flags = sp->nonextcp | (sp->noprevcp<<1) | (sp->dontinterpolate<<2) |
+		    (sp->roundx<<3) | (sp->roundy<<4) | ((sp->prev!=NULL)<<5);
+	    if ( sp->next!=NULL )
+		flags |= (1<<6) | (sp->next->knownlinear<<7) |
+			(sp->next->order2<<8) | (sp->next->acceptableextrema<<9);
+	    hash = FingerprintAdd(hash,&flags,sizeof(flags));
+	    if ( sp->next==NULL )
+	break;
+	    sp = sp->next->to;
+	    if ( sp==ss->first )
+	break;
+	}
+	flags = -1;			/* End of contour */
+	hash = FingerprintAdd(hash,&flags,sizeof(flags));
+    }
+return( hash );
+}
+
+/* Of everything SCValidateOutlines looks at: the contours of the glyph */
+/*  and then those of its references (in the order LayerAllSplines chains */
+/*  them), how many of them are the glyph's own and the extrema bound */
+static uint64_t SCOutlineFingerprint(SplineChar *sc, int layer, bigreal bound2) {
+    uint64_t hash = FINGERPRINT_START;
+    SplineSet *ss;
+    RefChar *r;
+    int cnt;
+
+    cnt = sizeof(real);
+    hash = FingerprintAdd(hash,&cnt,sizeof(cnt));
+    hash = FingerprintAdd(hash,&bound2,sizeof(bound2));
+    for ( ss=sc->layers[layer].splines, cnt=0; ss!=NULL; ss=ss->next, ++cnt );
+    hash = FingerprintAdd(hash,&cnt,sizeof(cnt));
+    hash = VCHashContours(hash,sc->layers[layer].splines);
+    for ( r=sc->layers[layer].refs; r!=NULL; r=r->next )
+	hash = VCHashContours(hash,r->layers[0].splines);
+return( hash );
+}
+
+/* A cache file which can't be read (it won't exist the first time) is */
+/*  just an empty cache */
+static void VCacheLoad(GHashTable *cache, const char *filename) {
+    FILE *file = fopen(filename,"r");
+    char buffer[100];
+    unsigned long long fingerprint;
+    unsigned int state;
+    gint64 *key;
+
+    if ( file==NULL )
+return;
+    if ( fgets(buffer,sizeof(buffer),file)!=NULL &&
+	    strncmp(buffer,VCACHE_HEADER "\n",sizeof(VCACHE_HEADER))==0 ) {
+	while ( fgets(buffer,sizeof(buffer),file)!=NULL ) {
+	    if ( sscanf(buffer,"%llx %x",&fingerprint,&state)!=2 )
+	continue;
+	    key = malloc(sizeof(gint64));
+	    *key = fingerprint;
+	    /* vs_known keeps a glyph with no errors from looking like no entry */
+	    g_hash_table_replace(cache,key,GINT_TO_POINTER((state&vs_outlines)|vs_known));
+	}
+    }
+    fclose(file);
+}
+
+static void VCacheWriteEntry(gpointer key, gpointer value, gpointer file) {
+    fprintf((FILE *) file,"%016llx %x\n",(unsigned long long) *(gint64 *) key,
+	    GPOINTER_TO_INT(value)&vs_outlines);
+}
+
+/* Written beside the old file and renamed over it, so that a process */
+/*  reading the cache never sees half of it */
+static void VCacheSave(GHashTable *cache, const char *filename) {
+    char *temp = smprintf("%s.%d.tmp", filename, getpid());
+    FILE *file = fopen(temp,"w");
+    int ok;
+
+    if ( file!=NULL ) {
+	fprintf(file,VCACHE_HEADER "\n");
+	g_hash_table_foreach(cache,VCacheWriteEntry,file);
+	ok = !ferror(file);
+	ok = fclose(file)==0 && ok;
+	if ( ok && rename(temp,filename)==0 ) {
+	    free(temp);
+return;
+	}
+	unlink(temp);
+    }
+    LogError(_("Could not write the validation cache %s\n"), filename);
+    free(temp);
+}
+
+struct validatework {
+    SplineChar **glyphs;
+    int layer;
+    int *state;				/* What SCValidateOutlines found */
+    GHashTable *cache;			/* NULL if there is none */
+    uint64_t *fingerprint;
+    uint8 *found;			/* Whether the state came from the cache */
+};
+
+static void SCValidateWork(int i,void *data) {
+    struct validatework *work = data;
+    SplineChar *sc = work->glyphs[i];
+    bigreal bound2 = SFExtremaBound2(sc->parent);
+    int cached;
+
+    if ( work->cache!=NULL ) {
+	work->fingerprint[i] = SCOutlineFingerprint(sc,work->layer,bound2);
+	cached = GPOINTER_TO_INT(g_hash_table_lookup(work->cache,&work->fingerprint[i]));
+	if ( cached!=0 ) {
+	    work->state[i] = cached&vs_outlines;
+	    work->found[i] = true;
+return;
+	}
+    }
+    work->state[i] = SCValidateOutlines(sc,work->layer,bound2);
+}
+
+/* Validates on ff_parallel_jobs threads the outlines of the glyphs which */
+/*  need it (and finds nothing new in the font about glyphs which don't). */
+/*  If cachefile isn't NULL, glyphs whose outlines have a fingerprint in */
+/*  it take what was found from there, and what is found about others is */
+/*  added to it */
+int _SFValidate(SplineFont *sf, int layer, int force, const char *cachefile) {
+    int k, gid, i;
     SplineFont *sub;
     int any = 0;
     SplineChar *sc;
-    int cnt=0;
+    int cnt=0, added=0;
+    struct validatework work;
+    struct dupindex dups;
+    gint64 *key;
 
     if ( sf->cidmaster )
 	sf = sf->cidmaster;
 
-    if ( !no_windowing_ui ) {
-	cnt = 0;
+    cnt = 0;
+    k = 0;
+    do {
+	sub = sf->subfontcnt==0 ? sf : sf->subfonts[k];
+	for ( gid=0; gid<sub->glyphcnt; ++gid ) if ( (sc=sub->glyphs[gid])!=NULL ) {
+	    if ( force || !(sc->layers[layer].validation_state&vs_known) )
+		++cnt;
+	}
+	++k;
+    } while ( k<sf->subfontcnt );
+
+    if ( cnt!=0 ) {
+	memset(&work,0,sizeof(work));
+	work.glyphs = malloc(cnt*sizeof(SplineChar *));
+	work.layer = layer;
+	work.state = calloc(cnt,sizeof(int));
+	i = 0;
 	k = 0;
 	do {
 	    sub = sf->subfontcnt==0 ? sf : sf->subfonts[k];
 	    for ( gid=0; gid<sub->glyphcnt; ++gid ) if ( (sc=sub->glyphs[gid])!=NULL ) {
 		if ( force || !(sc->layers[layer].validation_state&vs_known) )
-		    ++cnt;
+		    work.glyphs[i++] = sc;
 	    }
 	    ++k;
 	} while ( k<sf->subfontcnt );
-	if ( cnt!=0 )
+	if ( cachefile!=NULL ) {
+	    work.cache = g_hash_table_new_full(g_int64_hash,g_int64_equal,free,NULL);
+	    VCacheLoad(work.cache,cachefile);
+	    work.fingerprint = malloc(cnt*sizeof(uint64_t));
+	    work.found = calloc(cnt,sizeof(uint8));
+	}
+
+	if ( !no_windowing_ui )
 	    ff_progress_start_indicator(10,_("Validating..."),_("Validating..."),0,cnt,1);
+	if ( !ParallelFor(cnt,SCValidateWork,&work,true) ) {
+	    /* Nothing has been changed yet, so nothing has been validated */
+	    if ( work.cache!=NULL )
+		g_hash_table_destroy(work.cache);
+	    free(work.glyphs); free(work.state);
+	    free(work.fingerprint); free(work.found);
+return( -1 );
+	}
+
+	/* The rest looks things up by name in the font, which isn't safe */
+	/*  on several threads, but is quick */
+	DupIndexBuild(&dups,sf);
+	for ( i=0; i<cnt; ++i ) {
+	    sc = work.glyphs[i];
+	    sc->layers[layer].validation_state = work.state[i] |
+		    SCValidateInFont(sc,layer,&dups);
+	    if ( work.cache!=NULL && !work.found[i] ) {
+		key = malloc(sizeof(gint64));
+		*key = work.fingerprint[i];
+		g_hash_table_replace(work.cache,key,GINT_TO_POINTER(work.state[i]|vs_known));
+		++added;
+	    }
+	}
+	DupIndexFree(&dups);
+
+	if ( work.cache!=NULL ) {
+	    if ( added!=0 )
+		VCacheSave(work.cache,cachefile);
+	    g_hash_table_destroy(work.cache);
+	}
+	free(work.glyphs); free(work.state);
+	free(work.fingerprint); free(work.found);
     }
 
     k = 0;
     do {
 	sub = sf->subfontcnt==0 ? sf : sf->subfonts[k];
 	for ( gid=0; gid<sub->glyphcnt; ++gid ) if ( (sc=sub->glyphs[gid])!=NULL ) {
-	    if ( force || !(sc->layers[layer].validation_state&vs_known) ) {
-		SCValidate(sc,layer,true);
-		if ( !ff_progress_next())
-return( -1 );
-	    } else if ( SCValidateAnchors(sc)!=NULL )
-		sc->layers[layer].validation_state |= vs_missinganchor;
-
+	    SCValidateFinish(sc,layer);
 	    if ( sc->unlink_rm_ovrlp_save_undo )
 		any |= sc->layers[layer].validation_state&~vs_selfintersects;
 	    else
@@ -1840,17 +2146,23 @@ return( -1 );
 	}
 	++k;
     } while ( k<sf->subfontcnt );
-    ff_progress_end_indicator();
+    if ( cnt!=0 && !no_windowing_ui )
+	ff_progress_end_indicator();
 
     /* a lot of asian ttf files have a bad postscript fontname stored in the */
     /*  name table */
 return( any&~vs_known );
 }
 
+int SFValidate(SplineFont *sf, int layer, int force) {
+return( _SFValidate(sf,layer,force,NULL) );
+}
+
 void SCTickValidationState(SplineChar *sc,int layer) {
     struct splinecharlist *dlist;
 
     sc->layers[layer].validation_state = vs_unknown;
+    sc->layers[layer].bb_splines = NULL;
     for ( dlist=sc->dependents; dlist!=NULL; dlist=dlist->next ) {
 	if ( dlist->sc==sc )
 	    IError("A glyph may not depend on itself in SCTickValidationState");
@@ -2575,6 +2887,7 @@ static void SCHintsChng(SplineChar *sc) {
 	sc->changed = true;
 	sc->parent->changed = true;
     }
+    sc->parent->changed_since_autosave = true;
 }
 
 void instrcheck(SplineChar *sc,int layer) {
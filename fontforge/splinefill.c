@@ -32,6 +32,7 @@
 #include "edgelist.h"
 #include "fontforge.h"
 #include "fvfonts.h"
+#include "parallel.h"
 #include "psread.h"
 #include "splinefont.h"
 #include "splinesaveafm.h"
@@ -1486,22 +1487,65 @@ BDFFont *SplineFontToBDFHeader(SplineFont *_sf, int pixelsize, int indicate) {
 return( bdf );
 }
 
-BDFFont *SplineFontRasterize(SplineFont *_sf, int layer, int pixelsize, int indicate) {
-    BDFFont *bdf = SplineFontToBDFHeader(_sf,pixelsize,indicate);
-    int i,k;
-    SplineFont *sf=_sf;	/* The complexity here is to pick the appropriate subfont of a CID font */
+/* The glyph a strike of _sf shows at i: for a CID font the first subfont */
+/*  with something worth outputting there */
+static SplineChar *BDFSourceGlyph(SplineFont *_sf, int i) {
+    SplineFont *sf = _sf;
+    int k;
+
+    for ( k=0; k<_sf->subfontcnt; ++k ) if ( _sf->subfonts[k]->glyphcnt>i ) {
+	sf = _sf->subfonts[k];
+	if ( SCWorthOutputting(sf->glyphs[i]))
+    break;
+    }
+return( sf->glyphs[i] );
+}
+
+struct strikework {
+    SplineFont *sf;
+    BDFFont *bdf;
+    int layer;
+    int pixelsize;
+    int linear_scale;		/* 1 for a bitmap */
+};
+
+static void BDFStrikeWork(int i, void *data) {
+    struct strikework *sw = data;
+    SplineChar *sc = BDFSourceGlyph(sw->sf,i);
+
+    sw->bdf->glyphs[i] = SplineCharRasterize(sc,sw->layer,sw->pixelsize*sw->linear_scale);
+    if ( sw->linear_scale!=1 )
+	BDFCAntiAlias(sw->bdf->glyphs[i],sw->linear_scale);
+}
+
+/* Each glyph is rasterized on its own, into its own slot of bdf->glyphs, */
+/*  so the glyphs of a strike may be spread over several threads. Patterns */
+/*  in multilayered fonts rasterize other glyphs though (PatternPrep), */
+/*  which must not happen while those are being done elsewhere */
+static void BDFFillStrike(SplineFont *_sf, BDFFont *bdf, int layer,
+	int pixelsize, int linear_scale, int indicate) {
+    struct strikework sw;
+    int i;
 
+    sw.sf = _sf;
+    sw.bdf = bdf;
+    sw.layer = layer;
+    sw.pixelsize = pixelsize;
+    sw.linear_scale = linear_scale;
+    if ( !_sf->multilayer && ParallelJobCount(bdf->glyphcnt)>1 ) {
+	ParallelFor(bdf->glyphcnt,BDFStrikeWork,&sw,indicate);
+return;
+    }
     for ( i=0; i<bdf->glyphcnt; ++i ) {
-	if ( _sf->subfontcnt!=0 ) {
-	    for ( k=0; k<_sf->subfontcnt; ++k ) if ( _sf->subfonts[k]->glyphcnt>i ) {
-		sf = _sf->subfonts[k];
-		if ( SCWorthOutputting(sf->glyphs[i]))
-	    break;
-	    }
-	}
-	bdf->glyphs[i] = SplineCharRasterize(sf->glyphs[i],layer,pixelsize);
+	BDFStrikeWork(i,&sw);
 	if ( indicate ) ff_progress_next();
     }
+}
+
+BDFFont *SplineFontRasterize(SplineFont *_sf, int layer, int pixelsize, int indicate) {
+    BDFFont *bdf = SplineFontToBDFHeader(_sf,pixelsize,indicate);
+
+    BDFFillStrike(_sf,bdf,layer,pixelsize,1,indicate);
     if ( indicate ) ff_progress_end_indicator();
 return( bdf );
 }
@@ -1605,7 +1649,7 @@ return( bc );
 
 BDFFont *SplineFontAntiAlias(SplineFont *_sf, int layer, int pixelsize, int linear_scale) {
     BDFFont *bdf;
-    int i,k;
+    int i;
     real scale;
     char size[40];
     char aa[200];
@@ -1644,19 +1688,7 @@ return( SplineFontRasterize(_sf,layer,pixelsize,true));
     bdf->ascent = rint(sf->ascent*scale);
     bdf->descent = pixelsize-bdf->ascent;
     bdf->res = -1;
-    for ( i=0; i<max; ++i ) {
-	if ( _sf->subfontcnt!=0 ) {
-	    for ( k=0; k<_sf->subfontcnt; ++k ) if ( _sf->subfonts[k]->glyphcnt>i ) {
-		sf = _sf->subfonts[k];
-		if ( SCWorthOutputting(sf->glyphs[i]))
-	    break;
-	    }
-	    scale = pixelsize / (real) (sf->ascent+sf->descent);
-	}
-	bdf->glyphs[i] = SplineCharRasterize(sf->glyphs[i],layer,pixelsize*linear_scale);
-	BDFCAntiAlias(bdf->glyphs[i],linear_scale);
-	ff_progress_next();
-    }
+    BDFFillStrike(_sf,bdf,layer,pixelsize,linear_scale,true);
     BDFClut(bdf,linear_scale);
     ff_progress_end_indicator();
 return( bdf );
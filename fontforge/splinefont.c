@@ -957,6 +957,20 @@ char *SFSubfontnameStart(char *fname) {
 
 /* This does not check currently existing fontviews, and should only be used */
 /*  by LoadSplineFont (which does) and by RevertFile (which knows what it's doing) */
+static SplineFont *RestrictedFontCheck(SplineFont *sf,enum openflags openflags) {
+    if ( (openflags&of_fstypepermitted) && sf!=NULL && (sf->pfminfo.fstype&0xff)==0x0002 ) {
+	    /* Ok, they have told us from a script they have access to the font */
+    } else if ( sf!=NULL && (sf->pfminfo.fstype&0xff)==0x0002 ) {
+	    char *buts[3];
+	    buts[0] = _("_Yes"); buts[1] = _("_No"); buts[2] = NULL;
+	    if ( ff_ask(_("Restricted Font"),(const char **) buts,1,1,_("This font is marked with an FSType of 2 (Restricted\nLicense). That means it is not editable without the\npermission of the legal owner.\n\nDo you have such permission?"))==1 ) {
+	        SplineFontFree(sf);
+                sf = NULL;
+	    }
+    }
+return( sf );
+}
+
 SplineFont *_ReadSplineFont(FILE *file, const char *filename, enum openflags openflags) {
     SplineFont *sf;
     char ubuf[251], *temp;
@@ -1128,6 +1142,8 @@ SplineFont *_ReadSplineFont(FILE *file, const char *filename, enum openflags ope
 		(ch1=='t' && ch2=='r' && ch3=='u' && ch4=='e') ||
 		(ch1=='t' && ch2=='t' && ch3=='c' && ch4=='f') ) {
 	    sf = _SFReadTTF(file,0,openflags,strippedname,chosenname,NULL);
+	    if ( sf!=NULL && sf->lazy!=NULL )
+		file = NULL;		/* The font keeps reading from it */
 	    checked = 't';
 	} else if ( ch1=='w' && ch2=='O' && ch3=='F' && ch4=='F' ) {
 	    sf = _SFReadWOFF(file,0,openflags,strippedname,chosenname,NULL);
@@ -1164,7 +1180,7 @@ SplineFont *_ReadSplineFont(FILE *file, const char *filename, enum openflags ope
 	    }
 	    checked = 'S';
 	} else if ( ch1=='S' && ch2=='p' && ch3=='l' && ch4=='i' ) {
-	    sf = _SFDRead(fullname,file); file = NULL;
+	    sf = _SFDRead(fullname,file,openflags); file = NULL;
 	    checked = 'f';
 	    fromsfd = true;
 	} else if ( ch1=='S' && ch2=='T' && ch3=='A' && ch4=='R' ) {
@@ -1243,6 +1259,9 @@ SplineFont *_ReadSplineFont(FILE *file, const char *filename, enum openflags ope
 
     if ( sf!=NULL ) {
 	    SplineFont *norm = sf->mm!=NULL ? sf->mm->normal : sf;
+	    /* Loaders set code points and names directly, perhaps after */
+	    /*  looking some glyphs up, so don't trust what was hashed then */
+	    GlyphHashFree(sf);
 	    if ( compression!=0 ) {
 	        free(sf->filename);
 	        *strrchr(oldstrippedname,'.') = '\0';
@@ -1292,16 +1311,8 @@ SplineFont *_ReadSplineFont(FILE *file, const char *filename, enum openflags ope
     }
     if ( wasarchived )
 	    ArchiveCleanup(archivedir);
-    if ( (openflags&of_fstypepermitted) && sf!=NULL && (sf->pfminfo.fstype&0xff)==0x0002 ) {
-	    /* Ok, they have told us from a script they have access to the font */
-    } else if ( !fromsfd && sf!=NULL && (sf->pfminfo.fstype&0xff)==0x0002 ) {
-	    char *buts[3];
-	    buts[0] = _("_Yes"); buts[1] = _("_No"); buts[2] = NULL;
-	    if ( ff_ask(_("Restricted Font"),(const char **) buts,1,1,_("This font is marked with an FSType of 2 (Restricted\nLicense). That means it is not editable without the\npermission of the legal owner.\n\nDo you have such permission?"))==1 ) {
-	        SplineFontFree(sf);
-                sf = NULL;
-	    }
-    }
+    if ( !fromsfd )
+	    sf = RestrictedFontCheck(sf,openflags);
     if (fname != NULL && fname != filename) free(fname); fname = NULL;
     return sf;
 }
@@ -1310,6 +1321,52 @@ SplineFont *ReadSplineFont(const char *filename,enum openflags openflags) {
 return( _ReadSplineFont(NULL,filename,openflags));
 }
 
+/* Reads an sfnt (or WOFF) font from len bytes of memory. The font has no */
+/*  file associated with it, just like a new one */
+SplineFont *ReadSplineFontFromMemory(const void *data,size_t len,enum openflags openflags) {
+    const uint8 *pt = data;
+    SplineFont *sf = NULL, *norm;
+    FILE *file;
+    int j;
+
+    if ( len<4 || (file = GFileMemOpen(data,len))==NULL )
+return( NULL );
+    ff_progress_start_indicator(FontViewFirst()==NULL?0:10,_("Loading..."),
+	    _("Loading font from memory"),_("Reading Glyphs"),0,1);
+    ff_progress_enable_stop(0);
+    if (( pt[0]==0 && pt[1]==1 && pt[2]==0 && pt[3]==0 ) ||
+	    (pt[0]=='O' && pt[1]=='T' && pt[2]=='T' && pt[3]=='O') ||
+	    (pt[0]=='t' && pt[1]=='r' && pt[2]=='u' && pt[3]=='e') ||
+	    (pt[0]=='t' && pt[1]=='t' && pt[2]=='c' && pt[3]=='f') )
+	/* The data aren't ours to keep, so no lazy reading */
+	sf = _SFReadTTF(file,0,openflags&~of_lazy,NULL,NULL,NULL);
+    else if ( pt[0]=='w' && pt[1]=='O' && pt[2]=='F' && pt[3]=='F' )
+	sf = _SFReadWOFF(file,0,openflags,NULL,NULL,NULL);
+#ifdef FONTFORGE_CAN_USE_WOFF2
+    else if ( pt[0]=='w' && pt[1]=='O' && pt[2]=='F' && pt[3]=='2' )
+	sf = _SFReadWOFF2(file,0,openflags,NULL,NULL,NULL);
+#endif
+    else
+	ff_post_error(_("Couldn't open font"),_("The data are not an sfnt or WOFF font"));
+    fclose(file);
+    ff_progress_end_indicator();
+
+    if ( sf!=NULL ) {
+	norm = sf->mm!=NULL ? sf->mm->normal : sf;
+	free(norm->origname); norm->origname = NULL;
+	free(norm->filename); norm->filename = NULL;
+	free(norm->chosenname); norm->chosenname = NULL;
+	norm->new = true;
+	if ( sf->mm!=NULL ) {
+	    for ( j=0; j<sf->mm->instance_count; ++j ) {
+		free(sf->mm->instances[j]->origname);
+		sf->mm->instances[j]->origname = NULL;
+	    }
+	}
+    }
+return( RestrictedFontCheck(sf,openflags));
+}
+
 char *ToAbsolute(char *filename) {
     char buffer[1025];
 
@@ -1335,6 +1335,10 @@ typedef struct layer /* : reflayer */{
     uint32 old_vs;
     void *python_persistent;		/* If python this will hold a python object, if not python this will hold a string containing a pickled object. We do nothing with it (if not python) except save it back out unchanged */
     int python_persistent_has_lists;
+    uint64_t ufo_fingerprint;		/* Of the glif for this layer in the font's ufo_dir, as it was at ufo_time. 0 if unknown */
+    DBounds bb, clipbb;			/* Of splines (and of its clip path), when the splines were bb_splines */
+    SplinePointList *bb_splines;	/*  at bb_generation. NULL if not yet figured */
+    int bb_generation;
 } Layer;
 
 enum layer_type { ly_all=-2, ly_grid= -1, ly_back=0, ly_fore=1,
@@ -1444,6 +1448,21 @@ enum validation_state { vs_unknown = 0,
 
 struct splinecharlist { struct splinechar *sc; struct splinecharlist *next;};
 
+/* When a font is opened lazily (of_lazy) glyph outlines are left in the */
+/*  file and only read in (by SCLoadLazy) when something needs them */
+struct lazyoutline {
+    long offset;		/* Where the outline starts in the file */
+    long end;			/* (TrueType) and where it ends */
+    int layer;			/* (sfd) -1 for the TrueType instructions */
+    struct lazyoutline *next;
+};
+
+struct lazyglyphs {
+    FILE *file;			/* Kept open until all outlines are read */
+    void (*load)(struct splinechar *sc,struct lazyglyphs *lazy);
+    unsigned int order2: 1;	/* (TrueType) Keep quadratic splines */
+};
+
 struct altuni { struct altuni *next; int32 unienc, vs; uint32 fid; };
 	/* vs is the "variation selector" a unicode codepoint which modifieds */
 	/*  the code point before it. If vs is -1 then unienc is just an */
@@ -1555,6 +1574,8 @@ typedef struct splinechar {
     DBounds tile_bounds;
     char * glif_name; // This stores the base name of the glyph when saved to U. F. O..
     unichar_t* user_decomp; // User decomposition for building this character
+    struct lazyoutline *lazy;		/* Outlines not yet read from the font file */
+    uint64_t autosave_fingerprint;	/* Of what the autosave holds for us, 0 if nothing */
 } SplineChar;
 
 #define TEX_UNDEF 0x7fff
@@ -1862,6 +1883,9 @@ typedef struct splinefont {
     BDFFont *bitmaps;
     char *origname;		/* filename of font file (ie. if not an sfd) */
     char *autosavename;
+    long autosave_base;		/* Bytes in the last full autosave, 0 if there is none yet (or it holds a glyph since removed) */
+    long autosave_journal;	/* Bytes of changes appended to it since */
+    int autosave_appends;	/* Number of blocks of changes appended */
     int display_size;		/* a val <0 => Generate our own images from splines, a value >0 => find a bdf font of that size */
     struct psdict *private;	/* read in from type1 file or provided by user */
     char *xuid;
@@ -1882,6 +1906,7 @@ typedef struct splinefont {
     int top_enc;
     uint16 desired_row_cnt, desired_col_cnt;
     struct glyphnamehash *glyphnames;
+    struct glyphunihash *glyphunis;
     struct ttf_table *ttf_tables, *ttf_tab_saved;
 	/* We copy: fpgm, prep, cvt, maxp (into ttf_tables) user can ask for others, into saved*/
     char **cvt_names;
@@ -1963,6 +1988,12 @@ typedef struct splinefont {
     char *styleMapFamilyName;
     struct sfundoes *undoes;
     int preferred_kerning; // 1 for U. F. O. native, 2 for feature file, 0 undefined. Input functions shall flag 2, I think. This is now in S. F. D. in order to round-trip U. F. O. consistently.
+    struct lazyglyphs *lazy;		/* Non-NULL while some glyphs have outlines still in the file */
+    char *ufo_dir;			/* Absolute name of the U. F. O. last read or written, so saving there again can skip unchanged glyphs */
+    long long ufo_time;			/* When that read or write began */
+    struct autohintcache *ahcache;	/* Stems autohinting has found, by fingerprint of what they depend on */
+    struct ftcache *ftcache;		/* FreeType contexts kept for rasterizing glyphs (freetype.c) */
+    struct sfdirprints *sfdir_prints;	/* Of the files in the sfdir last read or written, so saving there again can skip unchanged glyphs (sfd.c) */
 } SplineFont;
 
 struct axismap {
@@ -2051,7 +2082,8 @@ enum ttf_flags {
 };
 enum ttc_flags { ttc_flag_trymerge=0x1, ttc_flag_cff=0x2 };
 enum openflags { of_fstypepermitted=1, /*of_askcmap=2,*/ of_all_glyphs_in_ttc=4,
-	of_fontlint=8, of_hidewindow=0x10, of_all_tables=0x20 };
+	of_fontlint=8, of_hidewindow=0x10, of_all_tables=0x20,
+	of_lazy=0x40 };
 enum ps_flags { ps_flag_nohintsubs = 0x10000, ps_flag_noflex=0x20000,
 		    ps_flag_nohints = 0x40000, ps_flag_restrict256=0x80000,
 		    ps_flag_afm = 0x100000, ps_flag_pfm = 0x200000,
@@ -2065,6 +2097,8 @@ enum ps_flags { ps_flag_nohintsubs = 0x10000, ps_flag_noflex=0x20000,
 		    ps_flag_afmwithmarks = 0x4000000,
 		    ps_flag_noseac = 0x8000000,
 		    ps_flag_outputfontlog = 0x10000000,
+/* The other bits are all taken by ttf_flags, which share these flags */
+		    ps_flag_subroutinize = (int) 0x80000000,
 		    ps_flag_mask = (ps_flag_nohintsubs|ps_flag_noflex|
 			ps_flag_afm|ps_flag_pfm|ps_flag_tfm|ps_flag_round)
 		};
@@ -2087,8 +2121,8 @@ struct findsel;
 struct charprocs;
 struct enc;
 
-#define chunkalloc(size)	calloc(1,size)
-#define chunkfree(item,size)	free(item)
+extern void *chunkalloc(int size);
+extern void chunkfree(void *item,int size);
 
 extern char *strconcat(const char *str, const char *str2);
 
@@ -2309,6 +2343,7 @@ extern void InitGlobalInstrCt( GlobalInstrCt *gic,SplineFont *sf,int layer,
 	BlueData *bd );
 extern void FreeGlobalInstrCt( GlobalInstrCt *gic );
 extern void NowakowskiSCAutoInstr( GlobalInstrCt *gic,SplineChar *sc );
+extern void NowakowskiSFAutoInstr( GlobalInstrCt *gic,SplineChar **glyphs,int cnt );
 extern void CVT_ImportPrivate(SplineFont *sf);
 
 extern void SplineFontAutoHint( SplineFont *sf, int layer);
@@ -2324,6 +2359,7 @@ extern SplineFont *SFReadUFO(char *filename,int flags);
 extern SplineFont *LoadSplineFont(const char *filename,enum openflags);
 extern SplineFont *_ReadSplineFont(FILE *file, const char *filename, enum openflags openflags);
 extern SplineFont *ReadSplineFont(const char *filename,enum openflags);	/* Don't use this, use LoadSF instead */
+extern SplineFont *ReadSplineFontFromMemory(const void *data,size_t len,enum openflags openflags);
 extern void ArchiveCleanup(char *archivedir);
 extern char *Unarchive(char *name, char **_archivedir);
 extern char *Decompress(char *name, int compression);
@@ -2387,6 +2423,7 @@ extern BDFFont *SplineFontFreeTypeRasterize(void *freetypecontext,int pixelsize,
 extern BDFChar *SplineCharFreeTypeRasterize(void *freetypecontext,int gid,
 	int ptsize, int dpi,int depth);
 extern void FreeTypeFreeContext(void *freetypecontext);
+extern void FreeTypeCacheFree(struct ftcache *cache);
 extern SplineSet *FreeType_GridFitChar(void *single_glyph_context,
 	int enc, real ptsizey, real ptsizex, int dpi, uint16 *width,
 	SplineChar *sc, int depth, int scaled);
@@ -2513,6 +2550,7 @@ extern AnchorClass *SCValidateAnchors(SplineChar *sc);
 extern void SCTickValidationState(SplineChar *sc,int layer);
 extern int ValidatePrivate(SplineFont *sf);
 extern int SFValidate(SplineFont *sf, int layer, int force);
+extern int _SFValidate(SplineFont *sf, int layer, int force, const char *cachefile);
 extern int VSMaskFromFormat(SplineFont *sf, int layer, enum fontformat format);
 
 extern char *RandomParaFromScript(uint32 script, uint32 *lang, SplineFont *sf);
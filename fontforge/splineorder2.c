@@ -1243,6 +1243,7 @@ void SplineRefigure2(Spline *spline) {
     if ( RealNear(from->me.x,to->me.x) && RealNear(from->me.y,to->me.y))
 	IError("Zero length spline created");
 #endif
+    SplinesChanged();
     if ( spline->acceptableextrema )
 	old = *spline;
 
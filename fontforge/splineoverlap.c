@@ -30,6 +30,7 @@
 #include "splineoverlap.h"
 
 #include "edgelist2.h"
+#include "ffglib.h"
 #include "fontforge.h"
 #include "gwidget.h"		/* For PostNotice */
 #include "splinefont.h"
@@ -89,16 +90,26 @@
 // (The pointers tend to clutter the diff a bit.)
 // #define FF_OVERLAP_VERBOSE
 
-static char *glyphname=NULL;
+/* The name of the glyph being worked on, per thread, since several glyphs */
+/*  may have their overlaps removed at once */
+static GPrivate glyphname = G_PRIVATE_INIT(NULL);
+
+static void SOReport(const char *what,const char *format,va_list ap) {
+    const char *name = g_private_get(&glyphname);
+    char *msg = vsmprintf(format,ap);
+
+    /* In one go, so that reports from different threads don't get mixed up */
+    if ( name==NULL )
+	fprintf(stderr, "%s (overlap): %s", what, msg );
+    else
+	fprintf(stderr, "%s (overlap) in %s: %s", what, name, msg );
+    free(msg);
+}
 
 static void SOError(const char *format,...) {
     va_list ap;
     va_start(ap,format);
-    if ( glyphname==NULL )
-	fprintf(stderr, "Internal Error (overlap): " );
-    else
-	fprintf(stderr, "Internal Error (overlap) in %s: ", glyphname );
-    vfprintf(stderr,format,ap);
+    SOReport("Internal Error",format,ap);
     va_end(ap);
 }
 
@@ -106,11 +117,7 @@ static void SONotify(const char *format,...) {
     va_list ap;
     va_start(ap,format);
 #ifdef FF_OVERLAP_VERBOSE
-    if ( glyphname==NULL )
-	fprintf(stderr, "Note (overlap): " );
-    else
-	fprintf(stderr, "Note (overlap) in %s: ", glyphname );
-    vfprintf(stderr,format,ap);
+    SOReport("Note",format,ap);
 #endif
     va_end(ap);
 }
@@ -1339,10 +1346,12 @@ static Intersection *_AddIntersection(Intersection *ilist,Monotonic *m1,
     /* I tried changing from Within16 to Within64 here, and below, and the */
     /*  result was that I cause more new errors (about 6) than I fixed old(1) */
     for ( il = ilist; il!=NULL; il=il->next ) {
+#ifdef FF_OVERLAP_VERBOSE
 ValidateMListTs_IF_VERBOSE(il->monos)
 	SONotify("Compare (%f, %f) to (%f, %f): x %s, y %s...", inter->x, inter->y, il->inter.x, il->inter.y,
           Within4RoundingErrors(il->inter.x,inter->x) ? "yes" : "no",
           Within4RoundingErrors(il->inter.y,inter->y) ? "yes" : "no");
+#endif
 	if ( Within16RoundingErrors(il->inter.x,inter->x) && Within16RoundingErrors(il->inter.y,inter->y)) {
             SONotify(" maybe.\n");
 	    if ( (dx = il->inter.x-inter->x)<0 ) dx = -dx; // We want absolute values.
@@ -1354,9 +1363,12 @@ ValidateMListTs_IF_VERBOSE(il->monos)
 		if ( dist==0 )
     break;
 	    }
-	} else {
+	}
+#ifdef FF_OVERLAP_VERBOSE
+	else {
           SONotify(" off by (%.12f, %.12f).\n", il->inter.x-inter->x, il->inter.y-inter->y);
         }
+#endif
     }
 
     if ( m1->tstart==0 && m1->start==NULL &&
@@ -1426,9 +1438,11 @@ ValidateMListTs_IF_VERBOSE(closest->monos)
         AddSpline(closest,m2,t2);
 ValidateMListTs_IF_VERBOSE(closest->monos)
     }
+#ifdef FF_OVERLAP_VERBOSE
           for ( il = ilist; il!=NULL; il=il->next ) {
 ValidateMListTs_IF_VERBOSE(il->monos)
           }
+#endif
 return( ilist );
 }
 
@@ -1438,9 +1452,11 @@ static Intersection *AddIntersection(Intersection *ilist,Monotonic *m1,
     extended ot1 = t1, ot2 = t2;
 // ValidateMonotonic(m1);
 // ValidateMonotonic(m2);
+#ifdef FF_OVERLAP_VERBOSE
     for ( il = ilist; il!=NULL; il=il->next ) {
 ValidateMListTs_IF_VERBOSE(il->monos)
     }
+#endif
     /* This is just a join between two adjacent monotonics. There might already*/
     /*  be an intersection there, but if there be, we've already found it */
     /* Do this now, because no point wasting the time it takes to ImproveInter*/
@@ -1540,9 +1556,11 @@ return( ilist );
 	    ((RealWithin(m2->tstart,t2,.01) && m2->start==il) ||
 	     (RealWithin(m2->tend,t2,.01) && m2->end==il)) )
 return( ilist );
+#ifdef FF_OVERLAP_VERBOSE
     for ( il = ilist; il!=NULL; il=il->next ) {
 ValidateMListTs_IF_VERBOSE(il->monos)
     }
+#endif
 // ValidateMonotonic(m1);
 // ValidateMonotonic(m2);
 // If all else fails, we try to add an intersection.
@@ -1561,18 +1579,24 @@ static Intersection *SplitMonotonicsAt(Monotonic *m1,Monotonic *m2,
 	 Within64RoundingErrors(coord,((m2->s->splines[which].a*m2->tstart+m2->s->splines[which].b)*m2->tstart+m2->s->splines[which].c)*m2->tstart+m2->s->splines[which].d) ||
 	 Within64RoundingErrors(coord,((m2->s->splines[which].a*m2->tend+m2->s->splines[which].b)*m2->tend+m2->s->splines[which].c)*m2->tend+m2->s->splines[which].d ) )
 return( ilist );
+#ifdef FF_OVERLAP_VERBOSE
     for ( Intersection * il = ilist; il!=NULL; il=il->next ) {
 ValidateMListTs_IF_VERBOSE(il->monos)
     }
+#endif
     SplitMonotonicAtFake(m1,which,coord,&id1);
     SplitMonotonicAtFake(m2,which,coord,&id2);
+#ifdef FF_OVERLAP_VERBOSE
     for ( Intersection * il = ilist; il!=NULL; il=il->next ) {
 ValidateMListTs_IF_VERBOSE(il->monos)
     }
+#endif
     if ( !id1.new && !id2.new ) {
+#ifdef FF_OVERLAP_VERBOSE
     for ( Intersection * il = ilist; il!=NULL; il=il->next ) {
 ValidateMListTs_IF_VERBOSE(il->monos)
     }
+#endif
 return( ilist );
     }
     if ( !id1.new )
@@ -2281,47 +2305,126 @@ static void FigureProperMonotonicsAtIntersections(Intersection *ilist) {
     }
 }
 
+struct monosweep {
+    Monotonic *m;
+    int index;			/* Position in the linked list */
+};
+
+struct monopair {
+    int first, second;		/* first<second */
+};
+
+static int msweepcmp(const void *_ms1, const void *_ms2) {
+    const struct monosweep *ms1 = _ms1, *ms2 = _ms2;
+    if ( ms1->m->b.minx>ms2->m->b.minx )
+return( 1 );
+    else if ( ms1->m->b.minx<ms2->m->b.minx )
+return( -1 );
+
+return( ms1->index-ms2->index );
+}
+
+static int mpaircmp(const void *_mp1, const void *_mp2) {
+    const struct monopair *mp1 = _mp1, *mp2 = _mp2;
+    if ( mp1->first!=mp2->first )
+return( mp1->first-mp2->first );
+
+return( mp1->second-mp2->second );
+}
+
+/* Returns the pairs of monotonics whose bounding boxes overlap, in the order */
+/*  the obvious double loop over the linked list would meet them (so that */
+/*  the pending lists, and therefore the results, don't change). Rather than */
+/*  comparing every pair we sweep across the monotonics in order of their */
+/*  left edges, keeping only those whose right edges we haven't yet passed */
+static struct monopair *OverlappingMonotonics(Monotonic *ms,Monotonic ***_mons,int *_pcnt) {
+    struct monosweep *byx, **active, *cur;
+    struct monopair *pairs;
+    Monotonic *m, **mons;
+    int cnt, acnt, pcnt, pmax, i, j, k;
+
+    for ( m=ms, cnt=0; m!=NULL; m=m->linked, ++cnt );
+    mons = malloc((cnt+1)*sizeof(Monotonic *));
+    byx = malloc((cnt+1)*sizeof(struct monosweep));
+    active = malloc((cnt+1)*sizeof(struct monosweep *));
+    for ( m=ms, i=0; m!=NULL; m=m->linked, ++i ) {
+	mons[i] = byx[i].m = m;
+	byx[i].index = i;
+    }
+    qsort(byx,cnt,sizeof(struct monosweep),msweepcmp);
+
+    pmax = cnt+10; pcnt = 0;
+    pairs = malloc(pmax*sizeof(struct monopair));
+    for ( k=acnt=0; k<cnt; ++k ) {
+	cur = &byx[k];
+	for ( i=j=0; i<acnt; ++i ) {
+	    if ( active[i]->m->b.maxx < cur->m->b.minx )
+	continue;		/* Everything from now on is further right */
+	    active[j++] = active[i];
+	    if ( active[i]->m->b.miny > cur->m->b.maxy ||
+		    active[i]->m->b.maxy < cur->m->b.miny )
+	continue;
+	    if ( pcnt>=pmax )
+		pairs = realloc(pairs,(pmax*=2)*sizeof(struct monopair));
+	    if ( active[i]->index<cur->index ) {
+		pairs[pcnt].first = active[i]->index;
+		pairs[pcnt++].second = cur->index;
+	    } else {
+		pairs[pcnt].first = cur->index;
+		pairs[pcnt++].second = active[i]->index;
+	    }
+	}
+	acnt = j;
+	active[acnt++] = cur;
+    }
+    qsort(pairs,pcnt,sizeof(struct monopair),mpaircmp);
+    free(byx);
+    free(active);
+    *_mons = mons;
+    *_pcnt = pcnt;
+return( pairs );
+}
+
 static Intersection *FindIntersections(Monotonic **ms, enum overlap_type ot) {
-    Monotonic *m1, *m2;
+    Monotonic *m1, *m2, **mons;
     BasePoint pts[9];
     extended t1s[10], t2s[10];
     Intersection *ilist=NULL;
-    int i;
-    // For each monotonic, check against each other monotonic for an intersection.
-    for ( m1=*ms; m1!=NULL; m1=m1->linked ) {
-	for ( m2=m1->linked; m2!=NULL; m2=m2->linked ) {
-	    if ( m2->b.minx > m1->b.maxx ||
-		    m2->b.maxx < m1->b.minx ||
-		    m2->b.miny > m1->b.maxy ||
-		    m2->b.maxy < m1->b.miny )
-	continue;		/* Can't intersect since they don't have overlapping bounding boxes */
-	    // ValidateMonotonic(m1); ValidateMonotonic(m2);
-	    if ( CoincidentIntersect(m1,m2,pts,t1s,t2s) ) {
-		// If the splines are nearly coincident, we add up to 4 preintersections with the close flag.
+    struct monopair *pairs;
+    int i, p, pcnt;
+    // For each pair of monotonics whose bounding boxes overlap, check for an intersection.
+    pairs = OverlappingMonotonics(*ms,&mons,&pcnt);
+    for ( p=0; p<pcnt; ++p ) {
+	m1 = mons[pairs[p].first];
+	m2 = mons[pairs[p].second];
+	// ValidateMonotonic(m1); ValidateMonotonic(m2);
+	if ( CoincidentIntersect(m1,m2,pts,t1s,t2s) ) {
+	    // If the splines are nearly coincident, we add up to 4 preintersections with the close flag.
+	    for ( i=0; i<4 && t1s[i]!=-1; ++i ) {
+		if ( t1s[i]>=m1->tstart && t1s[i]<=m1->tend &&
+			t2s[i]>=m2->tstart && t2s[i]<=m2->tend ) {
+		    AddPreIntersection(m1,m2,t1s[i],t2s[i],&pts[i],true);
+		}
+	    }
+	} else if ( m1->s->knownlinear || m2->s->knownlinear ) {
+	    // The splines are non-coincident and linear.
+	    // We look for all intersections between the splines.
+	    // Assignment to specific monotonics happens in TurnPreInter2Inter.
+	    // SplinesIntersect returns a maximum of four intersections.
+	    // That is okay if one spline is linear. Otherwise, there may be more.
+	    if ( SplinesIntersect(m1->s,m2->s,pts,t1s,t2s)>0 )
 		for ( i=0; i<4 && t1s[i]!=-1; ++i ) {
 		    if ( t1s[i]>=m1->tstart && t1s[i]<=m1->tend &&
 			    t2s[i]>=m2->tstart && t2s[i]<=m2->tend ) {
-			AddPreIntersection(m1,m2,t1s[i],t2s[i],&pts[i],true);
+			AddPreIntersection(m1,m2,t1s[i],t2s[i],&pts[i],false);
 		    }
 		}
-	    } else if ( m1->s->knownlinear || m2->s->knownlinear ) {
-		// The splines are non-coincident and linear.
-		// We look for all intersections between the splines.
-		// Assignment to specific monotonics happens in TurnPreInter2Inter.
-		// SplinesIntersect returns a maximum of four intersections.
-		// That is okay if one spline is linear. Otherwise, there may be more.
-		if ( SplinesIntersect(m1->s,m2->s,pts,t1s,t2s)>0 )
-		    for ( i=0; i<4 && t1s[i]!=-1; ++i ) {
-			if ( t1s[i]>=m1->tstart && t1s[i]<=m1->tend &&
-				t2s[i]>=m2->tstart && t2s[i]<=m2->tend ) {
-			    AddPreIntersection(m1,m2,t1s[i],t2s[i],&pts[i],false);
-			}
-		    }
-	    } else {
-		FindMonotonicIntersection(m1,m2);
-	    }
+	} else {
+	    FindMonotonicIntersection(m1,m2);
 	}
     }
+    free(pairs);
+    free(mons);
 
     ilist = TurnPreInter2Inter(*ms);
     FigureProperMonotonicsAtIntersections(ilist);
@@ -2418,49 +2521,174 @@ int CheckMonotonicClosed(struct monotonic *ms) {
   return 1;
 }
 
-int MonotonicFindAt(Monotonic *ms,int which, extended test, Monotonic **space ) {
+static int MonotonicAddAt(Monotonic *m,int which, extended test, Monotonic **space, int i) {
+    /* If m crosses the line (x,y)[which] == test, find the value of the */
+    /*  other coord there and add m to space[i]. Returns the new count */
+    extended t;
+    int nw = !which;
+
+    if ( !(( which==0 && test >= m->b.minx && test <= m->b.maxx ) ||
+	    ( which==1 && test >= m->b.miny && test <= m->b.maxy )))
+return( i );
+    if (CheckMonotonicClosed(m) == 0)
+return( i );		/* Open monotonics break things. */
+    /* Lines parallel to the direction we are testing just get in the */
+    /*  way and don't add any useful info */
+    if ( m->s->knownlinear &&
+	    (( which==1 && m->s->from->me.y==m->s->to->me.y ) ||
+		(which==0 && m->s->from->me.x==m->s->to->me.x)))
+return( i );
+    t = IterateSplineSolveFixup(&m->s->splines[which],m->tstart,m->tend,test);
+    if ( t==-1 ) {
+	if ( which==0 ) {
+	    if (( test-m->b.minx > m->b.maxx-test && m->xup ) ||
+		    ( test-m->b.minx < m->b.maxx-test && !m->xup ))
+		t = m->tstart;
+	    else
+		t = m->tend;
+	} else {
+	    if (( test-m->b.miny > m->b.maxy-test && m->yup ) ||
+		    ( test-m->b.miny < m->b.maxy-test && !m->yup ))
+		t = m->tstart;
+	    else
+		t = m->tend;
+	}
+    }
+    m->t = t;
+    if ( t==m->tend ) t -= (m->tend-m->tstart)/100;
+    else if ( t==m->tstart ) t += (m->tend-m->tstart)/100;
+    m->other = ((m->s->splines[nw].a*t+m->s->splines[nw].b)*t+
+	    m->s->splines[nw].c)*t+m->s->splines[nw].d;
+    space[i++] = m;
+return( i );
+}
+
+/* An index of the monotonics by their extent along each axis, so that */
+/*  finding the ones which cross a line doesn't mean looking at them all. */
+/*  The range covered by the monotonics is cut into equal buckets, and each */
+/*  bucket lists (in the order of the linked list) the monotonics which */
+/*  overlap it. A monotonic which gets split after the index is built still */
+/*  lies within its original bounds, and the new piece follows it on the */
+/*  linked list, so we find the pieces by walking along the linked list */
+/*  until we reach the monotonic which used to follow it */
+struct monoentry {
+    Monotonic *m;
+    Monotonic *next;		/* m->linked when the index was built */
+};
+
+struct monoindex {
+    Monotonic *ms;
+    int bcnt[2];
+    bigreal low[2], width[2];
+    int *bstart[2];		/* Bucket b is entries[bstart[b]] up to entries[bstart[b+1]] */
+    struct monoentry *entries[2];
+};
+
+static int MonoIndexBucket(struct monoindex *mi,int which,bigreal pos) {
+    bigreal b;
+
+    if ( mi->width[which]<=0 )
+return( 0 );
+    b = floor((pos-mi->low[which])/mi->width[which]);
+    if ( b<0 || isnan(b) )
+return( 0 );
+    else if ( b>=mi->bcnt[which] )
+return( mi->bcnt[which]-1 );
+
+return( (int) b );
+}
+
+static void MonoIndexRange(struct monoindex *mi,int which,Monotonic *m,int *first,int *last) {
+    /* The bounds of the pieces of a split monotonic may come from an */
+    /*  intersection point which is a rounding error outside the original */
+    /*  bounds, so list everything in the neighbouring buckets too */
+    *first = MonoIndexBucket(mi,which,(&m->b.minx)[2*which]);
+    *last = MonoIndexBucket(mi,which,(&m->b.maxx)[2*which]);
+    if ( *first>0 ) --*first;
+    if ( *last<mi->bcnt[which]-1 ) ++*last;
+}
+
+static struct monoindex *MonoIndexBuild(Monotonic *ms) {
+    struct monoindex *mi = calloc(1,sizeof(struct monoindex));
+    Monotonic *m;
+    int cnt, which, b, first, last, tot;
+    bigreal low, high, extent, bcnt;
+
+    mi->ms = ms;
+    for ( m=ms, cnt=0; m!=NULL; m=m->linked, ++cnt );
+    for ( which=0; which<2; ++which ) {
+	low = 1e10; high = -1e10; extent = 0;
+	for ( m=ms; m!=NULL; m=m->linked ) {
+	    if ( (&m->b.minx)[2*which]<low ) low = (&m->b.minx)[2*which];
+	    if ( (&m->b.maxx)[2*which]>high ) high = (&m->b.maxx)[2*which];
+	    extent += (&m->b.maxx)[2*which]-(&m->b.minx)[2*which];
+	}
+	/* Choose the bucket size so that a monotonic is listed in about */
+	/*  four buckets on average. Long monotonics are listed many times */
+	/*  over, and if there are lots of them that would add up */
+	bcnt = 1;
+	if ( high>low && extent>0 ) {
+	    bcnt = 4*cnt*(high-low)/extent;
+	    if ( bcnt>cnt ) bcnt = cnt;
+	    if ( bcnt<1 ) bcnt = 1;
+	}
+	mi->bcnt[which] = (int) bcnt;
+	mi->low[which] = low;
+	mi->width[which] = high>low ? (high-low)/mi->bcnt[which] : 0;
+	mi->bstart[which] = calloc(mi->bcnt[which]+1,sizeof(int));
+	for ( m=ms; m!=NULL; m=m->linked ) {
+	    MonoIndexRange(mi,which,m,&first,&last);
+	    for ( b=first; b<=last; ++b )
+		++mi->bstart[which][b+1];
+	}
+	for ( b=0; b<mi->bcnt[which]; ++b )
+	    mi->bstart[which][b+1] += mi->bstart[which][b];
+	tot = mi->bstart[which][mi->bcnt[which]];
+	mi->entries[which] = malloc((tot+1)*sizeof(struct monoentry));
+	/* Use bstart[b] to fill bucket b, after which it has moved on to */
+	/*  where bucket b+1 begins, and shift them all back again */
+	for ( m=ms; m!=NULL; m=m->linked ) {
+	    MonoIndexRange(mi,which,m,&first,&last);
+	    for ( b=first; b<=last; ++b ) {
+		mi->entries[which][mi->bstart[which][b]].m = m;
+		mi->entries[which][mi->bstart[which][b]++].next = m->linked;
+	    }
+	}
+	for ( b=mi->bcnt[which]; b>0; --b )
+	    mi->bstart[which][b] = mi->bstart[which][b-1];
+	mi->bstart[which][0] = 0;
+    }
+return( mi );
+}
+
+static void MonoIndexFree(struct monoindex *mi) {
+    int which;
+
+    for ( which=0; which<2; ++which ) {
+	free(mi->bstart[which]);
+	free(mi->entries[which]);
+    }
+    free(mi);
+}
+
+static int _MonotonicFindAt(Monotonic *ms,struct monoindex *mi,int which, extended test, Monotonic **space ) {
     /* Find all monotonic sections which intersect the line (x,y)[which] == test */
     /*  find the value of the other coord on that line */
     /*  Order them (by the other coord) */
     /*  then run along that line figuring out which monotonics are needed */
-    extended t;
     Monotonic *m, *mm;
-    int i, j, k, cnt;
-    int nw = !which;
+    int i, j, k, cnt, b;
+    struct monoentry *e, *end;
 
-    for ( m=ms, i=0; m!=NULL; m=m->linked ) {
-        if (CheckMonotonicClosed(m) == 0) continue; // Open monotonics break things.
-	if (( which==0 && test >= m->b.minx && test <= m->b.maxx ) ||
-		( which==1 && test >= m->b.miny && test <= m->b.maxy )) {
-	    /* Lines parallel to the direction we are testing just get in the */
-	    /*  way and don't add any useful info */
-	    if ( m->s->knownlinear &&
-		    (( which==1 && m->s->from->me.y==m->s->to->me.y ) ||
-			(which==0 && m->s->from->me.x==m->s->to->me.x)))
-    continue;
-	    t = IterateSplineSolveFixup(&m->s->splines[which],m->tstart,m->tend,test);
-	    if ( t==-1 ) {
-		if ( which==0 ) {
-		    if (( test-m->b.minx > m->b.maxx-test && m->xup ) ||
-			    ( test-m->b.minx < m->b.maxx-test && !m->xup ))
-			t = m->tstart;
-		    else
-			t = m->tend;
-		} else {
-		    if (( test-m->b.miny > m->b.maxy-test && m->yup ) ||
-			    ( test-m->b.miny < m->b.maxy-test && !m->yup ))
-			t = m->tstart;
-		    else
-			t = m->tend;
-		}
-	    }
-	    m->t = t;
-	    if ( t==m->tend ) t -= (m->tend-m->tstart)/100;
-	    else if ( t==m->tstart ) t += (m->tend-m->tstart)/100;
-	    m->other = ((m->s->splines[nw].a*t+m->s->splines[nw].b)*t+
-		    m->s->splines[nw].c)*t+m->s->splines[nw].d;
-	    space[i++] = m;
-	}
+    if ( mi==NULL ) {
+	for ( m=ms, i=0; m!=NULL; m=m->linked )
+	    i = MonotonicAddAt(m,which,test,space,i);
+    } else {
+	b = MonoIndexBucket(mi,which,test);
+	end = &mi->entries[which][mi->bstart[which][b+1]];
+	for ( e=&mi->entries[which][mi->bstart[which][b]], i=0; e<end; ++e )
+	    for ( m=e->m; m!=e->next; m=m->linked )
+		i = MonotonicAddAt(m,which,test,space,i);
     }
     cnt = i;
 
@@ -2510,6 +2738,10 @@ int MonotonicFindAt(Monotonic *ms,int which, extended test, Monotonic **space )
 return(cnt);
 }
 
+int MonotonicFindAt(Monotonic *ms,int which, extended test, Monotonic **space ) {
+return( _MonotonicFindAt(ms,NULL,which,test,space));
+}
+
 static Intersection *TryHarderWhenClose(int which, Monotonic **space,int cnt, Intersection *ilist) {
     /* If splines are very close together at a certain point then we can't */
     /*  tell the proper ordering due to rounding errors. */
@@ -2668,7 +2900,7 @@ return( !( (( winding==0 || nwinding==0 ) && ew==0 && new==0 ) ||
 return( false );
 }
 
-static void FigureNeeds(Monotonic *ms,int which, extended test, Monotonic **space,
+static void FigureNeeds(struct monoindex *mi,int which, extended test, Monotonic **space,
 	enum overlap_type ot, bigreal close_level) {
     /* Find all monotonic sections which intersect the line (x,y)[which] == test */
     /*  find the value of the other coord on that line */
@@ -2676,7 +2908,7 @@ static void FigureNeeds(Monotonic *ms,int which, extended test, Monotonic **spac
     /*  then run along that line figuring out which monotonics are needed */
     int i, winding, ew, close, n;
 
-    TryHarderWhenClose(which,space,MonotonicFindAt(ms,which,test,space),NULL);
+    TryHarderWhenClose(which,space,_MonotonicFindAt(mi->ms,mi,which,test,space),NULL);
 
     winding = 0; ew = 0;
     for ( i=0; space[i]!=NULL; ++i ) {
@@ -2795,6 +3027,7 @@ static Intersection *FindNeeded(Monotonic *ms,enum overlap_type ot,Intersection
     int i,j,k,l, cnt,which;
     struct gaps *gaps;
     extended min_gap;
+    struct monoindex *mi;
     static const bigreal closeness_level[] = { .1, .01, 0, -1 };
 
     if ( ms==NULL )
@@ -2802,6 +3035,7 @@ return(ilist);
 
     for ( m=ms, cnt=0; m!=NULL; m=m->linked, ++cnt );
     space = malloc(4*(cnt+2)*sizeof(Monotonic*));	/* We need at most cnt, but we will be adding more monotonics... */
+    mi = MonoIndexBuild(ms);
 
     /* Check (again) for coincident spline segments */
     for ( m=ms; m!=NULL; m=m->linked ) {
@@ -2815,7 +3049,7 @@ return(ilist);
 	    which = 1;
 	}
 	test=(top+bottom)/2;
-	ilist = TryHarderWhenClose(which,space,MonotonicFindAt(ms,which,test,space),ilist);
+	ilist = TryHarderWhenClose(which,space,_MonotonicFindAt(ms,mi,which,test,space),ilist);
     }
 
     ends[0] = FindOrderedEndpoints(ms,0);
@@ -2846,7 +3080,7 @@ return(ilist);
     }
     if ( min_gap<.5 ) min_gap = .5;
     for ( i=0; i<k && gaps[i].len>=min_gap; ++i )
-	FigureNeeds(ms,gaps[i].which,gaps[i].test,space,ot,1.0);
+	FigureNeeds(mi,gaps[i].which,gaps[i].test,space,ot,1.0);
 
     for ( l=0; closeness_level[l]>=0; ++l ) {
 	for ( m=ms; m!=NULL; m=m->linked ) if ( !m->isneeded && !m->isunneeded ) {
@@ -2880,7 +3114,7 @@ return(ilist);
 		test = last + gap_len/2;
 	    }
 	    if ( test!=last && test!=top )
-		FigureNeeds(ms,which,test,space,ot,closeness_level[l]);
+		FigureNeeds(mi,which,test,space,ot,closeness_level[l]);
 	}
     }
     for ( m=ms; m!=NULL; m=m->linked ) if ( !m->isneeded && !m->isunneeded ) {
@@ -2894,6 +3128,7 @@ return(ilist);
     free(ends[1]);
     free(space);
     free(gaps);
+    MonoIndexFree(mi);
 return( ilist );
 }
 
@@ -3965,7 +4200,7 @@ SplineSet *SplineSetRemoveOverlap(SplineChar *sc, SplineSet *base,enum overlap_t
     SplineSet *ret;
 
     if ( sc!=NULL )
-	glyphname = sc->name;
+	g_private_set(&glyphname,sc->name);
 
     base = SSRemoveTiny(base);
     SSRemoveStupidControlPoints(base);
@@ -3998,6 +4233,6 @@ SplineSet *SplineSetRemoveOverlap(SplineChar *sc, SplineSet *base,enum overlap_t
     }
     FreeMonotonics(ms);
     FreeIntersections(ilist);
-    glyphname = NULL;
+    g_private_set(&glyphname,NULL);
 return( ret );
 }
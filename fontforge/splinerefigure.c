@@ -48,6 +48,7 @@ void SplineRefigure3(Spline *spline) {
     Spline1D *xsp = &spline->splines[0], *ysp = &spline->splines[1];
     Spline old;
 
+    SplinesChanged();
     spline->isquadratic = false;
     if ( spline->acceptableextrema )
 	old = *spline;
@@ -34,6 +34,7 @@
 #include "fontforge.h"
 #include "fvfonts.h"
 #include "gwidget.h"
+#include "parallel.h"
 #include "parsepfa.h"
 #include "psfont.h"
 #include "splinefont.h"
@@ -41,6 +42,7 @@
 #include "splinesaveafm.h"
 #include "splineutil.h"
 #include "splineutil2.h"
+#include "type2subrs.h"
 #include "ustring.h"
 #include "utype.h"
 
@@ -119,7 +121,9 @@ struct potentialsubrs {
 struct bits {
     uint8 *data;
     int dlen;
-    int psub_index;
+    int psub_index;		/* -2 => not hashed yet, subr/slen hold the data */
+    uint8 *subr;
+    int slen;
 };
 
 struct glyphbits {
@@ -148,6 +152,8 @@ typedef struct glyphinfo {
     const int *bygid;
     int justbroken;
     int instance_count;
+    int threaded;		/* Converting glyphs on several threads. Leave */
+				/*  shared state alone, and don't hash subrs */
 } GlyphInfo;
 
 struct mhlist {
@@ -235,6 +241,7 @@ return;
     gi->bits[gi->bcnt].dlen = gb->pt-gb->base;
     gi->bits[gi->bcnt].data = malloc(gi->bits[gi->bcnt].dlen);
     gi->bits[gi->bcnt].psub_index = -1;
+    gi->bits[gi->bcnt].subr = NULL;
     memcpy(gi->bits[gi->bcnt].data,gb->base,gi->bits[gi->bcnt].dlen);
     gb->pt = gb->base;
     gi->justbroken = false;
@@ -253,31 +260,17 @@ static int hashfunc(uint8 *data, int len) {
 return( hash%HSH_SIZE );
 }
 
-static void BreakSubroutine(GrowBuf *gb,struct hintdb *hdb) {
-    GlyphInfo *gi;
+/* Find (or add) the potential subr matching data, and count another use of it */
+static int HashSubroutine(GlyphInfo *gi,uint8 *data,int len) {
     struct potentialsubrs *ps;
     int hash;
     int pi;
 
-    if ( hdb==NULL )
-return;
-    gi = hdb->gi;
-    if ( gi==NULL )
-return;
-    /* The stuff before the first moveto in a glyph (the header that sets */
-    /*  the width, sets up the hints, counters, etc.) can't go into a subr */
-    if ( gi->bcnt==-1 ) {
-	gi->bcnt=0;
-	gi->justbroken = true;
-return;
-    } else if ( gi->justbroken )
-return;
-    /* Otherwise stuff everything in the growbuffer into a subr */
-    hash = hashfunc(gb->base,gb->pt-gb->base);
+    hash = hashfunc(data,len);
     ps = NULL;
     for ( pi=gi->hashed[hash]; pi!=-1; pi=gi->psubrs[pi].next ) {
 	ps = &gi->psubrs[pi];
-	if ( ps->len==gb->pt-gb->base && memcmp(ps->data,gb->base,gb->pt-gb->base)==0 )
+	if ( ps->len==len && memcmp(ps->data,data,len)==0 )
     break;
     }
     if ( pi==-1 ) {
@@ -286,9 +279,9 @@ return;
 	ps = &gi->psubrs[gi->pcnt];
 	memset(ps,0,sizeof(*ps));	/* set cnt to 0 */
 	ps->idx = gi->pcnt++;
-	ps->len = gb->pt-gb->base;
+	ps->len = len;
 	ps->data = malloc(ps->len);
-	memcpy(ps->data,gb->base,ps->len);
+	memcpy(ps->data,data,ps->len);
 	ps->next = gi->hashed[hash];
 	gi->hashed[hash] = ps->idx;
 	ps->fd = gi->active->fd;
@@ -296,8 +289,38 @@ return;
     }
     if ( ps->fd!=gi->active->fd )
 	ps->fd = -1;			/* used in multiple cid sub-fonts */
-    gi->bits[gi->bcnt].psub_index = ps->idx;
     ++ps->cnt;
+return( ps->idx );
+}
+
+static void BreakSubroutine(GrowBuf *gb,struct hintdb *hdb) {
+    GlyphInfo *gi;
+    struct bits *bit;
+
+    if ( hdb==NULL )
+return;
+    gi = hdb->gi;
+    if ( gi==NULL )
+return;
+    /* The stuff before the first moveto in a glyph (the header that sets */
+    /*  the width, sets up the hints, counters, etc.) can't go into a subr */
+    if ( gi->bcnt==-1 ) {
+	gi->bcnt=0;
+	gi->justbroken = true;
+return;
+    } else if ( gi->justbroken )
+return;
+    /* Otherwise stuff everything in the growbuffer into a subr */
+    bit = &gi->bits[gi->bcnt];
+    if ( gi->threaded ) {
+	/* The subr numbering depends on the order things are hashed in, so */
+	/*  hang on to the data and let HashGlyphSubrs do it in glyph order */
+	bit->psub_index = -2;
+	bit->slen = gb->pt-gb->base;
+	bit->subr = malloc(bit->slen+1);
+	memcpy(bit->subr,gb->base,bit->slen);
+    } else
+	bit->psub_index = HashSubroutine(gi,gb->base,gb->pt-gb->base);
     gb->pt = gb->base;
     ++gi->bcnt;
     gi->justbroken = true;
@@ -340,6 +363,18 @@ static int NumberHints(SplineChar *scs[MmMax], int instance_count) {
 return( cnt );
 }
 
+/* What NumberHints would return for a single glyph, without renumbering */
+static int CountHints(SplineChar *sc) {
+    StemInfo *s;
+    int i=0;
+
+    for ( s=sc->hstem; s!=NULL && i<HntMax; s=s->next )
+	++i;
+    for ( s=sc->vstem; s!=NULL && i<HntMax; s=s->next )
+	++i;
+return( i );
+}
+
 void RefCharsFreeRef(RefChar *ref) {
     RefChar *rnext;
 
@@ -2914,7 +2949,15 @@ static void RSC2PS2(GrowBuf *gb, SplineChar *base,SplineChar *rsc,
     int hc, vc;
     SplineSet *freeme, *temp;
     int wasntconflicted = hdb->noconflicts;
+    int threaded = hdb->gi->threaded;
+    SplineChar stripped;
 
+    if ( (flags&ps_flag_nohints) && threaded && rsc!=base ) {
+	/* Other threads may be looking at this glyph's hints, so remove */
+	/*  them from a copy rather than from the glyph itself */
+	stripped = *rsc;
+	rsc = &stripped;
+    }
     if ( flags&ps_flag_nohints ) {
 	oldh = rsc->hstem; oldv = rsc->vstem;
 	hc = rsc->hconflicts; vc = rsc->vconflicts;
@@ -2923,7 +2966,8 @@ static void RSC2PS2(GrowBuf *gb, SplineChar *base,SplineChar *rsc,
     } else {
 	for ( r=rsc->layers[layer].refs; r!=NULL; r=r->next ) {
 	    /* Ensure hintmask on refs are set correctly */
-	    if (SCNeedsSubsPts(r->sc, ff_otf, layer))
+	    /*  (PS2PrepareGlyph has done it already if we are threaded) */
+	    if ( !threaded && SCNeedsSubsPts(r->sc, ff_otf, layer))
 	        SCFigureHintMasks(r->sc, layer);
 
 	    if ( !r->justtranslated )
@@ -2936,7 +2980,8 @@ static void RSC2PS2(GrowBuf *gb, SplineChar *base,SplineChar *rsc,
 	}
 	if ( !stationary )
 	    allwithouthints = false;
-	if ( allwithouthints && unsafe!=NULL && hdb->cnt!=NumberHints(&unsafe->sc,1)) 
+	if ( allwithouthints && unsafe!=NULL &&
+		hdb->cnt!=(threaded ? CountHints(unsafe->sc) : NumberHints(&unsafe->sc,1)))
 	    allwithouthints = false;		/* There are other hints elsewhere in the base glyph */
     }
 
@@ -2954,6 +2999,15 @@ static void RSC2PS2(GrowBuf *gb, SplineChar *base,SplineChar *rsc,
     freeme = NULL; temp = rsc->layers[layer].splines;
     if ( base!=rsc )
 	temp = freeme = SPLCopyTranslatedHintMasks(temp,base,rsc,trans);
+    else if ( threaded && temp!=NULL ) {
+	/* CvtPsSplineSet2 turns the contours around while it works, and */
+	/*  SplineChar2PS2 has left the initial hintmask for us to remove */
+	temp = freeme = SplinePointListCopy(temp);
+	if ( !(flags&ps_flag_nohints) && !rsc->hconflicts && !rsc->vconflicts ) {
+	    chunkfree(temp->first->hintmask,sizeof(HintMask));
+	    temp->first->hintmask = NULL;
+	}
+    }
     CvtPsSplineSet2(gb,temp,hdb,rsc->layers[layer].order2,round);
     SplinePointListsFree(freeme);
 
@@ -3002,14 +3056,28 @@ static unsigned char *SplineChar2PS2(SplineChar *sc,int *len, int nomwid,
     int round = (flags&ps_flag_round)? true : false;
     HintMask *hm = NULL;
     BasePoint trans;
+    SplineChar stripped;
 
-    if ( autohint_before_generate && sc->changedsincelasthinted &&
-	    !sc->manualhints && !(flags&ps_flag_nohints))
-	SplineCharAutoHint(sc,gi->layer,NULL);
-    if ( !(flags&ps_flag_nohints) && SCNeedsSubsPts(sc,ff_otf,gi->layer))
-	SCFigureHintMasks(sc,gi->layer);
+    if ( gi->threaded ) {
+	/* PS2PrepareGlyph has done the autohinting and hint numbering, and */
+	/*  RSC2PS2 will work on a copy of the contours */
+	if ( flags&ps_flag_nohints ) {
+	    stripped = *sc;
+	    stripped.hstem = stripped.vstem = NULL;
+	    stripped.hconflicts = stripped.vconflicts = false;
+	    sc = &stripped;
+	}
+    } else {
+	if ( autohint_before_generate && sc->changedsincelasthinted &&
+		!sc->manualhints && !(flags&ps_flag_nohints))
+	    SplineCharAutoHint(sc,gi->layer,NULL);
+	if ( !(flags&ps_flag_nohints) && SCNeedsSubsPts(sc,ff_otf,gi->layer))
+	    SCFigureHintMasks(sc,gi->layer);
+    }
 
-    if ( flags&ps_flag_nohints ) {
+    if ( gi->threaded )
+	/* Nothing to save */;
+    else if ( flags&ps_flag_nohints ) {
 	oldh = sc->hstem; oldv = sc->vstem;
 	hc = sc->hconflicts; vc = sc->vconflicts;
 	sc->hstem = NULL; sc->vstem = NULL;
@@ -3038,7 +3106,7 @@ static unsigned char *SplineChar2PS2(SplineChar *sc,int *len, int nomwid,
 	gi->bcnt = -1;
     scs[0] = sc;
     hdb.noconflicts = !sc->hconflicts && !sc->vconflicts;
-    hdb.cnt = NumberHints(hdb.scs,1);
+    hdb.cnt = gi->threaded ? CountHints(sc) : NumberHints(hdb.scs,1);
     DumpHints(&gb,sc->hstem,sc->hconflicts || sc->vconflicts?18:1,
 			    sc->hconflicts || sc->vconflicts?18:1,round);
     DumpHints(&gb,sc->vstem,sc->hconflicts || sc->vconflicts?-1:3,
@@ -3055,7 +3123,9 @@ static unsigned char *SplineChar2PS2(SplineChar *sc,int *len, int nomwid,
     ret = NULL;
 
     free(gb.base);
-    if ( flags&ps_flag_nohints ) {
+    if ( gi->threaded )
+	/* Nothing to restore */;
+    else if ( flags&ps_flag_nohints ) {
 	sc->hstem = oldh; sc->vstem = oldv;
 	sc->hconflicts = hc; sc->vconflicts = vc;
     } else if ( hm!=NULL )
@@ -3063,6 +3133,151 @@ static unsigned char *SplineChar2PS2(SplineChar *sc,int *len, int nomwid,
 return( ret );
 }
 
+/* The parts of RSC2PS2 which change the glyphs it looks at (rather than */
+/*  just its output), following the same path through the references */
+static void RSC2PS2Prepare(SplineChar *rsc, BasePoint *trans, int hcnt, int layer) {
+    BasePoint subtrans;
+    RefChar *r, *unsafe=NULL;
+    int allwithouthints=true;
+
+    for ( r=rsc->layers[layer].refs; r!=NULL; r=r->next ) {
+	if (SCNeedsSubsPts(r->sc, ff_otf, layer))
+	    SCFigureHintMasks(r->sc, layer);
+	if ( !r->justtranslated )
+    continue;
+	if ( r->sc->hconflicts || r->sc->vconflicts )
+	    unsafe = r;
+	else if ( r->sc->hstem!=NULL || r->sc->vstem!=NULL )
+	    allwithouthints = false;
+    }
+    if ( trans->x!=0 || trans->y!=0 )
+	allwithouthints = false;
+    if ( allwithouthints && unsafe!=NULL && hcnt!=NumberHints(&unsafe->sc,1))
+	allwithouthints = false;
+
+    if ( unsafe && allwithouthints ) {
+	if ( unsafe->sc->lsidebearing!=0x7fff )
+	    /* ExpandRef2 changes nothing */;
+	else if ( unsafe->transform[4]==0 && unsafe->transform[5]==0 )
+	    RSC2PS2Prepare(unsafe->sc,trans,hcnt,layer);
+	else
+	    unsafe = NULL;
+    } else
+	unsafe = NULL;
+
+    for ( r = rsc->layers[layer].refs; r!=NULL; r = r->next ) if ( r!=unsafe ) {
+	if ( !r->justtranslated )
+    continue;
+	if ( r->sc->lsidebearing!=0x7fff && !r->sc->hconflicts && !r->sc->vconflicts )
+    continue;
+	subtrans.x = trans->x + r->transform[4];
+	subtrans.y = trans->y + r->transform[5];
+	RSC2PS2Prepare(r->sc,&subtrans,hcnt,layer);
+    }
+}
+
+/* Make the changes to the font that SplineChar2PS2 would make when */
+/*  converting sc, so that afterwards the conversion only reads the font */
+static void PS2PrepareGlyph(SplineChar *sc,int flags,int layer) {
+    BasePoint trans;
+
+    if ( flags&ps_flag_nohints )
+return;
+    if ( autohint_before_generate && sc->changedsincelasthinted &&
+	    !sc->manualhints )
+	SplineCharAutoHint(sc,layer,NULL);
+    if ( SCNeedsSubsPts(sc,ff_otf,layer))
+	SCFigureHintMasks(sc,layer);
+    memset(&trans,'\0',sizeof(trans));
+    RSC2PS2Prepare(sc,&trans,NumberHints(&sc,1),layer);
+}
+
+/* CvtPsSplineSet2 turns off flex on a contour's start point if it can't */
+/*  rotate it away, and glyphs converted after that (which reference this */
+/*  one) see the change. That can't be reproduced when glyphs are converted */
+/*  out of order, so fonts where it might happen are done on one thread */
+static int PS2FlexOrderMatters(GlyphInfo *gi) {
+    int i;
+    SplineChar *sc;
+    SplineSet *spl;
+
+    for ( i=0; i<gi->glyphcnt; ++i ) if ( (sc=gi->gb[i].sc)!=NULL ) {
+	if ( sc->layers[gi->layer].order2 )
+    continue;
+	for ( spl=sc->layers[gi->layer].splines; spl!=NULL; spl=spl->next )
+	    if ( spl->first->flexx || spl->first->flexy ||
+		    spl->last->flexx || spl->last->flexy )
+return( true );
+    }
+return( false );
+}
+
+struct ps2_threaddata {
+    GlyphInfo *gi;
+    int nomwid, defwid;
+    int flags;
+};
+
+static void ParallelSplineChar2PS2(int i, void *data) {
+    struct ps2_threaddata *td = data;
+    GlyphInfo gi;
+
+    if ( td->gi->gb[i].sc==NULL )
+return;
+    /* Each glyph gets its own scratch space */
+    gi = *td->gi;
+    gi.active = &td->gi->gb[i];
+    gi.bits = NULL;
+    gi.bcnt = gi.bmax = 0;
+    gi.threaded = true;
+    SplineChar2PS2(gi.active->sc,NULL,td->nomwid,td->defwid,NULL,td->flags,&gi);
+    free(gi.bits);
+}
+
+/* Hash the potential subrs of glyphs converted by ParallelSplineChar2PS2 */
+/*  in glyph order, which numbers them just as converting serially would */
+static void HashGlyphSubrs(GlyphInfo *gi) {
+    int i,j;
+    struct bits *bit;
+
+    for ( i=0; i<gi->glyphcnt; ++i ) if ( gi->gb[i].sc!=NULL ) {
+	gi->active = &gi->gb[i];
+	for ( j=0; j<gi->active->bcnt; ++j ) {
+	    bit = &gi->active->bits[j];
+	    if ( bit->psub_index==-2 ) {
+		bit->psub_index = HashSubroutine(gi,bit->subr,bit->slen);
+		free(bit->subr);
+		bit->subr = NULL;
+	    }
+	}
+    }
+}
+
+static void SplineFont2PS2Glyphs(GlyphInfo *gi,int nomwid,int defwid,int flags) {
+    struct ps2_threaddata td;
+    SplineChar *sc;
+    int i;
+
+    if ( ParallelJobCount(gi->glyphcnt)>1 && !PS2FlexOrderMatters(gi) ) {
+	for ( i=0; i<gi->glyphcnt; ++i ) if ( (sc=gi->gb[i].sc)!=NULL )
+	    PS2PrepareGlyph(sc,flags,gi->layer);
+	td.gi = gi;
+	td.nomwid = nomwid; td.defwid = defwid;
+	td.flags = flags;
+	ParallelFor(gi->glyphcnt,ParallelSplineChar2PS2,&td,true);
+	HashGlyphSubrs(gi);
+return;
+    }
+
+    for ( i=0; i<gi->glyphcnt; ++i ) {
+	if ( (sc = gi->gb[i].sc)==NULL )
+    continue;
+	gi->active = &gi->gb[i];
+	SplineChar2PS2(sc,NULL,nomwid,defwid,NULL,flags,gi);
+	ff_progress_next();
+    }
+}
+
 static SplinePoint *LineTo(SplinePoint *last, int x, int y) {
     SplinePoint *sp = SplinePointCreate(x,y);
     SplineMake3(last,sp);
@@ -3247,13 +3462,7 @@ struct pschars *SplineFont2ChrsSubrs2(SplineFont *sf, int nomwid, int defwid,
     MarkTranslationRefs(sf,layer);
     SplineFont2FullSubrs2(flags,&gi);
 
-    for ( i=0; i<cnt; ++i ) {
-	if ( (sc = gi.gb[i].sc)==NULL )
-    continue;
-	gi.active = &gi.gb[i];
-	SplineChar2PS2(sc,NULL,nomwid,defwid,NULL,flags,&gi);
-	ff_progress_next();
-    }
+    SplineFont2PS2Glyphs(&gi,nomwid,defwid,flags);
 
     for ( i=scnt=0; i<gi.pcnt; ++i ) {
 	/* A subroutine call takes somewhere between 2 and 4 bytes itself. */
@@ -3393,6 +3602,8 @@ struct pschars *SplineFont2ChrsSubrs2(SplineFont *sf, int nomwid, int defwid,
     }
     
     GIFree(&gi,&dummynotdef);
+    if ( flags&ps_flag_subroutinize )
+	Type2Subroutinize(chrs,&subrs,1,NULL,NULL);
     *_subrs = subrs;
 return( chrs );
 }
@@ -3595,6 +3806,17 @@ struct pschars *CID2ChrsSubrs2(SplineFont *cidmaster,struct fd2data *fds,
 	chrs->values[i][len++] = 14;	/* endchar */
 	chrs->values[i][len] = '\0';
     }
+    if ( flags&ps_flag_subroutinize ) {
+	struct pschars **fdsubrs = malloc(cidmaster->subfontcnt*sizeof(struct pschars *));
+	int *glyphfds = malloc(cnt*sizeof(int));
+	for ( fd=0; fd<cidmaster->subfontcnt; ++fd )
+	    fdsubrs[fd] = fds[fd].subrs;
+	for ( i=0; i<cnt; ++i )
+	    glyphfds[i] = gi.gb[i].fd;
+	Type2Subroutinize(chrs,fdsubrs,cidmaster->subfontcnt,glyphfds,glbls);
+	free(fdsubrs);
+	free(glyphfds);
+    }
     GIFree(&gi,&dummynotdef);
     *_glbls = glbls;
 return( chrs );
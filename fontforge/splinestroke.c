@@ -1832,10 +1832,10 @@ static void ArcsJoin(JoinParams *jpp) {
 	    K_to = SplineEndCurvature(tmp_st->next, false);
 	    while ( tmp_st!=tmp_end ) {
 		tmp_st = tmp_st->next->to;
-		free(tmp_st->prev->from);
-		free(tmp_st->prev);
+		SplinePointFree(tmp_st->prev->from);
+		SplineFree(tmp_st->prev);
 	    }
-	    free(tmp_end);
+	    SplinePointFree(tmp_end);
 	}
     } else {
 	// If the spline will be drawn by a nib point as opposed to a nib curve
@@ -29,6 +29,7 @@
 
 #include "splineutil.h"
 
+#include "autohint.h"
 #include "cvundoes.h"
 #include "dumppfa.h"
 #include "encoding.h"
@@ -39,10 +40,12 @@
 #include "glif_name_hash.h"
 #include "mm.h"
 #include "namelist.h"
+#include "parallel.h"
 #include "parsepfa.h"
 #include "parsettf.h"
 #include "psfont.h"
 #include "psread.h"
+#include "sfd.h"
 #include "sfd1.h" // This has the extended SplineFont type SplineFont1 for old file versions.
 #include "spiro.h"
 #include "splinefill.h"
@@ -64,52 +67,166 @@
 
 /*#define DEBUG 1*/
 
-/* In an attempt to make allocation more efficient I just keep preallocated */
-/*  lists of certain common sizes. It doesn't seem to make much difference */
-/*  when allocating stuff, but does when freeing. If the extra complexity */
-/*  is bad then put:							  */
+/* In an attempt to make allocation more efficient I keep lists of free */
+/*  blocks of each of the small sizes our data structures come in, carved */
+/*  out of larger pieces of memory, rather than going to malloc for every */
+/*  SplinePoint, Spline, SplineSet, RefChar and KernPair (a big font has */
+/*  millions of them). That saves malloc's per block overhead, and time, */
+/*  particularly when freeing. So anything from chunkalloc must be given */
+/*  back with chunkfree, never with free() or realloc(). chunkfree will */
+/*  take blocks which came from malloc, and blocks which were allocated as */
+/*  something bigger (the old sfd formats read KernPairs and the like into */
+/*  larger structures), they just go on the list for the smaller size. */
+/*  Memory is never returned to the system, the next font reuses it. Each */
+/*  thread has its own lists, which are topped up from (and spill over */
+/*  into) shared ones, so ParallelFor's threads don't need a lock for */
+/*  every allocation. If the extra complexity is bad then put:		  */
 /*	#define chunkalloc(size)	calloc(1,size)			  */
 /*	#define chunkfree(item,size)	free(item)			  */
-/*  into splinefont.h after (or instead of) the definition of chunkalloc()*/
+/*  into splinefont.h instead of the declarations of chunkalloc()	  */
 
-#define ALLOC_CHUNK	100		/* Number of small chunks to malloc at a time */
-#ifndef FONTFORGE_CONFIG_USE_DOUBLE
-# define CHUNK_MAX	100		/* Maximum size (in chunk units) that we are prepared to allocate */
-					/* The size of our data structures */
-#else
-# define CHUNK_MAX	129
-#endif
-# define CHUNK_UNIT	sizeof(void *)	/*  will vary with the word size of */
-					/*  the machine. if pointers are 64 bits*/
-					/*  we may need twice as much space as for 32 bits */
+#define CHUNK_UNIT	sizeof(void *)	/* Sizes are rounded up to this */
+#define CHUNK_MAX	100		/* Bigger things go to malloc, in CHUNK_UNITs */
+#define CHUNK_SLAB	16384		/* Bytes to carve into chunks at a time */
+#define CHUNK_BATCH	64		/* Chunks handed between threads at a time */
 
-#ifdef FLAG
-#undef FLAG
-#define FLAG 0xbadcafe
-#endif
+struct chunk { struct chunk *next; };
 
-#ifdef CHUNKDEBUG
-static int chunkdebug = 0;	/* When this is set we never free anything, insuring that each chunk is unique */
-#endif
+struct chunklist {
+    struct chunk *head;
+    int cnt;
+};
 
-#if ALLOC_CHUNK>1
-struct chunk { struct chunk *next; };
-struct chunk2 { struct chunk2 *next; int flag; };
-#endif
+/* Each thread frees into "loaded" and allocates from it. When it is full */
+/*  it becomes "previous" (and any older previous list goes to the shared */
+/*  lists), when it is empty previous, or a shared list, replaces it. So */
+/*  lists only ever change hands whole, and a thread which frees and */
+/*  allocates around a multiple of CHUNK_BATCH doesn't keep going back to */
+/*  the shared lists. Fresh memory is handed out in address order */
+struct chunkcache {
+    struct chunkclass {
+	struct chunklist loaded, previous;
+	char *fresh;
+	int fresh_cnt;
+    } classes[CHUNK_MAX];	/* Indexed by size in CHUNK_UNITs */
+};
+
+static struct chunkshared {
+    struct chunklist *lists;
+    int cnt, max;
+} chunk_shared[CHUNK_MAX];
+static GMutex chunk_lock;
 
-#if defined(FLAG) && ALLOC_CHUNK>1
-void chunktest(void) {
+static void ChunkShare(int index, struct chunklist *list) {
+    struct chunkshared *shared = &chunk_shared[index];
+
+    if ( list->head==NULL )
+return;
+    g_mutex_lock(&chunk_lock);
+    if ( shared->cnt>=shared->max ) {
+	shared->max += 64;
+	shared->lists = realloc(shared->lists,shared->max*sizeof(struct chunklist));
+    }
+    shared->lists[shared->cnt++] = *list;
+    g_mutex_unlock(&chunk_lock);
+    list->head = NULL;
+    list->cnt = 0;
+}
+
+static int ChunkUnshare(int index, struct chunklist *list) {
+    struct chunkshared *shared = &chunk_shared[index];
+    int ret = false;
+
+    g_mutex_lock(&chunk_lock);
+    if ( shared->cnt>0 ) {
+	*list = shared->lists[--shared->cnt];
+	ret = true;
+    }
+    g_mutex_unlock(&chunk_lock);
+return( ret );
+}
+
+static void ChunkCacheRelease(gpointer data) {
+    struct chunkcache *cache = data;
     int i;
-    struct chunk2 *c;
 
-    for ( i=2; i<CHUNK_MAX; ++i )
-	for ( c=(struct chunk2 *) chunklists[i]; c!=NULL; c=c->next )
-	    if ( c->flag!=FLAG ) {
-		fprintf( stderr, "Chunk memory list has been corrupted\n" );
-		abort();
+    /* Whatever is left of the thread's fresh memory is lost, but that's */
+    /*  less than a slab per size */
+    for ( i=0; i<CHUNK_MAX; ++i ) {
+	ChunkShare(i,&cache->classes[i].loaded);
+	ChunkShare(i,&cache->classes[i].previous);
+    }
+    free(cache);
+}
+
+static GPrivate chunk_cache = G_PRIVATE_INIT(ChunkCacheRelease);
+
+static struct chunkclass *ChunkClass(int index) {
+    struct chunkcache *cache = g_private_get(&chunk_cache);
+
+    if ( cache==NULL ) {
+	cache = calloc(1,sizeof(struct chunkcache));
+	g_private_set(&chunk_cache,cache);
+    }
+return( &cache->classes[index] );
+}
+
+void *chunkalloc(int size) {
+    int index = (size+CHUNK_UNIT-1)/CHUNK_UNIT;
+    struct chunkclass *class;
+    struct chunk *item;
+
+    if ( size<=0 || index>=CHUNK_MAX )
+return( calloc(1,size));
+    class = ChunkClass(index);
+    if ( class->loaded.head==NULL ) {
+	if ( class->previous.head!=NULL ) {
+	    class->loaded = class->previous;
+	    class->previous.head = NULL;
+	    class->previous.cnt = 0;
+	} else if ( !ChunkUnshare(index,&class->loaded) ) {
+	    if ( class->fresh_cnt==0 ) {
+		class->fresh_cnt = CHUNK_SLAB/(index*CHUNK_UNIT);
+		if ( (class->fresh = malloc(CHUNK_SLAB))==NULL ) {
+		    class->fresh_cnt = 0;
+return( NULL );
+		}
 	    }
+	    item = (struct chunk *) class->fresh;
+	    class->fresh += index*CHUNK_UNIT;
+	    --class->fresh_cnt;
+	    memset(item,'\0',index*CHUNK_UNIT);
+return( item );
+	}
+    }
+    item = class->loaded.head;
+    class->loaded.head = item->next;
+    --class->loaded.cnt;
+    memset(item,'\0',index*CHUNK_UNIT);
+return( item );
+}
+
+void chunkfree(void *item,int size) {
+    int index = (size+CHUNK_UNIT-1)/CHUNK_UNIT;
+    struct chunkclass *class;
+
+    if ( item==NULL )
+return;
+    if ( size<=0 || index>=CHUNK_MAX ) {
+	free(item);
+return;
+    }
+    class = ChunkClass(index);
+    if ( class->loaded.cnt>=CHUNK_BATCH ) {
+	ChunkShare(index,&class->previous);
+	class->previous = class->loaded;
+	class->loaded.head = NULL;
+	class->loaded.cnt = 0;
+    }
+    ((struct chunk *) item)->next = class->loaded.head;
+    class->loaded.head = item;
+    ++class->loaded.cnt;
 }
-#endif
 
 char *strconcat(const char *str1,const char *str2) {
     char *ret;
@@ -153,7 +270,16 @@ void LinearApproxFree(LinearApprox *la) {
     }
 }
 
+/* Bumped whenever a spline is refigured or freed, which is how the bounds */
+/*  cached in each layer learn that they may be out of date */
+static gint spline_generation;
+
+void SplinesChanged(void) {
+    g_atomic_int_inc(&spline_generation);
+}
+
 void SplineFree(Spline *spline) {
+    SplinesChanged();
     LinearApproxFree(spline->approx);
     chunkfree(spline,sizeof(Spline));
 }
@@ -678,6 +804,39 @@ static void _ImageFindBounds(ImageList *img,DBounds *bounds) {
     }
 }
 
+static void _LayerFindClippedBounds(Layer *ly, DBounds *bounds,DBounds *clipb) {
+    SplinePointList *spl = ly->splines, *ss;
+    int generation = g_atomic_int_get(&spline_generation);
+    int cacheable = true;
+
+    /* A contour of one point has no spline to tell us when it moves (or */
+    /*  when it is freed and its memory reused), so such layers aren't cached */
+    for ( ss=spl; ss!=NULL && cacheable; ss=ss->next )
+	if ( ss->first->next==NULL )
+	    cacheable = false;
+    if ( cacheable && spl!=NULL && ly->bb_splines==spl &&
+	    g_atomic_int_get(&ly->bb_generation)==generation ) {
+	*bounds = ly->bb;
+	*clipb = ly->clipbb;
+return;
+    }
+    memset(bounds,0,sizeof(*bounds));
+    memset(clipb,0,sizeof(*clipb));
+    if ( spl==NULL )
+return;
+    _SplineSetFindClippedBounds(spl,bounds,clipb);
+    /* Other threads may be reading the same layer, and the bounds can't be */
+    /*  written in one go */
+    if ( !cacheable || ParallelRunning())
+return;
+    /* Stamped with the generation from before we looked, so a change made */
+    /*  while we were looking is not hidden */
+    ly->bb = *bounds;
+    ly->clipbb = *clipb;
+    ly->bb_splines = spl;
+    g_atomic_int_set(&ly->bb_generation,generation);
+}
+
 static void _SplineCharLayerFindBounds(SplineChar *sc,int layer, DBounds *bounds) {
     RefChar *rf;
     ImageList *img;
@@ -694,9 +853,7 @@ static void _SplineCharLayerFindBounds(SplineChar *sc,int layer, DBounds *bounds
 	    if ( rf->bb.maxy > bounds->maxy ) bounds->maxy = rf->bb.maxy;
 	}
     }
-    memset(&b,0,sizeof(b));
-    memset(&clipb,0,sizeof(clipb));
-    _SplineSetFindClippedBounds(sc->layers[layer].splines,&b,&clipb);
+    _LayerFindClippedBounds(&sc->layers[layer],&b,&clipb);
     for ( img=sc->layers[layer].images; img!=NULL; img=img->next )
 	_ImageFindBounds(img,bounds);
     if ( sc->layers[layer].dostroke ) {
@@ -3085,6 +3242,33 @@ void RefCharFindBounds(RefChar *rf) {
     rf->bb.maxx += extra; rf->bb.maxy += extra;
 }
 
+/* Reads in the outlines of a glyph from a lazily opened font */
+void SCLoadLazy(SplineChar *sc) {
+    struct lazyglyphs *lazy;
+    long pos;
+
+    if ( sc->lazy==NULL )
+return;
+    lazy = sc->parent->lazy;
+    /* We may be called while the font file is still being parsed */
+    pos = ftell(lazy->file);
+    (lazy->load)(sc,lazy);
+    fseek(lazy->file,pos,SEEK_SET);
+    LazyOutlinesFree(sc->lazy);
+    sc->lazy = NULL;
+}
+
+void SFLoadLazyGlyphs(SplineFont *sf) {
+    int i;
+
+    if ( sf->lazy==NULL )
+return;
+    for ( i=0; i<sf->glyphcnt; ++i ) if ( sf->glyphs[i]!=NULL )
+	SCLoadLazy(sf->glyphs[i]);
+    LazyGlyphsFree(sf->lazy);
+    sf->lazy = NULL;
+}
+
 void SCReinstanciateRefChar(SplineChar *sc,RefChar *rf,int layer) {
     SplinePointList *new, *last;
     RefChar *refs;
@@ -3104,6 +3288,7 @@ void SCReinstanciateRefChar(SplineChar *sc,RefChar *rf,int layer) {
     rf->layer_cnt = 0;
     if ( rsc==NULL )
 return;
+    SCLoadLazy(rsc);
     /* Can be called before sc->parent is set, but only when reading a ttf */
     /*  file which won't be multilayer */
     if ( sc->parent!=NULL && sc->parent->multilayer ) {
@@ -5158,7 +5343,7 @@ StemInfo *StemInfoCopy(StemInfo *h) {
 	}
 	cur->where = hilast = NULL;
 	for ( hi=h->where; hi!=NULL; hi=hi->next ) {
-	    hicur = chunkalloc(sizeof(StemInfo));
+	    hicur = chunkalloc(sizeof(HintInstance));
 	    *hicur = *hi;
 	    hicur->next = NULL;
 	    if ( hilast==NULL )
@@ -5188,7 +5373,7 @@ DStemInfo *DStemInfoCopy(DStemInfo *h) {
 	}
 	cur->where = hilast = NULL;
 	for ( hi=h->where; hi!=NULL; hi=hi->next ) {
-	    hicur = chunkalloc(sizeof(StemInfo));
+	    hicur = chunkalloc(sizeof(HintInstance));
 	    *hicur = *hi;
 	    hicur->next = NULL;
 	    if ( hilast==NULL )
@@ -5231,6 +5416,102 @@ void KernPairsFree(KernPair *kp) {
     }
 }
 
+/* Pair kerning is kept in a list on the first glyph of each pair, which is */
+/*  fine for looking up one pair but makes anything that looks up pairs by */
+/*  the thousand (reading a GPOS table or a kerning.plist, autokerning) */
+/*  quadratic. Such code builds one of these open addressing tables over */
+/*  the lists for the duration, and tells it about the pairs it adds */
+struct kernpairentry {
+    SplineChar *first;		/* NULL for an empty slot */
+    KernPair *kp;		/* kp->sc is the second glyph */
+};
+
+struct kernpairindex {
+    struct kernpairentry *table;
+    int size;			/* A power of two */
+    int cnt;
+};
+
+static unsigned int KernPairHash(SplineChar *first,SplineChar *second) {
+    uintptr_t val = ((uintptr_t) first)*31 ^ (uintptr_t) second;
+
+    val ^= val>>17;
+    val *= 0x9e3779b1;
+return( (unsigned int) (val ^ (val>>15)) );
+}
+
+static void KernPairIndexInsert(struct kernpairindex *kpi,SplineChar *first,KernPair *kp) {
+    unsigned int mask = kpi->size-1, pos = KernPairHash(first,kp->sc)&mask;
+
+    while ( kpi->table[pos].first!=NULL ) {
+	if ( kpi->table[pos].first==first && kpi->table[pos].kp->sc==kp->sc )
+return;		/* The list has it twice, a search finds the first */
+	pos = (pos+1)&mask;
+    }
+    kpi->table[pos].first = first;
+    kpi->table[pos].kp = kp;
+    ++kpi->cnt;
+}
+
+static void KernPairIndexGrow(struct kernpairindex *kpi) {
+    struct kernpairentry *old = kpi->table;
+    int i, oldsize = kpi->size;
+
+    kpi->size = oldsize==0 ? 256 : 2*oldsize;
+    kpi->table = calloc(kpi->size,sizeof(struct kernpairentry));
+    kpi->cnt = 0;
+    for ( i=0; i<oldsize; ++i )
+	if ( old[i].first!=NULL )
+	    KernPairIndexInsert(kpi,old[i].first,old[i].kp);
+    free(old);
+}
+
+void KernPairIndexAdd(struct kernpairindex *kpi,SplineChar *first,KernPair *kp) {
+    if ( 2*(kpi->cnt+1)>kpi->size )
+	KernPairIndexGrow(kpi);
+    KernPairIndexInsert(kpi,first,kp);
+}
+
+/* sf may be NULL for an empty index */
+struct kernpairindex *KernPairIndexNew(SplineFont *sf,int isv) {
+    struct kernpairindex *kpi = calloc(1,sizeof(struct kernpairindex));
+    SplineFont *_sf;
+    KernPair *kp;
+    int i, k;
+
+    KernPairIndexGrow(kpi);
+    if ( sf!=NULL ) {
+	k = 0;
+	do {
+	    _sf = sf->subfontcnt==0 ? sf : sf->subfonts[k];
+	    for ( i=0; i<_sf->glyphcnt; ++i ) if ( _sf->glyphs[i]!=NULL ) {
+		for ( kp = isv ? _sf->glyphs[i]->vkerns : _sf->glyphs[i]->kerns; kp!=NULL; kp=kp->next )
+		    KernPairIndexAdd(kpi,_sf->glyphs[i],kp);
+	    }
+	    ++k;
+	} while ( k<sf->subfontcnt );
+    }
+return( kpi );
+}
+
+KernPair *KernPairIndexFind(struct kernpairindex *kpi,SplineChar *first,SplineChar *second) {
+    unsigned int mask = kpi->size-1, pos = KernPairHash(first,second)&mask;
+
+    while ( kpi->table[pos].first!=NULL ) {
+	if ( kpi->table[pos].first==first && kpi->table[pos].kp->sc==second )
+return( kpi->table[pos].kp );
+	pos = (pos+1)&mask;
+    }
+return( NULL );
+}
+
+void KernPairIndexFree(struct kernpairindex *kpi) {
+    if ( kpi==NULL )
+return;
+    free(kpi->table);
+    free(kpi);
+}
+
 static AnchorPoint *AnchorPointsRemoveName(AnchorPoint *alist,AnchorClass *an) {
     AnchorPoint *prev=NULL, *ap, *next;
 
@@ -5990,6 +6271,7 @@ return;
     DeviceTableFree(sc->top_accent_adjusts);
     MathKernFree(sc->mathkern);
     if (sc->glif_name != NULL) { free(sc->glif_name); sc->glif_name = NULL; }
+    LazyOutlinesFree(sc->lazy);
 }
 
 void SplineCharFree(SplineChar *sc) {
@@ -6000,6 +6282,24 @@ return;
     chunkfree(sc,sizeof(SplineChar));
 }
 
+void LazyOutlinesFree(struct lazyoutline *lo) {
+    struct lazyoutline *next;
+
+    for ( ; lo!=NULL; lo = next ) {
+	next = lo->next;
+	chunkfree(lo,sizeof(struct lazyoutline));
+    }
+}
+
+void LazyGlyphsFree(struct lazyglyphs *lazy) {
+
+    if ( lazy==NULL )
+return;
+    if ( lazy->file!=NULL )
+	fclose(lazy->file);
+    chunkfree(lazy,sizeof(struct lazyglyphs));
+}
+
 void AnchorClassesFree(AnchorClass *an) {
     AnchorClass *anext;
     for ( ; an!=NULL; an = anext ) {
@@ -6306,7 +6606,7 @@ EncMap *EncMapNew(int enccount,int backmax,Encoding *enc) {
 	    }
 	    free(map->map);
 	}
-	free(map);
+	chunkfree(map,sizeof(EncMap));
     }
     return( NULL );
 }
@@ -6362,7 +6662,7 @@ EncMap *EncMapCopy(EncMap *map) {
 	    }
 	    free(new->map);
 	}
-	free(new);
+	chunkfree(new,sizeof(EncMap));
      }
     return( NULL );
 }
@@ -6568,6 +6868,7 @@ return;
     free(sf->filename);
     free(sf->origname);
     free(sf->autosavename);
+    free(sf->ufo_dir);
     free(sf->version);
     free(sf->xuid);
     free(sf->cidregistry);
@@ -6614,6 +6915,10 @@ return;
     BaseFree(sf->horiz_base);
     BaseFree(sf->vert_base);
     JustifyFree(sf->justify);
+    LazyGlyphsFree(sf->lazy);
+    AutoHintCacheFree(sf->ahcache);
+    FreeTypeCacheFree(sf->ftcache);
+    SFDirPrintsFree(sf->sfdir_prints);
     if (sf->layers != NULL) {
       int layer;
       for (layer = 0; layer < sf->layer_cnt; layer ++) {
@@ -7942,3 +8247,14 @@ bigreal DistanceBetweenPoints( BasePoint *p1, BasePoint *p2 )
     t = sqrt( t );
     return t;
 }
+
+/* For the fingerprints caches key what they found by. Start with */
+/*  FINGERPRINT_START and feed in each thing the fingerprint depends on */
+uint64_t FingerprintAdd(uint64_t hash,const void *data,int len) {
+    const uint8 *pt = data;
+    int i;
+
+    for ( i=0; i<len; ++i )
+	hash = (hash ^ pt[i]) * 0x100000001b3ULL;	/* FNV-1a */
+return( hash );
+}
@@ -148,8 +148,14 @@ extern void KernClassFreeContents(KernClass *kc);
 extern void KernClassListClearSpecialContents(KernClass *kc);
 extern void KernClassListFree(KernClass *kc);
 extern void KernPairsFree(KernPair *kp);
+extern struct kernpairindex *KernPairIndexNew(SplineFont *sf, int isv);
+extern KernPair *KernPairIndexFind(struct kernpairindex *kpi, SplineChar *first, SplineChar *second);
+extern void KernPairIndexAdd(struct kernpairindex *kpi, SplineChar *first, KernPair *kp);
+extern void KernPairIndexFree(struct kernpairindex *kpi);
 extern void LayerDefault(Layer *layer);
 extern void LayerFreeContents(SplineChar *sc, int layer);
+extern void LazyGlyphsFree(struct lazyglyphs *lazy);
+extern void LazyOutlinesFree(struct lazyoutline *lo);
 extern void LinearApproxFree(LinearApprox *la);
 extern void LineListFree(LineList *ll);
 extern void MacFeatListFree(MacFeat *mf);
@@ -174,11 +180,13 @@ extern void RefCharsFree(RefChar *ref);
 extern void SCCategorizePoints(SplineChar *sc);
 extern void SCMakeDependent(SplineChar *dependent, SplineChar *base);
 extern void SCRefToSplines(SplineChar *sc, RefChar *rf, int layer);
+extern void SCLoadLazy(SplineChar *sc);
 extern void SCReinstanciateRefChar(SplineChar *sc, RefChar *rf, int layer);
 extern void SCRemoveDependent(SplineChar *dependent, RefChar *rf, int layer);
 extern void SCRemoveDependents(SplineChar *dependent);
 extern void SCRemoveLayerDependents(SplineChar *dependent, int layer);
 extern void SFInstanciateRefs(SplineFont *sf);
+extern void SFLoadLazyGlyphs(SplineFont *sf);
 extern void SFReinstanciateRefs(SplineFont *sf);
 extern void SFRemoveAnchorClass(SplineFont *sf, AnchorClass *an);
 extern void SFRemoveSavedTable(SplineFont *sf, uint32 tag);
@@ -212,6 +220,7 @@ extern void SplineSetFindBounds(const SplinePointList *spl, DBounds *bounds);
 extern void SplineSetQuickBounds(SplineSet *ss, DBounds *b);
 extern void SplineSetQuickConservativeBounds(SplineSet *ss, DBounds *b);
 extern void SplineSetSpirosClear(SplineSet *spl);
+extern void SplinesChanged(void);
 extern void TTFLangNamesFree(struct ttflangname *l);
 extern void TtfTablesFree(struct ttf_table *tab);
 extern void ValDevFree(ValDevTab *adjust);
@@ -221,6 +230,9 @@ extern int HashKerningClassNames(SplineFont *sf, struct glif_name_index * class_
 extern int HashKerningClassNamesCaps(SplineFont *sf, struct glif_name_index * class_name_hash);
 extern int HashKerningClassNamesFlex(SplineFont *sf, struct glif_name_index * class_name_hash, int capitalize);
 
+#define FINGERPRINT_START	0xcbf29ce484222325ULL
+extern uint64_t FingerprintAdd(uint64_t hash,const void *data,int len);
+
 // Some useful inline-function-like defines
 #define SPLINE1DPVAL(s, t) ((((s)->a*(t)+(s)->b)*(t)+(s)->c)*(t)+(s)->d)
 #define SPLINEPVAL(s, t) (BasePoint) { SPLINE1DPVAL(&(s)->splines[0], t), SPLINE1DPVAL(&(s)->splines[1], t) }
@@ -315,6 +315,7 @@ return( true );
 	spline->splines[1].a = spline->splines[1].b = 0;
 	spline->splines[1].d = spline->from->me.y;
 	spline->splines[1].c = spline->to->me.y-spline->from->me.y;
+	SplinesChanged();
     }
 return( ret );
 }
@@ -883,7 +884,7 @@ SplineSet *SSRemoveZeroLengthSplines(SplineSet *base) {
 	if ( spl->first->next!=NULL && spl->first->next->to==spl->first &&
 		spl->first->nonextcp && spl->first->noprevcp ) {
 	    /* Turn it into a single point, rather than a zero length contour */
-	    chunkfree(spl->first->next,sizeof(Spline));
+	    SplineFree(spl->first->next);
 	    spl->first->next = spl->first->prev = NULL;
 	}
     }
@@ -35,6 +35,7 @@
 #include "fontforgevw.h"
 #include "gfile.h"
 #include "namelist.h"
+#include "parallel.h"
 #include "psfont.h"
 
 #include <locale.h>
@@ -83,6 +84,7 @@ void InitSimpleStuff(void) {
     if ( *localeinfo.decimal_point=='.' ) coord_sep=",";
     else if ( *localeinfo.decimal_point!='.' ) coord_sep=" ";
     if ( getenv("FF_SCRIPT_IN_LATIN1") ) use_utf8_in_script=false;
+    if ( getenv("FONTFORGE_JOBS") ) ff_parallel_jobs = strtol(getenv("FONTFORGE_JOBS"),NULL,10);
 
     SetDefaults();
 }
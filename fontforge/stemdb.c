@@ -52,14 +52,16 @@ int     hint_diagonal_ends = 0,
 float   stem_slope_error = .05061454830783555773, /*  2.9 degrees */
 	stub_slope_error = .317649923862967983;   /* 18.2 degrees */
 
-static double dist_error_hv = 3.5;
-static double dist_error_diag = 5.5;
+/* Each glyph's gd->dist_error_hv and dist_error_diag are what lines */
+/*  may be off by and still be counted as lines (3.5 and 5.5 in a 1000 */
+/*  unit em) */
 /* It's easy to get horizontal/vertical lines aligned properly */
 /* it is more difficult to get diagonal ones done */
 /* The "A" glyph in Apple's Times.dfont(Roman) is off by 6 in one spot */
-static double dist_error_curve = 22;
-/* The maximum possible distance between the edge of an active zone for */
-/* a curved spline segment and the spline itself */
+/* gd->dist_error_curve (22 in a 1000 unit em) is the maximum possible */
+/* distance between the edge of an active zone for a curved spline */
+/* segment and the spline itself. They are kept in the glyphdata so that */
+/* several glyphs can be worked on at once */
 
 struct st {
     Spline *s;
@@ -177,7 +179,7 @@ return( false );
 return ( in*out < 0 );
 }
 
-static int SplineFigureOpticalSlope(Spline *s,int start_at_from,BasePoint *dir) {
+static int SplineFigureOpticalSlope(struct glyphdata *gd,Spline *s,int start_at_from,BasePoint *dir) {
     /* Sometimes splines have tiny control points, and to the eye the slope */
     /*  of the spline has nothing to do with that specified by the cps. */
     /* So see if the spline is straightish and figure the slope based on */
@@ -222,7 +224,7 @@ return( false );
 	pos.x = ((s->splines[0].a*t+s->splines[0].b)*t+s->splines[0].c)*t+s->splines[0].d;
 	pos.y = ((s->splines[1].a*t+s->splines[1].b)*t+s->splines[1].c)*t+s->splines[1].d;
 	off = (pos.x-base->x)*normal.x + (pos.y-base->y)*normal.y;
-	if ( off<-dist_error_hv || off>dist_error_hv )
+	if ( off<-gd->dist_error_hv || off>gd->dist_error_hv )
 return( false );
 	t += incr;
     }
@@ -303,7 +305,7 @@ return;
 	pd->nextunit.x /= len;
 	pd->nextunit.y /= len;
 	if ( sp->next!=NULL && !sp->next->knownlinear )
-	    SplineFigureOpticalSlope(sp->next,true,&pd->nextunit);
+	    SplineFigureOpticalSlope(gd,sp->next,true,&pd->nextunit);
 	hv = IsUnitHV( &pd->nextunit,true );
 	if ( hv == 2 ) {
 	    pd->nextunit.x = 0; pd->nextunit.y = pd->nextunit.y>0 ? 1 : -1;
@@ -342,7 +344,7 @@ return;
 	pd->prevunit.x /= len;
 	pd->prevunit.y /= len;
 	if ( sp->prev!=NULL && !sp->prev->knownlinear )
-	    SplineFigureOpticalSlope(sp->prev,false,&pd->prevunit);
+	    SplineFigureOpticalSlope(gd,sp->prev,false,&pd->prevunit);
 	hv = IsUnitHV( &pd->prevunit,true );
 	if ( hv == 2 ) {
 	    pd->prevunit.x = 0; pd->prevunit.y = pd->prevunit.y>0 ? 1 : -1;
@@ -1082,7 +1084,7 @@ static struct linedata *BuildLine(struct glyphdata *gd,struct pointdata *pd,int
     
     dir = is_next ? &pd->nextunit : &pd->prevunit;
     is_l = IsCorrectSide( gd,pd,is_next,true,dir );
-    dist_error = ( IsUnitHV( dir,true )) ? dist_error_hv : dist_error_diag ;	/* Diagonals are harder to align */
+    dist_error = ( IsUnitHV( dir,true )) ? gd->dist_error_hv : gd->dist_error_diag ;	/* Diagonals are harder to align */
     if ( dir->x==0 && dir->y==0 )
 return( NULL );
     base = &pd->sp->me;
@@ -1357,7 +1359,7 @@ static void SwapEdges( struct glyphdata *gd,struct stemdata *stem ) {
     }
 }
 
-static int StemFitsHV( struct stemdata *stem,int is_x,uint8 mask ) {
+static int StemFitsHV( struct glyphdata *gd,struct stemdata *stem,int is_x,uint8 mask ) {
     int i,cnt;
     double loff,roff;
     double lmin=0,lmax=0,rmin=0,rmax=0;
@@ -1390,12 +1392,12 @@ return( true );
 	    else if ( roff > rmax ) rmax = roff;
 	}
     }
-    if ((( lmax - lmin ) < 2*dist_error_hv ) && (( rmax - rmin ) < 2*dist_error_hv ))
+    if ((( lmax - lmin ) < 2*gd->dist_error_hv ) && (( rmax - rmin ) < 2*gd->dist_error_hv ))
 return( true );
 return( false );
 }
 
-static int LineFitsHV( struct linedata *line ) {
+static int LineFitsHV( struct glyphdata *gd,struct linedata *line ) {
     int i,cnt,is_x,hv;
     double off,min=0,max=0;
     struct pointdata *pd;
@@ -1418,18 +1420,18 @@ return( false );
 	if ( off < min ) min = off;
 	else if ( off > max ) max = off;
     }
-    if (( max - min ) < 2*dist_error_hv )
+    if (( max - min ) < 2*gd->dist_error_hv )
 return( true );
 return( false );
 }
 
-static int OnStem( struct stemdata *stem,BasePoint *test,int left ) {
+static int OnStem( struct glyphdata *gd,struct stemdata *stem,BasePoint *test,int left ) {
     double dist_error, off;
     BasePoint *dir = &stem->unit;
     double max=0, min=0;
 
     /* Diagonals are harder to align */
-    dist_error = IsUnitHV( dir,true ) ? dist_error_hv : dist_error_diag;
+    dist_error = IsUnitHV( dir,true ) ? gd->dist_error_hv : gd->dist_error_diag;
     if ( !stem->positioned ) dist_error = dist_error * 2;
     if ( dist_error > stem->width/2 ) dist_error = stem->width/2;
     if ( left ) {
@@ -1446,7 +1448,7 @@ return( true );
 return( false );
 }
 
-static int BothOnStem( struct stemdata *stem,BasePoint *test1,BasePoint *test2,
+static int BothOnStem( struct glyphdata *gd,struct stemdata *stem,BasePoint *test1,BasePoint *test2,
     int force_hv,int strict,int cove ) {
     double dist_error, off1, off2;
     BasePoint dir = stem->unit;
@@ -1458,7 +1460,7 @@ static int BothOnStem( struct stemdata *stem,BasePoint *test1,BasePoint *test2,
     if ( force_hv ) {
 	if ( force_hv != hv )
 return( false );
-	if ( !hv_strict && !StemFitsHV( stem,( hv == 1 ),7 ))
+	if ( !hv_strict && !StemFitsHV( gd,stem,( hv == 1 ),7 ))
 return( false );
 	if ( !hv_strict ) {
 	    dir.x = ( force_hv == 2 ) ? 0 : 1;
@@ -1466,7 +1468,7 @@ return( false );
 	}
     }
     /* Diagonals are harder to align */
-    dist_error = ( hv ) ? dist_error_hv : dist_error_diag;
+    dist_error = ( hv ) ? gd->dist_error_hv : gd->dist_error_diag;
     if ( !strict ) {
 	dist_error = dist_error * 2;
 	lmax = stem->lmax; lmin = stem->lmin;
@@ -1503,7 +1505,7 @@ return( true );
 return( false );
 }
 
-static int RecalcStemOffsets( struct stemdata *stem,BasePoint *dir,int left,int right ) {
+static int RecalcStemOffsets( struct glyphdata *gd,struct stemdata *stem,BasePoint *dir,int left,int right ) {
     double off, err;
     double lmin=0, lmax=0, rmin=0, rmax=0;
     struct stem_chunk *chunk;
@@ -1511,7 +1513,7 @@ static int RecalcStemOffsets( struct stemdata *stem,BasePoint *dir,int left,int
     
     if ( !left && !right )
 return( false );
-    err = ( IsUnitHV( dir,true )) ? dist_error_hv : dist_error_diag;
+    err = ( IsUnitHV( dir,true )) ? gd->dist_error_hv : gd->dist_error_diag;
 
     if ( stem->chunk_cnt > 1 ) for ( i=0; i<stem->chunk_cnt; i++ ) {
 	chunk = &stem->chunks[i];
@@ -1536,7 +1538,7 @@ return( true );
 return( false );
 }
 
-static void SetStemUnit( struct stemdata *stem,BasePoint dir ) {
+static void SetStemUnit( struct glyphdata *gd,struct stemdata *stem,BasePoint dir ) {
     double width;
     
     width = ( stem->right.x - stem->left.x ) * dir.y -
@@ -1559,7 +1561,7 @@ static void SetStemUnit( struct stemdata *stem,BasePoint dir ) {
     }
     
     /* Recalculate left/right offsets relatively to new vectors */
-    RecalcStemOffsets( stem,&dir,true,true );
+    RecalcStemOffsets( gd,stem,&dir,true,true );
 }
 
 static struct stem_chunk *AddToStem( struct glyphdata *gd,struct stemdata *stem,
@@ -1578,7 +1580,7 @@ static struct stem_chunk *AddToStem( struct glyphdata *gd,struct stemdata *stem,
 
     if ( cheat || stem->positioned ) is_potential2 = false;
     /* Diagonals are harder to align */
-    dist_error = IsUnitHV( dir,true ) ? 2*dist_error_hv : 2*dist_error_diag;
+    dist_error = IsUnitHV( dir,true ) ? 2*gd->dist_error_hv : 2*gd->dist_error_diag;
     if ( dist_error > stem->width/2 ) dist_error = stem->width/2;
     max = stem->lmax;
     min = stem->lmin;
@@ -1655,7 +1657,7 @@ static struct stem_chunk *AddToStem( struct glyphdata *gd,struct stemdata *stem,
 	    if ( gd->order2 && !pd1->sp->nonextcp && pd1->sp->nextcpindex < gd->realcnt ) {
 		cpidx = pd1->sp->nextcpindex;
 		npd = &gd->points[cpidx];
-		if ( OnStem( stem,&npd->base,true ))
+		if ( OnStem( gd,stem,&npd->base,true ))
 		    AssignStemToPoint( npd,stem,false,true );
 	    }
 	}
@@ -1665,7 +1667,7 @@ static struct stem_chunk *AddToStem( struct glyphdata *gd,struct stemdata *stem,
 		pd1->sp->prev->from->nextcpindex < gd->realcnt ) {
 		cpidx = pd1->sp->prev->from->nextcpindex;
 		ppd = &gd->points[cpidx];
-		if ( OnStem( stem,&ppd->base,true ))
+		if ( OnStem( gd,stem,&ppd->base,true ))
 		    AssignStemToPoint( ppd,stem,true,true );
 	    }
 	}
@@ -1678,7 +1680,7 @@ static struct stem_chunk *AddToStem( struct glyphdata *gd,struct stemdata *stem,
 	    if ( gd->order2 && !pd2->sp->nonextcp && pd2->sp->nextcpindex < gd->realcnt ) {
 		cpidx = pd2->sp->nextcpindex;
 		npd = &gd->points[cpidx];
-		if ( OnStem( stem,&npd->base,false ))
+		if ( OnStem( gd,stem,&npd->base,false ))
 		    AssignStemToPoint( npd,stem,false,false );
 	    }
 	}
@@ -1688,7 +1690,7 @@ static struct stem_chunk *AddToStem( struct glyphdata *gd,struct stemdata *stem,
 		pd2->sp->prev->from->nextcpindex < gd->realcnt ) {
 		cpidx = pd2->sp->prev->from->nextcpindex;
 		ppd = &gd->points[cpidx];
-		if ( OnStem( stem,&ppd->base,false ))
+		if ( OnStem( gd,stem,&ppd->base,false ))
 		    AssignStemToPoint( ppd,stem,true,false );
 	    }
 	}
@@ -1717,7 +1719,7 @@ static struct stemdata *FindStem( struct glyphdata *gd,struct pointdata *pd,
 	test_left = ( is_next2 ) ? !pd2->next_is_l[i] : !pd2->prev_is_l[i];
 
 	if (UnitsParallel( &stem->unit,dir,true ) && 
-	    OnStem( stem,&pd->sp->me,test_left ))
+	    OnStem( gd,stem,&pd->sp->me,test_left ))
 return( stem );
     }
 
@@ -1735,7 +1737,7 @@ return( stem );
     continue;
 
 	if ( UnitsParallel( &stem->unit,dir,true ) &&
-	    BothOnStem( stem,&pd->sp->me,&pd2->sp->me,false,true,cove )) {
+	    BothOnStem( gd,stem,&pd->sp->me,&pd2->sp->me,false,true,cove )) {
  return( stem );
 	}
     }
@@ -1746,7 +1748,7 @@ return( stem );
     continue;
 
 	if ( UnitsParallel( &stem->unit,dir,true ) &&
-	    BothOnStem( stem,&pd->sp->me,&pd2->sp->me,false,false,cove )) {
+	    BothOnStem( gd,stem,&pd->sp->me,&pd2->sp->me,false,false,cove )) {
 return( stem );
 	}
     }
@@ -1761,13 +1763,13 @@ return( NULL );
 	stem = &gd->stems[i];
 	if ( stem->ghost || stem->bbox )
     continue;
-	if ( hv && BothOnStem( stem,&pd->base,&pd2->base,hv,false,cove )) {
+	if ( hv && BothOnStem( gd,stem,&pd->base,&pd2->base,hv,false,cove )) {
 	    newdir.x = ( hv == 2 ) ? 0 : 1;
 	    newdir.y = ( hv == 2 ) ? 1 : 0;
 	    if ( hv == 2 && stem->unit.y < 0 )
 		SwapEdges( gd,stem );
 	    if ( stem->unit.x != newdir.x )
-		SetStemUnit( stem,newdir );
+		SetStemUnit( gd,stem,newdir );
 return( stem );
 	}
     }
@@ -1877,7 +1879,7 @@ static struct stemdata *FindOrMakeHVStem( struct glyphdata *gd,
     for ( i=0; i<gd->stemcnt; ++i ) {
 	stem = &gd->stems[i];
 	if ( IsUnitHV( &stem->unit,true ) &&
-	    ( pd2 != NULL && BothOnStem( stem,&pd->sp->me,&pd2->sp->me,false,false,cove )))
+	    ( pd2 != NULL && BothOnStem( gd,stem,&pd->sp->me,&pd2->sp->me,false,false,cove )))
     break;
     }
     if ( i==gd->stemcnt ) stem=NULL;
@@ -1907,10 +1909,10 @@ return( false );
     /* Both key points of a diagonal end stem should have nearly the same */
     /* coordinate by x or y (otherwise we can't determine by which axis   */
     /* it should be hinted) */
-    if ( pt1->x >= pt2->x - dist_error_hv &&  pt1->x <= pt2->x + dist_error_hv ) {
+    if ( pt1->x >= pt2->x - gd->dist_error_hv &&  pt1->x <= pt2->x + gd->dist_error_hv ) {
 	width = pd1->sp->me.y - pd2->sp->me.y;
 	hv = 1;
-    } else if ( pt1->y >= pt2->y - dist_error_hv &&  pt1->y <= pt2->y + dist_error_hv ) {
+    } else if ( pt1->y >= pt2->y - gd->dist_error_hv &&  pt1->y <= pt2->y + gd->dist_error_hv ) {
 	width = pd1->sp->me.x - pd2->sp->me.x;
 	hv = 2;
     } else
@@ -1946,7 +1948,7 @@ return( false );
     dist2 = ( hv == 1 ) ? prevsp2->me.y - pt2->y : prevsp2->me.x - pt2->x;
     if ( dist1 < 0 ) dist1 = -dist1;
     if ( dist2 < 0 ) dist2 = -dist2;
-    if ( dist1 < 2*dist_error_hv && dist2 < 2*dist_error_hv )
+    if ( dist1 < 2*gd->dist_error_hv && dist2 < 2*gd->dist_error_hv )
 return( false );
 
 return( hv );
@@ -2016,7 +2018,7 @@ return( NULL );         /* Cannot make a stem if edges are not parallel (unless
 	    /* if that line also has an exactly HV vector */
 	    if ( line != NULL && (( !hv &&
 		UnitsParallel( &stem->unit,&line->unit,true ) && 
-		RecalcStemOffsets( stem,&line->unit,true,true )) || 
+		RecalcStemOffsets( gd,stem,&line->unit,true,true )) || 
 		( hv && line->unit.x == stem->unit.x && line->unit.y == stem->unit.y ))) {
 		
 		otherline = NULL; l_changed = false;
@@ -2037,11 +2039,11 @@ return( NULL );         /* Cannot make a stem if edges are not parallel (unless
 		/* then prefer the longer line */
 		if ( !hv && l_changed && !stem->positioned && 
 		    ( otherline == NULL || ( otherline->length < line->length )))
-		    SetStemUnit( stem,line->unit );
+		    SetStemUnit( gd,stem,line->unit );
 	    }
 	    if ( line2 != NULL && (( !hv &&
 		UnitsParallel( &stem->unit,&line2->unit,true ) && 
-		RecalcStemOffsets( stem,&line2->unit,true,true )) || 
+		RecalcStemOffsets( gd,stem,&line2->unit,true,true )) || 
 		( hv && line2->unit.x == stem->unit.x && line2->unit.y == stem->unit.y ))) {
 		
 		otherline = NULL; l_changed = false;
@@ -2060,7 +2062,7 @@ return( NULL );         /* Cannot make a stem if edges are not parallel (unless
 		}
 		if ( !hv && l_changed && !stem->positioned && 
 		    ( otherline == NULL || ( otherline->length < line2->length )))
-		    SetStemUnit( stem,line2->unit );
+		    SetStemUnit( gd,stem,line2->unit );
 	    }
 	}
     }
@@ -2119,12 +2121,12 @@ static int HalfStemNoOpposite( struct glyphdata *gd,struct pointdata *pd,
 	corner = (( pd->x_corner && hv == 2 ) || ( pd->y_corner && hv == 1 ));
 
 	if ( UnitsParallel( &tstem->unit,dir,true ) || tstem->ghost || corner ) {
-	    if ( OnStem( tstem,&pd->sp->me,true ) && allowleft ) {
+	    if ( OnStem( gd,tstem,&pd->sp->me,true ) && allowleft ) {
 		if ( IsCorrectSide( gd,pd,is_next,true,&tstem->unit )) {
 		    AddToStem( gd,tstem,pd,NULL,is_next,false,false );
 		    ret++;
 		}
-	    } else if ( OnStem( tstem,&pd->sp->me,false ) && allowright ) {
+	    } else if ( OnStem( gd,tstem,&pd->sp->me,false ) && allowright ) {
 		if ( IsCorrectSide( gd,pd,is_next,false,&tstem->unit )) {
 		    AddToStem( gd,tstem,NULL,pd,false,is_next,false );
 		    ret++;
@@ -2196,7 +2198,7 @@ return( NULL );		/* Zero width stems aren't interesting */
     for ( i=0; i<gd->stemcnt; ++i ) {
 	tstem = &gd->stems[i];
 	if ( UnitsParallel( &tstem->unit,dir,true ) && 
-	    BothOnStem( tstem,&pd->base,&match,false,false,false )) {
+	    BothOnStem( gd,tstem,&pd->base,&match,false,false,false )) {
 	    stem = tstem;
     break;
 	}
@@ -2444,18 +2446,18 @@ static void AssignLinePointsToStems( struct glyphdata *gd ) {
 	
 	if ( stem->leftline != NULL ) {
 	    line = stem->leftline;
-	    line_hv = ( needs_hv && LineFitsHV( line ));
+	    line_hv = ( needs_hv && LineFitsHV( gd,line ));
 
 	    if ( needs_hv && !line_hv )
 		stem->leftline = NULL;
 	    else {
 		for ( j=0; j<line->pcnt; j++ ) {
 		    pd = line->points[j];
-		    if ( pd->prevline == line && OnStem( stem,&pd->base,true ) &&
+		    if ( pd->prevline == line && OnStem( gd,stem,&pd->base,true ) &&
 			IsStemAssignedToPoint( pd,stem,false ) == -1) {
 			chunk = AddToStem( gd,stem,pd,NULL,false,false,false );
 			chunk->lpotential = true;
-		    } if ( pd->nextline == line && OnStem( stem,&pd->base,true ) &&
+		    } if ( pd->nextline == line && OnStem( gd,stem,&pd->base,true ) &&
 			IsStemAssignedToPoint( pd,stem,true ) == -1 ) {
 			chunk = AddToStem( gd,stem,pd,NULL,true,false,false );
 			chunk->lpotential = true;
@@ -2465,18 +2467,18 @@ static void AssignLinePointsToStems( struct glyphdata *gd ) {
 	}
 	if ( stem->rightline != NULL ) {
 	    line = stem->rightline;
-	    line_hv = ( needs_hv && LineFitsHV( line ));
+	    line_hv = ( needs_hv && LineFitsHV( gd,line ));
 
 	    if ( needs_hv && !line_hv )
 		stem->rightline = NULL;
 	    else {
 		for ( j=0; j<line->pcnt; j++ ) {
 		    pd = line->points[j];
-		    if ( pd->prevline == line && OnStem( stem,&pd->base,false ) &&
+		    if ( pd->prevline == line && OnStem( gd,stem,&pd->base,false ) &&
 			IsStemAssignedToPoint( pd,stem,false ) == -1 ) {
 			chunk = AddToStem( gd,stem,NULL,pd,false,false,false );
 			chunk->rpotential = true;
-		    } if ( pd->nextline == line && OnStem( stem,&pd->base,false ) &&
+		    } if ( pd->nextline == line && OnStem( gd,stem,&pd->base,false ) &&
 			IsStemAssignedToPoint( pd,stem,true ) == -1 ) {
 			chunk = AddToStem( gd,stem,NULL,pd,false,true,false );
 			chunk->rpotential = true;
@@ -2942,14 +2944,14 @@ static int StemIsActiveAt( struct glyphdata *gd,struct stemdata *stem,double ste
 	MonotonicFindAt(gd->ms,which,((real *) &pos.x)[which],space = gd->space);
 	test = ((real *) &pos.x)[!which];
 
-	lmin = ( stem->lmax - 2*dist_error_hv < -dist_error_hv ) ? 
-	    stem->lmax - 2*dist_error_hv : -dist_error_hv;
-	lmax = ( stem->lmin + 2*dist_error_hv > dist_error_hv ) ? 
-	    stem->lmin + 2*dist_error_hv : dist_error_hv;
-	rmin = ( stem->rmax - 2*dist_error_hv < -dist_error_hv ) ? 
-	    stem->rmax - 2*dist_error_hv : -dist_error_hv;
-	rmax = ( stem->rmin + 2*dist_error_hv > dist_error_hv ) ? 
-	    stem->rmin + 2*dist_error_hv : dist_error_hv;
+	lmin = ( stem->lmax - 2*gd->dist_error_hv < -gd->dist_error_hv ) ? 
+	    stem->lmax - 2*gd->dist_error_hv : -gd->dist_error_hv;
+	lmax = ( stem->lmin + 2*gd->dist_error_hv > gd->dist_error_hv ) ? 
+	    stem->lmin + 2*gd->dist_error_hv : gd->dist_error_hv;
+	rmin = ( stem->rmax - 2*gd->dist_error_hv < -gd->dist_error_hv ) ? 
+	    stem->rmax - 2*gd->dist_error_hv : -gd->dist_error_hv;
+	rmax = ( stem->rmin + 2*gd->dist_error_hv > gd->dist_error_hv ) ? 
+	    stem->rmin + 2*gd->dist_error_hv : gd->dist_error_hv;
 	minoff = test + ( lmin * stem->unit.y - lmax * stem->unit.x );
 	maxoff = test + ( lmax * stem->unit.y - lmin * stem->unit.x );
 
@@ -2987,7 +2989,7 @@ return( false );
 return( true );
 return( false );
     } else {
-return( StillStem( gd,dist_error_diag,&pos,stem ));
+return( StillStem( gd,gd->dist_error_diag,&pos,stem ));
     }
 }
 
@@ -3006,7 +3008,7 @@ static int WalkSpline( struct glyphdata *gd, struct pointdata *pd,int gonext,
     SplinePoint *sp, *nsp;
     struct pointdata *npd;
 
-    err = ( IsUnitHV( &stem->unit,true )) ? dist_error_hv : dist_error_diag;
+    err = ( IsUnitHV( &stem->unit,true )) ? gd->dist_error_hv : gd->dist_error_diag;
     width = stem->width;
     ratio = gd->emsize/( 6 * width );
     if ( err > width/2) err = width/2;
@@ -3046,8 +3048,8 @@ static int WalkSpline( struct glyphdata *gd, struct pointdata *pd,int gonext,
     /* with control point coordinates, because it takes into account just the */
     /* spline configuration rather than point positions */
     if ( curved ) {
-	max = err = dist_error_curve;
-	min = -dist_error_curve;
+	max = err = gd->dist_error_curve;
+	min = -gd->dist_error_curve;
 	/* The following statement forces our code to detect an active zone */
 	/* even if all checks actually fail. This makes sense for stems */
 	/* marking arks and bends */
@@ -3100,14 +3102,14 @@ static int WalkSpline( struct glyphdata *gd, struct pointdata *pd,int gonext,
 return( curved );
 }
 
-static int AdjustForImperfectSlopeMatch( SplinePoint *sp,BasePoint *pos,
+static int AdjustForImperfectSlopeMatch( struct glyphdata *gd,SplinePoint *sp,BasePoint *pos,
     BasePoint *newpos,struct stemdata *stem,int is_l ) {
    
     double poff, err, min, max;
     BasePoint *base;
     
     base = ( is_l ) ? &stem->left : &stem->right;
-    err = ( IsUnitHV( &stem->unit,true )) ? dist_error_hv : dist_error_diag;
+    err = ( IsUnitHV( &stem->unit,true )) ? gd->dist_error_hv : gd->dist_error_diag;
     min = ( is_l ) ? stem->lmax - 2*err : stem->rmax - 2*err;
     max = ( is_l ) ? stem->lmin + 2*err : stem->rmin + 2*err;
     
@@ -3178,7 +3180,7 @@ return( cnt );
 	    end = &etemp;
 	} else if ( par || corner )  {
 	    nsp = sp->next->to;
-	    ecurved = AdjustForImperfectSlopeMatch( sp,&nsp->me,&etemp,stem,is_l );
+	    ecurved = AdjustForImperfectSlopeMatch( gd,sp,&nsp->me,&etemp,stem,is_l );
 	    end = &etemp;
 	}
     }
@@ -3192,7 +3194,7 @@ return( cnt );
 	    start = &stemp;
 	} else if ( par || corner ) {
 	    psp = sp->prev->from;
-	    scurved = AdjustForImperfectSlopeMatch( sp,&psp->me,&stemp,stem,is_l );
+	    scurved = AdjustForImperfectSlopeMatch( gd,sp,&psp->me,&stemp,stem,is_l );
 	    start = &stemp;
 	}
     }
@@ -3450,7 +3452,7 @@ static void FigureStemActive( struct glyphdata *gd, struct stemdata *stem ) {
 #endif
 
     err = ( stem->unit.x == 0 || stem->unit.y == 0 ) ?
-	dist_error_hv : dist_error_diag;
+	gd->dist_error_hv : gd->dist_error_diag;
     lmin = ( stem->lmin < -err ) ? stem->lmin : -err;
     rmax = ( stem->rmax > err ) ? stem->rmax : err;
     acnt = 0;
@@ -3481,6 +3483,9 @@ static void FigureStemActive( struct glyphdata *gd, struct stemdata *stem ) {
 	    if ( bothspace[bpos].curved || pcnt==0 ) {
 		activespace[acnt++] = bothspace[bpos++];
 	    } else {
+		/* Only what is set below may be read back, whatever was */
+		/*  left in activespace must not count */
+		memset(&activespace[acnt],0,sizeof(struct segment));
 		last = bothspace[bpos].start;
 		startset = false; endset = false;
 
@@ -3511,7 +3516,8 @@ static void FigureStemActive( struct glyphdata *gd, struct stemdata *stem ) {
 		while ( i<pcnt && (
 		    ( !bothspace[bpos].ecurved && pspace[i]->projection<bothspace[bpos].end ) ||
 		    ( bothspace[bpos].ecurved && pspace[i]->projection<=bothspace[bpos].ebase ))) {
-		    if ( last==activespace[acnt].start && pspace[i]->projection >= last ) {
+		    if ( startset && !endset && last==activespace[acnt].start &&
+			    pspace[i]->projection >= last ) {
 
 			if ( !StemIsActiveAt( gd,stem,last+(( 1.001*pspace[i]->projection-last )/2.001 ))) {
 			    last = activespace[acnt].start = pspace[i]->projection;
@@ -3523,13 +3529,16 @@ static void FigureStemActive( struct glyphdata *gd, struct stemdata *stem ) {
 			    activespace[acnt].curved = false;
 			    endset = true;
 			}
-		    } else if (( last==activespace[acnt].end || !startset )
+		    } else if ((( endset && last==activespace[acnt].end ) || !startset )
 			&& pspace[i]->projection >= last) {
 			
 			if ( !StemIsActiveAt( gd,stem,last+(( 1.001*pspace[i]->projection-last )/2.001 )) || 
 			    !startset ) {
 			    
-			    if ( startset ) acnt++;
+			    if ( startset ) {
+				acnt++;
+				memset(&activespace[acnt],0,sizeof(struct segment));
+			    }
 			    last = activespace[acnt].start = pspace[i]->projection;
 			    activespace[acnt].scurved = false;
 			    startset = true; endset = false;
@@ -3588,6 +3597,7 @@ static void FigureStemActive( struct glyphdata *gd, struct stemdata *stem ) {
 		ptemp = proj2; proj2 = proj3; proj3 = ptemp;
 	    }
 	    
+	    memset(&activespace[acnt],0,sizeof(struct segment));
 	    if ( (proj3-proj2) < width ) {
 		activespace[acnt  ].curved = true;
 		proj2 -= width/2;
@@ -3613,6 +3623,7 @@ static void FigureStemActive( struct glyphdata *gd, struct stemdata *stem ) {
 		proj -= width/2;
 	    else if ( len<0 )
 		proj -= width;
+	    memset(&activespace[acnt],0,sizeof(struct segment));
 	    activespace[acnt].curved = true;
 	    activespace[acnt].start = proj;
 	    activespace[acnt].end = proj+width;
@@ -3709,13 +3720,13 @@ static void GDNormalizeStubs( struct glyphdata *gd ) {
 	
 	if ( !IsUnitHV( &stem->unit,true )) {
 	    hv = IsUnitHV( &stem->unit,false );
-	    if ( hv && StemFitsHV( stem,( hv == 1 ),3 )) {
+	    if ( hv && StemFitsHV( gd,stem,( hv == 1 ),3 )) {
 		if ( hv == 2 && stem->unit.y < 0 )
 		    SwapEdges( gd,stem );
 
 		newdir.x = fabs( rint( stem->unit.x ));
 		newdir.y = fabs( rint( stem->unit.y ));
-		SetStemUnit( stem,newdir );
+		SetStemUnit( gd,stem,newdir );
 		
 		for ( j=0; j<stem->chunk_cnt && stem->leftidx == -1 && stem->rightidx == -1; j++ ) {
 		    chunk = &stem->chunks[j];
@@ -3769,7 +3780,7 @@ static void GDFindUnlikelyStems( struct glyphdata *gd ) {
 	width = stem->width;
 
 	if ( IsUnitHV( &stem->unit,true ) && stem->activecnt == 1 && 
-	    stem->active[0].curved && width/2 > dist_error_curve ) {
+	    stem->active[0].curved && width/2 > gd->dist_error_curve ) {
 	    
 	    for ( j=0; j<gd->stemcnt; ++j) {
 		stem1 = &gd->stems[j];
@@ -3779,7 +3790,7 @@ static void GDFindUnlikelyStems( struct glyphdata *gd ) {
 	    }
 
 	    if ( j == gd->stemcnt ) {
-		minl = sqrt( pow( width/2,2 ) - pow( width/2 - dist_error_curve,2 ));
+		minl = sqrt( pow( width/2,2 ) - pow( width/2 - gd->dist_error_curve,2 ));
 		if ( stem->clen >= minl ) stem->toobig = false;
 	    }
 	}
@@ -4053,8 +4064,8 @@ static void FindRefPointsNew( struct glyphdata *gd,struct stemdata *stem ) {
 	    chunk->l->value = lval+1;
 
 	    if ( lval == 0 &&
-		( stem->lmin - ( pos - lpos ) > -dist_error_hv ) &&
-		( stem->lmax - ( pos - lpos ) < dist_error_hv ))
+		( stem->lmin - ( pos - lpos ) > -gd->dist_error_hv ) &&
+		( stem->lmax - ( pos - lpos ) < gd->dist_error_hv ))
 		chunk->l->value++;
 	}
 
@@ -4082,8 +4093,8 @@ static void FindRefPointsNew( struct glyphdata *gd,struct stemdata *stem ) {
 	    chunk->r->value = rval+1;
 
 	    if ( rval == 0 &&
-		( stem->rmin - ( pos - rpos ) > -dist_error_hv ) &&
-		( stem->rmax - ( pos - rpos ) < dist_error_hv ))
+		( stem->rmin - ( pos - rpos ) > -gd->dist_error_hv ) &&
+		( stem->rmax - ( pos - rpos ) < gd->dist_error_hv ))
 		chunk->r->value++;
 	}
     }
@@ -4231,7 +4242,7 @@ static void NormalizeStem( struct glyphdata *gd,struct stemdata *stem ) {
 			    ( chunk->r->sp->me.y - stem->right.y )*stem->l_to_r.y;
 		    stem->left = chunk->l->sp->me;
 		    stem->right = chunk->r->sp->me;
-		    RecalcStemOffsets( stem,&stem->unit,loff != 0,roff != 0 );
+		    RecalcStemOffsets( gd,stem,&stem->unit,loff != 0,roff != 0 );
 	break;
 		}
 	    }
@@ -4253,7 +4264,7 @@ static void NormalizeStem( struct glyphdata *gd,struct stemdata *stem ) {
 		rset = true;
 	    }
 	    if ( lset && rset ) {
-		RecalcStemOffsets( stem,&stem->unit,loff != 0,roff != 0 );
+		RecalcStemOffsets( gd,stem,&stem->unit,loff != 0,roff != 0 );
 	break;
 	    }
 	}
@@ -4279,10 +4290,10 @@ static void AssignPointsToBBoxHint( struct glyphdata *gd,DBounds *bounds,
 	min = ( is_v ) ? bounds->minx : bounds->miny;
 	max = ( is_v ) ? bounds->maxx : bounds->maxy;
 	test = ( is_v ) ? pd->base.x : pd->base.y;
-	if ( test >= min && test < min + dist_error_hv && (
+	if ( test >= min && test < min + gd->dist_error_hv && (
 	    IsCorrectSide( gd,pd,true,is_v,&dir ) || IsCorrectSide( gd,pd,false,is_v,&dir )))
 	    lpoints[lcnt++] = pd->sp;
-	else if ( test > max - dist_error_hv && test <= max && (
+	else if ( test > max - gd->dist_error_hv && test <= max && (
 	    IsCorrectSide( gd,pd,true,!is_v,&dir ) || IsCorrectSide( gd,pd,false,!is_v,&dir )))
 	    rpoints[rcnt++] = pd->sp;
     }
@@ -4387,10 +4398,10 @@ static struct stemdata *FindOrMakeGhostStem( struct glyphdata *gd,
 	/* we don't occasionally assign an additional point to a stem which   */
 	/* has already been rejected in favor of another stem */
 	} else if ( tstem->blue == blue && !tstem->ghost && !tstem->toobig ) {
-	    min = ( width == 20 ) ? tstem->left.y - tstem->lmin - 2*dist_error_hv :
-				    tstem->right.y - tstem->rmin - 2*dist_error_hv;
-	    max = ( width == 20 ) ? tstem->left.y - tstem->lmax + 2*dist_error_hv :
-				    tstem->right.y - tstem->rmax + 2*dist_error_hv;
+	    min = ( width == 20 ) ? tstem->left.y - tstem->lmin - 2*gd->dist_error_hv :
+				    tstem->right.y - tstem->rmin - 2*gd->dist_error_hv;
+	    max = ( width == 20 ) ? tstem->left.y - tstem->lmax + 2*gd->dist_error_hv :
+				    tstem->right.y - tstem->rmax + 2*gd->dist_error_hv;
 	    
 	    if ( sp->me.y <= min || sp->me.y >= max )
     continue;
@@ -4659,7 +4670,7 @@ return;
     for ( i=0; i<gd->stemcnt; i++ ) {
 	stem = &gd->stems[i];
 	if (!stem->toobig && UnitsParallel( &unit,&stem->unit,true ) && 
-	    OnStem( stem,&pd->sp->me,is_l ))
+	    OnStem( gd,stem,&pd->sp->me,is_l ))
     break;
     }
     if ( i == gd->stemcnt ) {
@@ -4683,16 +4694,16 @@ static void MarkDStemCorners( struct glyphdata *gd ) {
 	echunk = &stem->chunks[stem->chunk_cnt - 1];
 	
 	if ( schunk->l != NULL && schunk->r != NULL && 
-	    fabs( schunk->l->base.x - schunk->r->base.x ) > dist_error_hv &&
-            fabs( schunk->l->base.y - schunk->r->base.y ) > dist_error_hv && (
+	    fabs( schunk->l->base.x - schunk->r->base.x ) > gd->dist_error_hv &&
+            fabs( schunk->l->base.y - schunk->r->base.y ) > gd->dist_error_hv && (
 	    ( schunk->l->x_corner == 1 && schunk->r->y_corner == 1 ) ||
 	    ( schunk->l->y_corner == 1 && schunk->r->x_corner == 1 ))) {
 	    MarkDStemCorner( gd,schunk->l );
 	    MarkDStemCorner( gd,schunk->r );
 	}
 	if ( echunk->l != NULL && echunk->r != NULL &&
-	    fabs( echunk->l->base.x - echunk->r->base.x ) > dist_error_hv &&
-            fabs( echunk->l->base.y - echunk->r->base.y ) > dist_error_hv && (
+	    fabs( echunk->l->base.x - echunk->r->base.x ) > gd->dist_error_hv &&
+            fabs( echunk->l->base.y - echunk->r->base.y ) > gd->dist_error_hv && (
 	    ( echunk->l->x_corner == 1 && echunk->r->y_corner == 1 ) ||
 	    ( echunk->l->y_corner == 1 && echunk->r->x_corner == 1 ))) {
 	    MarkDStemCorner( gd,echunk->l );
@@ -4919,11 +4930,11 @@ static void _StemInfoToStemData( struct glyphdata *gd,StemInfo *si,DBounds *boun
 	stem = NewStem( gd,&dir,&left,&right );
 	stem->ghost = si->ghost;
 	if (( is_v && 
-		left.x >= bounds->minx && left.x < bounds->minx + dist_error_hv &&
-		right.x > bounds->maxx - dist_error_hv && right.x <= bounds->maxx ) ||
+		left.x >= bounds->minx && left.x < bounds->minx + gd->dist_error_hv &&
+		right.x > bounds->maxx - gd->dist_error_hv && right.x <= bounds->maxx ) ||
 	    ( !is_v && 
-		right.y >= bounds->miny && right.y < bounds->miny + dist_error_hv &&
-		left.y > bounds->maxy - dist_error_hv && left.y <= bounds->maxy ))
+		right.y >= bounds->miny && right.y < bounds->miny + gd->dist_error_hv &&
+		left.y > bounds->maxy - gd->dist_error_hv && left.y <= bounds->maxy ))
 	    stem->bbox = true;
 	stem->positioned = true;
 	si = si->next;
@@ -5031,7 +5042,7 @@ return( edist < sdist );
 return( emaster->clen > smaster->clen );
 }
 
-static void LookForMasterHVStem( struct stemdata *stem,BlueData *bd ) {
+static void LookForMasterHVStem( struct glyphdata *gd,struct stemdata *stem,BlueData *bd ) {
     struct stemdata *tstem, *smaster=NULL, *emaster=NULL;
     struct stembundle *bundle = stem->bundle;
     double start, end, tstart, tend;
@@ -5042,16 +5053,16 @@ static void LookForMasterHVStem( struct stemdata *stem,BlueData *bd ) {
     is_x = ( bundle->unit.x == 1 );
     if ( is_x ) {
 	start = stem->right.y; end = stem->left.y;
-	smin = start - stem->rmin - 2*dist_error_hv;
-	smax = start - stem->rmax + 2*dist_error_hv;
-	emin = end - stem->lmin - 2*dist_error_hv;
-	emax = end - stem->lmax + 2* dist_error_hv;
+	smin = start - stem->rmin - 2*gd->dist_error_hv;
+	smax = start - stem->rmax + 2*gd->dist_error_hv;
+	emin = end - stem->lmin - 2*gd->dist_error_hv;
+	emax = end - stem->lmax + 2* gd->dist_error_hv;
     } else {
 	start = stem->left.x; end = stem->right.x;
-	smin = start + stem->lmax - 2*dist_error_hv;
-	smax = start + stem->lmin + 2*dist_error_hv;
-	emin = end + stem->rmax - 2*dist_error_hv;
-	emax = end + stem->rmin + 2*dist_error_hv;
+	smin = start + stem->lmax - 2*gd->dist_error_hv;
+	smax = start + stem->lmin + 2*gd->dist_error_hv;
+	emin = end + stem->rmax - 2*gd->dist_error_hv;
+	emax = end + stem->rmin + 2*gd->dist_error_hv;
     }
     start = ( is_x ) ? stem->right.y : stem->left.x;
     end = ( is_x ) ? stem->left.y : stem->right.x;
@@ -5061,16 +5072,16 @@ static void LookForMasterHVStem( struct stemdata *stem,BlueData *bd ) {
 	tstem = bundle->stemlist[i];
 	if ( is_x ) {
 	    tstart = tstem->right.y; tend = tstem->left.y;
-	    tsmin = tstart - tstem->rmin - 2*dist_error_hv;
-	    tsmax = tstart - tstem->rmax + 2*dist_error_hv;
-	    temin = tend - tstem->lmin - 2*dist_error_hv;
-	    temax = tend - tstem->lmax + 2* dist_error_hv;
+	    tsmin = tstart - tstem->rmin - 2*gd->dist_error_hv;
+	    tsmax = tstart - tstem->rmax + 2*gd->dist_error_hv;
+	    temin = tend - tstem->lmin - 2*gd->dist_error_hv;
+	    temax = tend - tstem->lmax + 2* gd->dist_error_hv;
 	} else {
 	    tstart = tstem->left.x; tend = tstem->right.x;
-	    tsmin = tstart + tstem->lmax - 2*dist_error_hv;
-	    tsmax = tstart + tstem->lmin + 2*dist_error_hv;
-	    temin = tend + tstem->rmax - 2*dist_error_hv;
-	    temax = tend + tstem->rmin + 2*dist_error_hv;
+	    tsmin = tstart + tstem->lmax - 2*gd->dist_error_hv;
+	    tsmax = tstart + tstem->lmin + 2*gd->dist_error_hv;
+	    temin = tend + tstem->rmax - 2*gd->dist_error_hv;
+	    temax = tend + tstem->rmin + 2*gd->dist_error_hv;
 	}
 	tstart = ( is_x ) ? tstem->right.y : tstem->left.x;
 	tend = ( is_x ) ? tstem->left.y : tstem->right.x;
@@ -5391,11 +5402,11 @@ static void GDBundleStems( struct glyphdata *gd, int maxtoobig, int needs_deps )
     if ( !needs_deps )
 return;
     for ( i=0; i<gd->hbundle->cnt; i++ )
-	LookForMasterHVStem( gd->hbundle->stemlist[i],&gd->bd );
+	LookForMasterHVStem( gd,gd->hbundle->stemlist[i],&gd->bd );
     for ( i=0; i<gd->hbundle->cnt; i++ )
 	ClearUnneededDeps( gd->hbundle->stemlist[i] );
     for ( i=0; i<gd->vbundle->cnt; i++ )
-	LookForMasterHVStem( gd->vbundle->stemlist[i],&gd->bd );
+	LookForMasterHVStem( gd,gd->vbundle->stemlist[i],&gd->bd );
     for ( i=0; i<gd->vbundle->cnt; i++ )
 	ClearUnneededDeps( gd->vbundle->stemlist[i] );
 }
@@ -5412,14 +5423,14 @@ static void AddSerifOrBall( struct glyphdata *gd,
 	width = fabs(
 		( slave->right.x - master->left.x ) * master->unit.y -
 		( slave->right.y - master->left.y ) * master->unit.x );
-	max = width + slave->rmin + 2*dist_error_hv;
-	min = width + slave->rmax - 2*dist_error_hv;
+	max = width + slave->rmin + 2*gd->dist_error_hv;
+	min = width + slave->rmax - 2*gd->dist_error_hv;
     } else {
 	width = fabs(
 		( master->right.x - slave->left.x ) * master->unit.y -
 		( master->right.y - slave->left.y ) * master->unit.x );
-	max = width - slave->lmax + 2*dist_error_hv;
-	min = width - slave->lmin - 2*dist_error_hv;
+	max = width - slave->lmax + 2*gd->dist_error_hv;
+	min = width - slave->lmin - 2*gd->dist_error_hv;
     }
     
     scnt = master->serif_cnt;
@@ -5670,7 +5681,7 @@ static double ActiveOverlap( struct stemdata *stem1,struct stemdata *stem2 ) {
 return( len );
 }
 
-static int StemPairsSimilar( struct stemdata *s1, struct stemdata *s2,
+static int StemPairsSimilar( struct glyphdata *gd,struct stemdata *s1, struct stemdata *s2,
     struct stemdata *ts1, struct stemdata *ts2 ) {
     
     int normal, reversed, ret = 0;
@@ -5678,14 +5689,14 @@ static int StemPairsSimilar( struct stemdata *s1, struct stemdata *s2,
     
     /* Stem widths in the second pair should be nearly the same as */
     /* stem widths in the first pair */
-    normal = (  ts1->width >= s1->width - dist_error_hv && 
-		ts1->width <= s1->width + dist_error_hv &&
-		ts2->width >= s2->width - dist_error_hv && 
-		ts2->width <= s2->width + dist_error_hv );
-    reversed = (ts1->width >= s2->width - dist_error_hv && 
-		ts1->width <= s2->width + dist_error_hv &&
-		ts2->width >= s1->width - dist_error_hv && 
-		ts2->width <= s1->width + dist_error_hv );
+    normal = (  ts1->width >= s1->width - gd->dist_error_hv && 
+		ts1->width <= s1->width + gd->dist_error_hv &&
+		ts2->width >= s2->width - gd->dist_error_hv && 
+		ts2->width <= s2->width + gd->dist_error_hv );
+    reversed = (ts1->width >= s2->width - gd->dist_error_hv && 
+		ts1->width <= s2->width + gd->dist_error_hv &&
+		ts2->width >= s1->width - gd->dist_error_hv && 
+		ts2->width <= s1->width + gd->dist_error_hv );
 
     if ( !normal && !reversed )
 return( false );
@@ -5730,8 +5741,8 @@ static void FindCounterGroups( struct glyphdata *gd,int is_v ) {
 	    }
 	    
 	    dist =  is_v ? cur->left.x - prev->right.x : cur->right.y - prev->left.y;
-	    if ( mdist > dist - dist_error_hv && mdist < dist + dist_error_hv && 
-		StemPairsSimilar( prevm,curm,prev,cur )) {
+	    if ( mdist > dist - gd->dist_error_hv && mdist < dist + gd->dist_error_hv && 
+		StemPairsSimilar( gd,prevm,curm,prev,cur )) {
 		prev->next_c_m = prevm;
 		cur->prev_c_m = curm;
 	    }
@@ -5774,9 +5785,9 @@ return( NULL );
     gd->order2 = ( sc->parent != NULL ) ? sc->parent->layers[layer].order2 : false;
     gd->fuzz = GetBlueFuzz( sc->parent );
     
-    dist_error_hv = .0035*gd->emsize;
-    dist_error_diag = .0065*gd->emsize;
-    dist_error_curve = .022*gd->emsize;
+    gd->dist_error_hv = .0035*gd->emsize;
+    gd->dist_error_diag = .0065*gd->emsize;
+    gd->dist_error_curve = .022*gd->emsize;
 
     if ( sc->parent != NULL && sc->parent->italicangle ) {
 	iangle = ( 90 + sc->parent->italicangle );
@@ -42,6 +42,7 @@ typedef struct glyphdata {
     SplineChar *sc;
     int layer;
     int emsize;
+    double dist_error_hv, dist_error_diag, dist_error_curve;	/* Scaled to emsize */
     int order2;
     int has_slant;
     BasePoint slant_unit;
@@ -217,6 +218,9 @@ extern struct glyphdata *DStemInfoToStemData( struct glyphdata *gd,DStemInfo *ds
 extern int IsStemAssignedToPoint( struct pointdata *pd,struct stemdata *stem,int is_next );
 extern void GlyphDataFree(struct glyphdata *gd);
 
+extern int hint_diagonal_ends, hint_diagonal_intersections, hint_bounding_boxes, detect_diagonal_stems;
+extern float stem_slope_error, stub_slope_error;
+
 extern int UnitsParallel(BasePoint *u1, BasePoint *u2, int strict);
 
 #endif /* FONTFORGE_STEMDB_H */
@@ -2447,7 +2447,7 @@ return( NULL );		/* I can only handle data URIs */
 return( NULL );
     base = img->list_len==0 ? img->u.image : img->u.images[0];
 
-    ent = chunkalloc(sizeof(Entity));
+    ent = calloc(1,sizeof(Entity));
     ent->type = et_image;
     ent->u.image.image = img;
     ent->u.image.transform[1] = ent->u.image.transform[2] = 0;
@@ -42,6 +42,7 @@
 #include "macenc.h"
 #include "mem.h"
 #include "mm.h"
+#include "parallel.h"
 #include "parsepfa.h"
 #include "parsettfbmf.h"
 #include "splinefill.h"
@@ -545,16 +546,6 @@ static int uniranges[][3] = {
     { 0x100000, 0x10fffd, 90 },	/* Supplementary Private Use Area-B */
 };
 
-static int32 getuint32(FILE *ttf) {
-    int ch1 = getc(ttf);
-    int ch2 = getc(ttf);
-    int ch3 = getc(ttf);
-    int ch4 = getc(ttf);
-    if ( ch4==EOF )
-return( EOF );
-return( (ch1<<24)|(ch2<<16)|(ch3<<8)|ch4 );
-}
-
 static int short_too_long_warned = 0;
 
 void putshort(FILE *file,int sval) {
@@ -615,7 +606,8 @@ void putfixed(FILE *file,real dval) {
 }
 
 int ttfcopyfile(FILE *ttf, FILE *other, int pos, const char *tab_name) {
-    int ch;
+    char buffer[8192];
+    size_t len;
     int ret = 1;
 
     if ( ferror(ttf) || ferror(other)) {
@@ -624,8 +616,9 @@ int ttfcopyfile(FILE *ttf, FILE *other, int pos, const char *tab_name) {
 	IError("File Offset wrong for ttf table (%s), %d expected %d", tab_name, ftell(ttf), pos );
     }
     rewind(other);
-    while (( ch = getc(other))!=EOF )
-	putc(ch,ttf);
+    while (( len = fread(buffer,1,sizeof(buffer),other))>0 )
+	if ( fwrite(buffer,1,len,ttf)!=len )
+    break;
     if ( ferror(other)) ret = 0;
     if ( fclose(other)) ret = 0;
 return( ret );
@@ -1229,7 +1222,11 @@ return;
 	IError("max glyph count wrong in ttf output");
     gi->loca[gi->next_glyph] = ftell(gi->glyphs);
 
-    ttfss = SCttfApprox(sc,gi->layer);
+    if ( gi->ttfss!=NULL && gi->ttfss[sc->ttf_glyph]!=NULL ) {
+	ttfss = gi->ttfss[sc->ttf_glyph];
+	gi->ttfss[sc->ttf_glyph] = NULL;
+    } else
+	ttfss = SCttfApprox(sc,gi->layer);
     ptcnt = SSTtfNumberPoints(ttfss);
     for ( ss=ttfss, contourcnt=0; ss!=NULL; ss=ss->next ) {
 	++contourcnt;
@@ -1408,6 +1405,53 @@ static int AssignTTFBitGlyph(struct glyphinfo *gi,SplineFont *sf,EncMap *map,int
 return j;
 }
 
+struct ttfapprox_data {
+    SplineFont *sf;
+    struct glyphinfo *gi;
+};
+
+static void ParallelTtfApprox(int i, void *data) {
+    struct ttfapprox_data *td = data;
+    struct glyphinfo *gi = td->gi;
+    SplineChar *sc;
+
+    if ( gi->bygid[i]==-1 )
+return;
+    sc = td->sf->glyphs[gi->bygid[i]];
+    if ( sc->ttf_glyph<0 || sc->ttf_glyph>=gi->gcnt )
+return;
+    if ( sc->layers[gi->layer].splines==NULL && sc->layers[gi->layer].refs==NULL )
+return;
+    if ( i!=0 && IsTTFRefable(sc,gi->layer) )
+return;
+    gi->ttfss[sc->ttf_glyph] = SCttfApprox(sc,gi->layer);
+}
+
+/* Converting the outlines to quadratics is where most of the time goes, and */
+/*  each glyph can be done on its own. So do them all up front (on as many */
+/*  threads as we are allowed) and leave dumpglyph to write them out in order */
+static void PrecomputeTtfApprox(SplineFont *sf,struct glyphinfo *gi) {
+    struct ttfapprox_data td;
+
+    gi->ttfss = NULL;
+    if ( gi->onlybitmaps || ParallelJobCount(gi->gcnt)<=1 )
+return;
+    gi->ttfss = calloc(gi->gcnt,sizeof(SplineSet *));
+    td.sf = sf; td.gi = gi;
+    ParallelFor(gi->gcnt,ParallelTtfApprox,&td,false);
+}
+
+static void FreeTtfApprox(struct glyphinfo *gi) {
+    int i;
+
+    if ( gi->ttfss==NULL )
+return;
+    for ( i=0; i<gi->gcnt; ++i )
+	SplinePointListsFree(gi->ttfss[i]);
+    free(gi->ttfss);
+    gi->ttfss = NULL;
+}
+
 static int dumpglyphs(SplineFont *sf,struct glyphinfo *gi) {
     int i;
     int fixed = gi->fixed_width;
@@ -1452,16 +1496,17 @@ static int dumpglyphs(SplineFont *sf,struct glyphinfo *gi) {
     gi->pointcounts = malloc((gi->maxp->numGlyphs+1)*sizeof(int32));
     memset(gi->pointcounts,-1,(gi->maxp->numGlyphs+1)*sizeof(int32));
     gi->next_glyph = 0;
-    gi->glyphs = GFileTmpfile();
-    gi->hmtx = GFileTmpfile();
+    gi->glyphs = GFileMemTmpfile();
+    gi->hmtx = GFileMemTmpfile();
     if ( sf->hasvmetrics )
-	gi->vmtx = GFileTmpfile();
+	gi->vmtx = GFileMemTmpfile();
     FigureFullMetricsEnd(sf,gi,true);
 
     if ( fixed>0 ) {
 	gi->lasthwidth = 3;
 	gi->hfullcnt = 3;
     }
+    PrecomputeTtfApprox(sf,gi);
     for ( i=0; i<gi->gcnt; ++i ) {
 	if ( i==0 ) {
 	    if ( gi->bygid[0]!=-1 && (fixed<=0 || sf->glyphs[gi->bygid[0]]->width==fixed))
@@ -1489,9 +1534,12 @@ static int dumpglyphs(SplineFont *sf,struct glyphinfo *gi) {
 	    if ( ftell(gi->glyphs)&2 )
 		putshort(gi->glyphs,0);
 	}
-	if ( !ff_progress_next())
+	if ( !ff_progress_next()) {
+	    FreeTtfApprox(gi);
 return( false );
+	}
     }
+    FreeTtfApprox(gi);
 
     /* extra location entry points to end of last glyph */
     gi->loca[gi->next_glyph] = ftell(gi->glyphs);
@@ -1522,7 +1570,7 @@ return( true );
 
 /* Generate a null glyph and loca table for X opentype bitmaps */
 static int dumpnoglyphs(struct glyphinfo *gi) {
-    gi->glyphs = GFileTmpfile();
+    gi->glyphs = GFileMemTmpfile();
     gi->glyph_len = 0;
     /* loca gets built in dummyloca */
 return( true );
@@ -1544,7 +1592,7 @@ return( i );
     pos = ftell(at->sidf)+1;
     if ( pos>=65536 && !at->sidlongoffset ) {
 	at->sidlongoffset = true;
-	news = GFileTmpfile();
+	news = GFileMemTmpfile();
 	rewind(at->sidh);
 	for ( i=0; i<at->sidcnt; ++i )
 	    putlong(news,getushort(at->sidh));
@@ -1892,7 +1940,7 @@ static void _dumpcffstrings(FILE *file, struct pschars *strs) {
 }
 
 static FILE *dumpcffstrings(struct pschars *strs) {
-    FILE *file = GFileTmpfile();
+    FILE *file = GFileMemTmpfile();
     _dumpcffstrings(file,strs);
     PSCharsFree(strs);
 return( file );
@@ -2423,9 +2471,9 @@ static int dumpcffhmtx(struct alltabs *at,SplineFont *sf,int bitmaps) {
     int dovmetrics = sf->hasvmetrics;
     int width = at->gi.fixed_width;
 
-    at->gi.hmtx = GFileTmpfile();
+    at->gi.hmtx = GFileMemTmpfile();
     if ( dovmetrics )
-	at->gi.vmtx = GFileTmpfile();
+	at->gi.vmtx = GFileMemTmpfile();
     FigureFullMetricsEnd(sf,&at->gi,bitmaps);	/* Bitmap fonts use ttf convention of 3 magic glyphs */
     if ( at->gi.bygid[0]!=-1 && (sf->glyphs[at->gi.bygid[0]]->width==width || width<=0 )) {
 	putshort(at->gi.hmtx,sf->glyphs[at->gi.bygid[0]]->width);
@@ -2498,9 +2546,9 @@ static void dumpcffcidhmtx(struct alltabs *at,SplineFont *_sf) {
     SplineFont *sf;
     int dovmetrics = _sf->hasvmetrics;
 
-    at->gi.hmtx = GFileTmpfile();
+    at->gi.hmtx = GFileMemTmpfile();
     if ( dovmetrics )
-	at->gi.vmtx = GFileTmpfile();
+	at->gi.vmtx = GFileMemTmpfile();
     FigureFullMetricsEnd(_sf,&at->gi,false);
 
     max = 0;
@@ -2555,12 +2603,12 @@ static int dumptype2glyphs(SplineFont *sf,struct alltabs *at) {
     int i;
     struct pschars *subrs, *chrs;
 
-    at->cfff = GFileTmpfile();
-    at->sidf = GFileTmpfile();
-    at->sidh = GFileTmpfile();
-    at->charset = GFileTmpfile();
-    at->encoding = GFileTmpfile();
-    at->private = GFileTmpfile();
+    at->cfff = GFileMemTmpfile();
+    at->sidf = GFileMemTmpfile();
+    at->sidh = GFileMemTmpfile();
+    at->charset = GFileMemTmpfile();
+    at->encoding = GFileMemTmpfile();
+    at->private = GFileMemTmpfile();
 
     dumpcffheader(at->cfff);
     dumpcffnames(sf,at->cfff);
@@ -2599,17 +2647,17 @@ static int dumpcidglyphs(SplineFont *sf,struct alltabs *at) {
     int i;
     struct pschars *glbls = NULL, *chrs;
 
-    at->cfff = GFileTmpfile();
-    at->sidf = GFileTmpfile();
-    at->sidh = GFileTmpfile();
-    at->charset = GFileTmpfile();
-    at->fdselect = GFileTmpfile();
-    at->fdarray = GFileTmpfile();
-    at->globalsubrs = GFileTmpfile();
+    at->cfff = GFileMemTmpfile();
+    at->sidf = GFileMemTmpfile();
+    at->sidh = GFileMemTmpfile();
+    at->charset = GFileMemTmpfile();
+    at->fdselect = GFileMemTmpfile();
+    at->fdarray = GFileMemTmpfile();
+    at->globalsubrs = GFileMemTmpfile();
 
     at->fds = calloc(sf->subfontcnt,sizeof(struct fd2data));
     for ( i=0; i<sf->subfontcnt; ++i ) {
-	at->fds[i].private = GFileTmpfile();
+	at->fds[i].private = GFileMemTmpfile();
 	ATFigureDefWidth(sf->subfonts[i],at,i);
     }
     if ( (chrs = CID2ChrsSubrs2(sf,at->fds,at->gi.flags,&glbls,at->gi.layer))==NULL )
@@ -3526,7 +3574,7 @@ docs are wrong.
 static void redoloca(struct alltabs *at) {
     int i;
 
-    at->loca = GFileTmpfile();
+    at->loca = GFileMemTmpfile();
     if ( at->head.locais32 ) {
 	for ( i=0; i<=at->maxp.numGlyphs; ++i )
 	    putlong(at->loca,at->gi.loca[i]);
@@ -3546,7 +3594,7 @@ static void redoloca(struct alltabs *at) {
 
 static void dummyloca(struct alltabs *at) {
 
-    at->loca = GFileTmpfile();
+    at->loca = GFileMemTmpfile();
     if ( at->head.locais32 ) {
 	putlong(at->loca,0);
 	at->localen = sizeof(int32);
@@ -3559,7 +3607,7 @@ static void dummyloca(struct alltabs *at) {
 
 static void redohead(struct alltabs *at) {
     if (at->headf) fclose(at->headf);
-    at->headf = GFileTmpfile();
+    at->headf = GFileMemTmpfile();
 
     putlong(at->headf,at->head.version);
     putlong(at->headf,at->head.revision);
@@ -3592,10 +3640,10 @@ static void redohhead(struct alltabs *at,int isv) {
     FILE *f;
 
     if ( !isv ) {
-	f = at->hheadf = GFileTmpfile();
+	f = at->hheadf = GFileMemTmpfile();
 	head = &at->hhead;
     } else {
-	f = at->vheadf = GFileTmpfile();
+	f = at->vheadf = GFileMemTmpfile();
 	head = &at->vhead;
     }
 
@@ -3626,7 +3674,7 @@ static void redohhead(struct alltabs *at,int isv) {
 }
 
 static void redomaxp(struct alltabs *at,enum fontformat format) {
-    at->maxpf = GFileTmpfile();
+    at->maxpf = GFileMemTmpfile();
 
     putlong(at->maxpf,at->maxp.version);
     putshort(at->maxpf,at->maxp.numGlyphs);
@@ -3653,7 +3701,7 @@ static void redomaxp(struct alltabs *at,enum fontformat format) {
 
 static void redoos2(struct alltabs *at) {
     int i;
-    at->os2f = GFileTmpfile();
+    at->os2f = GFileMemTmpfile();
 
     putshort(at->os2f,at->os2.version);
     putshort(at->os2f,at->os2.avgCharWid);
@@ -3706,7 +3754,7 @@ static void redoos2(struct alltabs *at) {
 static void dumpgasp(struct alltabs *at, SplineFont *sf) {
     int i;
 
-    at->gaspf = GFileTmpfile();
+    at->gaspf = GFileMemTmpfile();
     if ( sf->gasp_cnt==0 ) {
 	putshort(at->gaspf,0);	/* Old version number */
 	/* For fonts with no instructions always dump a gasp table which */
@@ -3990,7 +4038,7 @@ static void dumpnames(struct alltabs *at, SplineFont *sf,enum fontformat format)
     nt.encoding_name = at->map->enc;
     nt.format	     = format;
     nt.applemode     = at->applemode;
-    nt.strings	     = GFileTmpfile();
+    nt.strings	     = GFileMemTmpfile();
     if (isttflike_ff(format) && (at->gi.flags&ttf_flag_symbol))
 	nt.format    = ff_ttfsym;
 
@@ -4046,7 +4094,7 @@ static void dumpnames(struct alltabs *at, SplineFont *sf,enum fontformat format)
 
     qsort(nt.entries,nt.cur,sizeof(NameEntry),compare_entry);
 
-    at->name = GFileTmpfile();
+    at->name = GFileMemTmpfile();
     putshort(at->name,0);				/* format */
     putshort(at->name,nt.cur);				/* numrec */
     putshort(at->name,(3+nt.cur*6)*sizeof(int16));	/* offset to strings */
@@ -4082,7 +4130,7 @@ static void dumppost(struct alltabs *at, SplineFont *sf, enum fontformat format)
 	    (at->gi.flags&ttf_flag_shortps));
     uint32 here;
 
-    at->post = GFileTmpfile();
+    at->post = GFileMemTmpfile();
 
     putlong(at->post,shorttable?0x00030000:0x00020000);	/* formattype */
     putfixed(at->post,sf->italicangle);
@@ -4341,7 +4389,7 @@ return( NULL );
 	subheads[i].rangeoff = subheads[i].rangeoff*sizeof(uint16) +
 		(subheadcnt-i)*sizeof(struct subhead) + sizeof(uint16);
 
-    sub = GFileTmpfile();
+    sub = GFileMemTmpfile();
     if ( sub==NULL )
 return( NULL );
 
@@ -4461,7 +4509,7 @@ return(NULL);
     if ( !map->enc->is_unicodefull )
 	map = freeme = EncMapFromEncoding(sf,FindOrMakeEncoding("ucs4"));
 
-    format12 = GFileTmpfile();
+    format12 = GFileMemTmpfile();
     if ( format12==NULL )
 return( NULL );
 
@@ -4680,7 +4728,7 @@ static FILE *NeedsUCS2Table(SplineFont *sf,int *ucs2len,EncMap *map,int issymbol
 	return NULL;
     }
 
-    format4 = GFileTmpfile();
+    format4 = GFileMemTmpfile();
     putshort(format4,4);		/* format */
     putshort(format4,slen);
     putshort(format4,0);		/* language/version */
@@ -4774,7 +4822,7 @@ return( NULL );			/* No variation selectors */
 
     avail = malloc(unicode4_size*sizeof(uint32));
 
-    format14 = GFileTmpfile();
+    format14 = GFileMemTmpfile();
     putshort(format14,14);
     putlong(format14,0);		/* Length, fixup later */
     putlong(format14,vs_cnt);		/* number of selectors */
@@ -4880,7 +4928,7 @@ static void dumpcmap(struct alltabs *at, SplineFont *sf,enum fontformat format)
     if (isttflike_ff(format) && (at->gi.flags&ttf_flag_symbol))
 	modformat = ff_ttfsym;
 
-    at->cmap = GFileTmpfile();
+    at->cmap = GFileMemTmpfile();
 
     /* MacRoman encoding table */ /* Not going to bother with making this work for cid fonts */
     /* I now see that Apple doesn't restrict us to format 0 sub-tables (as */
@@ -5113,14 +5161,19 @@ static void dumpcmap(struct alltabs *at, SplineFont *sf,enum fontformat format)
 }
 
 int32 filechecksum(FILE *file) {
-    uint32 sum = 0, chunk;
+    uint8 buffer[8192];
+    uint32 sum = 0;
+    size_t len, i;
 
     rewind(file);
-    while ( 1 ) {
-	chunk = getuint32(file);
-	if ( feof(file) || ferror(file))
+    /* The buffer holds a whole number of longs, so only a short read at the */
+    /*  end of the file can leave a partial one, and that is ignored */
+    while (( len = fread(buffer,1,sizeof(buffer),file))>=4 ) {
+	for ( i=0; i+4<=len; i+=4 )
+	    sum += ((uint32) buffer[i]<<24) | (buffer[i+1]<<16) |
+		    (buffer[i+2]<<8) | buffer[i+3];
+	if ( len<sizeof(buffer) )
     break;
-	sum += chunk;
     }
 return( sum );
 }
@@ -5284,7 +5337,7 @@ static FILE *dumpstoredtable(SplineFont *sf,uint32 tag,int *len) {
 return( NULL );
     }
 
-    out = GFileTmpfile();
+    out = GFileMemTmpfile();
     fwrite(tab->data,1,tab->len,out);
     if ( (tab->len&1))
 	putc('\0',out);
@@ -5300,7 +5353,7 @@ static FILE *dumpsavedtable(struct ttf_table *tab) {
     if ( tab==NULL )
 return( NULL );
 
-    out = GFileTmpfile();
+    out = GFileMemTmpfile();
     fwrite(tab->data,1,tab->len,out);
     if ( (tab->len&1))
 	putc('\0',out);
@@ -5969,15 +6022,21 @@ return( buffer );
 }
 
 static void dumpttf(FILE *ttf,struct alltabs *at) {
-    int32 checksum;
+    uint32 checksum;
     int i, head_index=-1;
     /* I can't use fwrite because I (may) have to byte swap everything */
 
+    /* Every table is long aligned and zero padded, so the checksum of the */
+    /*  whole file is the checksum of the directory plus those of the tables */
+    /*  we have already computed. No need to read the file back */
     putlong(ttf,at->tabdir.version);
     putshort(ttf,at->tabdir.numtab);
     putshort(ttf,at->tabdir.searchRange);
     putshort(ttf,at->tabdir.entrySel);
     putshort(ttf,at->tabdir.rangeShift);
+    checksum = at->tabdir.version +
+	    (((uint32) at->tabdir.numtab<<16)|(uint16) at->tabdir.searchRange) +
+	    (((uint32) at->tabdir.entrySel<<16)|(uint16) at->tabdir.rangeShift);
     for ( i=0; i<at->tabdir.numtab; ++i ) {
 	if ( at->tabdir.alpha[i]->tag==CHR('h','e','a','d') || at->tabdir.alpha[i]->tag==CHR('b','h','e','d') )
 	    head_index = i;
@@ -5985,16 +6044,18 @@ static void dumpttf(FILE *ttf,struct alltabs *at) {
 	putlong(ttf,at->tabdir.alpha[i]->checksum);
 	putlong(ttf,at->tabdir.alpha[i]->offset);
 	putlong(ttf,at->tabdir.alpha[i]->length);
+	checksum += at->tabdir.alpha[i]->tag + at->tabdir.alpha[i]->checksum +
+		at->tabdir.alpha[i]->offset + at->tabdir.alpha[i]->length;
     }
 
     for ( i=0; i<at->tabdir.numtab; ++i ) if ( at->tabdir.ordered[i]->data!=NULL ) {
+	checksum += at->tabdir.ordered[i]->checksum;
 	if ( !ttfcopyfile(ttf,at->tabdir.ordered[i]->data,
 		at->tabdir.ordered[i]->offset,Tag2String(at->tabdir.ordered[i]->tag)))
 	    at->error = true;
     }
 
     if ( head_index!=-1 ) {
-	checksum = filechecksum(ttf);
 	checksum = 0xb1b0afba-checksum;
 	fseek(ttf,at->tabdir.alpha[head_index]->offset+2*sizeof(int32),SEEK_SET);
 	putlong(ttf,checksum);
@@ -6266,7 +6327,7 @@ static void dumphex(struct hexout *hexout,FILE *temp,int length) {
 }
 
 static void dumptype42(FILE *type42,struct alltabs *at, enum fontformat format) {
-    FILE *temp = GFileTmpfile();
+    FILE *temp = GFileMemTmpfile();
     struct hexout hexout;
     int i, length;
 
@@ -7026,7 +7087,7 @@ return( 0 );
 	/* Generate all the fonts (don't generate DSIGs, there's one DSIG for */
 	/*  the ttc as a whole) */
 	for ( sfitem= sfs, cnt=0; sfitem!=NULL; sfitem=sfitem->next, ++cnt ) {
-	    sfitem->tempttf = GFileTmpfile();
+	    sfitem->tempttf = GFileMemTmpfile();
 	    if ( sfitem->tempttf==NULL )
 		ok=0;
 	    else
@@ -396,7 +396,7 @@ return;
 
     /* Old kerning format (version 0) uses 16 bit quantities */
     /* Apple's new format (version 0x00010000) uses 32 bit quantities */
-    at->kern = GFileTmpfile();
+    at->kern = GFileMemTmpfile();
     if ( must_use_old_style  ||
 	    ( kcnt.kccnt==0 && kcnt.vkccnt==0 && kcnt.ksm==0 && mmcnt==0 )) {
 	/* MS does not support format 1,2,3 kern sub-tables so if we have them */
@@ -499,7 +499,7 @@ void aat_dumplcar(struct alltabs *at, SplineFont *sf) {
 	if ( k==0 ) {
 	    if ( seg_cnt==0 )
 return;
-	    lcar = GFileTmpfile();
+	    lcar = GFileMemTmpfile();
 	    putlong(lcar, 0x00010000);	/* version */
 	    putshort(lcar,0);		/* data are distances (not points) */
 
@@ -1160,7 +1160,7 @@ static int morx_dumpASM(FILE *temp,ASM *sm, struct alltabs *at, SplineFont *sf )
 	}
     } else if ( sm->type==asm_kern ) {
 	int off=0;
-	kernvalues = GFileTmpfile();
+	kernvalues = GFileMemTmpfile();
 	for ( j=0; j<sm->state_cnt*sm->class_cnt; ++j ) {
 	    struct asm_state *this = &sm->state[j];
 	    transdata[j].mark_index = 0xffff;
@@ -1690,7 +1690,7 @@ return;
 	if ( k==0 ) {
 	    ++fcnt;		/* Add one for "All Typographic Features" */
 	    ++scnt;		/* Add one for All Features */
-	    at->feat = GFileTmpfile();
+	    at->feat = GFileMemTmpfile();
 	    at->feat_name = malloc((fcnt+scnt+1)*sizeof(struct feat_name));
 	    putlong(at->feat,0x00010000);
 	    putshort(at->feat,fcnt);
@@ -1904,7 +1904,7 @@ static void morxDumpChain(struct alltabs *at,struct feature *features,
 }
 
 void aat_dumpmorx(struct alltabs *at, SplineFont *sf) {
-    FILE *temp = GFileTmpfile();
+    FILE *temp = GFileMemTmpfile();
     struct feature *features = NULL, *features_by_type;
     int nchains, i;
     OTLookup *otl;
@@ -1966,7 +1966,7 @@ return;
     nchains = featuresAssignFlagsChains(features,features_by_type);
     SetExclusiveOffs(features_by_type);
 
-    at->morx = GFileTmpfile();
+    at->morx = GFileMemTmpfile();
     putlong(at->morx,0x00020000);
     putlong(at->morx,nchains);
     for ( i=0; i<nchains; ++i )
@@ -2060,7 +2060,7 @@ void aat_dumpopbd(struct alltabs *at, SplineFont *_sf) {
 	if ( k==0 ) {
 	    if ( seg_cnt==0 )
 return;
-	    opbd = GFileTmpfile();
+	    opbd = GFileMemTmpfile();
 	    putlong(opbd, 0x00010000);	/* version */
 	    putshort(opbd,0);		/* data are distances (not control points) */
 
@@ -2198,7 +2198,7 @@ void aat_dumpprop(struct alltabs *at, SplineFont *sf) {
     if ( props==NULL )
 return;
 
-    at->prop = GFileTmpfile();
+    at->prop = GFileMemTmpfile();
     putlong(at->prop,0x00020000);
     putshort(at->prop,1);		/* Lookup data */
     putshort(at->prop,0);		/* default property is simple l2r */
@@ -2373,7 +2373,7 @@ return;
 
     baselines = PerGlyphDefBaseline(sf,&def_baseline);
 
-    at->bsln = GFileTmpfile();
+    at->bsln = GFileMemTmpfile();
     putlong(at->bsln,0x00010000);	/* Version */
     if ( def_baseline & 0x100 )		/* Only one baseline in the font */
 	putshort(at->bsln,0);		/* distanced based (no control point), no per-glyph info */
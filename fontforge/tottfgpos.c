@@ -1133,18 +1133,73 @@ static int cmp_gid( const void *_s1, const void *_s2 ) {
 return( ((int) s1->other_gid) - ((int) s2->other_gid) );
 }
 
+static int SecondsSame(struct sckppst *test,struct sckppst *test2) {
+    int j;
+
+    if ( test[0].tot != test2[0].tot )
+return( false );
+    for ( j=test[0].tot-1; j>=0; --j ) {
+	if ( test[j].other_gid != test2[j].other_gid )
+return( false );
+	if ( test[j].kp!=NULL && test2[j].kp!=NULL &&
+		test[j].kp->off == test2[j].kp->off
+		&& DevTabsSame(test[j].kp->adjust,test2[j].kp->adjust)
+		)
+	    /* So far, so good */;
+	else if ( test[j].pst!=NULL && test2[j].pst!=NULL &&
+		test[j].pst->u.pair.vr[0].xoff == test2[j].pst->u.pair.vr[0].xoff &&
+		test[j].pst->u.pair.vr[0].yoff == test2[j].pst->u.pair.vr[0].yoff &&
+		test[j].pst->u.pair.vr[0].h_adv_off == test2[j].pst->u.pair.vr[0].h_adv_off &&
+		test[j].pst->u.pair.vr[0].v_adv_off == test2[j].pst->u.pair.vr[0].v_adv_off &&
+		test[j].pst->u.pair.vr[1].xoff == test2[j].pst->u.pair.vr[1].xoff &&
+		test[j].pst->u.pair.vr[1].yoff == test2[j].pst->u.pair.vr[1].yoff &&
+		test[j].pst->u.pair.vr[1].h_adv_off == test2[j].pst->u.pair.vr[1].h_adv_off &&
+		test[j].pst->u.pair.vr[1].v_adv_off == test2[j].pst->u.pair.vr[1].v_adv_off
+		&& ValDevTabsSame(test[j].pst->u.pair.vr[0].adjust,test2[j].pst->u.pair.vr[0].adjust)
+		&& ValDevTabsSame(test[j].pst->u.pair.vr[1].adjust,test2[j].pst->u.pair.vr[1].adjust)
+		)
+	    /* That's ok too. */;
+	else
+return( false );
+    }
+return( true );
+}
+
+/* Lists which SecondsSame says are the same must hash the same */
+static unsigned int SecondsHash(struct sckppst *test) {
+    unsigned int hval = test[0].tot;
+    int j;
+
+    for ( j=0; j<test[0].tot; ++j ) {
+	hval = hval*31 + test[j].other_gid;
+	if ( test[j].kp!=NULL )
+	    hval = hval*31 + (uint16) test[j].kp->off;
+	else if ( test[j].pst!=NULL )
+	    hval = hval*31 + (uint16) (test[j].pst->u.pair.vr[0].xoff +
+		    test[j].pst->u.pair.vr[0].h_adv_off + test[j].pst->u.pair.vr[0].v_adv_off);
+    }
+return( hval ^ (hval>>16) );
+}
+
+struct secondshash {
+    int index;			/* Into seconds, -1 for an empty slot */
+    unsigned int hval;
+};
+
 static void dumpGPOSpairpos(FILE *gpos,SplineFont *sf,struct lookup_subtable *sub) {
     int cnt;
     int32 coverage_pos, offset_pos, end, start, pos;
     PST *pst;
     KernPair *kp;
-    int vf1 = 0, vf2=0, i, j, k, tot, bit_cnt, v;
+    int vf1 = 0, vf2=0, i, k, tot, bit_cnt, v;
     int start_cnt, end_cnt;
     int chunk_cnt, chunk_max;
     SplineChar *sc, **glyphs, *gtemp;
     struct sckppst **seconds;
     int devtablen;
     int next_dev_tab;
+    struct secondshash *hash;
+    int h, hsize;
 
     /* Figure out all the data we need. First the glyphs with kerning info */
     /*  then the glyphs to which they kern, and by how much */
@@ -1198,43 +1253,28 @@ static void dumpGPOSpairpos(FILE *gpos,SplineFont *sf,struct lookup_subtable *su
     }
 
     /* Some fonts do a primitive form of class based kerning, several glyphs */
-    /*  can share the same list of second glyphs & offsets */
+    /*  can share the same list of second glyphs & offsets. Each list which */
+    /*  isn't like any before it goes in a hash table, so finding the first */
+    /*  list like this one doesn't mean comparing it with all of them */
+    hsize = 16;
+    while ( hsize<2*cnt ) hsize <<= 1;
+    hash = malloc(hsize*sizeof(struct secondshash));
+    for ( h=0; h<hsize; ++h )
+	hash[h].index = -1;
     for ( cnt=0; glyphs[cnt]!=NULL; ++cnt) {
-	struct sckppst *test = seconds[cnt], *test2;
-	for ( i=cnt-1; i>=0; --i ) {
-	    test2 = seconds[i];
-	    if ( test[0].tot != test2[0].tot || test2[0].samewas!=0xffff )
-	continue;
-	    for ( j=test[0].tot-1; j>=0; --j ) {
-		if ( test[j].other_gid != test2[j].other_gid )
-	    break;
-		if ( test[j].kp!=NULL && test2[j].kp!=NULL &&
-			test[j].kp->off == test2[j].kp->off
-			&& DevTabsSame(test[j].kp->adjust,test2[j].kp->adjust)
-			)
-		    /* So far, so good */;
-		else if ( test[j].pst!=NULL && test2[j].pst!=NULL &&
-			test[j].pst->u.pair.vr[0].xoff == test2[j].pst->u.pair.vr[0].xoff &&
-			test[j].pst->u.pair.vr[0].yoff == test2[j].pst->u.pair.vr[0].yoff &&
-			test[j].pst->u.pair.vr[0].h_adv_off == test2[j].pst->u.pair.vr[0].h_adv_off &&
-			test[j].pst->u.pair.vr[0].v_adv_off == test2[j].pst->u.pair.vr[0].v_adv_off &&
-			test[j].pst->u.pair.vr[1].xoff == test2[j].pst->u.pair.vr[1].xoff &&
-			test[j].pst->u.pair.vr[1].yoff == test2[j].pst->u.pair.vr[1].yoff &&
-			test[j].pst->u.pair.vr[1].h_adv_off == test2[j].pst->u.pair.vr[1].h_adv_off &&
-			test[j].pst->u.pair.vr[1].v_adv_off == test2[j].pst->u.pair.vr[1].v_adv_off
-			&& ValDevTabsSame(test[j].pst->u.pair.vr[0].adjust,test2[j].pst->u.pair.vr[0].adjust)
-			&& ValDevTabsSame(test[j].pst->u.pair.vr[1].adjust,test2[j].pst->u.pair.vr[1].adjust)
-			)
-		    /* That's ok too. */;
-		else
-	    break;
-	    }
-	    if ( j>=0 )
-	continue;
-	    test[0].samewas = i;
+	unsigned int hval = SecondsHash(seconds[cnt]);
+	for ( h=hval&(hsize-1); (i=hash[h].index)!=-1; h = (h+1)&(hsize-1) ) {
+	    if ( hash[h].hval==hval && SecondsSame(seconds[cnt],seconds[i]) ) {
+		seconds[cnt][0].samewas = i;
 	break;
+	    }
+	}
+	if ( i==-1 ) {
+	    hash[h].index = cnt;
+	    hash[h].hval = hval;
 	}
     }
+    free(hash);
 
     /* Ok, how many offsets must we output? Normal kerning will just use */
     /*  one offset (with perhaps a device table), but the standard allows */
@@ -1447,21 +1487,6 @@ uint16 *ClassesFromNames(SplineFont *sf,char **classnames,int class_cnt,
 return( class );
 }
 
-static SplineChar **GlyphsFromClasses(SplineChar **gs, int numGlyphs) {
-    int i, cnt;
-    SplineChar **glyphs;
-
-    for ( i=cnt=0; i<numGlyphs; ++i )
-	if ( gs[i]!=NULL ) ++cnt;
-    glyphs = malloc((cnt+1)*sizeof(SplineChar *));
-    for ( i=cnt=0; i<numGlyphs; ++i )
-	if ( gs[i]!=NULL )
-	    glyphs[cnt++] = gs[i];
-    glyphs[cnt++] = NULL;
-    free(gs);
-return( glyphs );
-}
-
 static SplineChar **GlyphsFromInitialClasses(SplineChar **gs, int numGlyphs, uint16 *classes, uint16 *initial) {
     int i, j, cnt;
     SplineChar **glyphs;
@@ -1522,57 +1547,240 @@ static void DumpClass(FILE *gpos,uint16 *class,int numGlyphs) {
     }
 }
 
-static void dumpgposkernclass(FILE *gpos,SplineFont *sf,
-	struct lookup_subtable *sub, struct alltabs *at) {
-    uint32 begin_off = ftell(gpos), pos;
+/* The length of what DumpClass will write */
+static int ClassLen(uint16 *class,int numGlyphs) {
+    int ranges, i, cur, first= -1, last=-1, istart;
+
+    for ( i=ranges=0; i<numGlyphs; ) {
+	istart = i;
+	cur = class[i];
+	while ( i<numGlyphs && class[i]==cur )
+	    ++i;
+	if ( cur!=0 ) {
+	    ++ranges;
+	    if ( first==-1 ) first = istart;
+	    last = i-1;
+	}
+    }
+    if ( ranges*3+1>last-first+1+2 || first==-1 ) {
+	if ( first==-1 ) first = last = 0;
+return( (3+last-first+1)*sizeof(uint16) );
+    }
+return( (2+3*ranges)*sizeof(uint16) );
+}
+
+/* The length of what dumpcoveragetable will write */
+static int CoverageLen(SplineChar **glyphs) {
+    int i, last = -2, range_cnt=0;
+
+    for ( i=0; glyphs[i]!=NULL; ++i ) {
+	if ( glyphs[i]->ttf_glyph>=0 ) {
+	    if ( range_cnt==0 || glyphs[i]->ttf_glyph>last+1 )
+		++range_cnt;
+	    last = glyphs[i]->ttf_glyph;
+	}
+    }
+    if ( !(coverageformatsallowed&2) || ((coverageformatsallowed&1) && i<=3*range_cnt ))
+return( (2+i)*sizeof(uint16) );
+return( (2+3*range_cnt)*sizeof(uint16) );
+}
+
+/* Class kerning is written as format 2 pair subtables. First classes */
+/*  (rows) with no glyphs in the font are left out and rows which kern the */
+/*  same are merged. So are second classes (columns), and when class 0 */
+/*  kerns nothing, columns which don't either become class 0, so their */
+/*  glyphs need not be in the class table at all. Class 0 of the first */
+/*  glyph always stays row 0, as we read it back as the kerning class's */
+/*  own class 0. Matrices made by merging fonts or by auto kerning often */
+/*  shrink a lot */
+/* If the result won't fit in the 64k which the subtable's offsets reach, */
+/*  the rows are packed in order into as many subtables as it takes, each */
+/*  of which merges its columns again over just its own rows */
+struct kcmatrix {
+    KernClass *kc;
+    int anydevtab;
+    int numGlyphs;
+    uint16 *class1, *class2;	/* Of each glyph, as kc has them */
+    SplineChar **gs;		/* Glyphs in some first class, by gid */
+    int *rowof;			/* Merged row of each first class, -1 if none */
+    int *rows, rcnt;		/* A first class for each merged row, not 0 */
+    int *colof;			/* Merged column of each second class */
+    int *cols, ccnt;		/* A second class for each merged column */
+};
+
+/* What goes in one subtable */
+struct kcsubtable {
+    int *rows, rcnt;		/* First classes, one for each of its rows, */
+				/*  the first being class 0 */
+    int *cols, ccnt;		/* Second classes, one for each of its columns */
     uint16 *class1, *class2;
-    KernClass *kc = sub->kc, *test;
-    SplineChar **glyphs;
-    int i, isv;
-    int anydevtab = false;
-    int next_devtab;
+    SplineChar **glyphs;	/* Coverage */
+    int len;
+};
 
-    putshort(gpos,2);		/* format 2 of the pair adjustment subtable */
-    putshort(gpos,0);		/* offset to coverage table */
-    for ( i=0; i<kc->first_cnt*kc->second_cnt; ++i ) {
-	if ( kc->adjusts[i].corrections!=NULL ) {
-	    anydevtab = true;
+static int KCCellSame(struct kcmatrix *m,int r1,int c1,int r2,int c2) {
+    KernClass *kc = m->kc;
+    int p1 = r1*kc->second_cnt+c1, p2 = r2*kc->second_cnt+c2;
+
+    if ( kc->offsets[p1]!=kc->offsets[p2] )
+return( false );
+return( !m->anydevtab || DevTabsSame(&kc->adjusts[p1],&kc->adjusts[p2]) );
+}
+
+/* Merges the lines (rows if !bycol, else columns) which are the same at */
+/*  each of the cross lines. map[k] gets the merged line of lines[k] and */
+/*  reps[n] the first line which went into merged line n, so lines[0] is */
+/*  always merged line 0. Returns the number of merged lines */
+static int KCMerge(struct kcmatrix *m,int bycol,int *lines,int lcnt,
+	int *across,int acnt,int *map,int *reps) {
+    KernClass *kc = m->kc;
+    struct linehash { int line; unsigned int hval; } *hash;
+    int hsize, h, k, a, n, pos, cnt = 0;
+    unsigned int hval;
+
+    for ( hsize=16; hsize<2*lcnt; hsize<<=1 );
+    hash = malloc(hsize*sizeof(struct linehash));
+    for ( h=0; h<hsize; ++h )
+	hash[h].line = -1;
+    for ( k=0; k<lcnt; ++k ) {
+	hval = 0;
+	for ( a=0; a<acnt; ++a ) {
+	    pos = bycol ? across[a]*kc->second_cnt+lines[k] : lines[k]*kc->second_cnt+across[a];
+	    hval = hval*31 + (uint16) kc->offsets[pos];
+	    if ( m->anydevtab && kc->adjusts[pos].corrections!=NULL )
+		hval ^= 0x5bd1e995;
+	}
+	for ( h=hval&(hsize-1); (n=hash[h].line)!=-1; h=(h+1)&(hsize-1) ) {
+	    if ( hash[h].hval!=hval )
+	continue;
+	    for ( a=0; a<acnt; ++a ) {
+		if ( bycol ? !KCCellSame(m,across[a],lines[k],across[a],reps[n]) :
+			!KCCellSame(m,lines[k],across[a],reps[n],across[a]) )
+	    break;
+	    }
+	    if ( a==acnt )
+	break;
+	}
+	if ( n==-1 ) {
+	    n = cnt++;
+	    reps[n] = lines[k];
+	    hash[h].line = n;
+	    hash[h].hval = hval;
+	}
+	map[k] = n;
+    }
+    free(hash);
+return( cnt );
+}
+
+/* Merges columns as KCMerge does, but keeps a second class 0 which kerns */
+/*  anything apart from the others. cols[0] must be class 0 */
+static int KCMergeColumns(struct kcmatrix *m,int *cols,int ccnt,
+	int *rows,int rcnt,int *map,int *reps) {
+    KernClass *kc = m->kc;
+    int r, k, cnt;
+
+    for ( r=0; r<rcnt; ++r )
+	if ( kc->offsets[rows[r]*kc->second_cnt]!=0 ||
+		(m->anydevtab && kc->adjusts[rows[r]*kc->second_cnt].corrections!=NULL) )
     break;
+    if ( r==rcnt )
+return( KCMerge(m,true,cols,ccnt,rows,rcnt,map,reps) );
+    cnt = KCMerge(m,true,cols+1,ccnt-1,rows,rcnt,map+1,reps+1);
+    map[0] = 0;
+    reps[0] = cols[0];
+    for ( k=1; k<ccnt; ++k )
+	++map[k];
+return( cnt+1 );
+}
+
+/* Lays out a subtable holding class 0 and the merged rows [start,end) */
+static void KCSubtableFigure(struct kcmatrix *m,int start,int end,struct kcsubtable *st) {
+    KernClass *kc = m->kc;
+    int *colmap = malloc(m->ccnt*sizeof(int));
+    int i, r, c, cnt, devtablen = 0;
+
+    st->rows = malloc((end-start+1)*sizeof(int));
+    st->rcnt = end-start+1;
+    st->rows[0] = 0;
+    for ( r=start; r<end; ++r )
+	st->rows[r-start+1] = m->rows[r];
+    st->cols = malloc(m->ccnt*sizeof(int));
+    st->ccnt = KCMergeColumns(m,m->cols,m->ccnt,st->rows,st->rcnt,colmap,st->cols);
+
+    st->class1 = calloc(m->numGlyphs,sizeof(uint16));
+    st->class2 = calloc(m->numGlyphs,sizeof(uint16));
+    st->glyphs = malloc((m->numGlyphs+1)*sizeof(SplineChar *));
+    for ( i=cnt=0; i<m->numGlyphs; ++i ) {
+	if ( m->gs[i]==NULL )
+	    /* Not a first glyph */;
+	else if ( m->class1[i]==0 ) {
+	    if ( start==0 )
+		st->glyphs[cnt++] = m->gs[i];
+	} else if ( (r = m->rowof[m->class1[i]])>=start && r<end ) {
+	    st->class1[i] = r-start+1;
+	    st->glyphs[cnt++] = m->gs[i];
 	}
+	st->class2[i] = colmap[m->colof[m->class2[i]]];
     }
+    st->glyphs[cnt] = NULL;
+    free(colmap);
 
-    for ( test=sf->vkerns; test!=NULL && test!=kc; test=test->next );
-    isv = test==kc;
+    if ( m->anydevtab ) {
+	for ( r=0; r<st->rcnt; ++r ) for ( c=0; c<st->ccnt; ++c )
+	    devtablen += DevTabLen(&kc->adjusts[st->rows[r]*kc->second_cnt+st->cols[c]]);
+    }
+    st->len = 8*sizeof(uint16) +
+	    st->rcnt*st->ccnt*(m->anydevtab?2:1)*sizeof(uint16) + devtablen +
+	    ClassLen(st->class1,m->numGlyphs) + ClassLen(st->class2,m->numGlyphs) +
+	    CoverageLen(st->glyphs);
+}
+
+static void KCSubtableFree(struct kcsubtable *st) {
+    free(st->rows);
+    free(st->cols);
+    free(st->class1);
+    free(st->class2);
+    free(st->glyphs);
+}
 
+static void dumpgposkernclasssubtable(FILE *gpos,struct kcmatrix *m,int isv,
+	struct kcsubtable *st) {
+    KernClass *kc = m->kc;
+    uint32 begin_off = ftell(gpos), pos;
+    int r, c, p;
+    int next_devtab;
+
+    putshort(gpos,2);		/* format 2 of the pair adjustment subtable */
+    putshort(gpos,0);		/* offset to coverage table */
     if ( isv ) {
 	/* As far as I know there is no "bottom to top" writing direction */
 	/*  Oh. There is. Ogham, Runic */
-	putshort(gpos,anydevtab?0x0088:0x0008);	/* Alter YAdvance of first character */
+	putshort(gpos,m->anydevtab?0x0088:0x0008);	/* Alter YAdvance of first character */
 	putshort(gpos,0x0000);			/* leave second char alone */
     } else {
-	putshort(gpos,anydevtab?0x0044:0x0004);	/* Alter XAdvance of first character */
+	putshort(gpos,m->anydevtab?0x0044:0x0004);	/* Alter XAdvance of first character */
 	putshort(gpos,0x0000);			/* leave second char alone */
     }
-    class1 = ClassesFromNames(sf,kc->firsts,kc->first_cnt,at->maxp.numGlyphs,&glyphs,false);
-    glyphs = GlyphsFromClasses(glyphs,at->maxp.numGlyphs);
-    class2 = ClassesFromNames(sf,kc->seconds,kc->second_cnt,at->maxp.numGlyphs,NULL,false);
     putshort(gpos,0);		/* offset to first glyph classes */
     putshort(gpos,0);		/* offset to second glyph classes */
-    putshort(gpos,kc->first_cnt);
-    putshort(gpos,kc->second_cnt);
-    next_devtab = ftell(gpos)-begin_off + kc->first_cnt*kc->second_cnt*2*sizeof(uint16);
-    for ( i=0; i<kc->first_cnt*kc->second_cnt; ++i ) {
-	putshort(gpos,kc->offsets[i]);
-	if ( anydevtab && kc->adjusts[i].corrections!=NULL ) {
+    putshort(gpos,st->rcnt);
+    putshort(gpos,st->ccnt);
+    next_devtab = ftell(gpos)-begin_off + st->rcnt*st->ccnt*2*sizeof(uint16);
+    for ( r=0; r<st->rcnt; ++r ) for ( c=0; c<st->ccnt; ++c ) {
+	p = st->rows[r]*kc->second_cnt+st->cols[c];
+	putshort(gpos,kc->offsets[p]);
+	if ( m->anydevtab && kc->adjusts[p].corrections!=NULL ) {
 	    putshort(gpos,next_devtab);
-	    next_devtab += DevTabLen(&kc->adjusts[i]);
-	} else if ( anydevtab )
+	    next_devtab += DevTabLen(&kc->adjusts[p]);
+	} else if ( m->anydevtab )
 	    putshort(gpos,0);
     }
-    if ( anydevtab ) {
-	for ( i=0; i<kc->first_cnt*kc->second_cnt; ++i ) {
-	    if ( kc->adjusts[i].corrections!=NULL )
-		dumpgposdevicetable(gpos,&kc->adjusts[i]);
+    if ( m->anydevtab ) {
+	for ( r=0; r<st->rcnt; ++r ) for ( c=0; c<st->ccnt; ++c ) {
+	    p = st->rows[r]*kc->second_cnt+st->cols[c];
+	    if ( kc->adjusts[p].corrections!=NULL )
+		dumpgposdevicetable(gpos,&kc->adjusts[p]);
 	}
 	if ( next_devtab!=ftell(gpos)-begin_off )
 	    IError("Device table offsets screwed up in kerning class");
@@ -1581,23 +1789,130 @@ static void dumpgposkernclass(FILE *gpos,SplineFont *sf,
     fseek(gpos,begin_off+4*sizeof(uint16),SEEK_SET);
     putshort(gpos,pos-begin_off);
     fseek(gpos,pos,SEEK_SET);
-    DumpClass(gpos,class1,at->maxp.numGlyphs);
+    DumpClass(gpos,st->class1,m->numGlyphs);
 
     pos = ftell(gpos);
     fseek(gpos,begin_off+5*sizeof(uint16),SEEK_SET);
     putshort(gpos,pos-begin_off);
     fseek(gpos,pos,SEEK_SET);
-    DumpClass(gpos,class2,at->maxp.numGlyphs);
+    DumpClass(gpos,st->class2,m->numGlyphs);
 
     pos = ftell(gpos);
     fseek(gpos,begin_off+sizeof(uint16),SEEK_SET);
     putshort(gpos,pos-begin_off);
     fseek(gpos,pos,SEEK_SET);
-    dumpcoveragetable(gpos,glyphs);
+    dumpcoveragetable(gpos,st->glyphs);
+    if ( ftell(gpos)-begin_off!=st->len )
+	IError("Miscalculated the length of a kerning class subtable");
+}
 
-    free(glyphs);
-    free(class1);
-    free(class2);
+static void dumpgposkernclass(FILE *gpos,SplineFont *sf,
+	struct lookup_subtable *sub, struct alltabs *at) {
+    KernClass *kc = sub->kc, *test;
+    struct kcmatrix m;
+    struct kcsubtable st;
+    int *allrows, *allcols, *rowmap, *rowglyphs, *rowcost;
+    int i, k, r, c, isv, start, end, fixed, len, chunk_cnt, chunk_max;
+    char *sizes, *temp;
+
+    memset(&m,0,sizeof(m));
+    m.kc = kc;
+    m.numGlyphs = at->maxp.numGlyphs;
+    for ( i=0; i<kc->first_cnt*kc->second_cnt; ++i ) {
+	if ( kc->adjusts[i].corrections!=NULL ) {
+	    m.anydevtab = true;
+    break;
+	}
+    }
+
+    for ( test=sf->vkerns; test!=NULL && test!=kc; test=test->next );
+    isv = test==kc;
+
+    m.class1 = ClassesFromNames(sf,kc->firsts,kc->first_cnt,m.numGlyphs,&m.gs,false);
+    m.class2 = ClassesFromNames(sf,kc->seconds,kc->second_cnt,m.numGlyphs,NULL,false);
+
+    /* The rows worth having are the first classes with glyphs in the font */
+    /*  and class 0, which comes first */
+    rowglyphs = calloc(kc->first_cnt,sizeof(int));
+    for ( i=0; i<m.numGlyphs; ++i )
+	if ( m.gs[i]!=NULL )
+	    ++rowglyphs[m.class1[i]];
+    allrows = malloc(kc->first_cnt*sizeof(int));
+    allrows[0] = 0;
+    for ( i=k=1; i<kc->first_cnt; ++i )
+	if ( rowglyphs[i]!=0 )
+	    allrows[k++] = i;
+
+    allcols = malloc(kc->second_cnt*sizeof(int));
+    for ( i=0; i<kc->second_cnt; ++i )
+	allcols[i] = i;
+    m.colof = malloc(kc->second_cnt*sizeof(int));
+    m.cols = malloc(kc->second_cnt*sizeof(int));
+    m.ccnt = KCMergeColumns(&m,allcols,kc->second_cnt,allrows,k,m.colof,m.cols);
+
+    rowmap = malloc(k*sizeof(int));
+    m.rows = malloc(k*sizeof(int));
+    m.rcnt = KCMerge(&m,false,allrows+1,k-1,m.cols,m.ccnt,rowmap,m.rows);
+    m.rowof = malloc(kc->first_cnt*sizeof(int));
+    for ( i=0; i<kc->first_cnt; ++i )
+	m.rowof[i] = -1;
+    for ( i=1; i<k; ++i )
+	m.rowof[allrows[i]] = rowmap[i-1];
+
+    KCSubtableFigure(&m,0,m.rcnt,&st);
+    if ( st.len<=65535 ) {
+	dumpgposkernclasssubtable(gpos,&m,isv,&st);
+	KCSubtableFree(&st);
+    } else {
+	/* Pack rows in while a generous guess at the length still fits. */
+	/*  Taking a row out of a subtable can't make its columns or its */
+	/*  second class table any bigger, and a glyph costs at most six */
+	/*  bytes in each of the first class table and the coverage table */
+	fixed = 8*sizeof(uint16) + ClassLen(st.class2,m.numGlyphs) + 2*2*sizeof(uint16) +
+		m.ccnt*(m.anydevtab?2:1)*sizeof(uint16) + 2*6*rowglyphs[0];
+	if ( m.anydevtab )
+	    for ( c=0; c<m.ccnt; ++c )
+		fixed += DevTabLen(&kc->adjusts[m.cols[c]]);
+	KCSubtableFree(&st);
+	rowcost = calloc(m.rcnt,sizeof(int));
+	for ( i=0; i<kc->first_cnt; ++i )
+	    if ( m.rowof[i]!=-1 )
+		rowcost[m.rowof[i]] += 2*6*rowglyphs[i];
+	for ( r=0; r<m.rcnt; ++r ) {
+	    rowcost[r] += m.ccnt*(m.anydevtab?2:1)*sizeof(uint16);
+	    if ( m.anydevtab )
+		for ( c=0; c<m.ccnt; ++c )
+		    rowcost[r] += DevTabLen(&kc->adjusts[m.rows[r]*kc->second_cnt+m.cols[c]]);
+	}
+	chunk_cnt = chunk_max = 0;
+	sizes = NULL;
+	for ( start=0; start<m.rcnt; start=end ) {
+	    len = fixed;
+	    for ( end=start; end<m.rcnt && (end==start || len+rowcost[end]<=65535); ++end )
+		len += rowcost[end];
+	    if ( chunk_cnt>=chunk_max )
+		sub->extra_subtables = realloc(sub->extra_subtables,((chunk_max+=10)+1)*sizeof(int32));
+	    sub->extra_subtables[chunk_cnt++] = ftell(gpos);
+	    sub->extra_subtables[chunk_cnt] = -1;
+	    KCSubtableFigure(&m,start,end,&st);
+	    if ( st.len>65535 )
+		LogError(_("Lookup subtable %s contains a glyph %s whose kerning information takes up more than 64k bytes\n"),
+			sub->subtable_name, st.glyphs[0]!=NULL ? st.glyphs[0]->name : "" );
+	    temp = sizes==NULL ? smprintf("%d",st.len) : smprintf("%s, %d",sizes,st.len);
+	    free(sizes);
+	    sizes = temp;
+	    dumpgposkernclasssubtable(gpos,&m,isv,&st);
+	    KCSubtableFree(&st);
+	}
+	LogError(_("Lookup subtable %s had to be split into %d subtables\nbecause it was too big. They take %s bytes.\n"),
+		sub->subtable_name, chunk_cnt, sizes );
+	free(sizes);
+	free(rowcost);
+    }
+
+    free(allrows); free(allcols); free(rowmap); free(rowglyphs);
+    free(m.rows); free(m.cols); free(m.rowof); free(m.colof);
+    free(m.class1); free(m.class2); free(m.gs);
 }
 
 static void dumpanchor(FILE *gpos,AnchorPoint *ap, int is_ttf ) {
@@ -2771,7 +3086,7 @@ static FILE *G___figureLookups(SplineFont *sf,int is_gpos,
     struct lookup_subtable *sub;
     int index, i,j;
     FILE *final;
-    FILE *lfile = GFileTmpfile();
+    FILE *lfile = GFileMemTmpfile();
     OTLookup **sizeordered;
     OTLookup *all = is_gpos ? sf->gpos_lookups : sf->gsub_lookups;
     char *buffer;
@@ -2807,7 +3122,7 @@ return( lfile );
 	    sizeordered[ otl->lookup_index ] = otl;
     qsort(sizeordered,index,sizeof(OTLookup *),lookup_size_cmp);
 
-    final = GFileTmpfile();
+    final = GFileMemTmpfile();
     buffer = malloc(32768);
     for ( i=0; i<index; ++i ) {
 	uint32 diff;
@@ -3106,7 +3421,7 @@ return( NULL );
     /* Now we've worked out which lookups need extension tables and marked them*/
     /* Generate the extension tables, and update the offsets to reflect the size */
     /* of the extensions */
-    efile = GFileTmpfile();
+    efile = GFileMemTmpfile();
 
     len2 = 0;
     for ( otf=all; otf!=NULL; otf=otf->next ) if ( otf->lookup_index!=-1 ) {
@@ -3186,7 +3501,7 @@ return( NULL );
 return( NULL );
     }
 
-    g___ = GFileTmpfile();
+    g___ = GFileMemTmpfile();
 
     putlong(g___,0x10000);		/* version number */
     putshort(g___,10);		/* offset to script table */
@@ -3594,7 +3909,7 @@ void otf_dumpgdef(struct alltabs *at, SplineFont *sf) {
     if ( !needsclass && lcnt==0 && sf->mark_class_cnt==0 && sf->mark_set_cnt==0 )
 return;					/* No anchor positioning, no ligature carets */
 
-    at->gdef = GFileTmpfile();
+    at->gdef = GFileMemTmpfile();
     if ( sf->mark_set_cnt==0 ) {
 	putlong(at->gdef,0x00010000);		/* Version */
         putshort(at->gdef, needsclass ? 12 : 0 ); /* glyph class defn table */
@@ -4164,7 +4479,7 @@ void otf_dump_math(struct alltabs *at, SplineFont *sf) {
     else
 	return;
 
-    at->math = mathf = GFileTmpfile();
+    at->math = mathf = GFileMemTmpfile();
 
     putlong(mathf,  0x00010000 );		/* Version 1 */
     putshort(mathf, 10);			/* Offset to constants */
@@ -4391,7 +4706,7 @@ return;
 
     SFBaseSort(sf);
 
-    at->base = basef = GFileTmpfile();
+    at->base = basef = GFileMemTmpfile();
 
     putlong(basef,  0x00010000 );		/* Version 1 */
     putshort(basef,  0 );			/* offset to horizontal baselines, fill in later */
@@ -4699,7 +5014,7 @@ return;
     SFJstfSort(sf);
     for ( jscript=sf->justify, cnt=0; jscript!=NULL; jscript=jscript->next, ++cnt );
 
-    at->jstf = jstf = GFileTmpfile();
+    at->jstf = jstf = GFileMemTmpfile();
 
     putlong(jstf,  0x00010000 );		/* Version 1 */
     putshort(jstf, cnt );			/* script count */
@@ -4838,7 +5153,7 @@ void otf_dump_dummydsig(struct alltabs *at, SplineFont *sf) {
     /*  told an empty DSIG table works for that. So... a truely pointless   */
     /*  instance of a pointless table. I suppose that's a bit ironic. */
 
-    at->dsigf = dsigf = GFileTmpfile();
+    at->dsigf = dsigf = GFileMemTmpfile();
     putlong(dsigf,0x00000001);		/* Standard version (and why isn't it 0x10000 like everything else?) */
     putshort(dsigf,0);			/* No signatures in my signature table*/
     putshort(dsigf,0);			/* No flags */
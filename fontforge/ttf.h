@@ -106,6 +106,7 @@ struct ttfinfo {
     unsigned int apply_lsb: 1;
     int sfntRevision;
     enum openflags openflags;
+    struct lazyglyphs *lazy;	/* Simple glyphs are left in the file (of_lazy) */
     /* Mac fonts platform=0/1, platform specific enc id, roman=0, english is lang code 0 */
     /* iso platform=2, platform specific enc id, latin1=0/2, no language */
     /* microsoft platform=3, platform specific enc id, 1, english is lang code 0x??09 */
@@ -300,6 +301,7 @@ struct ttfinfo {
     uint8 warned_morx_out_of_bounds_glyph;
     int badgid_cnt, badgid_max;		/* Used when parsing apple morx tables*/
     SplineChar **badgids;		/* which use out of range glyph IDs as temporary flags */
+    struct kernpairindex *kern_index[2];	/* Of the glyphs' kern pairs, while GPOS or JSTF is read (horizontal, vertical) */
     long long creationtime;		/* seconds since 1970 */
     long long modificationtime;
     int gasp_cnt;
@@ -581,6 +583,7 @@ struct glyphinfo {
     int *bygid;			/* glyph list */
     int gcnt;
     int layer;
+    SplineSet **ttfss;		/* outlines converted ahead of time, by ttf_glyph */
 };
 
 struct vorg {
@@ -74,7 +74,7 @@ static void PfEd_FontComment(SplineFont *sf, struct PfEd_subtabs *pfed, uint32 t
     if ( text==NULL || *text=='\0' )
 return;
     pfed->subtabs[pfed->next].tag = tag;
-    pfed->subtabs[pfed->next++].data = fcmt = GFileTmpfile();
+    pfed->subtabs[pfed->next++].data = fcmt = GFileMemTmpfile();
 
     putshort(fcmt,1);			/* sub-table version number */
     putshort(fcmt,strlen(text));
@@ -106,7 +106,7 @@ static void PfEd_GlyphComments(SplineFont *sf, struct PfEd_subtabs *pfed,
 return;
 
     pfed->subtabs[pfed->next].tag = cmnt_TAG;
-    pfed->subtabs[pfed->next++].data = cmnt = GFileTmpfile();
+    pfed->subtabs[pfed->next++].data = cmnt = GFileMemTmpfile();
 
     putshort(cmnt,1);			/* sub-table version number */
 	    /* Version 0 used ucs2, version 1 uses utf8 */
@@ -174,7 +174,7 @@ static void PfEd_CvtComments(SplineFont *sf, struct PfEd_subtabs *pfed ) {
     if ( sf->cvt_names==NULL )
 return;
     pfed->subtabs[pfed->next].tag = cvtc_TAG;
-    pfed->subtabs[pfed->next++].data = cvtcmt = GFileTmpfile();
+    pfed->subtabs[pfed->next++].data = cvtcmt = GFileMemTmpfile();
 
     for ( i=0; sf->cvt_names[i]!=END_CVT_NAMES; ++i);
 
@@ -217,7 +217,7 @@ static void PfEd_Colours(SplineFont *sf, struct PfEd_subtabs *pfed, struct glyph
 return;
 
     pfed->subtabs[pfed->next].tag = colr_TAG;
-    pfed->subtabs[pfed->next++].data = colr = GFileTmpfile();
+    pfed->subtabs[pfed->next++].data = colr = GFileMemTmpfile();
 
     putshort(colr,0);			/* sub-table version number */
     for ( j=0; j<2; ++j ) {
@@ -275,7 +275,7 @@ return;
     }
 
     pfed->subtabs[pfed->next].tag = tag;
-    pfed->subtabs[pfed->next++].data = lkf = GFileTmpfile();
+    pfed->subtabs[pfed->next++].data = lkf = GFileMemTmpfile();
 
     putshort(lkf,0);			/* Subtable version */
     putshort(lkf,lcnt);
@@ -615,7 +615,7 @@ return;
     h = pfed_guide_sortuniq(hs,h);
 
     pfed->subtabs[pfed->next].tag = guid_TAG;
-    pfed->subtabs[pfed->next++].data = guid = GFileTmpfile();
+    pfed->subtabs[pfed->next++].data = guid = GFileMemTmpfile();
 
     nameoff   = 5*2 + (h+v) * 4;
     namelen   = 0;
@@ -772,7 +772,7 @@ return;
     }
 
     pfed->subtabs[pfed->next].tag = layr_TAG;
-    pfed->subtabs[pfed->next++].data = layr = GFileTmpfile();
+    pfed->subtabs[pfed->next++].data = layr = GFileMemTmpfile();
 
     putshort(layr,1);			/* sub-table version */
     putshort(layr,cnt);			/* layer count */
@@ -854,7 +854,7 @@ void pfed_dump(struct alltabs *at, SplineFont *sf) {
     if ( pfed.next==0 )
 return;		/* No subtables */
 
-    at->pfed = file = GFileTmpfile();
+    at->pfed = file = GFileMemTmpfile();
     putlong(file, 0x00010000);		/* Version number */
     putlong(file, pfed.next);		/* sub-table count */
     offset = 2*sizeof(uint32) + 2*pfed.next*sizeof(uint32);
@@ -1693,7 +1693,7 @@ static void TeX_dumpFontParams(SplineFont *sf, struct TeX_subtabs *tex, struct a
     if ( sf->texdata.type==tex_unset )
 return;
     tex->subtabs[tex->next].tag = CHR('f','t','p','m');
-    tex->subtabs[tex->next++].data = fprm = GFileTmpfile();
+    tex->subtabs[tex->next++].data = fprm = GFileMemTmpfile();
 
     putshort(fprm,0);			/* sub-table version number */
     pcnt = sf->texdata.type==tex_math ? 22 : sf->texdata.type==tex_mathext ? 13 : 7;
@@ -1723,7 +1723,7 @@ static void TeX_dumpHeightDepth(SplineFont *sf, struct TeX_subtabs *tex, struct
 return;
 
     tex->subtabs[tex->next].tag = CHR('h','t','d','p');
-    tex->subtabs[tex->next++].data = htdp = GFileTmpfile();
+    tex->subtabs[tex->next++].data = htdp = GFileMemTmpfile();
 
     putshort(htdp,0);				/* sub-table version number */
     putshort(htdp,sf->glyphs[gid]->ttf_glyph+1);/* data for this many glyphs */
@@ -1761,7 +1761,7 @@ static void TeX_dumpItalicCorr(SplineFont *sf, struct TeX_subtabs *tex, struct a
 return;
 
     tex->subtabs[tex->next].tag = CHR('i','t','l','c');
-    tex->subtabs[tex->next++].data = itlc = GFileTmpfile();
+    tex->subtabs[tex->next++].data = itlc = GFileMemTmpfile();
 
     putshort(itlc,0);				/* sub-table version number */
     putshort(itlc,sf->glyphs[gid]->ttf_glyph+1);/* data for this many glyphs */
@@ -1800,7 +1800,7 @@ return;
     if ( tex.next==0 )
 return;		/* No subtables */
 
-    at->tex = file = GFileTmpfile();
+    at->tex = file = GFileMemTmpfile();
     putlong(file, 0x00010000);		/* Version number */
     putlong(file, tex.next);		/* sub-table count */
     offset = 2*sizeof(uint32) + 2*tex.next*sizeof(uint32);
@@ -2028,8 +2028,8 @@ int ttf_bdf_dump(SplineFont *sf,struct alltabs *at,int32 *sizes) {
     if ( spcnt==0 )	/* No strikes with properties */
 return(true);
 
-    at->bdf = GFileTmpfile();
-    strings = GFileTmpfile();
+    at->bdf = GFileMemTmpfile();
+    strings = GFileMemTmpfile();
 
     putshort(at->bdf,0x0001);
     putshort(at->bdf,spcnt);
@@ -2231,7 +2231,7 @@ int ttf_fftm_dump(SplineFont *sf,struct alltabs *at) {
     if ( at->gi.flags & ttf_flag_noFFTMtable )
 	return false;
 
-    at->fftmf = GFileTmpfile();
+    at->fftmf = GFileMemTmpfile();
 
     putlong(at->fftmf,0x00000001);	/* Version */
 
@@ -0,0 +1,772 @@
+/* Copyright (C) 2020 by FontForge authors */
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+
+ * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+
+ * The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fontforge-config.h>
+
+#include "type2subrs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* The subroutines SplineFont2ChrsSubrs2 makes are whole pieces of contour */
+/*  between one moveto/hintmask and the next, so they only catch glyphs */
+/*  which share entire contours. Here we start again from the charstrings */
+/*  with all their subr calls expanded, split them into tokens (a number, */
+/*  or an operator along with any mask bytes), and look for token sequences */
+/*  which occur more than once wherever they are. */
+/* A suffix array of the whole font's tokens (with its lcp array) gives us */
+/*  every repeated sequence: each lcp interval is a sequence and the set */
+/*  of places it occurs. The ones which might save space become candidate */
+/*  subrs. Then we go round a few times: work out the cheapest way to write */
+/*  each glyph (and each candidate subr, which may call shorter ones) given */
+/*  the candidates, count how often each is actually called, and drop the */
+/*  ones which don't pay for themselves. The survivors are numbered so the */
+/*  most used get the shortest subr numbers */
+/* Type2 limits us to 48 things on the stack and 10 levels of subr calls. */
+/*  A call pushes the subr number, so it may only happen where the stack */
+/*  has room for one more */
+
+#define T2_MAXSTACK	48
+#define T2_MAXNEST	10
+#define T2_MAXSUBRS	65535
+#define T2_ROUNDS	8
+
+struct t2text {
+    uint8 *bytes;		/* The charstrings with all calls expanded */
+    int blen, bmax;
+    int *off;			/* Where each token starts in bytes */
+    int *depth;			/* Numbers on the stack before each token */
+    uint8 *barrier;		/* Token may not go into a subr */
+    int cnt, max;
+    int *gstart;		/* First token of each glyph */
+};
+
+struct t2flatten {
+    struct pschars *lsubrs, *gsubrs;
+    int sp;			/* Numbers on the stack */
+    int hints;			/* Stems declared so far */
+    int started;		/* Seen the first drawing operator */
+    int lastnum, lastval;	/* Token index and value of the last number */
+};
+
+struct t2subr {
+    int pos;			/* Where (one copy of) it starts in the text */
+    int len;			/* In tokens */
+    int lb, rb;			/* It starts at sa[lb..rb] */
+    int bytes;			/* When written out in full */
+    int maxentry;		/* Most numbers on the stack where it starts */
+    int estimate;		/* Bytes it might save */
+    int cost;			/* Bytes when written calling other subrs */
+    int nest;			/* Levels of calls it makes, counting itself */
+    int callcost;		/* Bytes needed to call it */
+    int used;			/* Calls to it */
+    int idx;			/* subr number (before the bias) */
+    unsigned int alive: 1;
+};
+
+struct t2state {
+    struct t2text *tt;
+    struct t2subr *subrs;
+    int scnt;
+    int *at_start, *at;		/* subrs starting at each token */
+    int *cost, *choice;		/* Scratch for T2Parse */
+};
+
+static int T2IsNumber(int ch) {
+return( ch>=32 || ch==28 );
+}
+
+static int T2NumLen(int v) {
+return( v>=-107 && v<=107 ? 1 : v>=-1131 && v<=1131 ? 2 : 3 );
+}
+
+static int T2Bias(int cnt) {
+return( cnt<1240 ? 107 : cnt<33900 ? 1131 : 32768 );
+}
+
+static void T2AddToken(struct t2text *tt,const uint8 *data,int len,int depth,int barrier) {
+    if ( tt->cnt+1>=tt->max ) {
+	tt->max += tt->max+1000;
+	tt->off = realloc(tt->off,tt->max*sizeof(int));
+	tt->depth = realloc(tt->depth,tt->max*sizeof(int));
+	tt->barrier = realloc(tt->barrier,tt->max);
+    }
+    if ( tt->blen+len>tt->bmax ) {
+	tt->bmax += tt->bmax+len+4000;
+	tt->bytes = realloc(tt->bytes,tt->bmax);
+    }
+    tt->off[tt->cnt] = tt->blen;
+    if ( len>0 )
+	memcpy(tt->bytes+tt->blen,data,len);
+    tt->blen += len;
+    tt->depth[tt->cnt] = depth;
+    tt->barrier[tt->cnt] = barrier;
+    tt->off[++tt->cnt] = tt->blen;
+}
+
+/* Appends the tokens of a charstring to the text, replacing subr calls by */
+/*  what they call. Returns 0 at the end of a subr, 1 at endchar and -1 on */
+/*  anything we don't expect to find in a charstring we wrote ourselves */
+static int T2Flatten(struct t2text *tt,struct t2flatten *st,const uint8 *data,int len,int nest) {
+    const uint8 *pt = data, *end = data+len;
+    struct pschars *subrs;
+    int ch, n, v, ret;
+
+    while ( pt<end ) {
+	ch = *pt;
+	if ( T2IsNumber(ch) ) {
+	    if ( ch==28 ) {
+		n = 3;
+		v = (int16) ((pt[1]<<8)|pt[2]);
+	    } else if ( ch<=246 ) {
+		n = 1;
+		v = ch-139;
+	    } else if ( ch<=250 ) {
+		n = 2;
+		v = (ch-247)*256+pt[1]+108;
+	    } else if ( ch<=254 ) {
+		n = 2;
+		v = -(ch-251)*256-pt[1]-108;
+	    } else {
+		n = 5;
+		v = 0x7fffffff;		/* Fixed. Not a subr number */
+	    }
+	    if ( pt+n>end )
+return( -1 );
+	    st->lastnum = tt->cnt;
+	    st->lastval = v;
+	    T2AddToken(tt,pt,n,st->sp,!st->started);
+	    ++st->sp;
+	    pt += n;
+	} else if ( ch==10 || ch==29 ) {		/* callsubr, callgsubr */
+	    subrs = ch==10 ? st->lsubrs : st->gsubrs;
+	    if ( subrs==NULL || st->lastnum!=tt->cnt-1 || nest>=T2_MAXNEST ||
+		    st->lastval==0x7fffffff )
+return( -1 );
+	    v = st->lastval + subrs->bias;
+	    if ( v<0 || v>=subrs->next )
+return( -1 );
+	    /* Take back the subr number and put the subr there instead */
+	    tt->blen = tt->off[--tt->cnt];
+	    --st->sp;
+	    st->lastnum = -1;
+	    if ( (ret = T2Flatten(tt,st,subrs->values[v],subrs->lens[v],nest+1))!=0 )
+return( ret );
+	    ++pt;
+	} else if ( ch==11 ) {				/* return */
+return( 0 );
+	} else if ( ch==14 ) {				/* endchar */
+	    T2AddToken(tt,pt,1,st->sp,true);
+return( 1 );
+	} else if ( ch==1 || ch==3 || ch==18 || ch==23 ) {	/* stems */
+	    st->hints += st->sp/2;
+	    T2AddToken(tt,pt,1,st->sp,true);
+	    st->sp = 0;
+	    ++pt;
+	} else if ( ch==19 || ch==20 ) {		/* hintmask, cntrmask */
+	    /* Any arguments are an implicit vstem, which must stay put */
+	    st->hints += st->sp/2;
+	    n = 1+(st->hints+7)/8;
+	    if ( pt+n>end )
+return( -1 );
+	    T2AddToken(tt,pt,n,st->sp,st->sp!=0 || !st->started);
+	    st->started = true;
+	    st->sp = 0;
+	    pt += n;
+	} else if ( ch==12 ) {
+	    /* The only escaped operators we write are the flexes */
+	    if ( pt+2>end || pt[1]<34 || pt[1]>37 )
+return( -1 );
+	    T2AddToken(tt,pt,2,st->sp,!st->started);
+	    st->started = true;
+	    st->sp = 0;
+	    pt += 2;
+	} else if ( (ch>=4 && ch<=8) || ch==21 || ch==22 || (ch>=24 && ch<=27) ||
+		ch==30 || ch==31 ) {
+	    /* The operator which takes the width (if any) stays in the glyph */
+	    T2AddToken(tt,pt,1,st->sp,!st->started);
+	    st->started = true;
+	    st->sp = 0;
+	    ++pt;
+	} else
+return( -1 );
+    }
+return( 0 );
+}
+
+static struct t2text *T2Text(struct pschars *chrs,struct pschars **subrs,
+	const int *fds,struct pschars *gsubrs) {
+    struct t2text *tt = calloc(1,sizeof(struct t2text));
+    struct t2flatten st;
+    int i;
+
+    tt->gstart = malloc((chrs->next+1)*sizeof(int));
+    for ( i=0; i<chrs->next; ++i ) {
+	tt->gstart[i] = tt->cnt;
+	memset(&st,0,sizeof(st));
+	st.lsubrs = subrs[fds==NULL ? 0 : fds[i]];
+	st.gsubrs = gsubrs;
+	st.lastnum = -1;
+	if ( T2Flatten(tt,&st,chrs->values[i],chrs->lens[i],0)==-1 ) {
+	    free(tt->gstart);
+	    free(tt->bytes); free(tt->off); free(tt->depth); free(tt->barrier);
+	    free(tt);
+return( NULL );
+	}
+	/* An empty token to end the glyph, so nothing runs from one into */
+	/*  the next */
+	T2AddToken(tt,NULL,0,0,true);
+    }
+    tt->gstart[i] = tt->cnt;
+return( tt );
+}
+
+static void T2TextFree(struct t2text *tt) {
+    free(tt->gstart);
+    free(tt->bytes);
+    free(tt->off);
+    free(tt->depth);
+    free(tt->barrier);
+    free(tt);
+}
+
+/* Numbers the tokens, so that identical tokens get the same number. Each */
+/*  barrier gets a number of its own, so it never matches anything */
+static int *T2TokenIds(struct t2text *tt,int *_alpha) {
+    int *ids = malloc(tt->cnt*sizeof(int));
+    int size, *table, i, j, len, ntok = 0;
+    uint32 hash;
+    const uint8 *pt;
+
+    for ( size=1024; size<2*tt->cnt; size<<=1 );
+    table = malloc(size*sizeof(int));
+    memset(table,-1,size*sizeof(int));
+    for ( i=0; i<tt->cnt; ++i ) {
+	if ( tt->barrier[i] )
+    continue;
+	pt = tt->bytes+tt->off[i];
+	len = tt->off[i+1]-tt->off[i];
+	hash = 2166136261u;
+	for ( j=0; j<len; ++j )
+	    hash = (hash^pt[j])*16777619u;
+	for ( j=hash&(size-1); table[j]!=-1; j=(j+1)&(size-1) ) {
+	    int k = table[j];
+	    if ( tt->off[k+1]-tt->off[k]==len &&
+		    memcmp(tt->bytes+tt->off[k],pt,len)==0 )
+	break;
+	}
+	if ( table[j]==-1 ) {
+	    table[j] = i;
+	    ids[i] = ntok++;
+	} else
+	    ids[i] = ids[table[j]];
+    }
+    free(table);
+    for ( i=0; i<tt->cnt; ++i )
+	if ( tt->barrier[i] )
+	    ids[i] = ntok+i;
+    *_alpha = ntok+tt->cnt;
+return( ids );
+}
+
+/* Suffix array by prefix doubling, radix sorting on the ranks each time */
+static int *T2SuffixArray(const int *s,int n,int alpha) {
+    int *sa = malloc(n*sizeof(int)), *rank = malloc(n*sizeof(int));
+    int *tmp = malloc(n*sizeof(int));
+    int m = alpha>n ? alpha : n;
+    int *cnt = malloc((m+1)*sizeof(int));
+    int i, k, p, r1, r2;
+
+    memset(cnt,0,(m+1)*sizeof(int));
+    for ( i=0; i<n; ++i )
+	++cnt[s[i]];
+    for ( i=1; i<alpha; ++i )
+	cnt[i] += cnt[i-1];
+    for ( i=n-1; i>=0; --i )
+	sa[--cnt[s[i]]] = i;
+    for ( i=0, p=0; i<n; ++i ) {
+	if ( i>0 && s[sa[i]]!=s[sa[i-1]] )
+	    ++p;
+	rank[sa[i]] = p;
+    }
+    m = p+1;
+    for ( k=1; m<n; k<<=1 ) {
+	/* Order by the second half: those without one come first */
+	for ( i=n-k, p=0; i<n; ++i )
+	    tmp[p++] = i;
+	for ( i=0; i<n; ++i )
+	    if ( sa[i]>=k )
+		tmp[p++] = sa[i]-k;
+	/* Then stably by the first */
+	memset(cnt,0,m*sizeof(int));
+	for ( i=0; i<n; ++i )
+	    ++cnt[rank[i]];
+	for ( i=1; i<m; ++i )
+	    cnt[i] += cnt[i-1];
+	for ( i=n-1; i>=0; --i )
+	    sa[--cnt[rank[tmp[i]]]] = tmp[i];
+	tmp[sa[0]] = p = 0;
+	for ( i=1; i<n; ++i ) {
+	    r1 = sa[i-1]+k<n ? rank[sa[i-1]+k] : -1;
+	    r2 = sa[i]+k<n ? rank[sa[i]+k] : -1;
+	    if ( rank[sa[i-1]]!=rank[sa[i]] || r1!=r2 )
+		++p;
+	    tmp[sa[i]] = p;
+	}
+	memcpy(rank,tmp,n*sizeof(int));
+	m = p+1;
+    }
+    free(cnt);
+    free(tmp);
+    free(rank);
+return( sa );
+}
+
+/* lcp[i] is the length of the common start of suffixes sa[i-1] and sa[i] */
+static int *T2Lcp(const int *s,const int *sa,int n) {
+    int *rank = malloc(n*sizeof(int)), *lcp = malloc((n+1)*sizeof(int));
+    int i, j, h = 0;
+
+    for ( i=0; i<n; ++i )
+	rank[sa[i]] = i;
+    lcp[0] = lcp[n] = 0;
+    for ( i=0; i<n; ++i ) {
+	if ( rank[i]>0 ) {
+	    j = sa[rank[i]-1];
+	    while ( i+h<n && j+h<n && s[i+h]==s[j+h] )
+		++h;
+	    lcp[rank[i]] = h;
+	    if ( h>0 ) --h;
+	} else
+	    h = 0;
+    }
+    free(rank);
+return( lcp );
+}
+
+static void T2AddCandidate(struct t2state *ts,const int *sa,int len,int lb,int rb,int *smax) {
+    struct t2text *tt = ts->tt;
+    struct t2subr *sub;
+    int pos = sa[lb], bytes = tt->off[pos+len]-tt->off[pos];
+    int cnt = rb-lb+1, estimate = cnt*(bytes-2)-(bytes+3);
+    int i;
+
+    if ( estimate<=0 )
+return;
+    if ( ts->scnt>=*smax )
+	ts->subrs = realloc(ts->subrs,(*smax += *smax+1000)*sizeof(struct t2subr));
+    sub = &ts->subrs[ts->scnt++];
+    memset(sub,0,sizeof(*sub));
+    sub->pos = pos;
+    sub->len = len;
+    sub->lb = lb; sub->rb = rb;
+    sub->bytes = bytes;
+    sub->estimate = estimate;
+    for ( i=lb; i<=rb; ++i )
+	if ( tt->depth[sa[i]]>sub->maxentry )
+	    sub->maxentry = tt->depth[sa[i]];
+    sub->alive = true;
+}
+
+/* Every lcp interval is a token sequence (as long as the interval's lcp) */
+/*  which starts at each of the suffixes in the interval */
+static void T2FindCandidates(struct t2state *ts,const int *sa,const int *lcp,int n) {
+    int *stlcp = malloc((n+1)*sizeof(int)), *stlb = malloc((n+1)*sizeof(int));
+    int top = 0, i, lb, cur, smax = 0;
+
+    stlcp[0] = 0; stlb[0] = 0;
+    for ( i=1; i<=n; ++i ) {
+	lb = i-1;
+	cur = lcp[i];
+	while ( cur<stlcp[top] ) {
+	    T2AddCandidate(ts,sa,stlcp[top],stlb[top],i-1,&smax);
+	    lb = stlb[top--];
+	}
+	if ( cur>stlcp[top] ) {
+	    ++top;
+	    stlcp[top] = cur;
+	    stlb[top] = lb;
+	}
+    }
+    free(stlcp);
+    free(stlb);
+}
+
+static void T2IndexCandidates(struct t2state *ts,const int *sa) {
+    int n = ts->tt->cnt, i, j;
+
+    ts->at_start = calloc(n+1,sizeof(int));
+    for ( i=0; i<ts->scnt; ++i )
+	for ( j=ts->subrs[i].lb; j<=ts->subrs[i].rb; ++j )
+	    ++ts->at_start[sa[j]+1];
+    for ( i=0; i<n; ++i )
+	ts->at_start[i+1] += ts->at_start[i];
+    ts->at = malloc(ts->at_start[n]*sizeof(int));
+    for ( i=0; i<ts->scnt; ++i )
+	for ( j=ts->subrs[i].lb; j<=ts->subrs[i].rb; ++j )
+	    ts->at[ts->at_start[sa[j]]++] = i;
+    for ( i=n; i>0; --i )
+	ts->at_start[i] = ts->at_start[i-1];
+    ts->at_start[0] = 0;
+}
+
+/* The cheapest way to write tokens [from,to): either a token as it is or */
+/*  a call to a subr starting there. Fills in ts->cost[i-from] (the cost of */
+/*  everything from i on) and ts->choice[i-from] (the subr to call, or -1) */
+/*  If within is set then [from,to) is its body, and may only call shorter */
+/*  subrs. The stack depth there depends on where within was called from, */
+/*  until its first operator clears the stack */
+static int T2Parse(struct t2state *ts,int from,int to,struct t2subr *within) {
+    struct t2text *tt = ts->tt;
+    struct t2subr *sub;
+    int i, j, k, best, choice, c, depth, firstop = to;
+
+    if ( within!=NULL ) {
+	for ( firstop=from; firstop<to; ++firstop )
+	    if ( !T2IsNumber(tt->bytes[tt->off[firstop]]) )
+	break;
+    }
+    ts->cost[to-from] = 0;
+    for ( i=to-1; i>=from; --i ) {
+	k = i-from;
+	best = tt->off[i+1]-tt->off[i] + ts->cost[k+1];
+	choice = -1;
+	depth = within==NULL || i>firstop ? tt->depth[i] :
+		within->maxentry + tt->depth[i]-tt->depth[from];
+	if ( depth<T2_MAXSTACK ) {
+	    for ( j=ts->at_start[i]; j<ts->at_start[i+1]; ++j ) {
+		sub = &ts->subrs[ts->at[j]];
+		if ( !sub->alive || i+sub->len>to )
+	    continue;
+		if ( within!=NULL ? sub->len>=within->len || sub->nest>=T2_MAXNEST :
+			sub->nest>T2_MAXNEST )
+	    continue;
+		c = sub->callcost + ts->cost[k+sub->len];
+		if ( c<best ) {
+		    best = c;
+		    choice = ts->at[j];
+		}
+	    }
+	}
+	ts->cost[k] = best;
+	ts->choice[k] = choice;
+    }
+return( ts->cost[0] );
+}
+
+static int T2CmpLen(const void *_s1, const void *_s2) {
+    const struct t2subr *s1 = *(struct t2subr * const *) _s1, *s2 = *(struct t2subr * const *) _s2;
+
+    if ( s1->len!=s2->len )
+return( s1->len<s2->len ? -1 : 1 );
+return( s1<s2 ? -1 : s1>s2 );
+}
+
+static int T2CmpUse(const void *_s1, const void *_s2) {
+    const struct t2subr *s1 = *(struct t2subr * const *) _s1, *s2 = *(struct t2subr * const *) _s2;
+
+    if ( s1->used!=s2->used )
+return( s1->used>s2->used ? -1 : 1 );
+    if ( s1->estimate!=s2->estimate )
+return( s1->estimate>s2->estimate ? -1 : 1 );
+return( s1<s2 ? -1 : s1>s2 );
+}
+
+/* The most used subrs get the numbers which are quickest to write, which */
+/*  after biasing are those in the middle */
+static int T2Number(struct t2state *ts,struct t2subr **order) {
+    int i, n, k, l, bias;
+
+    for ( i=n=0; i<ts->scnt; ++i )
+	if ( ts->subrs[i].alive )
+	    order[n++] = &ts->subrs[i];
+    qsort(order,n,sizeof(struct t2subr *),T2CmpUse);
+    if ( n>T2_MAXSUBRS ) {
+	for ( i=T2_MAXSUBRS; i<n; ++i )
+	    order[i]->alive = false;
+	n = T2_MAXSUBRS;
+    }
+    bias = T2Bias(n);
+    k = 0;
+    for ( l=1; l<=3; ++l ) {
+	for ( i=0; i<n; ++i ) if ( T2NumLen(i-bias)==l ) {
+	    order[k]->idx = i;
+	    order[k++]->callcost = 1+l;
+	}
+    }
+return( n );
+}
+
+/* How deep the calls made by the last thing parsed (len tokens) go */
+static int T2Nest(struct t2state *ts,int len) {
+    int k, nest = 0;
+
+    for ( k=0; k<len; ) {
+	if ( ts->choice[k]==-1 )
+	    ++k;
+	else {
+	    if ( ts->subrs[ts->choice[k]].nest>nest )
+		nest = ts->subrs[ts->choice[k]].nest;
+	    k += ts->subrs[ts->choice[k]].len;
+	}
+    }
+return( nest );
+}
+
+/* Works out which subrs each glyph would call, and how often each subr */
+/*  gets called. Returns the number of subrs which are not worth having */
+static int T2Round(struct t2state *ts,struct t2subr **bylen) {
+    struct t2text *tt = ts->tt;
+    struct t2subr *sub;
+    int i, k, g, mult, dropped = 0;
+
+    for ( i=0; i<ts->scnt; ++i ) {
+	sub = bylen[i];
+	sub->used = 0;
+	if ( !sub->alive )
+    continue;
+	sub->cost = T2Parse(ts,sub->pos,sub->pos+sub->len,sub);
+	sub->nest = T2Nest(ts,sub->len)+1;
+    }
+    for ( g=0; tt->gstart[g]<tt->cnt; ++g ) {
+	T2Parse(ts,tt->gstart[g],tt->gstart[g+1],NULL);
+	for ( k=0; k<tt->gstart[g+1]-tt->gstart[g]; ) {
+	    if ( ts->choice[k]==-1 )
+		++k;
+	    else {
+		++ts->subrs[ts->choice[k]].used;
+		k += ts->subrs[ts->choice[k]].len;
+	    }
+	}
+    }
+    /* A subr which isn't worth having gets written out in full wherever it */
+    /*  was called, so the calls it makes happen that many times instead of */
+    /*  once. Longer subrs can only call shorter, so work down from them */
+    for ( i=ts->scnt-1; i>=0; --i ) {
+	sub = bylen[i];
+	if ( !sub->alive )
+    continue;
+	if ( sub->used*(sub->cost-sub->callcost) <= sub->cost+3 ) {
+	    sub->alive = false;
+	    ++dropped;
+	    mult = sub->used;
+	} else
+	    mult = 1;
+	if ( mult==0 )
+    continue;
+	T2Parse(ts,sub->pos,sub->pos+sub->len,sub);
+	for ( k=0; k<sub->len; ) {
+	    if ( ts->choice[k]==-1 )
+		++k;
+	    else {
+		ts->subrs[ts->choice[k]].used += mult;
+		k += ts->subrs[ts->choice[k]].len;
+	    }
+	}
+    }
+return( dropped );
+}
+
+/* Writes tokens [from,to) as T2Parse said, followed by final (if not 0) */
+static uint8 *T2Write(struct t2state *ts,int from,int to,struct t2subr *within,
+	int bias,int callop,int final,int *_len) {
+    struct t2text *tt = ts->tt;
+    struct t2subr *sub;
+    int len = T2Parse(ts,from,to,within) + (final!=0);
+    uint8 *ret = malloc(len+1), *pt = ret;
+    int k, si, n;
+
+    for ( k=0; k<to-from; ) {
+	if ( ts->choice[k]==-1 ) {
+	    n = tt->off[from+k+1]-tt->off[from+k];
+	    memcpy(pt,tt->bytes+tt->off[from+k],n);
+	    pt += n;
+	    ++k;
+	} else {
+	    sub = &ts->subrs[ts->choice[k]];
+	    si = sub->idx - bias;
+	    if ( si>=-107 && si<=107 )
+		*pt++ = si+139;
+	    else if ( si>0 && si<=1131 ) {
+		si -= 108;
+		*pt++ = (si>>8)+247;
+		*pt++ = si&0xff;
+	    } else if ( si>=-1131 && si<0 ) {
+		si = (-si)-108;
+		*pt++ = (si>>8)+251;
+		*pt++ = si&0xff;
+	    } else {
+		*pt++ = 28;
+		*pt++ = (si>>8)&0xff;
+		*pt++ = si&0xff;
+	    }
+	    *pt++ = callop;
+	    k += sub->len;
+	}
+    }
+    if ( final!=0 )
+	*pt++ = final;
+    *pt = '\0';
+    *_len = pt-ret;
+return( ret );
+}
+
+/* Bytes an INDEX of cnt strings, len bytes in all, takes up */
+static int T2IndexSize(int cnt,int len) {
+    int offsize = len<0xff ? 1 : len<0xffff ? 2 : len<0xffffff ? 3 : 4;
+
+    if ( cnt==0 )
+return( 2 );
+return( 3 + (cnt+1)*offsize + len );
+}
+
+static int T2Size(struct pschars *chrs) {
+    int i, len = 0;
+
+    if ( chrs==NULL )
+return( 0 );
+    for ( i=0; i<chrs->next; ++i )
+	len += chrs->lens[i];
+return( T2IndexSize(chrs->next,len) );
+}
+
+static void T2Replace(struct pschars *chrs,int cnt,uint8 **values,int *lens) {
+    int i;
+
+    for ( i=0; i<chrs->next; ++i )
+	free(chrs->values[i]);
+    free(chrs->values);
+    free(chrs->lens);
+    chrs->values = values;
+    chrs->lens = lens;
+    chrs->cnt = chrs->next = cnt;
+    chrs->bias = T2Bias(cnt);
+}
+
+void Type2Subroutinize(struct pschars *chrs, struct pschars **subrs, int subrcnt,
+	const int *fds, struct pschars *gsubrs) {
+    struct t2state ts;
+    struct t2text *tt;
+    struct t2subr **bylen, **order;
+    int *ids, *sa, *lcp;
+    int alpha, i, n, oldsize, newsize, glen, slen, bias, maxlen, callop, dropped;
+    uint8 **gvalues, **svalues;
+    int *glens, *slens;
+
+    if ( chrs==NULL || chrs->next==0 )
+return;
+    if ( (tt = T2Text(chrs,subrs,fds,gsubrs))==NULL )
+return;
+
+    memset(&ts,0,sizeof(ts));
+    ts.tt = tt;
+    ids = T2TokenIds(tt,&alpha);
+    sa = T2SuffixArray(ids,tt->cnt,alpha);
+    lcp = T2Lcp(ids,sa,tt->cnt);
+    free(ids);
+    T2FindCandidates(&ts,sa,lcp,tt->cnt);
+    free(lcp);
+    T2IndexCandidates(&ts,sa);
+    free(sa);
+
+    maxlen = 0;
+    for ( i=0; i<chrs->next; ++i )
+	if ( tt->gstart[i+1]-tt->gstart[i]>maxlen )
+	    maxlen = tt->gstart[i+1]-tt->gstart[i];
+    ts.cost = malloc((maxlen+1)*sizeof(int));
+    ts.choice = malloc((maxlen+1)*sizeof(int));
+
+    bylen = malloc((ts.scnt+1)*sizeof(struct t2subr *));
+    order = malloc((ts.scnt+1)*sizeof(struct t2subr *));
+    for ( i=0; i<ts.scnt; ++i )
+	bylen[i] = &ts.subrs[i];
+    qsort(bylen,ts.scnt,sizeof(struct t2subr *),T2CmpLen);
+    T2Number(&ts,order);
+    for ( i=0; i<T2_ROUNDS; ++i ) {
+	dropped = T2Round(&ts,bylen);
+	n = T2Number(&ts,order);
+	if ( dropped==0 )
+    break;
+    }
+
+    /* Renumbering changed what calls cost, so the subrs may not nest as */
+    /*  they did. Work it out again as they are written */
+    bias = T2Bias(n);
+    callop = gsubrs!=NULL ? 29 : 10;
+    gvalues = malloc(chrs->next*sizeof(uint8 *));
+    glens = malloc(chrs->next*sizeof(int));
+    svalues = malloc((n+1)*sizeof(uint8 *));
+    slens = malloc((n+1)*sizeof(int));
+    glen = slen = 0;
+    for ( i=0; i<ts.scnt; ++i ) {
+	struct t2subr *sub = bylen[i];
+	if ( !sub->alive )
+    continue;
+	svalues[sub->idx] = T2Write(&ts,sub->pos,sub->pos+sub->len,sub,bias,callop,11,&slens[sub->idx]);
+	sub->nest = T2Nest(&ts,sub->len)+1;
+	slen += slens[sub->idx];
+    }
+    for ( i=0; i<chrs->next; ++i ) {
+	gvalues[i] = T2Write(&ts,tt->gstart[i],tt->gstart[i+1],NULL,bias,callop,0,&glens[i]);
+	glen += glens[i];
+    }
+
+    /* There is always a global subr INDEX. Local subrs need an entry in */
+    /*  the private dict too, if there are any */
+    oldsize = T2Size(chrs) + (gsubrs!=NULL ? T2Size(gsubrs) : 2);
+    for ( i=0; i<subrcnt; ++i )
+	if ( subrs[i]->next!=0 )
+	    oldsize += T2Size(subrs[i]) + 3;
+    newsize = T2IndexSize(chrs->next,glen) + T2IndexSize(n,slen);
+    if ( gsubrs==NULL )
+	newsize += n!=0 ? 3+2 : 0;
+    if ( newsize<oldsize ) {
+	T2Replace(chrs,chrs->next,gvalues,glens);
+	if ( gsubrs!=NULL ) {
+	    T2Replace(gsubrs,n,svalues,slens);
+	    for ( i=0; i<subrcnt; ++i )
+		T2Replace(subrs[i],0,NULL,NULL);
+	} else
+	    T2Replace(subrs[0],n,svalues,slens);
+    } else {
+	for ( i=0; i<chrs->next; ++i )
+	    free(gvalues[i]);
+	for ( i=0; i<n; ++i )
+	    free(svalues[i]);
+	free(gvalues); free(glens);
+	free(svalues); free(slens);
+    }
+
+    free(bylen);
+    free(order);
+    free(ts.cost);
+    free(ts.choice);
+    free(ts.at_start);
+    free(ts.at);
+    free(ts.subrs);
+    T2TextFree(tt);
+}
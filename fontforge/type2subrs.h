@@ -0,0 +1,16 @@
+#ifndef FONTFORGE_TYPE2SUBRS_H
+#define FONTFORGE_TYPE2SUBRS_H
+
+#include "splinefont.h"
+
+/* Rewrites the type2 charstrings in chrs so that token sequences repeated */
+/*  anywhere in them (not just at the moveto/hintmask boundaries used when */
+/*  the charstrings were made) go into subroutines. Glyph i was written to */
+/*  call the local subrs in subrs[fds[i]] (fds may be NULL if subrcnt is 1) */
+/*  and the global subrs in gsubrs (which may be NULL). The new subroutines */
+/*  replace the old: they go in gsubrs if there is one (leaving every set */
+/*  of local subrs empty), otherwise in subrs[0]. Nothing changes if the */
+/*  result would not be smaller */
+extern void Type2Subroutinize(struct pschars *chrs, struct pschars **subrs, int subrcnt, const int *fds, struct pschars *gsubrs);
+
+#endif /* FONTFORGE_TYPE2SUBRS_H */
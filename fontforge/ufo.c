@@ -35,6 +35,7 @@
 #include "gfile.h"
 #include "glif_name_hash.h"
 #include "lookups.h"
+#include "parallel.h"
 #include "splinesaveafm.h"
 #include "splineutil.h"
 #include "splineutil2.h"
@@ -55,6 +56,7 @@
 #include <time.h>
 #include <unistd.h>
 #include <assert.h>
+#include <dirent.h>
 #include <stdarg.h>
 
 #undef extended			/* used in xlink.h */
@@ -1060,20 +1062,74 @@ xmlNodePtr _GlifToXML(const SplineChar *sc, int layer, int version) {
     return topglyphxml;
 }
 
-static int GlifDump(const char *glyphdir, const char *gfname, const SplineChar *sc, int layer, int version) {
-    char *gn = buildname(glyphdir,gfname);
+/* Saving over a U. F. O. only rewrites the files whose contents change, so */
+/*  that version control (and anything else watching the directory) sees */
+/*  just the glyphs that were edited. Each glyph layer remembers a */
+/*  fingerprint of its glif as it was read from or last written to */
+/*  sf->ufo_dir. We can't go by sc->changed, too many things set it */
+/*  directly and saving clears it */
+static uint64_t UFOFingerprint(const char *gfname, const xmlChar *buf, int len) {
+    uint64_t hash;
+
+    /* The file name goes in too, it is not part of the glif */
+    hash = FingerprintAdd(FINGERPRINT_START,gfname,strlen(gfname)+1);
+    hash = FingerprintAdd(hash,buf,len);
+return( hash==0 ? 1 : hash );		/* 0 means unknown */
+}
+
+/* Same output as xmlSaveFormatFileEnc(fname,doc,"UTF-8",1) */
+static int UFOSaveXML(const char *fname, xmlDocPtr doc) {
+    xmlChar *buf = NULL;
+    int len = 0, ret;
+
+    xmlDocDumpFormatMemoryEnc(doc,&buf,&len,"UTF-8",1);
+    if ( buf==NULL )
+return( false );
+    ret = GFileWriteIfChanged(fname,buf,len)!=-1;
+    xmlFree(buf);
+return( ret );
+}
+
+static xmlChar *GlifToMemory(const SplineChar *sc, int layer, int version, int *len) {
     xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
-    if (doc == NULL) {
-        free(gn);
-        return 0;
+    xmlNodePtr root_node;
+    xmlChar *buf = NULL;
+
+    if ( doc==NULL )
+return( NULL );
+    root_node = _GlifToXML(sc, layer, version);
+    if ( root_node==NULL ) {
+	xmlFreeDoc(doc);
+return( NULL );
     }
-    xmlNodePtr root_node = _GlifToXML(sc, layer, version);
-    if (root_node == NULL) {xmlFreeDoc(doc); doc = NULL; free(gn); return 0;}
     xmlDocSetRootElement(doc, root_node);
-    int ret = (xmlSaveFormatFileEnc(gn, doc, "UTF-8", 1) != -1);
-    xmlFreeDoc(doc); doc = NULL;
+    xmlDocDumpFormatMemoryEnc(doc,&buf,len,"UTF-8",1);
+    xmlFreeDoc(doc);
+return( buf );
+}
+
+/* If since is non-zero glyphdir is in sf->ufo_dir and the layer fingerprints */
+/*  describe what was there at that time */
+static int GlifDump(const char *glyphdir, const char *gfname, SplineChar *sc, int layer, int version, long long since) {
+    char *gn;
+    int len = 0, ret = true;
+    uint64_t fingerprint;
+    struct stat st;
+    xmlChar *buf = GlifToMemory(sc,layer,version,&len);
+
+    if ( buf==NULL ) {
+	sc->layers[layer].ufo_fingerprint = 0;
+return( false );
+    }
+    fingerprint = UFOFingerprint(gfname,buf,len);
+    gn = buildname(glyphdir,gfname);
+    if ( since==0 || fingerprint!=sc->layers[layer].ufo_fingerprint ||
+	    stat(gn,&st)!=0 || st.st_mtime>=since )
+	ret = GFileWriteIfChanged(gn,buf,len)!=-1;
+    sc->layers[layer].ufo_fingerprint = ret ? fingerprint : 0;
+    xmlFree(buf);
     free(gn);
-    return ret;
+return( ret );
 }
 
 int _ExportGlif(FILE *glif,SplineChar *sc, int layer, int version) {
@@ -1173,7 +1229,7 @@ static int UFOOutputMetaInfo(const char *basedir, SplineFont *sf, int version) {
     PListAddString(dictnode,"creator","net.GitHub.FontForge");
     PListAddInteger(dictnode,"formatVersion", version);
     char *fname = buildname(basedir, "metainfo.plist"); // Build the file name.
-    xmlSaveFormatFileEnc(fname, plistdoc, "UTF-8", 1); // Store the document.
+    UFOSaveXML(fname, plistdoc); // Store the document.
     free(fname); fname = NULL;
     xmlFreeDoc(plistdoc); // Free the memory.
     xmlCleanupParser();
@@ -1445,14 +1501,14 @@ static int UFOOutputFontInfo(const char *basedir, SplineFont *sf, int layer, int
 		    if (gl->name != NULL)
 		        PListAddString(gldictnode, "name", gl->name);
                 }
-                free(gl);
+                GuidelineSetFree(gl);
                 gl = NULL;
             }
         }
     }
     // TODO: Output unrecognized data.
     char *fname = buildname(basedir, "fontinfo.plist"); // Build the file name.
-    xmlSaveFormatFileEnc(fname, plistdoc, "UTF-8", 1); // Store the document.
+    UFOSaveXML(fname, plistdoc); // Store the document.
     free(fname); fname = NULL;
     xmlFreeDoc(plistdoc); // Free the memory.
     xmlCleanupParser();
@@ -1666,7 +1722,8 @@ static int UFOOutputGroups(const char *basedir, SplineFont *sf, int version) {
     if (output_done != NULL) { free(output_done); output_done = NULL; }
 
     char *fname = buildname(basedir, "groups.plist"); // Build the file name.
-    if (has_content) xmlSaveFormatFileEnc(fname, plistdoc, "UTF-8", 1); // Store the document.
+    if (has_content) UFOSaveXML(fname, plistdoc); // Store the document.
+    else GFileUnlink(fname); // Or get rid of any old one.
     free(fname); fname = NULL;
     xmlFreeDoc(plistdoc); // Free the memory.
     xmlCleanupParser();
@@ -1703,6 +1760,9 @@ struct ufo_kerning_tree_session {
   int left_group_count;
   int class_pair_count;
   struct glif_name_index *class_pair_hash;
+  struct glif_name_index *left_hash; // From the name of each left node to its place in lefts.
+  struct ufo_kerning_tree_left **lefts;
+  int left_cnt, left_max;
 };
 
 void ufo_kerning_tree_destroy_contents(struct ufo_kerning_tree_session *session) {
@@ -1721,6 +1781,8 @@ void ufo_kerning_tree_destroy_contents(struct ufo_kerning_tree_session *session)
     free(current_left);
   }
   glif_name_index_destroy(session->class_pair_hash);
+  if (session->left_hash != NULL) glif_name_index_destroy(session->left_hash);
+  free(session->lefts);
   memset(session, 0, sizeof(struct ufo_kerning_tree_session));
 }
 
@@ -1729,11 +1791,11 @@ int ufo_kerning_tree_attempt_insert(struct ufo_kerning_tree_session *session, co
   struct ufo_kerning_tree_left *first_left = NULL;
   struct ufo_kerning_tree_left *last_left = NULL;
   if (!glif_name_search_glif_name(session->class_pair_hash, tmppairname)) {
-    struct ufo_kerning_tree_left *current_left;
+    struct ufo_kerning_tree_left *current_left = NULL;
     // We look for a tree node matching the left side of the pair.
-    for (current_left = session->first_left; current_left != NULL &&
-      (current_left->name == NULL || strcmp(current_left->name, left_name));
-      current_left = current_left->next);
+    if (session->left_hash == NULL) session->left_hash = glif_name_index_new();
+    struct glif_name *left_record = glif_name_search_glif_name(session->left_hash, left_name);
+    if (left_record != NULL) current_left = session->lefts[left_record->gid];
     // If the search fails, we make a new node.
     if (current_left == NULL) {
       current_left = calloc(1, sizeof(struct ufo_kerning_tree_left));
@@ -1741,6 +1803,10 @@ int ufo_kerning_tree_attempt_insert(struct ufo_kerning_tree_session *session, co
       if (session->last_left != NULL) session->last_left->next = current_left;
       else session->first_left = current_left;
       session->last_left = current_left;
+      if (session->left_cnt >= session->left_max)
+        session->lefts = realloc(session->lefts, (session->left_max = 2 * session->left_max + 64) * sizeof(struct ufo_kerning_tree_left *));
+      glif_name_track_new(session->left_hash, session->left_cnt, left_name);
+      session->lefts[session->left_cnt++] = current_left;
     }
     {
       // We already know from the pair hash search that this pair does not exist.
@@ -1751,9 +1817,7 @@ int ufo_kerning_tree_attempt_insert(struct ufo_kerning_tree_session *session, co
       if (current_left->last_right != NULL) current_left->last_right->next = current_right;
       else current_left->first_right = current_right;
       current_left->last_right = current_right;
-      char *newpairname = smprintf("%s %s", left_name, right_name);
-      glif_name_track_new(session->class_pair_hash, session->class_pair_count++, newpairname);
-      free(newpairname); newpairname = NULL;
+      glif_name_track_new(session->class_pair_hash, session->class_pair_count++, tmppairname);
     }
   }
   free(tmppairname); tmppairname = NULL;
@@ -1765,7 +1829,12 @@ static int UFOOutputKerning2(const char *basedir, SplineFont *sf, int isv, int v
     int i, j;
     int has_content = 0;
 
-    if (!(sf->preferred_kerning & 1)) return true; // This goes into the feature file by default now.
+    if (!(sf->preferred_kerning & 1)) { // This goes into the feature file by default now.
+      char *fname = buildname(basedir, (isv ? "vkerning.plist" : "kerning.plist"));
+      GFileUnlink(fname); // So get rid of any old one.
+      free(fname);
+      return true;
+    }
 
     xmlDocPtr plistdoc = PlistInit(); if (plistdoc == NULL) return false; // Make the document.
     xmlNodePtr rootnode = xmlDocGetRootElement(plistdoc); if (rootnode == NULL) { xmlFreeDoc(plistdoc); return false; } // Find the root node.
@@ -1796,6 +1865,7 @@ static int UFOOutputKerning2(const char *basedir, SplineFont *sf, int isv, int v
 
     // We process the raw kerning list first in order to give preference to the original ordering.
     struct ff_rawoffsets *current_groupkern;
+    struct kernpairindex *kern_index = NULL;
     for (current_groupkern = (isv ? sf->groupvkerns : sf->groupkerns); current_groupkern != NULL; current_groupkern = current_groupkern->next) {
       if (current_groupkern->left != NULL && current_groupkern->right != NULL) {
         int left_grouptype = GroupNameType(current_groupkern->left);
@@ -1832,9 +1902,9 @@ static int UFOOutputKerning2(const char *basedir, SplineFont *sf, int isv, int v
           struct splinechar *sc = SFGetChar(sf, -1, current_groupkern->left);
           struct splinechar *ssc = SFGetChar(sf, -1, current_groupkern->right);
           if (sc && ssc) {
-            struct kernpair *current_kernpair = (isv ? sc->vkerns : sc->kerns);
-            while (current_kernpair != NULL && current_kernpair->sc != ssc) current_kernpair = current_kernpair->next;
-            if (current_kernpair != NULL && current_kernpair->sc == ssc) {
+            if (kern_index == NULL) kern_index = KernPairIndexNew(sf, isv);
+            struct kernpair *current_kernpair = KernPairIndexFind(kern_index, sc, ssc);
+            if (current_kernpair != NULL) {
               offset = current_kernpair->off;
               valid = 1;
             }
@@ -1912,12 +1982,14 @@ static int UFOOutputKerning2(const char *basedir, SplineFont *sf, int isv, int v
     }
 
     glif_name_index_destroy(class_name_hash); // Close the hash table.
+    KernPairIndexFree(kern_index);
     ufo_kerning_tree_destroy_contents(session);
 
     if (output_done != NULL) { free(output_done); output_done = NULL; }
 
     char *fname = buildname(basedir, (isv ? "vkerning.plist" : "kerning.plist")); // Build the file name.
-    if (has_content) xmlSaveFormatFileEnc(fname, plistdoc, "UTF-8", 1); // Store the document.
+    if (has_content) UFOSaveXML(fname, plistdoc); // Store the document.
+    else GFileUnlink(fname); // Or get rid of any old one.
     free(fname); fname = NULL;
     xmlFreeDoc(plistdoc); // Free the memory.
     xmlCleanupParser();
@@ -1926,7 +1998,12 @@ static int UFOOutputKerning2(const char *basedir, SplineFont *sf, int isv, int v
 
 static int UFOOutputLib(const char *basedir, const SplineFont *sf, int version) {
 #ifndef _NO_PYTHON
-    if ( sf->python_persistent==NULL || PyMapping_Check(sf->python_persistent) == 0) return true;
+    if ( sf->python_persistent==NULL || PyMapping_Check(sf->python_persistent) == 0) {
+      char *fname = buildname(basedir, "lib.plist");
+      GFileUnlink(fname); // Get rid of any old one.
+      free(fname);
+      return true;
+    }
 
     xmlDocPtr plistdoc = PlistInit(); if (plistdoc == NULL) return false; // Make the document.
     xmlNodePtr rootnode = xmlDocGetRootElement(plistdoc); if (rootnode == NULL) return false; // Find the root node.
@@ -1935,7 +2012,7 @@ static int UFOOutputLib(const char *basedir, const SplineFont *sf, int version)
     xmlAddChild(rootnode, dictnode);
 
     char *fname = buildname(basedir, "lib.plist"); // Build the file name.
-    xmlSaveFormatFileEnc(fname, plistdoc, "UTF-8", 1); // Store the document.
+    UFOSaveXML(fname, plistdoc); // Store the document.
     free(fname); fname = NULL;
     xmlFreeDoc(plistdoc); // Free the memory.
     xmlCleanupParser();
@@ -1944,20 +2021,69 @@ return( true );
 }
 
 static int UFOOutputFeatures(const char *basedir, SplineFont *sf, int version) {
-    char *fname = buildname(basedir,"features.fea");
-    FILE *feats = fopen( fname, "w" );
-    int err;
+    FILE *feats = GFileMemTmpfile();
+    char *fname, *buf;
+    long len;
+    int ret;
 
-    free(fname);
     if ( feats==NULL )
 return( false );
     FeatDumpFontLookups(feats,sf);
-    err = ferror(feats);
+    len = ftell(feats);
+    rewind(feats);
+    buf = malloc(len+1);
+    ret = !ferror(feats) && len>=0 && fread(buf,1,len,feats)==(size_t) len;
     fclose(feats);
-return( !err );
+    if ( ret ) {
+	fname = buildname(basedir,"features.fea");
+	ret = GFileWriteIfChanged(fname,buf,len)!=-1;
+	free(fname);
+    }
+    free(buf);
+return( ret );
+}
+
+/* Removes everything in dir whose name is not in keep */
+static void UFORemoveOthers(const char *dir, struct glif_name_index *keep) {
+    DIR *d;
+    struct dirent *ent;
+    char *name;
+
+    if ( (d = opendir(dir))==NULL )
+return;
+    while ( (ent = readdir(d))!=NULL ) {
+	if ( strcmp(ent->d_name,".")==0 || strcmp(ent->d_name,"..")==0 ||
+		glif_name_search_glif_name(keep,ent->d_name)!=NULL )
+    continue;
+	name = buildname(dir,ent->d_name);
+	GFileRemove(name,true);
+	free(name);
+    }
+    closedir(d);
+}
+
+static int UFOLayerHasGlyph(SplineChar *sc, int layer) {
+return( SCLWorthOutputtingOrHasData(sc, layer) ||
+	( layer == ly_fore && (SCWorthOutputting(sc) || SCHasData(sc) || (sc != NULL && sc->glif_name != NULL)) ) );
+}
+
+static void UFOForgetFingerprints(SplineFont *sf) {
+    int i, layer;
+
+    for ( i=0; i<sf->glyphcnt; ++i ) if ( sf->glyphs[i]!=NULL )
+	for ( layer=0; layer<sf->glyphs[i]->layer_cnt; ++layer )
+	    sf->glyphs[i]->layers[layer].ufo_fingerprint = 0;
 }
 
-int WriteUFOLayer(const char * glyphdir, SplineFont * sf, int layer, int version) {
+/* Called once a font has been read from basedir, whose glif fingerprints */
+/*  were taken as they were read (see UFOLoadGlyph) */
+static void UFONoteDir(SplineFont *sf, const char *basedir, long long started) {
+    free(sf->ufo_dir);
+    sf->ufo_dir = GFileMakeAbsoluteName((char *) basedir);
+    sf->ufo_time = started;
+}
+
+int WriteUFOLayer(const char * glyphdir, SplineFont * sf, int layer, int version, long long since) {
     xmlDocPtr plistdoc = PlistInit(); if (plistdoc == NULL) return false; // Make the document.
     xmlNodePtr rootnode = xmlDocGetRootElement(plistdoc); if (rootnode == NULL) { xmlFreeDoc(plistdoc); return false; } // Find the root node.
     xmlNodePtr dictnode = xmlNewChild(rootnode, NULL, BAD_CAST "dict", NULL); if (dictnode == NULL) { xmlFreeDoc(plistdoc); return false; } // Make the dict.
@@ -1966,14 +2092,15 @@ int WriteUFOLayer(const char * glyphdir, SplineFont * sf, int layer, int version
     int i;
     SplineChar * sc;
     int err = 0;
-    for ( i=0; i<sf->glyphcnt; ++i ) if ( SCLWorthOutputtingOrHasData(sc=sf->glyphs[i], layer) ||
-      ( layer == ly_fore && (SCWorthOutputting(sc) || SCHasData(sc) || (sc != NULL && sc->glif_name != NULL)) ) ) {
-        // TODO: Optionally skip rewriting an untouched glyph.
-        // Do we track modified glyphs carefully enough for this?
+    // Only glyphs whose glif has changed get rewritten (see GlifDump), and the files of any no longer here are removed.
+    struct glif_name_index * written = glif_name_index_new();
+    glif_name_track_new(written, -1, "contents.plist");
+    for ( i=0; i<sf->glyphcnt; ++i ) if ( UFOLayerHasGlyph(sc=sf->glyphs[i], layer) ) {
         char * final_name = smprintf("%s%s%s", "", sc->glif_name, ".glif");
         if (final_name != NULL) { // Generate the final name with prefix and suffix.
 		PListAddString(dictnode,sc->name,final_name); // Add the glyph to the table of contents.
-		err |= !GlifDump(glyphdir,final_name,sc,layer,version);
+		err |= !GlifDump(glyphdir,final_name,sc,layer,version,since);
+		glif_name_track_new(written, i, final_name);
         	free(final_name); final_name = NULL;
 	} else {
 		err |= 1;
@@ -1981,8 +2108,10 @@ int WriteUFOLayer(const char * glyphdir, SplineFont * sf, int layer, int version
     }
 
     char *fname = buildname(glyphdir, "contents.plist"); // Build the file name for the contents.
-    xmlSaveFormatFileEnc(fname, plistdoc, "UTF-8", 1); // Store the document.
+    UFOSaveXML(fname, plistdoc); // Store the document.
     free(fname); fname = NULL;
+    UFORemoveOthers(glyphdir, written);
+    glif_name_index_destroy(written);
     xmlFreeDoc(plistdoc); // Free the memory.
     xmlCleanupParser();
     if (err) {
@@ -1999,13 +2128,25 @@ int WriteUFOFontFlex(const char *basedir, SplineFont *sf, enum fontformat ff, in
     int i;
     SplineChar *sc;
 
-    /* Clean it out, if it exists */
-    if (!GFileRemove(basedir, true)) {
+    long long since = 0, started = time(NULL);
+    char *absdir;
+
+    /* Anything but a directory in the way has to go */
+    if (GFileExists(basedir) && !GFileIsDir(basedir) && !GFileRemove(basedir, true)) {
         LogError(_("Error clearing %s."), basedir);
     }
 
-    /* Create it */
-    if (GFileMkDir( basedir, 0755 ) == -1) return false;
+    /* Create it, if need be. What is already there gets updated in place */
+    if (GFileMkDir( basedir, 0755 ) == -1 && !GFileIsDir(basedir)) return false;
+
+    absdir = GFileMakeAbsoluteName((char *) basedir);
+    if (sf->ufo_dir != NULL && strcmp(sf->ufo_dir, absdir) == 0)
+        since = sf->ufo_time;
+    else
+        UFOForgetFingerprints(sf);
+    free(sf->ufo_dir);
+    sf->ufo_dir = absdir;
+    sf->ufo_time = started;
 
     locale_t tmplocale; locale_t oldlocale; // Declare temporary locale storage.
     switch_to_c_locale(&tmplocale, &oldlocale); // Switch to the C locale temporarily and cache the old locale.
@@ -2052,6 +2193,15 @@ int WriteUFOFontFlex(const char *basedir, SplineFont *sf, enum fontformat ff, in
     
     struct glif_name_index * layer_name_hash = glif_name_index_new(); // Open the hash table.
     struct glif_name_index * layer_path_hash = glif_name_index_new(); // Open the hash table.
+    struct glif_name_index * written = glif_name_index_new(); // What belongs in basedir once we are done.
+    static const char * const topfiles[] = { "metainfo.plist", "fontinfo.plist", "groups.plist",
+      "kerning.plist", "vkerning.plist", "features.fea", "layercontents.plist",
+#ifndef _NO_PYTHON
+      "lib.plist",
+#endif
+      NULL };
+    for (i = 0; topfiles[i] != NULL; i++)
+      glif_name_track_new(written, -1, topfiles[i]);
 
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
     xmlDocPtr plistdoc = PlistInit(); if (plistdoc == NULL) return false; // Make the document.
@@ -2097,7 +2247,8 @@ int WriteUFOFontFlex(const char *basedir, SplineFont *sf, enum fontformat ff, in
         xmlNewTextChild(layernode, NULL, BAD_CAST "string", numberedlayerpathwithglyphs);
         glyphdir = buildname(basedir, numberedlayerpathwithglyphs);
         // We write the glyph directory.
-        err |= WriteUFOLayer(glyphdir, sf, layer_pos, version);
+        err |= WriteUFOLayer(glyphdir, sf, layer_pos, version, since);
+        glif_name_track_new(written, layer_pos, numberedlayerpathwithglyphs);
       }
       free(numberedlayername); numberedlayername = NULL;
       free(numberedlayerpath); numberedlayerpath = NULL;
@@ -2106,12 +2257,16 @@ int WriteUFOFontFlex(const char *basedir, SplineFont *sf, enum fontformat ff, in
     }
     char *fname = buildname(basedir, "layercontents.plist"); // Build the file name for the contents.
     if (version >= 3)
-      xmlSaveFormatFileEnc(fname, plistdoc, "UTF-8", 1); // Store the document.
+      UFOSaveXML(fname, plistdoc); // Store the document.
+    else
+      GFileUnlink(fname);
     free(fname); fname = NULL;
     xmlFreeDoc(plistdoc); // Free the memory.
     xmlCleanupParser();
     glif_name_index_destroy(layer_name_hash); // Close the hash table.
     glif_name_index_destroy(layer_path_hash); // Close the hash table.
+    UFORemoveOthers(basedir, written); // Old layers, and anything else we didn't write.
+    glif_name_index_destroy(written);
 
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
     return !err;
@@ -2389,29 +2544,50 @@ static StemInfo *GlifParseHints(xmlDocPtr doc,xmlNodePtr dict,char *hinttype) {
 return( head );
 }
 
-static AnchorPoint *UFOLoadAnchor(SplineFont *sf, SplineChar *sc, xmlNodePtr xmlAnchor, AnchorPoint **lastap) {
+/* Glyphs may be read on several threads (see UFOLoadGlyphs), and they must */
+/*  not touch the font then. So anchors point at placeholder classes, which */
+/*  hold just the name, and everything which needs the font is put off until */
+/*  the glyph is merged into it (UFOGlyphDeferFixup) */
+struct ufoglyphdefer {
+    AnchorClass *anchors;	/* Placeholder classes, chained through next */
+#ifndef _NO_PYTHON
+    xmlDocPtr doc;		/* Kept for lib, which needs python */
+    xmlNodePtr lib;
+#endif
+};
+
+static void UFOSetAnchorClass(SplineFont *sf, AnchorPoint *ap, char *sname) {
+    AnchorClass *ac = SFFindOrAddAnchorClass(sf,*sname=='_' ? sname + 1 : sname,NULL);
+    if (*sname=='_')
+        ap->type = ac->type==act_curs ? at_centry : at_mark;
+    else
+        ap->type = ac->type==act_mkmk   ? at_basemark :
+                    ac->type==act_curs  ? at_cexit :
+                    ac->type==act_mklg  ? at_baselig :
+                                          at_basechar;
+    ap->anchor = ac;
+}
+
+static AnchorPoint *UFOLoadAnchor(SplineFont *sf, SplineChar *sc, xmlNodePtr xmlAnchor, AnchorPoint **lastap, struct ufoglyphdefer *defer) {
         xmlNodePtr points = xmlAnchor;
         char *sname = (char *) xmlGetProp(points, (xmlChar *) "name");
         if ( sname!=NULL) {
 
             /* make an AP and if necessary an AC */
             AnchorPoint *ap = chunkalloc(sizeof(AnchorPoint));
-            AnchorClass *ac;
-            char *namep = *sname=='_' ? sname + 1 : sname;
             char *xs = (char *) xmlGetProp(points, (xmlChar *) "x");
             char *ys = (char *) xmlGetProp(points, (xmlChar *) "y");
             if (xs) { ap->me.x = strtod(xs,NULL); free(xs); }
             if (ys) { ap->me.y = strtod(ys,NULL); free(ys); }
 
-            ac = SFFindOrAddAnchorClass(sf,namep,NULL);
-            if (*sname=='_')
-                ap->type = ac->type==act_curs ? at_centry : at_mark;
-            else
-                ap->type = ac->type==act_mkmk   ? at_basemark :
-                            ac->type==act_curs  ? at_cexit :
-                            ac->type==act_mklg  ? at_baselig :
-                                                  at_basechar;
-            ap->anchor = ac;
+            if ( defer!=NULL ) {
+                AnchorClass *ac = chunkalloc(sizeof(AnchorClass));
+                ac->name = copy(sname);
+                ac->next = defer->anchors;
+                defer->anchors = ac;
+                ap->anchor = ac;
+            } else
+                UFOSetAnchorClass(sf,ap,sname);
 	    if ( *lastap==NULL ) {
 			// If there are no existing anchors, we point the main spline reference to this one.
 			sc->anchor = ap;
@@ -2625,7 +2801,7 @@ static void UFOLoadGuidelines(SplineFont *sf, SplineChar *sc, int layer, xmlDocP
 	}
 }
 
-static SplineChar *_UFOLoadGlyph(SplineFont *sf, xmlDocPtr doc, char *glifname, char* glyphname, SplineChar* existingglyph, int layerdest) {
+static SplineChar *_UFOLoadGlyph(SplineFont *sf, xmlDocPtr doc, char *glifname, char* glyphname, SplineChar* existingglyph, int layerdest, struct ufoglyphdefer *defer) {
     xmlNodePtr glyph, kids, contour, points;
     SplineChar *sc;
     xmlChar *format, *width, *height, *u;
@@ -2743,7 +2919,7 @@ static SplineChar *_UFOLoadGlyph(SplineFont *sf, xmlDocPtr doc, char *glifname,
 			tval = NULL;
 		}
 	} else if ( xmlStrcmp(kids->name,(const xmlChar *) "anchor")==0 ){
-		if (UFOLoadAnchor(sf, sc, kids, &lastap))
+		if (UFOLoadAnchor(sf, sc, kids, &lastap, defer))
 			continue;
 	} else if ( xmlStrcmp(kids->name,(const xmlChar *) "guideline")==0 ){
 		if (UFOLoadGuideline(sf, sc, layerdest, doc, kids, &lastgl, NULL))
@@ -2804,7 +2980,7 @@ static SplineChar *_UFOLoadGlyph(SplineFont *sf, xmlDocPtr doc, char *glifname,
             break;
 			// If the contour has a single point without another point after it, we assume it to be an anchor point.
             if ( points!=NULL && npoints==NULL ) {
-              if (UFOLoadAnchor(sf, sc, points, &lastap))
+              if (UFOLoadAnchor(sf, sc, points, &lastap, defer))
                 continue; // We stop processing the contour at this point.
             }
 
@@ -3069,7 +3245,9 @@ static SplineChar *_UFOLoadGlyph(SplineFont *sf, xmlDocPtr doc, char *glifname,
 		    }
 		}
 #ifndef _NO_PYTHON
-		if (sc->layers[layerdest].python_persistent == NULL) {
+		if (defer != NULL && defer->lib == NULL) {
+		  defer->lib = dict;
+		} else if (defer == NULL && sc->layers[layerdest].python_persistent == NULL) {
 		  sc->layers[layerdest].python_persistent = LibToPython(doc,dict,1);
 		  sc->layers[layerdest].python_persistent_has_lists = 1;
 		} else LogError(_("Duplicate lib data.\n"));
@@ -3077,20 +3255,70 @@ static SplineChar *_UFOLoadGlyph(SplineFont *sf, xmlDocPtr doc, char *glifname,
 	    }
 	}
     }
+#ifndef _NO_PYTHON
+    if (defer != NULL && defer->lib != NULL)
+	defer->doc = doc;
+    else
+#endif
     xmlFreeDoc(doc);
     _SPLCategorizePoints(sc->layers[layerdest].splines, pconvert_flag_smooth|pconvert_flag_by_geom);
 return( sc );
 }
 
-static SplineChar *UFOLoadGlyph(SplineFont *sf,char *glifname, char* glyphname, SplineChar* existingglyph, int layerdest) {
-    xmlDocPtr doc;
-
-    doc = xmlParseFile(glifname);
+/* The layer is given the fingerprint of the file as it was read (see */
+/*  GlifDump), so saving back over it can leave it alone */
+static SplineChar *UFOLoadGlyph(SplineFont *sf,char *glifname, char* glyphname, SplineChar* existingglyph, int layerdest, struct ufoglyphdefer *defer) {
+    xmlDocPtr doc = NULL;
+    SplineChar *sc;
+    char *buf, *pt;
+    uint64_t fingerprint = 0;
+
+    if ( (buf = GFileReadAll(glifname))!=NULL ) {
+	doc = xmlParseMemory(buf,strlen(buf));
+	pt = strrchr(glifname,'/');
+	fingerprint = UFOFingerprint(pt==NULL ? glifname : pt+1,(xmlChar *) buf,strlen(buf));
+	free(buf);
+    }
     if ( doc==NULL ) {
 	LogError(_("Bad glif file %s"), glifname);
 return( NULL );
     }
-return( _UFOLoadGlyph(sf,doc,glifname,glyphname,existingglyph,layerdest));
+    sc = _UFOLoadGlyph(sf,doc,glifname,glyphname,existingglyph,layerdest,defer);
+    if ( sc!=NULL )
+	sc->layers[layerdest].ufo_fingerprint = fingerprint;
+return( sc );
+}
+
+/* Does what _UFOLoadGlyph put off because it needed the font (or python) */
+static void UFOGlyphDeferFixup(SplineFont *sf, SplineChar *sc, int layerdest, struct ufoglyphdefer *defer) {
+    AnchorPoint *ap;
+    AnchorClass *ac, *next;
+
+    if ( sc!=NULL ) {
+	for ( ap=sc->anchor; ap!=NULL; ap=ap->next ) {
+	    for ( ac=defer->anchors; ac!=NULL && ac!=ap->anchor; ac=ac->next );
+	    if ( ac!=NULL )
+		UFOSetAnchorClass(sf,ap,ac->name);
+	}
+    }
+    for ( ac=defer->anchors; ac!=NULL; ac=next ) {
+	next = ac->next;
+	free(ac->name);
+	chunkfree(ac,sizeof(AnchorClass));
+    }
+    defer->anchors = NULL;
+#ifndef _NO_PYTHON
+    if ( defer->doc!=NULL ) {
+	if ( sc!=NULL && sc->layers[layerdest].python_persistent==NULL ) {
+	    sc->layers[layerdest].python_persistent = LibToPython(defer->doc,defer->lib,1);
+	    sc->layers[layerdest].python_persistent_has_lists = 1;
+	} else if ( sc!=NULL )
+	    LogError(_("Duplicate lib data.\n"));
+	xmlFreeDoc(defer->doc);
+	defer->doc = NULL;
+	defer->lib = NULL;
+    }
+#endif
 }
 
 
@@ -3141,14 +3369,56 @@ static void UFORefFixup(SplineFont *sf, SplineChar *sc, int layer ) {
     }
 }
 
+/* With more than one thread, glyphs are read a chunk at a time: the glif */
+/*  files in a chunk are parsed on as many threads as we are allowed, then */
+/*  merged into the font in contents.plist order. Chunks keep down the */
+/*  number of glyphs (and parsed documents for python lib data) waiting to */
+/*  be merged. With one thread each glyph goes straight into the font */
+#define UFO_LOAD_CHUNK	64
+
+struct ufoglyphload {
+    char *glyphname, *valname, *glifname;
+    SplineChar *existingglyph, *sc;
+    int serial;			/* Name seen before, so load it while merging */
+    struct ufoglyphdefer defer;
+};
+
+struct ufoglyphloads {
+    SplineFont *sf;
+    struct ufoglyphload *loads;
+    int layerdest;
+};
+
+static void UFOLoadGlyphWork(int i, void *data) {
+    struct ufoglyphloads *ugl = data;
+    struct ufoglyphload *load = &ugl->loads[i];
+#ifndef BAD_LOCALE_HACK
+    locale_t tmplocale; locale_t oldlocale;
+#endif
+
+    if ( load->serial )
+return;
+#ifndef BAD_LOCALE_HACK
+    /* Each thread has its own locale (the global one is set by the caller) */
+    switch_to_c_locale(&tmplocale, &oldlocale);
+#endif
+    load->sc = UFOLoadGlyph(ugl->sf, load->glifname, load->glyphname, load->existingglyph, ugl->layerdest, &load->defer);
+#ifndef BAD_LOCALE_HACK
+    switch_to_old_locale(&tmplocale, &oldlocale);
+#endif
+}
+
 static void UFOLoadGlyphs(SplineFont *sf,char *glyphdir, int layerdest) {
     char *glyphlist = buildname(glyphdir,"contents.plist");
     xmlDocPtr doc;
     xmlNodePtr plist, dict, keys, value;
-    char *valname, *glyphfname;
-    int i;
+    char *valname;
+    int i, j, end, cnt, parallel;
     SplineChar *sc;
     int tot;
+    struct ufoglyphload *loads, *load;
+    struct ufoglyphloads ugl;
+    struct glif_name_index *names;
 
     doc = xmlParseFile(glyphlist);
     free(glyphlist);
@@ -3163,49 +3433,86 @@ return;
 	xmlFreeDoc(doc);
 return;
     }
-	// Count glyphs for the benefit of measuring progress.
+	// Count glyphs for the benefit of measuring progress, and so the glyph array need only grow once.
     for ( tot=0, keys=dict->children; keys!=NULL; keys=keys->next ) {
 		if ( xmlStrcmp(keys->name,(const xmlChar *) "key")==0 )
 		    ++tot;
     }
     ff_progress_change_total(tot);
+    if ( sf->glyphcnt+tot>sf->glyphmax )
+	sf->glyphs = realloc(sf->glyphs,(sf->glyphmax = sf->glyphcnt+tot)*sizeof(SplineChar *));
 	// Start reading in glyph name to file name mappings.
-    for ( keys=dict->children; keys!=NULL; keys=keys->next ) {
+    loads = calloc(tot+1,sizeof(struct ufoglyphload));
+    names = glif_name_index_new();
+    for ( cnt=0, keys=dict->children; keys!=NULL; keys=keys->next ) {
 		for ( value = keys->next; value!=NULL && xmlStrcmp(value->name,(const xmlChar *) "text")==0;
 			value = value->next );
 		if ( value==NULL )
 			break;
 		if ( xmlStrcmp(keys->name,(const xmlChar *) "key")==0 ) {
 			char * glyphname = (char *) xmlNodeListGetString(doc,keys->children,true);
-			int newsc = 0;
-			SplineChar* existingglyph = NULL;
 			if (glyphname != NULL) {
-				existingglyph = SFGetChar(sf,-1,glyphname);
-				if (existingglyph == NULL) newsc = 1;
-				valname = (char *) xmlNodeListGetString(doc,value->children,true);
-				glyphfname = buildname(glyphdir,valname);
-				sc = UFOLoadGlyph(sf, glyphfname, glyphname, existingglyph, layerdest);
-				// We want to stash the glif name (minus the extension) for future use.
-				if (sc != NULL && sc->glif_name == NULL && valname != NULL) {
-				  char * tmppos = strrchr(valname, '.'); if (tmppos) *tmppos = '\0';
-				  sc->glif_name = copy(valname);
-				  if (tmppos) *tmppos = '.';
-				}
-				free(valname);
-				if ( ( sc!=NULL ) && newsc ) {
-					sc->parent = sf;
-					if ( sf->glyphcnt>=sf->glyphmax )
-						sf->glyphs = realloc(sf->glyphs,(sf->glyphmax+=100)*sizeof(SplineChar *));
-					sc->orig_pos = sf->glyphcnt;
-					sf->glyphs[sf->glyphcnt++] = sc;
-				}
-			}
+				load = &loads[cnt];
+				load->glyphname = glyphname;
+				load->valname = (char *) xmlNodeListGetString(doc,value->children,true);
+				load->glifname = buildname(glyphdir,load->valname);
+				// A glyph named twice must wait for the first to be merged before it can be found.
+				if ( glif_name_search_glif_name(names,glyphname)!=NULL )
+					load->serial = true;
+				else
+					glif_name_track_new(names,cnt,glyphname);
+				++cnt;
+			} else
+				ff_progress_next();
 			keys = value;
-			ff_progress_next();
 		}
     }
+    glif_name_index_destroy(names);
     xmlFreeDoc(doc);
 
+    ugl.sf = sf;
+    ugl.layerdest = layerdest;
+    parallel = ParallelJobCount(cnt)>1;
+    for ( i=0; i<cnt; i=end ) {
+	end = !parallel ? cnt : i+UFO_LOAD_CHUNK<cnt ? i+UFO_LOAD_CHUNK : cnt;
+	if ( parallel ) {
+	    for ( j=i; j<end; ++j )
+		if ( !loads[j].serial )
+		    loads[j].existingglyph = SFGetChar(sf,-1,loads[j].glyphname);
+	    ugl.loads = loads+i;
+	    ParallelFor(end-i,UFOLoadGlyphWork,&ugl,false);
+	}
+	for ( j=i; j<end; ++j ) {
+	    load = &loads[j];
+	    if ( load->serial || !parallel ) {
+		load->existingglyph = SFGetChar(sf,-1,load->glyphname);
+		sc = UFOLoadGlyph(sf, load->glifname, load->glyphname, load->existingglyph, layerdest, NULL);
+	    } else {
+		sc = load->sc;
+		UFOGlyphDeferFixup(sf, sc, layerdest, &load->defer);
+	    }
+	    valname = load->valname;
+	    // We want to stash the glif name (minus the extension) for future use.
+	    if (sc != NULL && sc->glif_name == NULL && valname != NULL) {
+	      char * tmppos = strrchr(valname, '.'); if (tmppos) *tmppos = '\0';
+	      sc->glif_name = copy(valname);
+	      if (tmppos) *tmppos = '.';
+	    }
+	    if ( ( sc!=NULL ) && load->existingglyph==NULL ) {
+		sc->parent = sf;
+		if ( sf->glyphcnt>=sf->glyphmax )
+		    sf->glyphs = realloc(sf->glyphs,(sf->glyphmax+=100)*sizeof(SplineChar *));
+		sc->orig_pos = sf->glyphcnt;
+		sf->glyphs[sf->glyphcnt++] = sc;
+	    }
+	    free(load->glyphname);
+	    free(load->valname);
+	    free(load->glifname);
+	    ff_progress_next();
+	}
+    }
+    free(loads);
+
     GlyphHashFree(sf);
     for ( i=0; i<sf->glyphcnt; ++i )
 	UFORefFixup(sf,sf->glyphs[i], layerdest);
@@ -3585,6 +3892,7 @@ static void UFOHandleKern(SplineFont *sf,char *basedir,int isv) {
     int offset;
     SplineChar *sc, *ssc;
     KernPair *kp;
+    struct kernpairindex *kern_index;
     char *end;
     uint32 script;
 
@@ -3604,6 +3912,7 @@ return;
 	xmlFreeDoc(doc);
 return;
     }
+    kern_index = KernPairIndexNew(sf,isv);
     for ( keys=dict->children; keys!=NULL; keys=keys->next ) {
 	for ( value = keys->next; value!=NULL && xmlStrcmp(value->name,(const xmlChar *) "text")==0;
 		value = value->next );
@@ -3627,7 +3936,7 @@ return;
 		    free(keyname);
 		    if ( ssc==NULL )
 		continue;
-		    for ( kp=isv?sc->vkerns:sc->kerns; kp!=NULL && kp->sc!=ssc; kp=kp->next );
+		    kp = KernPairIndexFind(kern_index,sc,ssc);
 		    if ( kp!=NULL )
 		continue;
 		    subkeys = value;
@@ -3655,12 +3964,14 @@ return;
 			kp->subtable = SFSubTableFindOrMake(sf,
 				isv?CHR('v','k','r','n'):CHR('k','e','r','n'),
 				script, gpos_pair);
+			KernPairIndexAdd(kern_index,sc,kp);
 		    }
 		    free(valname);
 		}
 	    }
 	}
     }
+    KernPairIndexFree(kern_index);
     xmlFreeDoc(doc);
 }
 
@@ -3693,7 +4004,8 @@ static void UFOHandleKern3(SplineFont *sf,char *basedir,int isv) {
     char *keyname, *valname;
     int offset;
     SplineChar *sc, *ssc;
-    KernPair *kp;
+    KernPair *kp, *lastkp;
+    struct kernpairindex *kern_index;
     char *end;
     uint32 script;
 
@@ -3730,6 +4042,8 @@ return;
     int current_groupkern_index = 0;
     // We want to start at the end of the list of kerns already in the SplineFont (probably not any right now).
     for (current_groupkern = (isv ? sf->groupvkerns : sf->groupkerns); current_groupkern != NULL && current_groupkern->next != NULL; current_groupkern = current_groupkern->next);
+    // And an index of the kerning pairs, so that a glyph with thousands of them does not make this quadratic.
+    kern_index = KernPairIndexNew(sf, isv);
 
     // Read the left node. Set sc if it matches a character or isgroup and the associated values if it matches a group.
     // Read the right node. Set ssc if it matches a character or isgroup and the associated values if it matches a group.
@@ -3748,6 +4062,10 @@ return;
             struct glif_name *left_class_name_record = glif_name_search_glif_name(class_name_hash, keyname);
 	    free(keyname);
             if (sc == NULL && left_class_name_record == NULL) { LogError(_("kerning.plist references an entity that is neither a glyph nor a group.")); continue; }
+            // New pairs go on the end of the glyph's list.
+            lastkp = NULL;
+            if (sc != NULL)
+              for (lastkp = (isv ? sc->vkerns : sc->kerns); lastkp != NULL && lastkp->next != NULL; lastkp = lastkp->next);
 	    keys = value; // Set the offset for the next round.
             // This key represents the left/above side of the pair. The child keys represent its right/below complements.
 	    for ( subkeys = value->children; subkeys!=NULL; subkeys = subkeys->next ) {
@@ -3772,8 +4090,7 @@ return;
 		    if (ssc == NULL && right_class_name_record == NULL) { LogError(_("kerning.plist references an entity that is neither a glyph nor a group.")); continue; }
 
 		  if (sc && ssc) {
-		    KernPair *lastkp = NULL;
-		    for ( kp=(isv?sc->vkerns:sc->kerns); kp!=NULL && kp->sc!=ssc; lastkp = kp, kp=kp->next );
+		    kp = KernPairIndexFind(kern_index, sc, ssc);
 		    if ( kp!=NULL ) { LogError(_("kerning.plist defines kerning between two glyphs that are already kerned.")); continue; }
 		    // We do not want to add the virtual entry until we have confirmed the possibility of adding the real entry as precedes this.
 		    if (!TryAddRawGroupKern(sf, isv, class_name_pair_hash, &current_groupkern_index, &current_groupkern, sc->name, ssc->name, offset)) {
@@ -3807,6 +4124,7 @@ return;
 			kp->subtable = SFSubTableFindOrMake(sf,
 				isv?CHR('v','k','r','n'):CHR('k','e','r','n'),
 				script, gpos_pair);
+			KernPairIndexAdd(kern_index, sc, kp);
 		    }
 		  } else if (sc && right_class_name_record) {
 		    if (!TryAddRawGroupKern(sf, isv, class_name_pair_hash, &current_groupkern_index, &current_groupkern, sc->name, right_class_name_record->glif_name, offset)) {
@@ -3839,6 +4157,7 @@ return;
     glif_name_index_destroy(group_name_hash);
     glif_name_index_destroy(class_name_hash);
     glif_name_index_destroy(class_name_pair_hash);
+    KernPairIndexFree(kern_index);
     xmlFreeDoc(doc);
 }
 
@@ -3861,7 +4180,7 @@ static void UFOAddPrivate(SplineFont *sf,char *key,char *value) {
     char *pt;
 
     if ( sf->private==NULL )
-	sf->private = chunkalloc(sizeof(struct psdict));
+	sf->private = calloc(1,sizeof(struct psdict));
     for ( pt=value; *pt!='\0'; ++pt ) {	/* Value might contain white space. turn into spaces */
 	if ( *pt=='\n' || *pt=='\r' || *pt=='\t' )
 	    *pt = ' ';
@@ -3960,6 +4279,7 @@ SplineFont *SFReadUFO(char *basedir, int flags) {
     char *temp, *glyphlist, *glyphdir;
     char *end;
     int as = -1, ds= -1, em= -1;
+    long long started = time(NULL);
 
     sf = SplineFontEmpty();
     SFDefaultOS2Info(&sf->pfminfo, sf, ""); // We set the default pfm values.
@@ -4513,6 +4833,7 @@ SplineFont *SFReadUFO(char *basedir, int flags) {
 		xmlFreeDoc(doc);
     }
 #endif
+    UFONoteDir(sf,basedir,started);
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
 return( sf );
 }
@@ -4533,7 +4854,7 @@ return( NULL );
     locale_t tmplocale; locale_t oldlocale; // Declare temporary locale storage.
     switch_to_c_locale(&tmplocale, &oldlocale); // Switch to the C locale temporarily and cache the old locale.
     setlocale(LC_NUMERIC,"C");
-    sc = _UFOLoadGlyph(sf,doc,filename,NULL,NULL,ly_fore);
+    sc = _UFOLoadGlyph(sf,doc,filename,NULL,NULL,ly_fore,NULL);
     switch_to_old_locale(&tmplocale, &oldlocale); // Switch to the cached locale.
 
     if ( sc==NULL )
@@ -36,6 +36,7 @@
 #include "fontforge.h"
 #include "gfile.h"
 #include "mem.h"
+#include "parallel.h"
 #include "parsettf.h"
 #include "tottf.h"
 
@@ -43,151 +44,76 @@
 #include <math.h>
 #include <zlib.h>
 
-static void copydata(FILE *to,int off_to,FILE *from,int off_from, int len) {
-    int ch, i;
-
-    fseek(to  ,off_to  ,SEEK_SET);
-    fseek(from,off_from,SEEK_SET);
-    for ( i=0; i<len; ++i ) {
-	ch = getc(from);
-	putc(ch,to);
+/* zlib's level (0-9, or -1 for its default) for the tables of woff files */
+int woff_compression_level = Z_DEFAULT_COMPRESSION;
+
+/* Each table of a woff file is compressed on its own, so all of them can */
+/*  be compressed (or decompressed) at once, each from the whole file in */
+/*  memory into a buffer of its own */
+struct woff_table {
+    int tag, checksum;
+    int offset;			/* In buf */
+    int compLen, uncompLen;
+    int index;			/* In the table directory */
+    uint8_t *data;		/* NULL if the table is stored uncompressed */
+    int err;
+};
+
+struct woff_tables {
+    struct woff_table *tabs;
+    uint8_t *buf;		/* The sfnt (or woff) file the tables are in */
+    int level;
+};
+
+static uint8_t *woff_ReadFile(FILE *file,int len) {
+    uint8_t *buf = malloc(len>0 ? len : 1);
+
+    if ( buf==NULL )
+return( NULL );
+    rewind(file);
+    if ( fread(buf,1,len,file)!=(size_t) len ) {
+	free(buf);
+return( NULL );
     }
+return( buf );
 }
 
-#define CHUNK	(128*1024)
-/* Copied with few mods from the zlib usage examples */
-
-static int decompressdata(FILE *to,int off_to,FILE *from,int off_from,
-	int len, int uncomplen ) {
-    /* Return whether an error occurred */
-    char in[CHUNK];
-    char out[CHUNK];
-    z_stream strm;
-    int ret;
-    int amount;
-
-    fseek(to  ,off_to  ,SEEK_SET);
-    fseek(from,off_from,SEEK_SET);
-    memset(&strm,0,sizeof(strm));
-    ret = inflateInit(&strm);
-    if ( ret!=Z_OK )
-return( true );
-
-    do {
-	if ( len<=0 ) {
-            (void)inflateEnd(&strm);
-return( true );
-        }
-	amount = len;
-	if ( amount>CHUNK )
-	    amount = CHUNK;
-        strm.avail_in = fread(in, 1, amount, from);
-	len -= strm.avail_in;
-        if (ferror(from)) {
-            (void)inflateEnd(&strm);
-return( true );
-        }
-        if (strm.avail_in == 0)
-    break;
-        strm.next_in = in;
-        do {
-            strm.avail_out = CHUNK;
-            strm.next_out = out;
-            ret = inflate(&strm, Z_NO_FLUSH);
-	    if ( ret!=Z_OK && ret!=Z_STREAM_END ) {
-		(void)inflateEnd(&strm);
-return( true );
-	    }
-	    amount = CHUNK - strm.avail_out;
-	    if ( fwrite(out,1,amount,to)!= amount || ferror(to) ) {
-		(void)inflateEnd(&strm);
-return( true );
-	    }
-	} while ( strm.avail_out==0 );
-    } while ( ret!=Z_STREAM_END );
-    (void)inflateEnd(&strm);
-    if ( uncomplen!=strm.total_out ) {
+static void woff_DecompressTable(int i,void *data) {
+    struct woff_tables *wt = data;
+    struct woff_table *tab = &wt->tabs[i];
+    uLongf len = tab->uncompLen;
+
+    if ( tab->compLen==tab->uncompLen )
+return;			/* Not compressed */
+    tab->data = malloc(tab->uncompLen>0 ? tab->uncompLen : 1);
+    if ( tab->data==NULL ||
+	    uncompress(tab->data,&len,wt->buf+tab->offset,tab->compLen)!=Z_OK )
+	tab->err = true;
+    else if ( len!=(uLongf) tab->uncompLen ) {
 	LogError(_("Decompressed length did not match expected length for table"));
-return( true );
+	tab->err = true;
     }
-
-return( false );
 }
 
-static int compressOrNot(FILE *to,int off_to, FILE *from,int off_from,
-	int len, int forcecompress ) {
-    char in[CHUNK];
-    char out[CHUNK];
-    z_stream strm;
-    int ret, err=0;
-    int amount;
-    FILE *tmp;
-    int uncompLen = len;
+static void woff_CompressTable(int i,void *data) {
+    struct woff_tables *wt = data;
+    struct woff_table *tab = &wt->tabs[i];
+    uLongf len;
 
+    tab->compLen = tab->uncompLen;
     /* Empty table, nothing to do */
-    if ( len==0 )
-return(0);
-
-    fseek(from,off_from,SEEK_SET);
-    memset(&strm,0,sizeof(strm));
-    ret = deflateInit(&strm,Z_DEFAULT_COMPRESSION);
-    if ( ret!=Z_OK ) {
-	fprintf( stderr,"Compression initialization failed.\n" );
-return(0);
-    }
-    tmp = GFileTmpfile();
-
-    do {
-	if ( len<=0 ) {
-            (void)deflateEnd(&strm);
-    break;
-        }
-	amount = len;
-	if ( amount>CHUNK )
-	    amount = CHUNK;
-        strm.avail_in = fread(in, 1, amount, from);
-	len -= strm.avail_in;
-        if (ferror(from)) {
-            (void)deflateEnd(&strm);
-	    fprintf( stderr, "IO error.\n" );
-    break;
-        }
-        if (strm.avail_in == 0)
-    break;
-        strm.next_in = in;
-        do {
-            strm.avail_out = CHUNK;
-            strm.next_out = out;
-            ret = deflate(&strm, len==0 ? Z_FINISH : Z_NO_FLUSH);
-	    if ( ret==Z_STREAM_ERROR ) {
-		(void)deflateEnd(&strm);
-		fprintf( stderr, "Compression failed somehow.\n");
-		err = 1;
-	break;
-	    }
-	    amount = CHUNK - strm.avail_out;
-	    if ( fwrite(out,1,amount,tmp)!= amount || ferror(tmp) ) {
-		(void)deflateEnd(&strm);
-		fprintf( stderr, "IO Error.\n");
-		err=1;
-	break;
-	    }
-	} while ( strm.avail_out==0 );
-	if ( err )
-    break;
-    } while ( ret!=Z_STREAM_END );
-    (void)deflateEnd(&strm);
-
-    if ( strm.total_out>=uncompLen ) {
+    if ( tab->uncompLen==0 )
+return;
+    len = compressBound(tab->uncompLen);
+    tab->data = malloc(len);
+    if ( tab->data==NULL ||
+	    compress2(tab->data,&len,wt->buf+tab->offset,tab->uncompLen,wt->level)!=Z_OK ||
+	    len>=(uLongf) tab->uncompLen ) {
 	/* Didn't actually make the data smaller, so store uncompressed */
-	fclose(tmp);
-	copydata(to,off_to,from,off_from,uncompLen);
-return( uncompLen );
-    } else {
-	copydata(to,off_to,tmp,0,strm.total_out);
-	fclose(tmp);
-return( strm.total_out );
-    }
+	free(tab->data);
+	tab->data = NULL;
+    } else
+	tab->compLen = len;
 }
 
 SplineFont *_SFReadWOFF(FILE *woff,int flags,enum openflags openflags, char *filename,char *chosenname,struct fontdict *fd) {
@@ -199,11 +125,12 @@ SplineFont *_SFReadWOFF(FILE *woff,int flags,enum openflags openflags, char *fil
     uint32_t metaOffset, metaLenCompressed, metaLenUncompressed;
     int privOffset, privLength;
     int i,j,err;
-    int tag, offset, compLen, uncompLen, checksum;
     FILE *sfnt;
-    int here, next, tab_start;
+    int next, tab_start;
     int head_pos = -1;
     SplineFont *sf;
+    struct woff_tables wt;
+    struct woff_table *tab;
 
     fseek(woff,0,SEEK_END);
     len = ftell(woff);
@@ -238,9 +165,40 @@ return( NULL );
     privOffset = getlong(woff);
     privLength = getlong(woff);
 
-    sfnt = GFileTmpfile();
+    memset(&wt,0,sizeof(wt));
+    wt.tabs = calloc(num_tabs>0 ? num_tabs : 1,sizeof(struct woff_table));
+    for ( i=0; i<num_tabs; ++i ) {
+	tab = &wt.tabs[i];
+	tab->tag = getlong(woff);
+	tab->offset = getlong(woff);
+	tab->compLen = getlong(woff);
+	tab->uncompLen = getlong(woff);
+	tab->checksum = getlong(woff);
+	if ( tab->compLen>tab->uncompLen || tab->offset+tab->compLen>len ||
+		tab->offset<0 || tab->compLen<0 ) {
+	    if ( tab->compLen>tab->uncompLen )
+		LogError(_("Invalid compressed table length for '%c%c%c%c'."),
+			tab->tag>>24, tab->tag>>16, tab->tag>>8, tab->tag);
+	    else
+		LogError(_("Table length stretches beyond end of file for '%c%c%c%c'."),
+			tab->tag>>24, tab->tag>>16, tab->tag>>8, tab->tag);
+	    free(wt.tabs);
+return( NULL );
+	}
+    }
+    if ( (wt.buf = woff_ReadFile(woff,len))==NULL ) {
+	LogError(_("Could not read WOFF file."));
+	free(wt.tabs);
+return( NULL );
+    }
+    ParallelFor(num_tabs,woff_DecompressTable,&wt,false);
+
+    sfnt = GFileMemTmpfile();
     if ( sfnt==NULL ) {
 	LogError(_("Could not open temporary file."));
+	for ( i=0; i<num_tabs; ++i )
+	    free(wt.tabs[i].data);
+	free(wt.tabs); free(wt.buf);
 return( NULL );
     }
 
@@ -256,45 +214,27 @@ return( NULL );
     for ( i=0; i<4*num_tabs; ++i )
 	putlong(sfnt,0);
 
-    for ( i=0; i<num_tabs; ++i ) {
-	tag = getlong(woff);
-	offset = getlong(woff);
-	compLen = getlong(woff);
-	uncompLen = getlong(woff);
-	checksum = getlong(woff);
-	if ( compLen>uncompLen || offset+compLen>len ) {
-	    fclose(sfnt);
-	    if ( compLen>uncompLen )
-		LogError(_("Invalid compressed table length for '%c%c%c%c'."),
-			tag>>24, tag>>16, tag>>8, tag);
-	    else
-		LogError(_("Table length stretches beyond end of file for '%c%c%c%c'."),
-			tag>>24, tag>>16, tag>>8, tag);
-return( NULL );
-	}
-	here = ftell(woff);
+    for ( i=0, err=false; i<num_tabs && !err; ++i ) {
+	tab = &wt.tabs[i];
 	next = ftell(sfnt);
 	fseek(sfnt,tab_start,SEEK_SET);
-	putlong(sfnt,tag);
-	putlong(sfnt,checksum);
+	putlong(sfnt,tab->tag);
+	putlong(sfnt,tab->checksum);
 	putlong(sfnt,next);
-	putlong(sfnt,uncompLen);
-	if ( tag==CHR('h','e','a','d'))
+	putlong(sfnt,tab->uncompLen);
+	if ( tab->tag==CHR('h','e','a','d'))
 	    head_pos = next;
 	tab_start = ftell(sfnt);
 	fseek(sfnt,next,SEEK_SET);
-	if ( compLen==uncompLen ) {
+	if ( tab->err ) {
+	    LogError(_("Problem decompressing '%c%c%c%c' table."),
+		    tab->tag>>24, tab->tag>>16, tab->tag>>8, tab->tag);
+	    err = true;
+	} else if ( tab->data==NULL ) {
 	    /* Not compressed, copy verbatim */
-	    copydata(sfnt,next,woff,offset,compLen);
-	} else {
-	    err = decompressdata(sfnt,next,woff,offset,compLen,uncompLen);
-	    if ( err ) {
-		LogError(_("Problem decompressing '%c%c%c%c' table."),
-			tag>>24, tag>>16, tag>>8, tag);
-		fclose(sfnt);
-return( NULL );
-	    }
-	}
+	    fwrite(wt.buf+tab->offset,1,tab->compLen,sfnt);
+	} else
+	    fwrite(tab->data,1,tab->uncompLen,sfnt);
 	if ( (ftell(sfnt)&3)!=0 ) {
 	    /* Pad to a 4 byte boundary */
 	    if ( ftell(sfnt)&1 )
@@ -302,7 +242,13 @@ return( NULL );
 	    if ( ftell(sfnt)&2 )
 		putshort(sfnt,0);
 	}
-	fseek(woff,here,SEEK_SET);
+    }
+    for ( i=0; i<num_tabs; ++i )
+	free(wt.tabs[i].data);
+    free(wt.tabs); free(wt.buf);
+    if ( err ) {
+	fclose(sfnt);
+return( NULL );
     }
     /* I assumed at first that the check sum would just be right */
     /*  but I've reordered the tables (probably) so I've got a different */
@@ -319,7 +265,8 @@ return( NULL );
     }
     rewind(sfnt);
     sf = _SFReadTTF(sfnt,flags,openflags,filename,chosenname,fd);
-    fclose(sfnt);
+    if ( sf==NULL || sf->lazy==NULL )	/* A lazy font keeps reading from it */
+	fclose(sfnt);
 
     if ( sf!=NULL ) {
 	sf->woffMajor = major;
@@ -398,10 +345,11 @@ int _WriteWOFFFont(FILE *woff,SplineFont *sf, enum fontformat format,
     int flavour, num_tabs;
     int filelen, len;
     int i;
-    int compLen, uncompLen, newoffset;
-    int tag, checksum, offset;
+    int newoffset;
     int tab_start;
     tableOrderRec *tableOrder = NULL;
+    struct woff_tables wt;
+    struct woff_table *tab;
 
     if ( major==woffUnset ) {
 	struct ttflangname *useng;
@@ -429,7 +377,7 @@ int _WriteWOFFFont(FILE *woff,SplineFont *sf, enum fontformat format,
 
     format = sf->subfonts!=NULL ? ff_otfcid :
 		sf->layers[layer].order2 ? ff_ttf : ff_otf;
-    sfnt = GFileTmpfile();
+    sfnt = GFileMemTmpfile();
     ret = _WriteTTFFont(sfnt,sf,format,bsizes,bf,flags,enc,layer);
     if ( !ret ) {
 	fclose(sfnt);
@@ -471,6 +419,28 @@ return( ret );
     }
     qsort(tableOrder, num_tabs, sizeof(tableOrderRec), compareOffsets);
 
+    memset(&wt,0,sizeof(wt));
+    wt.level = woff_compression_level<-1 || woff_compression_level>9 ?
+	    Z_DEFAULT_COMPRESSION : woff_compression_level;
+    wt.tabs = calloc(num_tabs>0 ? num_tabs : 1,sizeof(struct woff_table));
+    if ( wt.tabs==NULL || (wt.buf = woff_ReadFile(sfnt,filelen))==NULL ) {
+        free(wt.tabs);
+        free(tableOrder);
+        fclose(sfnt);
+        return false;
+    }
+    for ( i=0; i<num_tabs; ++i ) {
+	tab = &wt.tabs[i];
+	tab->index = tableOrder[i].index;
+	fseek(sfnt,(3 + 4*tab->index)*sizeof(int32),SEEK_SET);
+	tab->tag = getlong(sfnt);
+	tab->checksum = getlong(sfnt);
+	tab->offset = getlong(sfnt);
+	tab->uncompLen = getlong(sfnt);
+    }
+    fclose(sfnt);
+    ParallelFor(num_tabs,woff_CompressTable,&wt,false);
+
     /* Now generate the WOFF file */
     rewind(woff);
     putlong(woff,CHR('w','O','F','F'));
@@ -492,13 +462,12 @@ return( ret );
 	putlong(woff,0);
 
     for ( i=0; i<num_tabs; ++i ) {
-	fseek(sfnt,(3 + 4*tableOrder[i].index)*sizeof(int32),SEEK_SET);
-	tag = getlong(sfnt);
-	checksum = getlong(sfnt);
-	offset = getlong(sfnt);
-	uncompLen = getlong(sfnt);
+	tab = &wt.tabs[i];
 	newoffset = ftell(woff);
-	compLen = compressOrNot(woff,newoffset,sfnt,offset,uncompLen,false);
+	if ( tab->data!=NULL )
+	    fwrite(tab->data,1,tab->compLen,woff);
+	else
+	    fwrite(wt.buf+tab->offset,1,tab->uncompLen,woff);
 	if ( (ftell(woff)&3)!=0 ) {
 	    /* Pad to a 4 byte boundary */
 	    if ( ftell(woff)&1 )
@@ -506,15 +475,16 @@ return( ret );
 	    if ( ftell(woff)&2 )
 		putshort(woff,0);
 	}
-	fseek(woff,tab_start+(5*tableOrder[i].index)*sizeof(int32),SEEK_SET);
-	putlong(woff,tag);
+	fseek(woff,tab_start+(5*tab->index)*sizeof(int32),SEEK_SET);
+	putlong(woff,tab->tag);
 	putlong(woff,newoffset);
-	putlong(woff,compLen);
-	putlong(woff,uncompLen);
-	putlong(woff,checksum);
+	putlong(woff,tab->compLen);
+	putlong(woff,tab->uncompLen);
+	putlong(woff,tab->checksum);
 	fseek(woff,0,SEEK_END);
+	free(tab->data);
     }
-    fclose(sfnt);
+    free(wt.tabs); free(wt.buf);
 
     if ( sf->woffMetadata!= NULL ) {
 	int uncomplen = strlen(sf->woffMetadata);
@@ -611,7 +581,7 @@ static FILE *WriteBufferToFile(FILE *fp, const uint8_t *buf, size_t buflen)
  */
 static FILE *WriteBufferToTempFile(const uint8_t *buf, size_t buflen)
 {
-    FILE *fp = GFileTmpfile();
+    FILE *fp = GFileMemTmpfile();
     if (!WriteBufferToFile(fp, buf, buflen)) {
         fclose(fp);
         return NULL;
@@ -632,7 +602,7 @@ int WriteWOFF2Font(char *fontname, SplineFont *sf, enum fontformat format, int32
 
 int _WriteWOFF2Font(FILE *fp, SplineFont *sf, enum fontformat format, int32_t *bsizes, enum bitmapformat bf, int flags, EncMap *enc, int layer)
 {
-    FILE *tmp = GFileTmpfile();
+    FILE *tmp = GFileMemTmpfile();
     if (!tmp) {
         return 0;
     }
@@ -699,7 +669,9 @@ SplineFont *_SFReadWOFF2(FILE *fp, int flags, enum openflags openflags, char *fi
     }
 
     SplineFont *ret = _SFReadTTF(tmp, flags, openflags, filename, chosenname, fd);
-    fclose(tmp);
+    if (ret == NULL || ret->lazy == NULL) {
+        fclose(tmp);
+    }
     return ret;
 }
 
@@ -1554,6 +1554,7 @@ static void CI_ApplyAll(CharInfo *ci) {
     int refresh_fvdi = false;
     struct splinecharlist *scl;
     SplineChar *cached, *sc;
+    char *oldname;
     SplineFont *sf = ci->sc->parent;
     FontView *fvs;
 
@@ -1566,9 +1567,10 @@ static void CI_ApplyAll(CharInfo *ci) {
 	if ( sc->name==NULL || strcmp( sc->name,cached->name )!=0 ) {
 	    if ( sc->name!=NULL )
 		SFGlyphRenameFixup(sf,sc->name,cached->name,false);
-	    free(sc->name); sc->name = copy(cached->name);
+	    oldname = sc->name; sc->name = copy(cached->name);
 	    sc->namechanged = true;
-	    GlyphHashFree(sf);
+	    SFHashRename(sf,sc,oldname);
+	    free(oldname);
 	}
 	if ( sc->unicodeenc != cached->unicodeenc ) {
 	    struct splinecharlist *scl;
@@ -1619,6 +1621,7 @@ static void CI_ApplyAll(CharInfo *ci) {
 	AltUniFree(sc->altuni);
 	sc->altuni = cached->altuni;
 	cached->altuni = NULL;
+	SFHashUnicodes(sf,sc);
 	sc->lig_caret_cnt_fixed = cached->lig_caret_cnt_fixed;
 	PSTFree(sc->possub);
 	sc->possub = cached->possub;
@@ -1653,7 +1656,7 @@ static void CI_ApplyAll(CharInfo *ci) {
 	}
     }
     if ( ci->changes )
-	sf->changed = true;
+	sf->changed = sf->changed_since_autosave = true;
 }
 
 static void CI_Finish(CharInfo *ci) {
@@ -192,6 +192,7 @@ extern int prefs_cv_outline_thickness; /* from charview.c */
 
 extern float OpenTypeLoadHintEqualityTolerance;  /* autohint.c */
 extern float GenerateHintWidthEqualityTolerance; /* splinesave.c */
+extern int woff_compression_level;	/* in woff.c */
 extern int warn_script_unsaved; /* fontview.c */
 extern NameList *force_names_when_opening;
 extern NameList *force_names_when_saving;
@@ -411,6 +412,7 @@ static struct prefs_list {
 #endif
 
 	{ N_("GenerateHintWidthEqualityTolerance"), pr_real, &GenerateHintWidthEqualityTolerance, NULL, NULL, '\0', NULL, 0, N_( "When generating a font, ignore slight rounding errors for hints that should be at the top or bottom of the glyph. For example, you might like to set this to 0.02 so that 19.999 will be considered 20. But only for the hint width value.") },
+	{ N_("WOFFCompressionLevel"), pr_int, &woff_compression_level, NULL, NULL, '\0', NULL, 0, N_("How hard zlib should try to compress the tables of a WOFF font, from 0 (stored) to 9 (smallest), or -1 for zlib's default. The same level always gives the same file.") },
 	
 	PREFS_LIST_EMPTY
 },
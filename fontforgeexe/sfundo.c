@@ -46,14 +46,14 @@ void SFUndoFreeAssociated( struct sfundoes *undo )
 void SFUndoFree( struct sfundoes *undo )
 {
     SFUndoFreeAssociated( undo );
-    free( undo );
+    chunkfree( undo, sizeof(SFUndoes) );
 }
 
 void SFUndoRemoveAndFree( SplineFont *sf, struct sfundoes *undo )
 {
     SFUndoFreeAssociated( undo );
     dlist_erase( (struct dlistnode **)&sf->undoes, (struct dlistnode *)undo );
-    free(undo);
+    chunkfree(undo,sizeof(SFUndoes));
 }
 
 
@@ -55,6 +55,7 @@ static void _doscriptusage(void) {
     printf( "\t-c script-string\t (executes the argument as scripting cmds)\n" );
     printf( "\t-skippyfile\t\t (do not execute python init scripts)\n" );
     printf( "\t-skippyplug\t\t (do not load python plugins)\n" );
+    printf( "\t-jobs count\t\t (threads to use when generating fonts,\n\t\t\t\t  0 for one per processor)\n" );
     printf( "\n" );
     printf( "If no scriptfile/string is given (or if it's \"-\") FontForge will read stdin\n" );
     printf( "FontForge will read postscript (pfa, pfb, ps, cid), opentype (otf),\n" );
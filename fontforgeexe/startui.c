@@ -39,6 +39,7 @@
 #include "gresource.h"
 #include "hotkeys.h"
 #include "lookups.h"
+#include "parallel.h"
 #include "prefs.h"
 #include "start.h"
 #include "ustring.h"
@@ -125,6 +126,7 @@ static void _dousage(void) {
     printf( "\t-allglyphs\t\t (load all glyphs in the 'glyf' table\n\t\t\t\t  of a truetype collection)\n" );
     printf( "\t-nosplash\t\t (no splash screen)\n" );
     printf( "\t-quiet\t\t\t (don't print non-essential\n\t\t\t\t  information to stderr)\n" );
+    printf( "\t-jobs count\t\t (threads to use when generating fonts,\n\t\t\t\t  0 for one per processor)\n" );
     printf( "\t-unique\t\t\t (if a fontforge is already running open all\n\t\t\t\t  arguments in it and have this process exit)\n" );
     printf( "\t-display display-name\t (sets the X display)\n" );
     printf( "\t-depth val\t\t (sets the display depth if possible)\n" );
@@ -1120,6 +1122,8 @@ int fontforge_main( int argc, char **argv ) {
 	    AddR(argv[0],"Gdraw.Keyboard", argv[++i]);
 	else if ( strcmp(pt,"-display")==0 && i<argc-1 )
 	    display = argv[++i];
+	else if ( strcmp(pt,"-jobs")==0 && i<argc-1 )
+	    ff_parallel_jobs = strtol(argv[++i],NULL,10);
 # if MyMemory
 	else if ( strcmp(pt,"-memory")==0 )
 	    __malloc_debug(5);
@@ -1348,7 +1352,7 @@ exit( 0 );
 	    /* Already done */;
 	else if ( (strcmp(pt,"-depth")==0 || strcmp(pt,"-vc")==0 ||
 		    strcmp(pt,"-cmap")==0 || strcmp(pt,"-colormap")==0 ||
-		    strcmp(pt,"-keyboard")==0 ||
+		    strcmp(pt,"-keyboard")==0 || strcmp(pt,"-jobs")==0 ||
 		    strcmp(pt,"-display")==0 || strcmp(pt,"-recover")==0 ) &&
 		i<argc-1 )
 	    ++i; /* Already done, needed to be before display opened */
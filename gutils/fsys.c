@@ -25,6 +25,10 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE		/* for memfd_create and fopencookie */
+#endif
+
 #include <fontforge-config.h>
 
 #include "basics.h"
@@ -35,6 +39,8 @@
 #include <errno.h>			/* for mkdir_p */
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/param.h>
 #include <sys/stat.h>		/* for mkdir */
 #include <sys/types.h>
@@ -455,6 +461,183 @@ FILE *GFileTmpfile() {
 #endif
 }
 
+#if defined(__GLIBC__)
+# include <sys/mman.h>
+#endif
+
+#if defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+# define HAVE_MEMFILE 1
+# if defined(__GLIBC__)
+#  include <stdio_ext.h>
+# endif
+
+struct memfile {
+    char *data;
+    size_t len, alloc, pos;
+    unsigned int borrowed: 1;	/* data belong to the caller */
+};
+
+static size_t memfile_read(struct memfile *mf, char *buf, size_t size) {
+    if ( mf->pos>=mf->len )
+return( 0 );
+    if ( size>mf->len-mf->pos )
+	size = mf->len-mf->pos;
+    memcpy(buf,mf->data+mf->pos,size);
+    mf->pos += size;
+return( size );
+}
+
+static int memfile_seek(struct memfile *mf, long long *offset, int whence) {
+    long long pos = *offset;
+
+    if ( whence==SEEK_CUR )
+	pos += mf->pos;
+    else if ( whence==SEEK_END )
+	pos += mf->len;
+    if ( pos<0 )
+return( -1 );
+    mf->pos = *offset = pos;
+return( 0 );
+}
+
+static int memfile_close(void *cookie) {
+    struct memfile *mf = cookie;
+
+    if ( !mf->borrowed )
+	free(mf->data);
+    free(mf);
+return( 0 );
+}
+
+# if defined(__GLIBC__)
+static ssize_t memfile_cookie_read(void *cookie, char *buf, size_t size) {
+return( memfile_read(cookie,buf,size));
+}
+
+static int memfile_cookie_seek(void *cookie, off64_t *offset, int whence) {
+    long long pos = *offset;
+    int ret = memfile_seek(cookie,&pos,whence);
+    *offset = pos;
+return( ret );
+}
+# else
+static int memfile_write(void *cookie, const char *buf, int size) {
+    struct memfile *mf = cookie;
+    size_t end = mf->pos+size;
+
+    if ( end>mf->alloc ) {
+	size_t alloc = mf->alloc==0 ? 4096 : mf->alloc;
+	char *data;
+	while ( alloc<end )
+	    alloc *= 2;
+	if ( (data = realloc(mf->data,alloc))==NULL )
+return( 0 );
+	mf->data = data;
+	mf->alloc = alloc;
+    }
+    if ( mf->pos>mf->len )		/* Seeked beyond the end, fill the gap */
+	memset(mf->data+mf->len,0,mf->pos-mf->len);
+    memcpy(mf->data+mf->pos,buf,size);
+    mf->pos = end;
+    if ( end>mf->len )
+	mf->len = end;
+return( size );
+}
+
+static int memfile_cookie_read(void *cookie, char *buf, int size) {
+return( memfile_read(cookie,buf,size));
+}
+
+static fpos_t memfile_cookie_seek(void *cookie, fpos_t offset, int whence) {
+    long long pos = offset;
+    if ( memfile_seek(cookie,&pos,whence)<0 )
+return( -1 );
+return( pos );
+}
+# endif
+
+/* Writable streams are only supported off glibc, see GFileMemTmpfile */
+static FILE *memfile_open(struct memfile *mf, int writable) {
+    FILE *fp;
+# if defined(__GLIBC__)
+    cookie_io_functions_t funcs = { memfile_cookie_read, NULL,
+	    memfile_cookie_seek, memfile_close };
+    fp = writable ? NULL : fopencookie(mf,"r",funcs);
+# else
+    fp = funopen(mf,memfile_cookie_read,writable ? memfile_write : NULL,
+	    memfile_cookie_seek,memfile_close);
+# endif
+    if ( fp==NULL )
+	memfile_close(mf);
+    else {
+	/* Left to itself stdio makes these line buffered */
+	setvbuf(fp,NULL,_IOFBF,BUFSIZ);
+# if defined(__GLIBC__)
+	/* And the stream is private to whoever opened it, so getc() etc. */
+	/*  need not lock it */
+	__fsetlocking(fp,FSETLOCKING_BYCALLER);
+# endif
+    }
+return( fp );
+}
+#endif
+
+/**
+ *  Creates an anonymous read/write stream like GFileTmpfile, but one which
+ *  lives entirely in memory and grows as it is written. Used for the
+ *  scratch tables of the font writers, which are built up, checksummed and
+ *  copied into the final file. On linux this is an anonymous memory file,
+ *  on the BSDs a buffer behind custom stream functions (glibc's version of
+ *  those loses track of the file position after writes). Falls back to
+ *  GFileTmpfile when neither is available.
+ */
+FILE *GFileMemTmpfile(void) {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2,27)
+    int fd = memfd_create("fontforge",MFD_CLOEXEC);
+    FILE *fp;
+
+    if ( fd==-1 )
+return( GFileTmpfile());
+    if ( (fp = fdopen(fd,"w+"))==NULL )
+	close(fd);
+return( fp );
+#elif defined(HAVE_MEMFILE) && !defined(__GLIBC__)
+    struct memfile *mf = calloc(1,sizeof(struct memfile));
+
+    if ( mf==NULL )
+return( NULL );
+return( memfile_open(mf,true));
+#else
+return( GFileTmpfile());
+#endif
+}
+
+/**
+ *  Opens a read only stream over len bytes of the caller's memory, which
+ *  must stay valid (and unchanged) until the stream is closed. Nothing is
+ *  copied. Where that is not possible the data are copied to a GFileTmpfile.
+ */
+FILE *GFileMemOpen(const void *data, size_t len) {
+#ifdef HAVE_MEMFILE
+    struct memfile *mf = calloc(1,sizeof(struct memfile));
+
+    if ( mf==NULL )
+return( NULL );
+    mf->data = (char *) data;
+    mf->len = mf->alloc = len;
+    mf->borrowed = true;
+return( memfile_open(mf,false));
+#else
+    FILE *fp = GFileTmpfile();
+
+    if ( fp!=NULL && (fwrite(data,1,len,fp)!=len || fseek(fp,0,SEEK_SET)!=0) ) {
+	fclose(fp);
+	fp = NULL;
+    }
+return( fp );
+#endif
+}
+
 /**
  * Removes a file or folder.
  *
@@ -1059,6 +1242,57 @@ int GFileWriteAll(char *filepath, char *data) {
     return -1;
 }
 
+/*
+ * Write len bytes of data into file 'name', unless that is exactly what it
+ * holds already. The data goes to a temporary file alongside which then
+ * replaces the old one, so a reader never sees a half written file. The
+ * new file keeps the permissions of the one it replaces, and the temporary
+ * file is removed if anything goes wrong.
+ * Return -1 if error, 0 if the file was left alone, 1 if it was written.
+ **/
+int GFileWriteIfChanged(const char *filepath, const void *data, size_t len) {
+    struct stat st;
+    char *old, *tmp;
+    FILE *fp;
+    int fd, exists, same = false, ok;
+
+    exists = stat(filepath,&st)==0 && S_ISREG(st.st_mode);
+    if ( exists && (size_t) st.st_size==len &&
+	 (fp=fopen(filepath,"rb"))!=NULL ) {
+	old = malloc(len+1);
+	same = old!=NULL && fread(old,1,len,fp)==len && memcmp(old,data,len)==0;
+	free(old);
+	fclose(fp);
+    }
+    if ( same )
+	return( 0 );
+
+    /* A new file gets 0666 less the umask, as fopen would give it */
+    tmp = g_strconcat(filepath, ".XXXXXX", NULL);
+    if ( (fd = g_mkstemp_full(tmp, O_RDWR, 0666))==-1 ) {
+	g_free(tmp);
+	return( -1 );
+    }
+    if ( (fp = fdopen(fd,"wb"))==NULL ) {
+	close(fd);
+	ok = false;
+    } else {
+	ok = fwrite(data,1,len,fp)==len;
+	if ( fclose(fp)!=0 )
+	    ok = false;
+    }
+    if ( ok && exists && chmod(tmp,st.st_mode&07777)!=0 )
+	ok = false;
+    /* Windows won't rename over an existing file */
+    if ( ok && rename(tmp,filepath)!=0 &&
+	 (unlink(filepath)!=0 || rename(tmp,filepath)!=0) )
+	ok = false;
+    if ( !ok )
+	unlink(tmp);
+    g_free(tmp);
+    return( ok ? 1 : -1 );
+}
+
 const char *getTempDir(void)
 {
     return g_get_tmp_dir();
@@ -73,6 +73,8 @@ extern int GFileModifyable(const char *file);
 extern int GFileModifyableDir(const char *file);
 extern int GFileReadable(const char *file);
 extern FILE* GFileTmpfile();
+extern FILE* GFileMemTmpfile(void);
+extern FILE* GFileMemOpen(const void *data, size_t len);
 extern int GFileRemove(const char *path, int recursive);
 extern int GFileMkDir(const char *name, int mode);
 extern int GFileRmDir(const char *name);
@@ -96,6 +98,7 @@ extern int u_GFileUnlink(unichar_t *name);
 extern off_t GFileGetSize(char *name);
 extern char *GFileReadAll(char *name);
 extern int   GFileWriteAll(char *filepath, char *data);
+extern int   GFileWriteIfChanged(const char *filepath, const void *data, size_t len);
 extern void  FindProgDir(char *prog);
 extern char *getShareDir(void);
 extern char *getLocaleDir(void);
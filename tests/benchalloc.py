@@ -0,0 +1,43 @@
+# Times opening and closing each sfd font in tests/fonts (or in the directory
+# given as the first argument), which is mostly spent making and freeing
+# SplinePoints, Splines and the other small structures, and prints the peak
+# memory use once they have all been open at the same time. Not run as part
+# of the testsuite.
+#   fontforge -lang=py -script benchalloc.py [directory [repeats]]
+
+import os, sys, glob, resource, time
+import fontforge
+
+fontdir = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), "fonts")
+repeats = int(sys.argv[2]) if len(sys.argv)>2 else 5
+
+names = []
+for name in sorted(glob.glob(os.path.join(fontdir, "*.sfd"))):
+  try:
+    fontforge.open(name).close()
+    names.append(name)
+  except EnvironmentError:
+    pass
+
+opening = closing = 0
+for name in names:
+  best_open = best_close = None
+  for i in range(repeats):
+    start = time.perf_counter()
+    font = fontforge.open(name)
+    middle = time.perf_counter()
+    font.close()
+    end = time.perf_counter()
+    if best_open is None or middle-start<best_open:
+      best_open = middle-start
+    if best_close is None or end-middle<best_close:
+      best_close = end-middle
+  opening += best_open
+  closing += best_close
+  print("%-32s open %8.1f ms  close %7.1f ms" % (os.path.basename(name), best_open*1000, best_close*1000))
+print("%-32s open %8.1f ms  close %7.1f ms" % ("total", opening*1000, closing*1000))
+
+fonts = [fontforge.open(name) for name in names]
+print("peak memory with all %d fonts open: %d kb" % (len(fonts), resource.getrusage(resource.RUSAGE_SELF).ru_maxrss))
+for font in fonts:
+  font.close()
@@ -0,0 +1,59 @@
+# Times autohinting a font of CJK-like glyphs (2000 by default, each made of
+# horizontal, vertical and slanted strokes) on one thread and on several,
+# then hinting it again once every glyph has been touched without changing
+# its outlines. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchautohint.py [glyph-count [threads]]
+
+import random, sys, time
+import fontforge, psMat
+
+count = int(sys.argv[1]) if len(sys.argv)>1 else 2000
+threads = int(sys.argv[2]) if len(sys.argv)>2 else 4
+
+def stroke(pen, points):
+  pen.moveTo(points[0])
+  for point in points[1:]:
+    pen.lineTo(point)
+  pen.closePath()
+
+def makefont():
+  random.seed(1)
+  font = fontforge.font()
+  font.encoding = "UnicodeBmp"
+  font.em = 1000
+  for i in range(count):
+    glyph = font.createChar(0x4E00+i)
+    pen = glyph.glyphPen()
+    for j in range(random.randint(3, 7)):
+      y = random.randrange(40, 800, 20)
+      x = random.randrange(60, 400, 10)
+      stroke(pen, [(x, y), (x, y+random.choice((50, 60, 70))),
+                   (x+random.randrange(300, 540, 10), y+60), (x+random.randrange(300, 540, 10), y)])
+    for j in range(random.randint(2, 5)):
+      x = random.randrange(80, 860, 20)
+      y = random.randrange(-80, 300, 10)
+      width = random.choice((70, 80, 90))
+      stroke(pen, [(x, y), (x, y+random.randrange(300, 600, 10)), (x+width, y+600), (x+width, y)])
+    if random.random()<.5:
+      x = random.randrange(100, 600, 10)
+      stroke(pen, [(x, 100), (x+300, 700), (x+380, 660), (x+80, 60)])
+    pen = None
+    glyph.width = 1000
+    glyph.removeOverlap()
+    glyph.round()
+  font.selection.all()
+  return font
+
+def timed(what, func):
+  start = time.perf_counter()
+  func()
+  print("%-36s %8.1f ms" % (what, (time.perf_counter()-start)*1000))
+
+for jobs in (1, threads):
+  font = makefont()
+  timed("first hinting, %d thread(s)" % jobs, lambda: font.autoHint(threads=jobs))
+  for glyph in font.glyphs():
+    glyph.transform(psMat.translate(0, 10))
+    glyph.transform(psMat.translate(0, -10))
+  timed("unchanged outlines, %d thread(s)" % jobs, lambda: font.autoHint(threads=jobs))
+  font.close()
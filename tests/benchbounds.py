@@ -0,0 +1,25 @@
+# Times asking for the bounding box of every glyph in a font (DejaVuSerif.sfd
+# by default) again and again, as metrics and generation do, before and after
+# the outlines are changed. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchbounds.py [sfd-file [repeats]]
+
+import os, sys, time
+import fontforge, psMat
+
+fontfile = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), "fonts", "DejaVuSerif.sfd")
+repeats = int(sys.argv[2]) if len(sys.argv)>2 else 100
+
+font = fontforge.open(fontfile)
+glyphs = list(font.glyphs())
+
+def bounds(what):
+  start = time.perf_counter()
+  for i in range(repeats):
+    for glyph in glyphs:
+      glyph.boundingBox()
+  print("%-40s %8.1f ms" % (what, (time.perf_counter()-start)*1000))
+
+bounds("%d glyphs, %d times" % (len(glyphs), repeats))
+font.transform(psMat.rotate(0.2))
+bounds("after rotating them all")
+font.close()
@@ -0,0 +1,55 @@
+# Makes a font with one big kerning class subtable, many of whose rows and
+# columns kern alike as those made by merging fonts or by auto kerning tend
+# to, then times writing it as OpenType and prints how big its GPOS table is
+# and how many subtables the kerning took. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchclasskern.py [glyph-count]
+
+import os, sys, shutil, struct, tempfile, time
+import fontforge
+
+count = int(sys.argv[1]) if len(sys.argv)>1 else 1200
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+
+font = fontforge.font()
+font.encoding = "UnicodeBmp"
+names = []
+for i in range(count):
+  glyph = font.createChar(0x4e00+i)
+  pen = glyph.glyphPen()
+  pen.moveTo((100,0)); pen.lineTo((100,700)); pen.lineTo((400+i%100,700)); pen.lineTo((400+i%100,0))
+  pen.closePath()
+  glyph.width = 500
+  names.append(glyph.glyphname)
+del pen # crash if (auto)destroyed after font.close()
+
+# Each of the first half of the glyphs is a class of its own on the left, the
+# rest go in pairs on the right
+lefts = names[:count//2]
+rights = names[count//2:]
+firsts = [None] + [(name,) for name in lefts]
+seconds = [None] + [tuple(rights[j:j+2]) for j in range(0,len(rights),2)]
+def value(r, c):
+  if r==0 or c==0 or c%5==0:
+    return 0
+  return -(((r%200)*13 + (c%150)*7 + (r%200)*(c%150)%11)%40)*5
+offsets = [value(r, c) for r in range(len(firsts)) for c in range(len(seconds))]
+font.addLookup("kern", "gpos_pair", None, (("kern",(("latn",("dflt")),)),))
+font.addKerningClass("kern", "kern-1", tuple(firsts), tuple(seconds), tuple(offsets))
+print("%d by %d kerning classes" % (len(firsts), len(seconds)))
+
+otf = os.path.join(results, "classkern.otf")
+start = time.perf_counter()
+font.generate(otf)
+print("%-28s %8.1f ms" % ("generate OpenType", (time.perf_counter()-start)*1000))
+font.close()
+
+with open(otf, "rb") as f:
+  data = f.read()
+for i in range(struct.unpack(">H", data[4:6])[0]):
+  tag, checksum, offset, length = struct.unpack(">4sLLL", data[12+16*i:28+16*i])
+  if tag==b"GPOS":
+    print("%-28s %8d bytes" % ("GPOS", length))
+font = fontforge.open(otf)
+print("%-28s %8d" % ("kerning subtables", len(font.getLookupSubtables(font.gpos_lookups[0]))))
+font.close()
+shutil.rmtree(results)
@@ -0,0 +1,58 @@
+# Writes a big feature file, of the sort generated for kerning and
+# alternates, for a font with many glyphs, then times applying it to the
+# font. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchfea.py [glyph-count [repeats]]
+
+import os, sys, shutil, tempfile, time
+import fontforge
+
+count = int(sys.argv[1]) if len(sys.argv)>1 else 800
+repeats = int(sys.argv[2]) if len(sys.argv)>2 else 3
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+
+font = fontforge.font()
+font.encoding = "UnicodeBmp"
+names = []
+for i in range(count):
+  glyph = font.createChar(0x4e00+i)
+  pen = glyph.glyphPen()
+  pen.moveTo((100,0)); pen.lineTo((100,700)); pen.lineTo((400,700)); pen.lineTo((400,0))
+  pen.closePath()
+  glyph.width = 500
+  names.append(glyph.glyphname)
+del pen # crash if (auto)destroyed after font.close()
+sfd = os.path.join(results, "fea.sfd")
+font.save(sfd)
+font.close()
+
+fea = os.path.join(results, "big.fea")
+with open(fea, "w") as f:
+  f.write("languagesystem DFLT dflt;\nlanguagesystem latn dflt;\n")
+  f.write("lookup pairs {\n")
+  for i in range(count):
+    for j in range(0, count, 2):
+      f.write("  pos %s %s %d;\n" % (names[i], names[j], -((i*j+i)%97)-1))
+  f.write("} pairs;\n")
+  f.write("lookup alternates {\n")
+  for i in range(count):
+    f.write("  sub %s by %s;\n" % (names[i], names[(i+7)%count]))
+  f.write("} alternates;\n")
+  f.write("lookup contextual {\n")
+  for i in range(count-1):
+    f.write("  sub %s' lookup alternates %s;\n" % (names[i], names[i+1]))
+  f.write("} contextual;\n")
+  f.write("feature kern {\n  lookup pairs;\n} kern;\n")
+  f.write("feature calt {\n  lookup contextual;\n} calt;\n")
+print("%d kerning pairs, %.1f Mb of feature file" % (count*((count+1)//2), os.path.getsize(fea)/1e6))
+
+best = None
+for i in range(repeats):
+  font = fontforge.open(sfd)
+  start = time.perf_counter()
+  font.mergeFeature(fea)
+  took = time.perf_counter()-start
+  font.close()
+  if best is None or took<best:
+    best = took
+print("%-28s %8.1f ms" % ("apply feature file", best*1000))
+shutil.rmtree(results)
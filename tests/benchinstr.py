@@ -0,0 +1,34 @@
+# Times TrueType auto-instruction of a hinted font (DejaVuSerif.sfd by
+# default) on one thread and on several, next to how long generating it as
+# TrueType takes. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchinstr.py [sfd-file [threads [repeats]]]
+
+import os, sys, shutil, tempfile, time
+import fontforge
+
+sfd = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(__file__), "fonts", "DejaVuSerif.sfd")
+threads = int(sys.argv[2]) if len(sys.argv)>2 else 4
+repeats = int(sys.argv[3]) if len(sys.argv)>3 else 3
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+
+def best(what, func):
+  result = None
+  for i in range(repeats):
+    font = fontforge.open(sfd)
+    font.is_quadratic = True
+    font.selection.all()
+    font.autoHint()
+    start = time.perf_counter()
+    func(font)
+    took = time.perf_counter()-start
+    font.close()
+    if result is None or took<result:
+      result = took
+  print("%-36s %8.1f ms" % (what, result*1000))
+
+fontforge.setPrefs("AutoHint", False)
+ttf = os.path.join(results, "bench.ttf")
+best("generate TrueType", lambda font: font.generate(ttf))
+for jobs in (1, threads):
+  best("instruct, %d thread(s)" % jobs, lambda font: font.autoInstr(threads=jobs))
+shutil.rmtree(results)
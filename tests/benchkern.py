@@ -0,0 +1,44 @@
+# Makes a font in which every glyph kerns with every other one, then times
+# writing and reading it back as OpenType (a GPOS pair subtable) and as a
+# UFO (kerning.plist). Not run as part of the testsuite.
+#   fontforge -lang=py -script benchkern.py [glyph-count]
+
+import os, sys, shutil, tempfile, time
+import fontforge
+
+count = int(sys.argv[1]) if len(sys.argv)>1 else 800
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+
+font = fontforge.font()
+font.encoding = "UnicodeBmp"
+font.addLookup("kern", "gpos_pair", None, (("kern",(("latn",("dflt")),)),))
+font.addLookupSubtable("kern", "kern-1")
+names = []
+for i in range(count):
+  glyph = font.createChar(0x4e00+i)
+  pen = glyph.glyphPen()
+  pen.moveTo((100,0)); pen.lineTo((100,700)); pen.lineTo((400+i%100,700)); pen.lineTo((400+i%100,0))
+  pen.closePath()
+  glyph.width = 500
+  names.append(glyph.glyphname)
+del pen # crash if (auto)destroyed after font.close()
+for i, name in enumerate(names):
+  glyph = font[name]
+  for j, other in enumerate(names):
+    glyph.addPosSub("kern-1", other, -((i*j+i)%97))
+print("%d kerning pairs" % (count*count))
+
+def timed(what, func):
+  start = time.perf_counter()
+  result = func()
+  print("%-28s %8.1f ms" % (what, (time.perf_counter()-start)*1000))
+  return result
+
+otf = os.path.join(results, "kern.otf")
+ufo = os.path.join(results, "kern.ufo")
+timed("generate OpenType", lambda: font.generate(otf))
+timed("generate UFO", lambda: font.generate(ufo))
+font.close()
+timed("open OpenType", lambda: fontforge.open(otf)).close()
+timed("open UFO", lambda: fontforge.open(ufo)).close()
+shutil.rmtree(results)
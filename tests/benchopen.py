@@ -0,0 +1,60 @@
+# Times how long it takes to open sfnt fonts. Every font in tests/fonts (or
+# in the directory given as the first argument) which fontforge can read is
+# first generated as a TrueType and an OpenType font, then each of those is
+# opened repeatedly, from the file and from a bytes object, and the best time
+# is reported. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchopen.py [directory [repeats]]
+
+import os, sys, glob, shutil, tempfile, time
+import fontforge
+
+fontdir = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), "fonts")
+repeats = int(sys.argv[2]) if len(sys.argv)>2 else 5
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+
+fontforge.setPrefs("AutoHint", False)
+sfnts = []
+for name in sorted(glob.glob(os.path.join(fontdir, "*"))):
+  base, ext = os.path.splitext(os.path.basename(name))
+  if ext.lower() in (".ttf", ".otf", ".woff"):
+    sfnts.append(name)
+    continue
+  if ext.lower()!=".sfd":
+    continue
+  try:
+    font = fontforge.open(name)
+    for out in ("ttf", "otf"):
+      sfnts.append(os.path.join(results, base + "." + out))
+      font.generate(sfnts[-1])
+    font.close()
+  except EnvironmentError:
+    pass
+
+def best(func):
+  times = []
+  for i in range(repeats):
+    start = time.perf_counter()
+    func()
+    times.append(time.perf_counter()-start)
+  return min(times)
+
+def fromfile(name):
+  fontforge.open(name, ("hidewindow", "fstypepermitted")).close()
+
+def frombytes(data):
+  fontforge.openFromBytes(data, ("hidewindow", "fstypepermitted")).close()
+
+total_file = total_bytes = 0
+for name in sfnts:
+  if not os.path.exists(name):
+    continue
+  with open(name, "rb") as f:
+    data = f.read()
+  t_file = best(lambda: fromfile(name))
+  t_bytes = best(lambda: frombytes(data))
+  total_file += t_file
+  total_bytes += t_bytes
+  print("%-40s %8d bytes  file %8.2f ms  bytes %8.2f ms" % (os.path.basename(name), len(data), t_file*1000, t_bytes*1000))
+print("%d fonts: file %.1f ms, bytes %.1f ms" % (len(sfnts), total_file*1000, total_bytes*1000))
+
+shutil.rmtree(results)
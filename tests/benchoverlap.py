@@ -0,0 +1,44 @@
+# Times remove overlap on glyphs made of more and more contours, to show how
+# it scales. Each glyph is a grid of stroked circles, each of which overlaps
+# its neighbours, much as the strokes of an ideograph or a calligraphic
+# outline do. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchoverlap.py [max-contours [repeats]]
+
+import sys, time
+import fontforge
+
+maxcnt = int(sys.argv[1]) if len(sys.argv)>1 else 1600
+repeats = int(sys.argv[2]) if len(sys.argv)>2 else 3
+
+def ring(x, y):
+  contours = fontforge.layer()
+  outer = fontforge.unitShape(0).transform((30,0,0,30,x,y))
+  inner = fontforge.unitShape(0).transform((20,0,0,20,x,y))
+  inner.reverseDirection()
+  contours += outer
+  contours += inner
+  return contours
+
+def rings(cnt):
+  side = 1
+  while side*side*2<cnt:
+    side += 1
+  layer = fontforge.layer()
+  for i in range(cnt//2):
+    layer += ring((i%side)*45, (i//side)*45)
+  return layer
+
+def best(layer):
+  times = []
+  for i in range(repeats):
+    l = layer.dup()
+    start = time.perf_counter()
+    l.removeOverlap()
+    times.append(time.perf_counter()-start)
+  return min(times)
+
+cnt = 25
+while cnt<=maxcnt:
+  layer = rings(cnt)
+  print("%6d contours %10.1f ms" % (cnt, best(layer)*1000))
+  cnt *= 2
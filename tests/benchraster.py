@@ -0,0 +1,35 @@
+# Times rasterizing every glyph of a font (DejaVuSerif.sfd by default) through
+# FreeType by exporting it as a bitmap, the first time and again, and once a
+# glyph has been changed in between each. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchraster.py [sfd-file [pixelsize]]
+
+import os, shutil, sys, tempfile, time
+import fontforge, psMat
+
+sfd = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(__file__), "fonts", "DejaVuSerif.sfd")
+size = int(sys.argv[2]) if len(sys.argv)>2 else 16
+
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+path = os.path.join(results, "glyph.bmp")
+font = fontforge.open(sfd)
+names = [glyph.glyphname for glyph in font.glyphs() if glyph.isWorthOutputting()]
+
+def timed(what, func):
+  start = time.perf_counter()
+  func()
+  print("%-36s %8.1f ms" % (what, (time.perf_counter()-start)*1000))
+
+def rasterize(change=None):
+  for name in names:
+    if change is not None:
+      change()
+    font[name].export(path, size, 1)
+
+def nudge():
+  font[names[-1]].transform(psMat.translate(0, 1))
+
+timed("%d glyphs, first time" % len(names), rasterize)
+timed("%d glyphs, again" % len(names), rasterize)
+timed("%d glyphs, one changed each time" % len(names), lambda: rasterize(nudge))
+font.close()
+shutil.rmtree(results)
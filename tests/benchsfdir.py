@@ -0,0 +1,55 @@
+# Times saving a font as an sfd directory: first into a new directory, then
+# over itself after changing more and more of its glyphs. Only the glyph
+# files which change get written, so the time of a save should follow the
+# size of the edit. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchsfdir.py [sfd-file [repeats]]
+
+import os, sys, shutil, tempfile, time
+import fontforge
+
+fontfile = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(sys.argv[0]), "fonts", "DejaVuSerif.sfd")
+repeats = int(sys.argv[2]) if len(sys.argv)>2 else 3
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+sfdir = os.path.join(results, "bench.sfdir")
+
+font = fontforge.open(fontfile)
+glyphs = [glyph for glyph in font.glyphs()]
+
+def timed_save():
+  best = None
+  for i in range(repeats):
+    start = time.perf_counter()
+    font.save(sfdir)
+    elapsed = time.perf_counter()-start
+    best = elapsed if best is None else min(best, elapsed)
+  return best
+
+def newer_files(since):
+  count = 0
+  for dirpath, dirnames, filenames in os.walk(sfdir):
+    for name in filenames:
+      if os.stat(os.path.join(dirpath, name)).st_mtime>=since:
+        count += 1
+  return count
+
+start = time.perf_counter()
+font.save(sfdir)
+print("%-24s %8.1f ms" % ("new directory", (time.perf_counter()-start)*1000))
+
+for percent in (0, 1, 10, 100):
+  count = len(glyphs)*percent//100
+  for glyph in glyphs[:count]:
+    glyph.width += 1
+  since = time.time()-1
+  for dirpath, dirnames, filenames in os.walk(sfdir):
+    for name in filenames:
+      os.utime(os.path.join(dirpath, name), (since-100, since-100))
+  start = time.perf_counter()
+  font.save(sfdir)
+  elapsed = time.perf_counter()-start
+  written = newer_files(since)
+  print("%-24s %8.1f ms %6d files written" % ("%d%% (%d) glyphs changed" % (percent, count), elapsed*1000, written))
+print("%-24s %8.1f ms (best of %d)" % ("nothing changed", timed_save()*1000, repeats))
+
+font.close()
+shutil.rmtree(results)
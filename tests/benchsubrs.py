@@ -0,0 +1,35 @@
+# Times generating OpenType (CFF) fonts with and without the "subroutinize"
+# flag, and prints the size of each. Every font is opened afresh for each
+# generate, since generating changes the font a little. Not run as part of
+# the testsuite.
+#   fontforge -lang=py -script benchsubrs.py [directory]
+
+import os, sys, shutil, tempfile, time
+import fontforge
+
+directory = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(sys.argv[0]), "fonts")
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+out = os.path.join(results, "bench.otf")
+
+for name in sorted(os.listdir(directory)):
+  if not name.lower().endswith(".sfd"):
+    continue
+  line = "%-32s" % name
+  for flags in ((), ("subroutinize",)):
+    font = fontforge.open(os.path.join(directory, name))
+    if os.path.exists(out):
+      os.remove(out)
+    start = time.perf_counter()
+    try:
+      font.generate(out, flags=flags)
+    except EnvironmentError:
+      font.close()
+      break
+    elapsed = time.perf_counter()-start
+    font.close()
+    if not os.path.exists(out):
+      break
+    line += " %9d bytes %8.1f ms" % (os.path.getsize(out), elapsed*1000)
+  print(line)
+
+shutil.rmtree(results)
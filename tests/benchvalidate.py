@@ -0,0 +1,59 @@
+# Times validating a font of CJK-like glyphs (2000 by default, each made of
+# overlapping horizontal, vertical and slanted strokes) on one thread and on
+# several, then with a validation cache, first empty and then filled by a
+# run before. Not run as part of the testsuite.
+#   fontforge -lang=py -script benchvalidate.py [glyph-count [threads]]
+
+import os, random, shutil, sys, tempfile, time
+import fontforge
+
+count = int(sys.argv[1]) if len(sys.argv)>1 else 2000
+threads = int(sys.argv[2]) if len(sys.argv)>2 else 4
+
+def stroke(pen, points):
+  pen.moveTo(points[0])
+  for point in points[1:]:
+    pen.lineTo(point)
+  pen.closePath()
+
+def makefont():
+  random.seed(1)
+  font = fontforge.font()
+  font.encoding = "UnicodeBmp"
+  font.em = 1000
+  for i in range(count):
+    glyph = font.createChar(0x4E00+i)
+    pen = glyph.glyphPen()
+    for j in range(random.randint(3, 7)):
+      y = random.randrange(40, 800, 20)
+      x = random.randrange(60, 400, 10)
+      stroke(pen, [(x, y), (x, y+random.choice((50, 60, 70))),
+                   (x+random.randrange(300, 540, 10), y+60), (x+random.randrange(300, 540, 10), y)])
+    for j in range(random.randint(2, 5)):
+      x = random.randrange(80, 860, 20)
+      y = random.randrange(-80, 300, 10)
+      width = random.choice((70, 80, 90))
+      stroke(pen, [(x, y), (x, y+random.randrange(300, 600, 10)), (x+width, y+600), (x+width, y)])
+    if random.random()<.5:
+      x = random.randrange(100, 600, 10)
+      pen.moveTo((x, 100)); pen.curveTo((x+100, 300), (x+250, 500), (x+300, 700))
+      pen.lineTo((x+380, 660)); pen.curveTo((x+300, 400), (x+200, 200), (x+80, 60))
+      pen.closePath()
+    pen = None
+    glyph.width = 1000
+  return font
+
+def timed(what, func):
+  start = time.perf_counter()
+  func()
+  print("%-36s %8.1f ms" % (what, (time.perf_counter()-start)*1000))
+
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+cache = os.path.join(results, "validation.cache")
+font = makefont()
+for jobs in (1, threads):
+  timed("validating, %d thread(s)" % jobs, lambda: font.validate(1, threads=jobs))
+timed("empty cache, %d thread(s)" % threads, lambda: font.validate(1, cache=cache, threads=threads))
+timed("filled cache, %d thread(s)" % threads, lambda: font.validate(1, cache=cache, threads=threads))
+font.close()
+shutil.rmtree(results)
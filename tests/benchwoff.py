@@ -0,0 +1,41 @@
+# Times writing a font (DejaVuSerif.sfd by default) as WOFF and reading it
+# back, on one thread and on several, at zlib's default level and its best.
+# Not run as part of the testsuite.
+#   fontforge -lang=py -script benchwoff.py [sfd-file [threads [repeats]]]
+
+import os, sys, shutil, tempfile, time
+import fontforge
+
+sfd = sys.argv[1] if len(sys.argv)>1 else os.path.join(os.path.dirname(__file__), "fonts", "DejaVuSerif.sfd")
+threads = int(sys.argv[2]) if len(sys.argv)>2 else 4
+repeats = int(sys.argv[3]) if len(sys.argv)>3 else 3
+results = tempfile.mkdtemp('.tmp','fontforge-bench-')
+
+fontforge.setPrefs("AutoHint", False)
+font = fontforge.open(sfd)
+ttf = os.path.join(results, "bench.ttf")
+font.generate(ttf)
+font.close()
+
+def best(what, func):
+  result = None
+  for i in range(repeats):
+    start = time.perf_counter()
+    func()
+    took = time.perf_counter()-start
+    if result is None or took<result:
+      result = took
+  print("%-36s %8.1f ms" % (what, result*1000))
+
+font = fontforge.open(ttf)
+woff = os.path.join(results, "bench.woff")
+for level in (-1, 9):
+  fontforge.setPrefs("WOFFCompressionLevel", level)
+  for jobs in (1, threads):
+    best("write level %d, %d thread(s)" % (level, jobs), lambda: font.generate(woff, threads=jobs))
+  print("%-36s %8d bytes" % ("  size", os.path.getsize(woff)))
+font.close()
+fontforge.setPrefs("WOFFCompressionLevel", -1)
+for jobs in (1, threads):
+  best("read, %d thread(s)" % jobs, lambda: fontforge.open(woff, threads=jobs).close())
+shutil.rmtree(results)
@@ -0,0 +1,22 @@
+#Needs: fonts/Ambrosia.sfd
+#Generating with several threads must give the same bytes as with one
+
+import os, sys, shutil, tempfile, fontforge
+
+os.environ['SOURCE_DATE_EPOCH'] = '1500000000'
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+for ext in ("ttf", "otf"):
+  data = []
+  for threads in (1, 4):
+    # Start afresh each time, generating autohints the font
+    font = fontforge.open(sys.argv[1])
+    out = os.path.join(results, "Threads%d.%s" % (threads, ext))
+    font.generate(out, flags=("opentype", "no-FFTM-table"), threads=threads)
+    font.close()
+    with open(out, "rb") as f:
+      data.append(f.read())
+  if data[0]!=data[1]:
+    raise ValueError("Threaded %s output differs from serial" % ext)
+
+shutil.rmtree(results)
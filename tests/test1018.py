@@ -0,0 +1,31 @@
+#Needs: fonts/Ambrosia.sfd
+#Generating to a bytes object must give the same font as generating to a file
+
+import os, sys, shutil, tempfile, fontforge
+
+os.environ['SOURCE_DATE_EPOCH'] = '1500000000'
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+for ext in ("ttf", "otf", "woff"):
+  # Start afresh each time, generating autohints the font
+  font = fontforge.open(sys.argv[1])
+  out = os.path.join(results, "Generated." + ext)
+  font.generate(out, flags=("opentype", "no-FFTM-table"))
+  font.close()
+  font = fontforge.open(sys.argv[1])
+  data = font.generateToBytes(ext, flags=("opentype", "no-FFTM-table"))
+  font.close()
+  with open(out, "rb") as f:
+    if f.read()!=data:
+      raise ValueError("generateToBytes %s output differs from generate" % ext)
+
+font = fontforge.open(sys.argv[1])
+try:
+  font.generateToBytes("pfb")
+except EnvironmentError:
+  pass
+else:
+  raise ValueError("generateToBytes accepted a non-sfnt format")
+font.close()
+
+shutil.rmtree(results)
@@ -0,0 +1,36 @@
+#Needs: fonts/Ambrosia.sfd
+#Opening a font from bytes must give the same font as opening the file
+
+import os, sys, shutil, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+for ext in ("ttf", "otf", "woff"):
+  font = fontforge.open(sys.argv[1])
+  out = os.path.join(results, "Ambrosia." + ext)
+  font.generate(out)
+  font.close()
+  with open(out, "rb") as f:
+    data = f.read()
+  fromfile = fontforge.open(out)
+  frombytes = fontforge.openFromBytes(data)
+  if frombytes.path is not None:
+    raise ValueError("A font opened from bytes should have no file")
+  if fromfile.fontname!=frombytes.fontname or len(fromfile)!=len(frombytes):
+    raise ValueError("Opening %s from bytes gives a different font" % ext)
+  for glyph in fromfile.glyphs():
+    other = frombytes[glyph.glyphname]
+    if glyph.width!=other.width or glyph.unicode!=other.unicode or \
+	glyph.foreground!=other.foreground:
+      raise ValueError("Glyph %s differs when %s is opened from bytes" % (glyph.glyphname, ext))
+  fromfile.close()
+  frombytes.close()
+
+try:
+  fontforge.openFromBytes(b"This is not a font")
+except EnvironmentError:
+  pass
+else:
+  raise ValueError("openFromBytes accepted garbage")
+
+shutil.rmtree(results)
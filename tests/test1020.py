@@ -0,0 +1,49 @@
+#Needs: fonts/Ambrosia.sfd
+#A font opened lazily must give the same glyphs as one opened normally
+
+import os, sys, shutil, tempfile, filecmp, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+sfd = os.path.join(results, "Ambrosia.sfd")
+ttf = os.path.join(results, "Ambrosia.ttf")
+shutil.copy(sys.argv[1], sfd)
+font = fontforge.open(sfd)
+font.generate(ttf)
+font.close()
+
+def glyphdata(font):
+  data = {}
+  for name in font:
+    glyph = font[name]
+    data[name] = (glyph.unicode, glyph.width, glyph.references,
+		  glyph.foreground, glyph.background, glyph.ttinstrs)
+  return data
+
+for path in (sfd, ttf):
+  font = fontforge.open(path)
+  eager = glyphdata(font)
+  font.close()
+  font = fontforge.open(path, lazy=True)
+  if font.fontname!="Ambrosia":
+    raise ValueError("Wrong font name for lazy %s" % path)
+  if glyphdata(font)!=eager:
+    raise ValueError("Lazily opened %s has different glyphs" % path)
+  font.close()
+
+# Whole font operations read everything in first
+for lazy in (False, True):
+  font = fontforge.open(sfd, lazy=lazy)
+  font.generate(os.path.join(results, "lazy%d.otf" % lazy))
+  font.save(os.path.join(results, "lazy%d.sfd" % lazy))
+  font.close()
+if not filecmp.cmp(os.path.join(results, "lazy0.otf"), os.path.join(results, "lazy1.otf"), False):
+  raise ValueError("A lazily opened font generates differently")
+saved = []
+for lazy in (False, True):
+  font = fontforge.open(os.path.join(results, "lazy%d.sfd" % lazy))
+  saved.append(glyphdata(font))
+  font.close()
+if saved[0]!=saved[1]:
+  raise ValueError("A lazily opened font saves differently")
+
+shutil.rmtree(results)
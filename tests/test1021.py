@@ -0,0 +1,33 @@
+#Needs: fonts/OverlapBugs.sfd
+#Outline operations on many threads must give the same glyphs as on one
+
+import sys, fontforge
+
+def outlines(font):
+  return dict((name, font[name].foreground) for name in font)
+
+def run(threads, op):
+  font = fontforge.open(sys.argv[1])
+  font.selection.all()
+  op(font, threads)
+  result = outlines(font)
+  font.close()
+  return result
+
+ops = (lambda f, t: f.removeOverlap(threads=t),
+       lambda f, t: f.intersect(threads=t),
+       lambda f, t: f.addExtrema(threads=t),
+       lambda f, t: f.simplify(1, ("mergelines",), threads=t))
+
+for op in ops:
+  serial = run(1, op)
+  if run(4, op)!=serial or run(0, op)!=serial:
+    raise ValueError("Threaded outline operation gave different glyphs")
+
+font = fontforge.open(sys.argv[1])
+try:
+  font.removeOverlap(threads=-2)
+  raise AssertionError("Negative thread count accepted")
+except ValueError:
+  pass
+font.close()
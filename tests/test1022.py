@@ -0,0 +1,45 @@
+#Needs: fonts/Ambrosia.sfd
+#Glyph name lookups must follow glyphs as they are renamed, added and removed
+
+import sys, fontforge
+
+font = fontforge.open(sys.argv[1])
+
+def check(font):
+  for glyph in font.glyphs():
+    if font[glyph.glyphname] is None or font[glyph.glyphname].glyphname!=glyph.glyphname:
+      raise ValueError("Lookup of %s failed" % glyph.glyphname)
+
+check(font)
+
+# Rename every glyph, then rename them back
+names = [g.glyphname for g in font.glyphs()]
+for name in names:
+  font[name].glyphname = "renamed_" + name
+for name in names:
+  if name in font:
+    raise ValueError("Old name %s still found" % name)
+  font["renamed_" + name].glyphname = name
+check(font)
+
+# Enough new glyphs to make the table grow several times
+for i in range(2000):
+  font.createChar(-1, "extra%d" % i)
+check(font)
+for i in range(0, 2000, 2):
+  font.removeGlyph("extra%d" % i)
+for i in range(2000):
+  if (("extra%d" % i) in font)!=(i%2==1):
+    raise ValueError("Lookup of extra%d wrong after removal" % i)
+check(font)
+
+# A glyph given the name of another is found under that name, and the
+# original is found again once the duplicate goes away
+first = names[0]
+extra = font["extra1"]
+extra.glyphname = first
+extra.glyphname = "extra1"
+if font[first].glyphname!=first or "extra1" not in font:
+  raise ValueError("Lookup wrong after a duplicate name went away")
+check(font)
+font.close()
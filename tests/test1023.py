@@ -0,0 +1,48 @@
+#Needs: fonts/Ambrosia.sfd
+#Lookups by code point must follow glyphs as their unicode values change
+
+import sys, fontforge
+
+font = fontforge.open(sys.argv[1])
+font.encoding = "compacted"
+
+def has(glyph, uni):
+  return glyph.unicode==uni or any(alt[0]==uni for alt in (glyph.altuni or ()))
+
+def check(font, unis):
+  for uni in unis:
+    exists = any(has(glyph, uni) for glyph in font.glyphs())
+    slot = font.findEncodingSlot(uni)
+    if (slot!=-1)!=exists:
+      raise ValueError("U+%04X is%s found" % (uni, "" if exists else " not"))
+    if exists and not has(font[slot], uni):
+      raise ValueError("U+%04X found %s" % (uni, font[slot].glyphname))
+
+unis = [g.unicode for g in font.glyphs() if g.unicode!=-1] + [0x4E00, 0xE123]
+check(font, unis)
+
+# Move a code point from one glyph to another
+a = font["A"]
+a.unicode = 0x4E00
+check(font, unis)
+a.unicode = ord("A")
+
+# Alternate unicodes are found too, and stop being found when removed
+font["B"].altuni = ((0xE123, -1, 0),)
+check(font, unis)
+font["B"].altuni = None
+check(font, unis)
+
+# New glyphs, some of them removed again
+for i in range(500):
+  font.createChar(0xF0000+i, "extra%d" % i)
+for i in range(0, 500, 2):
+  font.removeGlyph("extra%d" % i)
+for i in range(500):
+  slot = font.findEncodingSlot(0xF0000+i)
+  if i%2==0 and slot!=-1:
+    raise ValueError("Removed glyph extra%d still found" % i)
+  if i%2==1 and (slot==-1 or font[slot].glyphname!="extra%d" % i):
+    raise ValueError("Glyph extra%d not found" % i)
+check(font, unis)
+font.close()
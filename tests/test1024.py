@@ -0,0 +1,29 @@
+#Needs: fonts/Ambrosia.sfd
+#Subroutinizing Type2 charstrings must not change the outlines nor grow the font
+
+import os, sys, shutil, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+def outlines(font):
+  return dict((g.glyphname, (g.width, [[(p.x,p.y,p.on_curve) for p in c] for c in g.foreground]))
+              for g in font.glyphs())
+
+# Generating changes the font a little, so start afresh each time
+sizes = []
+for flags in ((), ("subroutinize",)):
+  font = fontforge.open(sys.argv[1])
+  font.generate(os.path.join(results, "subrs%d.otf" % len(flags)), flags=flags)
+  font.close()
+  sizes.append(os.path.getsize(os.path.join(results, "subrs%d.otf" % len(flags))))
+if sizes[1]>sizes[0]:
+  raise ValueError("Subroutinized font is bigger: %d > %d" % (sizes[1], sizes[0]))
+
+plain = fontforge.open(os.path.join(results, "subrs0.otf"))
+subr = fontforge.open(os.path.join(results, "subrs1.otf"))
+if outlines(plain)!=outlines(subr):
+  raise ValueError("Subroutinizing changed the outlines")
+plain.close()
+subr.close()
+
+shutil.rmtree(results)
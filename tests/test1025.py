@@ -0,0 +1,36 @@
+#Needs: fonts/Ambrosia.sfd
+#Reading a UFO on several threads must give the same font as on one
+
+import os, sys, shutil, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+ufo = os.path.join(results, "Ambrosia.ufo")
+
+font = fontforge.open(sys.argv[1])
+font.addLookup("marks", "gpos_mark2base", (), (("mark",(("latn",("dflt",)),)),))
+font.addLookupSubtable("marks", "marks-1")
+for name in ("top", "bottom"):
+  font.addAnchorClass("marks-1", name)
+for i, glyph in enumerate(font.glyphs()):
+  glyph.addAnchorPoint(("top", "bottom")[i%2], "base", glyph.width/2, i)
+font.generate(ufo)
+font.close()
+
+def contents(threads):
+  font = fontforge.open(ufo, threads=threads)
+  result = []
+  for glyph in font.glyphs("encoding"):
+    result.append((glyph.glyphname, glyph.unicode, glyph.width,
+                   [[(p.x,p.y,p.on_curve) for p in c] for c in glyph.foreground],
+                   glyph.references, glyph.anchorPoints, glyph.hhints,
+                   glyph.vhints, glyph.persistent))
+  font.close()
+  return result
+
+serial = contents(1)
+if not any(glyph[5] for glyph in serial) or not any(glyph[8] for glyph in serial):
+  raise ValueError("Anchors or glyph lib data lost")
+if contents(4)!=serial or contents(0)!=serial:
+  raise ValueError("Reading a UFO on several threads gave a different font")
+
+shutil.rmtree(results)
@@ -0,0 +1,184 @@
+#Needs: fonts/Ambrosia.sfd
+#Saving over a UFO or an sfd directory only rewrites the files which change,
+# and what it rewrites keeps its permissions
+
+import os, sys, shutil, filecmp, stat, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+# Backdate everything, so any file written from here on stands out
+def backdate(top):
+  for dirpath, dirnames, filenames in os.walk(top):
+    for name in filenames:
+      os.utime(os.path.join(dirpath, name), (1000000000, 1000000000))
+
+def files(top):
+  result = {}
+  for dirpath, dirnames, filenames in os.walk(top):
+    for name in filenames:
+      path = os.path.join(dirpath, name)
+      result[os.path.relpath(path, top)] = os.stat(path).st_mtime
+  return result
+
+def rewritten(before, after):
+  return sorted(name for name in after if before.get(name)!=after[name])
+
+def mode(path):
+  return stat.S_IMODE(os.stat(path).st_mode)
+
+# UFO
+ufo = os.path.join(results, "Ambrosia.ufo")
+fresh = os.path.join(results, "Fresh.ufo")
+
+font = fontforge.open(sys.argv[1])
+font.generate(ufo)
+font.close()
+# Not every glif reads back to exactly what was written (points get
+#  categorized, for one), so the first save over it may bring a few up to date
+font = fontforge.open(ufo)
+font.generate(ufo)
+font.close()
+
+backdate(ufo)
+with open(os.path.join(ufo, "glyphs", "stale.glif"), "w") as stale:
+  stale.write("<glyph/>\n")
+os.mkdir(os.path.join(ufo, "glyphs.stale"))
+before = files(ufo)
+
+font = fontforge.open(ufo)
+font.generate(ufo)
+after = files(ufo)
+# Reading fills in a few things fontinfo.plist didn't say
+if rewritten(before, after)!=["fontinfo.plist"]:
+  raise ValueError("Saving an unchanged font rewrote %s" % rewritten(before, after))
+if os.path.exists(os.path.join(ufo, "glyphs", "stale.glif")) or \
+   os.path.exists(os.path.join(ufo, "glyphs.stale")):
+  raise ValueError("Files which don't belong to the font were left behind")
+
+backdate(ufo)
+before = files(ufo)
+font["A"].width += 10
+font.generate(ufo)
+after = files(ufo)
+if rewritten(before, after)!=[os.path.join("glyphs", "A_.glif")]:
+  raise ValueError("Changing A rewrote %s" % rewritten(before, after))
+
+backdate(ufo)
+before = files(ufo)
+font.removeGlyph("B")
+font.generate(ufo)
+after = files(ufo)
+if os.path.join("glyphs", "B_.glif") in after:
+  raise ValueError("The file of a removed glyph was left behind")
+# (B is in the glyph classes of the feature file)
+if rewritten(before, after)!=["features.fea", os.path.join("glyphs", "contents.plist")]:
+  raise ValueError("Removing B rewrote %s" % rewritten(before, after))
+
+# Something other than us changed a glyph file; saving should put it right
+with open(os.path.join(ufo, "glyphs", "C_.glif"), "w") as glif:
+  glif.write("<glyph/>\n")
+font.generate(ufo)
+font.generate(fresh)
+font.close()
+# The glyphs we didn't touch keep the files they were read from (which
+#  needn't be exactly what we would write), the rest must match
+comparison = filecmp.dircmp(os.path.join(ufo, "glyphs"), os.path.join(fresh, "glyphs"))
+if comparison.left_only or comparison.right_only:
+  raise ValueError("Saving in place gave different glyph files than saving afresh")
+if not filecmp.cmp(os.path.join(ufo, "glyphs", "C_.glif"), os.path.join(fresh, "glyphs", "C_.glif"), False) or \
+   not filecmp.cmp(os.path.join(ufo, "glyphs", "A_.glif"), os.path.join(fresh, "glyphs", "A_.glif"), False):
+  raise ValueError("A glyph file was not brought up to date")
+
+# sfd directory
+sfdir = os.path.join(results, "Ambrosia.sfdir")
+fresh = os.path.join(results, "Fresh.sfdir")
+
+font = fontforge.open(sys.argv[1])
+font.save(sfdir)
+
+backdate(sfdir)
+with open(os.path.join(sfdir, "stale.glyph"), "w") as stale:
+  stale.write("StartChar: stale\nEndChar\n")
+with open(os.path.join(sfdir, "README"), "w") as readme:
+  readme.write("Not ours\n")
+before = files(sfdir)
+font.save(sfdir)
+after = files(sfdir)
+if rewritten(before, after):
+  raise ValueError("Saving an unchanged font rewrote %s" % rewritten(before, after))
+if "stale.glyph" in after:
+  raise ValueError("The file of a glyph the font doesn't have was left behind")
+if "README" not in after:
+  raise ValueError("A file which isn't ours was removed")
+
+backdate(sfdir)
+os.chmod(os.path.join(sfdir, "lozenge.glyph"), 0o640)
+before = files(sfdir)
+font["lozenge"].comment = "Changed"
+font.save(sfdir)
+after = files(sfdir)
+if rewritten(before, after)!=["lozenge.glyph"]:
+  raise ValueError("Changing lozenge rewrote %s" % rewritten(before, after))
+if mode(os.path.join(sfdir, "lozenge.glyph"))!=0o640:
+  raise ValueError("Rewriting lozenge changed its mode to %o" % mode(os.path.join(sfdir, "lozenge.glyph")))
+
+# A file changed behind our back is put right, even though we know what we
+#  wrote there
+with open(os.path.join(sfdir, "lozenge.glyph"), "r+b") as glyph:
+  data = glyph.read()
+  glyph.seek(0)
+  glyph.write(data.replace(b"Changed", b"Chang3d"))
+font.save(sfdir)
+with open(os.path.join(sfdir, "lozenge.glyph"), "rb") as glyph:
+  if glyph.read()!=data:
+    raise ValueError("Saving again didn't undo a change made to lozenge's file")
+
+# A file which can't be replaced leaves nothing behind
+os.remove(os.path.join(sfdir, "_A.glyph"))
+os.mkdir(os.path.join(sfdir, "_A.glyph"))
+font["A"].comment = "Changed"
+try:
+  font.save(sfdir)
+except EnvironmentError:
+  pass
+if [name for name in os.listdir(sfdir) if name.startswith("_A.glyph.")]:
+  raise ValueError("A failed rewrite left its temporary file behind")
+os.rmdir(os.path.join(sfdir, "_A.glyph"))
+
+backdate(sfdir)
+before = files(sfdir)
+font.removeGlyph("B")
+font.save(sfdir)
+after = files(sfdir)
+if "_B.glyph" in after or os.path.join("12.strike", "_B.bitmap") in after:
+  raise ValueError("The files of a removed glyph were left behind")
+
+# Nor does saving what was read from the directory. Not everything reads
+#  back to exactly what was written, so the first save may bring a few files
+#  up to date
+font.close()
+font = fontforge.open(sfdir)
+font.save(sfdir)
+font.close()
+font = fontforge.open(sfdir)
+backdate(sfdir)
+before = files(sfdir)
+font.save(sfdir)
+after = files(sfdir)
+# A's background image comes out differently each time it is read
+if [name for name in rewritten(before, after) if name!="_A.glyph"]:
+  raise ValueError("Saving an sfd directory as it was read rewrote %s" % rewritten(before, after))
+
+# And what was saved in place is what a save afresh would give
+font.save(fresh)
+font.close()
+for name in files(sfdir):
+  if name=="README":
+    continue
+  with open(os.path.join(sfdir, name), "rb") as a, open(os.path.join(fresh, name), "rb") as b:
+    if a.read()!=b.read():
+      raise ValueError("Saving in place gave a different %s than saving afresh" % name)
+if len(files(sfdir))!=len(files(fresh))+1:
+  raise ValueError("Saving in place gave different files than saving afresh")
+
+shutil.rmtree(results)
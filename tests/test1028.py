@@ -0,0 +1,73 @@
+#Needs: fonts/Ambrosia.sfd
+#The bounds of a glyph follow every change to its outlines
+
+import sys, fontforge, psMat
+
+font = fontforge.open(sys.argv[1])
+
+scratch = font.createChar(-1, "scratch")
+
+# Build the same outlines afresh in another glyph, whose bounds can't have
+#  been worked out before
+def check(glyph, what):
+  scratch.clear()
+  scratch.foreground = glyph.foreground
+  for ref in glyph.references:
+    scratch.addReference(ref[0], ref[1])
+  expected = scratch.boundingBox()
+  # Ask twice, the second answer may come from what the first worked out
+  for i in range(2):
+    got = glyph.boundingBox()
+    if any(abs(g-e)>.001 for g, e in zip(got, expected)):
+      raise ValueError("%s: bounds of %s are %s, not %s" % (what, glyph.glyphname, got, expected))
+
+A = font["A"]
+check(A, "As read")
+original = A.boundingBox()
+
+A.transform(psMat.translate(100, 50))
+check(A, "After a transform")
+if A.boundingBox()==original:
+  raise ValueError("Moving A didn't move its bounds")
+
+layer = A.foreground
+layer.transform(psMat.scale(2))
+A.foreground = layer
+check(A, "After setting the layer")
+
+A.left_side_bearing = 0
+check(A, "After setting the left side bearing")
+A.round()
+check(A, "After rounding")
+
+A.foreground = fontforge.layer()
+if A.boundingBox()!=(0,0,0,0):
+  raise ValueError("A glyph without outlines has bounds %s" % (A.boundingBox(),))
+
+# A contour of a single point has no splines
+dot = fontforge.contour()
+dot.moveTo(700, -40)
+layer = fontforge.layer()
+layer += dot
+A.foreground = layer
+check(A, "With a single point")
+A.transform(psMat.translate(-30, 20))
+check(A, "After moving a single point")
+layer += font["B"].foreground
+A.foreground = layer
+check(A, "With a single point and splines")
+A.transform(psMat.scale(0.5))
+check(A, "After scaling a single point and splines")
+
+C = font.createChar(-1, "BB")
+C.addReference("B", psMat.translate(0, 300))
+check(C, "Made of references")
+
+for glyph in font.glyphs():
+  glyph.boundingBox()
+font.transform(psMat.rotate(0.3))
+for glyph in list(font.glyphs()):
+  if glyph!=scratch and not glyph.references:
+    check(glyph, "After rotating the font")
+
+font.close()
@@ -0,0 +1,102 @@
+#Kerning pairs survive a round trip through GPOS and through kerning.plist
+
+import os, shutil, plistlib, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+count = 30
+font = fontforge.font()
+font.encoding = "UnicodeBmp"
+font.addLookup("kern", "gpos_pair", None, (("kern",(("latn",("dflt")),)),))
+font.addLookupSubtable("kern", "kern-1")
+names = []
+for i in range(count):
+  glyph = font.createChar(0x41+i)
+  glyph.width = 500
+  names.append(glyph.glyphname)
+
+# Every third glyph shares its kerning with the one before it, which GPOS
+#  output stores once
+expected = {}
+for i, name in enumerate(names):
+  for j, other in enumerate(names):
+    off = -(((i//3)*j+i//3)%41)-1
+    if (i+j)%5!=0:
+      font[name].addPosSub("kern-1", other, off)
+      expected[(name, other)] = off
+
+def pairs(font):
+  result = {}
+  for glyph in font.glyphs():
+    for pst in glyph.getPosSub("*"):
+      if pst[1]=="Pair":
+        if (glyph.glyphname, pst[2]) in result:
+          raise ValueError("Pair %s %s kerned twice" % (glyph.glyphname, pst[2]))
+        result[(glyph.glyphname, pst[2])] = pst[5]
+  return result
+
+if pairs(font)!=expected:
+  raise ValueError("Kerning pairs were not added as asked")
+
+otf = os.path.join(results, "Kern.otf")
+font.generate(otf)
+font.close()
+font = fontforge.open(otf)
+if pairs(font)!=expected:
+  raise ValueError("Kerning pairs changed going through GPOS")
+font.close()
+
+# The same pairs, this time read from and written to kerning.plist
+ufo = os.path.join(results, "Kern.ufo")
+font = fontforge.open(otf)
+font.generate(ufo)
+font.close()
+kerning = {}
+for (first, second), off in expected.items():
+  kerning.setdefault(first, {})[second] = off
+with open(os.path.join(ufo, "kerning.plist"), "wb") as plist:
+  plistlib.dump(kerning, plist)
+with open(os.path.join(ufo, "features.fea"), "w") as fea:
+  fea.write("")
+font = fontforge.open(ufo)
+if pairs(font)!=expected:
+  raise ValueError("Kerning pairs changed going through kerning.plist")
+font.generate(ufo)
+font.close()
+with open(os.path.join(ufo, "kerning.plist"), "rb") as plist:
+  if plistlib.load(plist)!=kerning:
+    raise ValueError("kerning.plist changed going through FontForge")
+
+# A justification lookup repeating a pair GPOS already kerned gives the
+#  glyph a positioning pair, not a second kern pair
+font = fontforge.font()
+font.encoding = "UnicodeBmp"
+for c in "AV":
+  font.createChar(ord(c)).width = 500
+font.addLookup("kern", "gpos_pair", None, (("kern",(("latn",("dflt")),)),))
+font.addLookupSubtable("kern", "kern-1")
+font["A"].addPosSub("kern-1", "V", -50)
+font.addLookup("extend", "gpos_pair", None, ())
+font.addLookupSubtable("extend", "extend-1")
+font["A"].addPosSub("extend-1", "V", -50)
+sfd = os.path.join(results, "Jstf.sfd")
+font.save(sfd)
+font.close()
+with open(sfd) as f:
+  text = f.read()
+with open(sfd, "w") as f:
+  f.write(text.replace("BeginChars:", "Justify: 'latn'\nJstfLang: 'dflt' 1\nJstfPrio:\nJstfMaxExtend: \"extend\"\nEndJustify\nBeginChars:", 1))
+font = fontforge.open(sfd)
+otf = os.path.join(results, "Jstf.otf")
+font.generate(otf)
+font.close()
+font = fontforge.open(otf)
+font.save(sfd)
+font.close()
+with open(sfd) as f:
+  kerns = [line for line in f if line.startswith("Kerns2:")]
+# (one quoted subtable name per pair)
+if len(kerns)!=1 or kerns[0].count('"')!=2:
+  raise ValueError("A kerns V as %s" % kerns)
+
+shutil.rmtree(results)
@@ -0,0 +1,71 @@
+#Class kerning survives GPOS, where repeated classes are stored once and a
+# matrix too big for one subtable is split over several
+
+import os, shutil, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+font = fontforge.font()
+font.encoding = "UnicodeBmp"
+for i in range(0x100, 0x100+800):
+  glyph = font.createChar(i)
+  glyph.width = 500
+names = [glyph.glyphname for glyph in font.glyphs()]
+
+# Every fourth row kerns like the one before it, every fifth column kerns
+#  like the one before it, a few columns kern nothing and there is a row
+#  whose glyph isn't in the font. At 2 bytes a value there are more than
+#  64k bytes of them
+lefts = names[:500]
+rights = names[500:]
+firsts = [None] + [(name,) for name in lefts] + [("nosuchglyph",)]
+seconds = [None] + [(rights[j],rights[j+1]) for j in range(0,len(rights)-1,2)]
+def value(r, c):
+  if c==0 or r==0 or c%7==3:
+    return 0
+  r -= (r%4==0)
+  c -= (c%5==0)
+  return -((r*37+c*11+(r*c)%97)%500)-1
+offsets = [value(r, c) for r in range(len(firsts)) for c in range(len(seconds))]
+
+def classes(font):
+  result = []
+  for lookup in font.gpos_lookups:
+    for sub in font.getLookupSubtables(lookup):
+      if font.isKerningClass(sub):
+        result.append(font.getKerningClass(sub))
+  return result
+
+# What the first subtable whose coverage holds the first glyph says
+def check(kerning, what):
+  indexed = []
+  for f, s, o in kerning:
+    rows = dict((name, r) for r in range(len(f)) if f[r] is not None for name in f[r])
+    cols = dict((name, c) for c in range(1, len(s)) if s[c] is not None for name in s[c])
+    indexed.append((rows, cols, len(s), o))
+  for i, left in enumerate(lefts):
+    for j, right in enumerate(rights):
+      expected = value(i+1, j//2+1) if j//2+1<len(seconds) else 0
+      got = 0
+      for rows, cols, width, o in indexed:
+        if left in rows:
+          got = o[rows[left]*width+cols.get(right, 0)]
+          break
+      if got!=expected:
+        raise ValueError("%s: %s %s kern by %d, not %d" % (what, left, right, got, expected))
+
+font.addLookup("kern", "gpos_pair", None, (("kern",(("latn",("dflt")),)),))
+font.addKerningClass("kern", "kern-1", tuple(firsts), tuple(seconds), tuple(offsets))
+check(classes(font), "As made")
+
+otf = os.path.join(results, "ClassKern.otf")
+font.generate(otf)
+font.close()
+font = fontforge.open(otf)
+kerning = classes(font)
+if len(kerning)<2:
+  raise ValueError("The kerning classes should need more than one subtable")
+check(kerning, "Read back")
+font.close()
+
+shutil.rmtree(results)
@@ -0,0 +1,64 @@
+#Kerning and substitutions from a feature file land where they did before:
+# in file order, once each, and in the subtables the file asked for
+
+import os, shutil, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+font = fontforge.font()
+font.encoding = "UnicodeBmp"
+names = []
+for i in range(20):
+  glyph = font.createChar(0x41+i)
+  glyph.width = 500
+  names.append(glyph.glyphname)
+
+# Pairs of different first glyphs come interleaved, the last pair of the
+#  first subtable is there twice, and the second subtable repeats a pair of
+#  the first
+first = [(names[i%5], names[j], -(i*7+j)%50-1) for i in range(15) for j in range(5, 20, 2) if (i//5)==(j%3)]
+second = [(names[0], names[7], -99), (names[1], names[5], -98)]
+fea = os.path.join(results, "Kern.fea")
+with open(fea, "w") as f:
+  f.write("languagesystem DFLT dflt;\n")
+  f.write("lookup kerning {\n")
+  for l, r, v in first:
+    f.write("  pos %s %s %d;\n" % (l, r, v))
+  f.write("  pos %s %s %d;\n" % first[-1])
+  f.write("  subtable;\n")
+  for l, r, v in second:
+    f.write("  pos %s %s %d;\n" % (l, r, v))
+  f.write("} kerning;\n")
+  f.write("lookup swaps {\n")
+  for i in range(5):
+    f.write("  sub %s by %s;\n" % (names[i], names[19-i]))
+  f.write("} swaps;\n")
+  f.write("@left = [%s %s];\n@right = [%s %s];\n" % (names[10], names[11], names[15], names[16]))
+  f.write("lookup classes {\n  pos @left @right -40;\n} classes;\n")
+  f.write("feature kern {\n  lookup kerning;\n  lookup classes;\n} kern;\n")
+  f.write("feature salt {\n  lookup swaps;\n} salt;\n")
+font.mergeFeature(fea)
+
+subtables = font.getLookupSubtables("kerning")
+if len(subtables)!=2:
+  raise ValueError("Expected 2 kerning subtables, not %d" % len(subtables))
+for sub, pairs in zip(subtables, (first, second)):
+  expected = {}
+  for l, r, v in pairs:
+    expected.setdefault(l, []).append((r, v))
+  for name in names:
+    got = [(pst[2], pst[5]) for pst in font[name].getPosSub(sub)]
+    if got!=expected.get(name, []):
+      raise ValueError("%s in %s kerns %s, not %s" % (name, sub, got, expected.get(name, [])))
+
+for i in range(5):
+  got = font[names[i]].getPosSub(font.getLookupSubtables("swaps")[0])
+  if len(got)!=1 or got[0][2]!=names[19-i]:
+    raise ValueError("%s substitutes %s" % (names[i], got))
+
+classes = font.getKerningClass(font.getLookupSubtables("classes")[0])
+if classes[2][-1]!=-40:
+  raise ValueError("Class kerning is %s" % (classes,))
+
+font.close()
+shutil.rmtree(results)
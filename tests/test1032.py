@@ -0,0 +1,69 @@
+#Needs: fonts/Ambrosia.sfd
+#WOFF tables compressed on several threads and at different zlib levels come
+# out the same as zlib makes them, and read back the same
+
+import os, sys, shutil, struct, tempfile, zlib, fontforge
+
+# The same time in each file, so only what the compression did can differ
+os.environ["SOURCE_DATE_EPOCH"] = "1500000000"
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+
+# A font's CFF table may change from one generate to the next, so each file
+#  is made from the font as read
+def generate(filename, threads=1):
+  font = fontforge.open(sys.argv[1])
+  font.generate(filename, threads=threads)
+  font.close()
+
+def contents(filename):
+  with open(filename, "rb") as f:
+    return f.read()
+
+# Each table is zlib's compression of the sfnt table at the given level,
+#  or the table as is when that isn't any smaller
+def check(woff, level, what):
+  data = contents(woff)
+  signature, flavour, length, numTables = struct.unpack(">4sIIH", data[:14])
+  if signature!=b"wOFF" or length!=len(data):
+    raise ValueError("%s: not a WOFF file" % what)
+  for i in range(numTables):
+    tag, offset, compLen, origLen, checksum = struct.unpack(">4sIIII", data[44+20*i:64+20*i])
+    table = data[offset:offset+compLen]
+    if compLen<origLen:
+      if table!=zlib.compress(zlib.decompress(table), level):
+        raise ValueError("%s: '%s' was not compressed at level %d" % (what, tag.decode(), level))
+      table = zlib.decompress(table)
+    elif compLen!=origLen or len(zlib.compress(table, level))<origLen:
+      raise ValueError("%s: '%s' should have been compressed" % (what, tag.decode()))
+    if len(table)!=origLen:
+      raise ValueError("%s: '%s' is %d bytes, not %d" % (what, tag.decode(), len(table), origLen))
+
+woffs = {}
+for level in (-1, 0, 9):
+  fontforge.setPrefs("WOFFCompressionLevel", level)
+  for threads in (1, 4):
+    woff = os.path.join(results, "Ambrosia%d-%d.woff" % (level, threads))
+    generate(woff, threads)
+    if threads!=1 and contents(woff)!=contents(woffs[level]):
+      raise ValueError("Level %d: the WOFF file changed with %d threads" % (level, threads))
+    woffs[level] = woff
+  check(woffs[level], level, "Level %d" % level)
+fontforge.setPrefs("WOFFCompressionLevel", -1)
+if not os.path.getsize(woffs[9])<=os.path.getsize(woffs[-1])<os.path.getsize(woffs[0]):
+  raise ValueError("The WOFF files are not sized as their levels")
+
+# Whatever the level and however many threads read it, the font is the same
+back = None
+for level, woff in sorted(woffs.items()):
+  for threads in (1, 4):
+    font = fontforge.open(woff, threads=threads)
+    out = os.path.join(results, "Back%d-%d.otf" % (level, threads))
+    font.generate(out)
+    font.close()
+    if back is None:
+      back = contents(out)
+    elif contents(out)!=back:
+      raise ValueError("Level %d: reading the WOFF file on %d threads changed the font" % (level, threads))
+
+shutil.rmtree(results)
@@ -0,0 +1,50 @@
+#Needs: fonts/Ambrosia.sfd
+#Autohinting a whole font on several threads finds the hints it finds on
+# one, and glyphs whose outlines haven't changed are given the same hints
+# again
+
+import sys, fontforge, psMat
+
+def hints(font):
+  return dict((glyph.glyphname, (glyph.hhints, glyph.vhints, glyph.dhints))
+              for glyph in font.glyphs())
+
+font = fontforge.open(sys.argv[1])
+font.selection.all()
+font.autoHint(threads=1)
+serial = hints(font)
+font.close()
+
+font = fontforge.open(sys.argv[1])
+font.selection.all()
+font.autoHint(threads=4)
+parallel = hints(font)
+for name in serial:
+  if serial[name]!=parallel[name]:
+    raise ValueError("Hints of %s changed with 4 threads" % name)
+
+# Moving a glyph there and back leaves its outlines as they were, so its
+#  stems may come from what was found last time
+for glyph in font.glyphs():
+  glyph.transform(psMat.translate(0, 100))
+  glyph.transform(psMat.translate(0, -100))
+font.autoHint(threads=4)
+if hints(font)!=serial:
+  raise ValueError("Hinting the same outlines again gave other hints")
+
+# But a glyph which really changed must be hinted afresh
+H = font["H"]
+H.transform(psMat.scale(1, 1.5))
+font.autoHint(threads=4)
+if H.hhints==serial["H"][0]:
+  raise ValueError("H was stretched but kept its old horizontal hints")
+stretched = H.hhints
+font.close()
+
+font = fontforge.open(sys.argv[1])
+font["H"].transform(psMat.scale(1, 1.5))
+font.selection.select("H")
+font.autoHint()
+if font["H"].hhints!=stretched:
+  raise ValueError("A changed H got %s, not %s" % (stretched, font["H"].hhints))
+font.close()
@@ -0,0 +1,39 @@
+#Needs: fonts/DejaVuSerif.sfd
+#Instructing a font on several threads gives the instructions and cvt that
+# instructing it on one does, even when diagonal stems add to the cvt
+
+import sys, fontforge
+
+def instruct(threads):
+  font = fontforge.open(sys.argv[1])
+  font.is_quadratic = True
+  font.selection.all()
+  font.autoHint()
+  font.autoInstr(threads=threads)
+  result = (tuple(font.cvt), dict((glyph.glyphname, glyph.ttinstrs) for glyph in font.glyphs()))
+  font.close()
+  return result
+
+cvt, instrs = instruct(1)
+if not any(instrs.values()):
+  raise ValueError("Nothing was instructed")
+cvt4, instrs4 = instruct(4)
+if cvt4!=cvt:
+  raise ValueError("The cvt changed with 4 threads")
+for name in instrs:
+  if instrs4[name]!=instrs[name]:
+    raise ValueError("Instructions of %s changed with 4 threads" % name)
+
+# Glyphs left unselected keep what they had
+font = fontforge.open(sys.argv[1])
+font.is_quadratic = True
+font.selection.all()
+font.autoHint()
+font.autoInstr(threads=4)
+A = font["A"].ttinstrs
+font.selection.select("B")
+font["A"].ttinstrs = b""
+font.autoInstr(threads=4)
+if font["A"].ttinstrs!=b"" or font["B"].ttinstrs!=instrs["B"]:
+  raise ValueError("Instructing B changed A, or B got other instructions")
+font.close()
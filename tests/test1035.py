@@ -0,0 +1,71 @@
+#Needs: fonts/DejaVuSerif.sfd
+#Validating a whole font on several threads finds what it finds on one, and
+# a validation cache gives the same results without looking again at glyphs
+# whose outlines it has seen
+
+import os, shutil, sys, tempfile, fontforge, psMat
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+cache = os.path.join(results, "validation.cache")
+
+def states(font):
+  return dict((glyph.glyphname, glyph.validation_state) for glyph in font.glyphs())
+
+def validate(**keywords):
+  font = fontforge.open(sys.argv[1])
+  found = font.validate(1, **keywords)
+  return font, found
+
+font, found = validate(threads=1)
+serial = states(font)
+font.close()
+
+font, parallel = validate(threads=4)
+if parallel!=found or states(font)!=serial:
+  raise ValueError("Validating on 4 threads found something else")
+font.close()
+
+font, cached = validate(cache=cache)
+if cached!=found or states(font)!=serial:
+  raise ValueError("Validating with an empty cache found something else")
+font.close()
+with open(cache) as f:
+  lines = f.readlines()
+if len(lines)<2:
+  raise ValueError("Nothing was put in the validation cache")
+
+# Nothing new is found, so the cache needn't be written again
+os.utime(cache, (0, 0))
+font, cached = validate(cache=cache)
+if cached!=found or states(font)!=serial:
+  raise ValueError("Validating from the cache found something else")
+font.close()
+if os.stat(cache).st_mtime!=0:
+  raise ValueError("The validation cache was rewritten with nothing added")
+
+# Show that the outlines really are taken from the cache, by making every
+#  entry in it say extrema are missing
+with open(cache, "w") as f:
+  f.write(lines[0])
+  for line in lines[1:]:
+    f.write("%s %x\n" % (line.split()[0], 0x20))
+font, cached = validate(cache=cache)
+for name, state in states(font).items():
+  if not state&0x20:
+    raise ValueError("%s was validated again, not taken from the cache" % name)
+font.close()
+
+# But a glyph whose outlines changed is looked at afresh
+font = fontforge.open(sys.argv[1])
+font["H"].transform(psMat.translate(0.5, 0))
+font.validate(1)
+moved = font["H"].validation_state
+font.close()
+font = fontforge.open(sys.argv[1])
+font["H"].transform(psMat.translate(0.5, 0))
+font.validate(1, cache=cache)
+if font["H"].validation_state!=moved:
+  raise ValueError("H was moved but its validation came from the cache")
+font.close()
+
+shutil.rmtree(results)
@@ -0,0 +1,80 @@
+#Needs: fonts/DejaVuSerif.sfd
+#Glyphs rasterized by FreeType come out the same however often they are
+# asked for, and as they would from a fresh font after they, a glyph they
+# refer to or the font have changed
+
+import os, shutil, sys, tempfile, fontforge, psMat
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+# A copy, as opening a file which is open already gives the same font
+copy = os.path.join(results, "Copy.sfd")
+shutil.copyfile(sys.argv[1], copy)
+
+def raster(font, name):
+  path = os.path.join(results, "glyph.bmp")
+  font[name].export(path, 16, 1)
+  with open(path, "rb") as f:
+    return f.read()
+
+# From a font which has rasterized nothing before
+def fresh(change, name):
+  font = fontforge.open(copy)
+  change(font)
+  result = raster(font, name)
+  font.close()
+  return result
+
+def nothing(font):
+  pass
+
+def stretch(font):
+  font["A"].transform(psMat.scale(1.25, 1))
+
+# Leaves the widths alone, so only the reference tells Aacute has changed
+def squash(font):
+  stretch(font)
+  font["A"].transform(psMat.scale(1, 0.6))
+
+def cvt(font):
+  font.cvt = tuple(value+10 for value in font.cvt)
+
+def squashcvt(font):
+  squash(font)
+  cvt(font)
+
+font = fontforge.open(sys.argv[1])
+if [ref[0] for ref in font["Aacute"].references][:1]!=["A"]:
+  raise ValueError("Aacute should refer to A")
+# Enough glyphs that one font of them all is made
+names = ["A", "Aacute"] + [glyph.glyphname for glyph in font.glyphs()
+                           if glyph.isWorthOutputting()][:200]
+first = dict((name, raster(font, name)) for name in names)
+for name in names:
+  if raster(font, name)!=first[name]:
+    raise ValueError("%s came out differently the second time" % name)
+for name in names[::25]:
+  if fresh(nothing, name)!=first[name]:
+    raise ValueError("%s came out differently from a fresh font" % name)
+
+stretch(font)
+for name in ("A", "Aacute"):
+  stretched = raster(font, name)
+  if stretched==first[name]:
+    raise ValueError("%s is as it was before A was stretched" % name)
+  if stretched!=fresh(stretch, name):
+    raise ValueError("%s differs from a fresh stretched one" % name)
+if raster(font, "B")!=first["B"]:
+  raise ValueError("B changed when A was stretched")
+
+font["A"].transform(psMat.scale(1, 0.6))
+for name in ("A", "Aacute"):
+  if raster(font, name)!=fresh(squash, name):
+    raise ValueError("%s differs from a fresh one after A was squashed" % name)
+
+cvt(font)
+for name in ("A", "B"):
+  if raster(font, name)!=fresh(squashcvt, name):
+    raise ValueError("%s differs from a fresh one after the cvt changed" % name)
+font.close()
+
+shutil.rmtree(results)
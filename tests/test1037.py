@@ -0,0 +1,45 @@
+#Glyphs made for a bitmap font import get their code points from their
+# names, and lookups by code point must find them
+
+import os, shutil, tempfile, fontforge
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+bdfname = os.path.join(results, "test.bdf")
+
+# B sits in slot 300, so it is not found through the encoding
+with open(bdfname, "w") as bdf:
+  bdf.write("""STARTFONT 2.1
+FONT -misc-test-medium-r-normal--12-120-75-75-p-60-iso10646-1
+SIZE 12 75 75
+FONTBOUNDINGBOX 6 12 0 -2
+STARTPROPERTIES 2
+FONT_ASCENT 10
+FONT_DESCENT 2
+ENDPROPERTIES
+CHARS 1
+STARTCHAR B
+ENCODING 300
+SWIDTH 500 0
+DWIDTH 6 0
+BBX 2 2 0 0
+BITMAP
+C0
+C0
+ENDCHAR
+ENDFONT
+""")
+
+font = fontforge.font()
+font.encoding = "custom"
+font.createChar(0x41, "A").width = 500
+# Look U+0042 up while it is missing
+if font.findEncodingSlot(0x42)!=-1:
+  raise ValueError("U+0042 found before it was imported")
+
+font.importBitmaps(bdfname)
+font.removeGlyph(0x42)
+if [g.unicode for g in font.glyphs()].count(0x42)!=0:
+  raise ValueError("U+0042 was not removed")
+
+font.close()
+shutil.rmtree(results)
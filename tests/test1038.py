@@ -0,0 +1,52 @@
+#Needs: fonts/Ambrosia.sfd
+#An autosave recovers glyphs changed without going through the usual
+# change hooks (as Glyph Info does), and does not bring back edits to
+# glyphs since removed
+
+import os, sys, shutil, tempfile, fontforge
+import __FontForge_Internals___ as internals
+
+results = tempfile.mkdtemp('.tmp','fontforge-test-')
+copy = os.path.join(results, "Ambrosia.sfd")
+autosave = os.path.join(results, "Ambrosia.asfd")
+shutil.copyfile(sys.argv[1], copy)
+
+def contents():
+  with open(autosave) as f:
+    return f.read()
+
+font = fontforge.open(copy)
+oldwidth = font["B"].width
+
+font["A"].width = font["A"].width + 17
+internals.autoSave(font, autosave)
+if "Journal:" in contents():
+  raise ValueError("The first autosave should be a snapshot")
+
+# Renaming sets the glyph's changed flag directly, as Glyph Info does
+font["C"].glyphname = "Cee"
+internals.autoSave(font, autosave)
+if "Journal:" not in contents() or "StartChar: Cee" not in contents():
+  raise ValueError("A renamed glyph should be journaled")
+
+font["B"].width = oldwidth + 23
+internals.autoSave(font, autosave)
+font.removeGlyph("B")
+internals.autoSave(font, autosave)
+if "Journal:" in contents() or "StartChar: B\n" in contents():
+  raise ValueError("Removing a glyph should start a new snapshot without it")
+
+# As after a crash: the font is not open, and its autosave is still there
+awidth = font["A"].width
+shutil.copyfile(autosave, autosave + ".kept")
+font.close()
+recovered = internals.recoverFile(autosave + ".kept")
+if "Cee" not in recovered or "C" in recovered:
+  raise ValueError("The rename was not recovered")
+if recovered["A"].width != awidth:
+  raise ValueError("The edit to A was not recovered")
+if "B" in recovered and recovered["B"].width != oldwidth:
+  raise ValueError("An edit to a removed glyph came back")
+
+recovered.close()
+shutil.rmtree(results)